@@ -7,6 +7,22 @@
 
 #include "app_config.h"
 
+#include <alert_limiter.h>
+#include <bme680.h>
+#include <dns_cache.h>
+#include <espnow_frame.h>
+#include <i2c_bus.h>
+#include <event_batch.h>
+#include <plausibility_filter.h>
+#include <reading_batch.h>
+#include <recovery_ladder.h>
+#include <report_policy.h>
+#include <tx_power.h>
+#include <wake_budget.h>
+#include <wifi_backoff.h>
+#include <wifi_link.h>
+#include <wifi_roaming.h>
+
 // One environmental sample plus optional battery information collected during
 // the same cycle.
 struct SensorReadings {
@@ -31,13 +47,49 @@ enum class RuntimeMode {
   UsbService,
 };
 
+// Upper bound for one serialized TLS session, including its session ticket.
+constexpr size_t TLS_SESSION_MAX_BYTES = 400;
+
+// Number of hosts whose TLS sessions are retained across deep sleep.
+constexpr size_t TLS_SESSION_CACHE_SLOTS = 2;
+
+// One resumable TLS session retained across deep sleep, keyed by host name.
+// `length` is zero for an empty slot.
+struct TlsSessionSlot {
+  char host[64];
+  uint16_t length;
+  uint32_t lastUsedSequence;
+  uint8_t data[TLS_SESSION_MAX_BYTES];
+};
+
 // Retained values that should survive deep sleep without re-deriving them on
 // every boot.
 struct PersistentState {
   SensorReadings lastGood;
   bool hasLastGood = false;
+  envnode::core::ReportState reportState;
   bool lowBatteryAlertActive = false;
   bool lowBatteryAlertPending = false;
+  envnode::core::ReadingRing pendingReadings;
+  TlsSessionSlot tlsSessions[TLS_SESSION_CACHE_SLOTS];
+  uint32_t tlsSessionSequence = 0;
+  envnode::core::DnsCache dnsCache;
+  envnode::core::RetainedLink wifiLink;
+  envnode::core::RoamingTable wifiRoaming;
+  envnode::core::TxPowerState wifiTxPower;
+  envnode::core::WiFiBackoff wifiBackoff;
+  bool journalStateKnown = false;
+  uint32_t journalPendingBytes = 0;
+  bool gzipUploadsRejected = false;
+  envnode::core::AlertLimiter webhookLimiter;
+  envnode::core::FrameCounter espNowCounter;
+  uint16_t sensorSettleMs = 0;
+  uint16_t sensorSettleMaxMs = 0;
+  uint16_t sensorSettleTimeouts = 0;
+  envnode::core::Bme680CalibrationCache bmeCalibration;
+  envnode::core::I2cSpeedState i2cSpeed;
+  envnode::core::RecoveryLadder recoveryLadder;
+  envnode::core::PlausibilityHistory plausibility;
 };
 
 // Runtime state shared by the firmware modules while the board is awake.
@@ -48,24 +100,29 @@ struct AppContext {
   uint8_t bmeAddress = 0;
   bool bmeInitialized = false;
   bool sensePowerEnabled = false;
+  unsigned long sensePowerOnMs = 0;
   bool lastI2cClearRequired = false;
+  envnode::core::I2cBusCounters i2cCounters;
   bool inErrorState = false;
-  unsigned long lastWebhookSent = 0;
   bool networkAvailable = false;
   wl_status_t lastReportedWiFiStatus = WL_IDLE_STATUS;
   bool wifiHasConfiguredSta = false;
   wifi_event_id_t wifiEventLoggerHandle = 0;
-  uint8_t targetBssid[6] = {0};
-  bool hasTargetBssid = false;
-  int32_t targetChannel = 0;
+  bool wifiAccessPointPinned = false;
+  bool wifiLeaseReused = false;
   uint16_t lastWiFiDisconnectReason = 0;
   uint32_t wifiConnectFailures = 0;
+  bool wifiConnectInProgress = false;
+  bool wifiConnectAuthIssue = false;
+  unsigned long wifiConnectStartedMs = 0;
   unsigned long lastSampleRunMs = 0;
   String serialInputBuffer;
   bool holdAwakeForDiagnostics = false;
   bool usbServiceEventSent = false;
   bool usbServiceWebhookSent = false;
   String sessionId;
+  envnode::core::EventBatch pendingEvents;
+  envnode::core::WakeBudget wakeBudget;
 };
 
 extern AppContext gApp;
@@ -83,12 +140,38 @@ const char* runtimeModeName(RuntimeMode mode);
 // Indicates whether a last-known-good reading is currently available.
 bool hasLastGoodReading();
 
-// Returns the last-known-good reading when available, otherwise `nullptr`.
-const SensorReadings* getLastGoodReading();
-
 // Stores a newly accepted reading as the retained last-known-good snapshot.
 void setLastGoodReading(const SensorReadings& readings);
 
+// Applies the deadband policy to an accepted reading: whether it differs
+// enough from the last reported one, or the silence limit has passed.
+envnode::core::ReportDecision evaluateReadingReport(const SensorReadings& readings);
+
+// Indicates whether the next reading will be reported regardless of its
+// values, so the sampling path can decide to start Wi-Fi early.
+bool readingKeepAliveDue();
+
+// Queues an accepted reading in the retained ring for the next batched upload
+// and makes it the reference for the deadband policy.
+void queuePendingReading(const SensorReadings& readings);
+
+// Returns how many readings are waiting in the retained upload ring.
+size_t pendingReadingCount();
+
+// Indicates whether the retained ring has reached its configured flush size.
+bool pendingReadingsFlushDue();
+
+// Returns the synchronized wall-clock time, or 0 if the clock was never set.
+uint32_t currentEpochSeconds();
+
+// Returns the RTC-backed system clock in seconds whether or not it has been
+// synchronized. It keeps counting through deep sleep, so it can time intervals
+// that span several wakes.
+uint32_t rtcClockSeconds();
+
+// Sets the wall clock from a trusted source such as an HTTP `Date` header.
+void setWallClockEpochSeconds(uint32_t epochSeconds);
+
 // Clamps a requested interval to the firmware's allowed runtime bounds.
 uint32_t sanitizeSampleIntervalSeconds(uint32_t intervalSeconds);
 
@@ -40,6 +40,33 @@
 // Low-battery alert defaults: warn at 3.50 V and clear at 3.65 V.
 // #define LOW_BATTERY_ALERT_V 3.5f
 // #define LOW_BATTERY_CLEAR_V 3.65f
+// Number of readings batched in RTC memory before one bulk upload (max 24).
+// #define READING_BATCH_FLUSH_COUNT 6
+// #define DEBUG_READING_BATCH_FLUSH_COUNT 1
+// Deadbands for reporting a reading, and the longest silence before a
+// keep-alive row is forced (REPORT_MAX_SILENCE_SECONDS 0 reports every reading).
+// #define REPORT_DEADBAND_TEMP_C 0.2f
+// #define REPORT_DEADBAND_HUMIDITY_RH 1.0f
+// #define REPORT_DEADBAND_PRESSURE_HPA 0.5f
+// #define REPORT_DEADBAND_BATTERY_V 0.05f
+// #define REPORT_MAX_SILENCE_SECONDS 3600
+// Upload buffered events immediately when an error-severity event is queued.
+// #define FLUSH_EVENTS_ON_ERROR 1
+// Gzip Supabase insert bodies at or above this many bytes (0 disables it).
+// #define UPLOAD_GZIP_MIN_BYTES 512
+// Flash journal for readings/events taken while offline (0 disables it).
+// #define JOURNAL_MAX_BYTES (256UL * 1024UL)
+// #define JOURNAL_SEGMENT_BYTES (16UL * 1024UL)
+// #define JOURNAL_REPLAY_MAX_BATCHES 4
+// Per-alert-type webhook limits: burst size, seconds per extra alert, and the
+// window in which an identical alert is suppressed (ALERT_BURST 0 disables).
+// #define ALERT_BURST 3
+// #define ALERT_REFILL_SECONDS 1200
+// #define ALERT_DEDUP_SECONDS 600
+// Seconds a resolved host address is reused across wakes (0 disables the cache).
+// #define DNS_CACHE_TTL_SECONDS 3600
+// Longest time one automatic wake may spend on network work (0 disables it).
+// #define WAKE_BUDGET_MS 20000
 // #define MIN_SAMPLE_INTERVAL_SECONDS 60
 // #define MAX_SAMPLE_INTERVAL_SECONDS 86400
 
@@ -61,11 +88,53 @@
 // #define WIFI_DNS2 8,8,8,8
 // #define WIFI_OVERRIDE_DNS 1
 // #define WIFI_TX_POWER_DBM 15
+// Adapt TX power per wake from RSSI and connect results, within these limits
+// (0 keeps WIFI_TX_POWER_DBM fixed). RSSI above STEP_DOWN lets power drop;
+// RSSI below RAISE raises it.
+// #define WIFI_TX_POWER_ADAPTIVE 1
+// #define WIFI_TX_POWER_MIN_DBM 8
+// #define WIFI_TX_POWER_MAX_DBM 19
+// #define WIFI_TX_POWER_STEP_DOWN_RSSI -60
+// #define WIFI_TX_POWER_RAISE_RSSI -72
+// Start Wi-Fi association while the sensor powers up and is read (0 disables).
+// #define WIFI_EARLY_CONNECT 1
+// After this many failed connects in a row, automatic wakes only sample and
+// buffer; attempts are spaced BASE, 2x BASE, ... up to MAX seconds apart
+// (WIFI_BACKOFF_MAX_SECONDS 0 disables the backoff).
+// #define WIFI_BACKOFF_AFTER_FAILURES 2
+// #define WIFI_BACKOFF_BASE_SECONDS 600
+// #define WIFI_BACKOFF_MAX_SECONDS 3600
+// Reconnect on timer wakes to the last access point and channel, reusing the
+// last DHCP lease until half its lifetime (capped below) has passed.
+// #define WIFI_FAST_RECONNECT 1
+// #define WIFI_LEASE_REUSE_MAX_SECONDS 43200
+
+// Send readings to an always-on gateway over ESP-NOW instead of over Wi-Fi.
+// The key (at least 16 characters) must match on every node and the gateway;
+// the MAC is the gateway's station MAC. Channel 0 uses the access point's
+// channel from the last Wi-Fi connection. The gateway build (see the
+// xiao-esp32s3-gateway environment) uploads once FLUSH_ROWS readings are
+// waiting or the oldest has waited MAX_HOLD_SECONDS.
+// #define ESPNOW_UPLINK 1
+// #define ESPNOW_KEY "change-me-to-a-long-random-string"
+// #define ESPNOW_GATEWAY_MAC 0x24,0x0A,0xC4,0x00,0x00,0x01
+// #define ESPNOW_CHANNEL 0
+// #define ESPNOW_ACK_TIMEOUT_MS 60
+// #define ESPNOW_GATEWAY_FLUSH_ROWS 24
+// #define ESPNOW_GATEWAY_MAX_HOLD_SECONDS 300
+
+// Longest wait for the BME680 to answer after its power rail is switched on.
+// The firmware continues as soon as the chip ID reads back.
+// #define SENSOR_POWER_SETTLE_MS 500
+
+// Runs the sensor bus at 400 kHz, falling back to 100 kHz for a while after a
+// NACK or timeout. Set to 0 to always run at 100 kHz, e.g. on long wiring.
+// #define I2C_FAST_MODE 1
 
 // Optional serial config window on non-timer boots. Set to 0 to disable.
 // Supported commands: `help`, `interval`, `interval <seconds>`, `interval default`,
 // `mode`, `status`, `scan`, `ping`, `resolve <host>`, `txpower`, `reconnect`,
-// `sample`, `sample upload`, and `voltage`
+// `journal`, `espnow`, `sample`, `sample upload`, and `voltage`
 // #define SERIAL_CONFIG_WINDOW_MS 5000
 
 // Enable USB host service mode on non-timer boots when the board is attached
@@ -0,0 +1,141 @@
+// Per-alert-type token buckets and deduplication.
+
+#include "alert_limiter.h"
+
+namespace envnode::core {
+
+namespace {
+
+// FNV-1a, remapped so a real string never hashes to the free-slot marker.
+uint32_t HashText(const char* text) {
+  uint32_t hash = 2166136261U;
+  for (const char* p = text ? text : ""; *p; ++p) {
+    hash = (hash ^ static_cast<uint8_t>(*p)) * 16777619U;
+  }
+  return hash ? hash : 1U;
+}
+
+AlertBucket* FindBucket(AlertLimiter& limiter, uint32_t typeHash) {
+  for (AlertBucket& bucket : limiter.buckets) {
+    if (bucket.typeHash == typeHash) {
+      return &bucket;
+    }
+  }
+  return nullptr;
+}
+
+// Returns a free slot, or the one whose type was sent least recently.
+AlertBucket& ClaimBucket(AlertLimiter& limiter) {
+  AlertBucket* oldest = &limiter.buckets[0];
+  for (AlertBucket& bucket : limiter.buckets) {
+    if (bucket.typeHash == 0) {
+      return bucket;
+    }
+    if (bucket.lastSentAt < oldest->lastSentAt) {
+      oldest = &bucket;
+    }
+  }
+  return *oldest;
+}
+
+// Adds the whole tokens earned since the last refill. The remainder carries
+// over so a steady trickle of alerts still refills at the configured rate. A
+// clock that moved backwards (for example when it is first synchronized)
+// restarts the refill period instead of granting tokens.
+void Refill(AlertBucket& bucket, const AlertLimiterConfig& config, uint32_t nowSeconds) {
+  if (bucket.tokens >= config.burst || nowSeconds < bucket.refilledAt) {
+    bucket.refilledAt = nowSeconds;
+    return;
+  }
+  const uint32_t earned = config.refillSeconds
+                              ? (nowSeconds - bucket.refilledAt) / config.refillSeconds
+                              : config.burst;
+  if (earned == 0) {
+    return;
+  }
+  if (earned >= static_cast<uint32_t>(config.burst - bucket.tokens)) {
+    bucket.tokens = config.burst;
+    bucket.refilledAt = nowSeconds;
+  } else {
+    bucket.tokens += static_cast<uint8_t>(earned);
+    bucket.refilledAt += earned * config.refillSeconds;
+  }
+}
+
+}  // namespace
+
+// Unknown types have a full bucket, so their first alert is always sent.
+AlertDecision CheckAlert(AlertLimiter& limiter,
+                         const AlertLimiterConfig& config,
+                         const char* alertType,
+                         const char* message,
+                         uint32_t nowSeconds) {
+  AlertBucket* bucket = FindBucket(limiter, HashText(alertType));
+  if (!bucket) {
+    return AlertDecision::Send;
+  }
+
+  Refill(*bucket, config, nowSeconds);
+  AlertDecision decision = AlertDecision::Send;
+  if (config.dedupSeconds && bucket->lastMessageHash == HashText(message) &&
+      nowSeconds >= bucket->lastSentAt &&
+      nowSeconds - bucket->lastSentAt < config.dedupSeconds) {
+    decision = AlertDecision::Duplicate;
+  } else if (bucket->tokens == 0) {
+    decision = AlertDecision::RateLimited;
+  }
+
+  if (decision != AlertDecision::Send && bucket->suppressed < UINT16_MAX) {
+    ++bucket->suppressed;
+  }
+  return decision;
+}
+
+// Claims a slot for types seen for the first time, starting from a full bucket.
+void RecordAlertSent(AlertLimiter& limiter,
+                     const AlertLimiterConfig& config,
+                     const char* alertType,
+                     const char* message,
+                     uint32_t nowSeconds) {
+  const uint32_t typeHash = HashText(alertType);
+  AlertBucket* bucket = FindBucket(limiter, typeHash);
+  if (!bucket) {
+    bucket = &ClaimBucket(limiter);
+    *bucket = AlertBucket();
+    bucket->typeHash = typeHash;
+    bucket->tokens = config.burst;
+    bucket->refilledAt = nowSeconds;
+  }
+
+  Refill(*bucket, config, nowSeconds);
+  if (bucket->tokens > 0) {
+    --bucket->tokens;
+  }
+  bucket->lastMessageHash = HashText(message);
+  bucket->lastSentAt = nowSeconds;
+  bucket->suppressed = 0;
+}
+
+uint16_t SuppressedAlertCount(const AlertLimiter& limiter, const char* alertType) {
+  const uint32_t typeHash = HashText(alertType);
+  for (const AlertBucket& bucket : limiter.buckets) {
+    if (bucket.typeHash == typeHash) {
+      return bucket.suppressed;
+    }
+  }
+  return 0;
+}
+
+const char* AlertDecisionName(AlertDecision decision) {
+  switch (decision) {
+    case AlertDecision::Send:
+      return "send";
+    case AlertDecision::RateLimited:
+      return "rate limited";
+    case AlertDecision::Duplicate:
+      return "duplicate";
+  }
+  return "unknown";
+}
+
+}  // namespace envnode::core
@@ -0,0 +1,75 @@
+// Per-alert-type rate limiting for outgoing notifications.
+//
+// Each alert type gets a token bucket: `burst` alerts may go out back to back,
+// after which one more is allowed every `refillSeconds`. An alert whose type
+// and message match the last one sent within `dedupSeconds` is suppressed as a
+// duplicate. Suppressed alerts are counted per type so the next alert that
+// does go out can report how many were held back. The state is plain data so
+// the firmware can keep it in RTC memory across deep sleep.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace envnode::core {
+
+// Alert types tracked at once; the least recently sent type is evicted when a
+// new one needs a slot.
+constexpr size_t kAlertLimiterSlots = 8;
+
+// Rate-limit settings shared by every alert type.
+struct AlertLimiterConfig {
+  uint8_t burst = 3;
+  uint32_t refillSeconds = 1200;
+  uint32_t dedupSeconds = 600;
+};
+
+// Bucket state for one alert type. Hashes stand in for the strings so the
+// slot stays small enough for RTC memory. A zero `typeHash` marks a free slot.
+struct AlertBucket {
+  uint32_t typeHash = 0;
+  uint32_t lastMessageHash = 0;
+  uint32_t lastSentAt = 0;
+  uint32_t refilledAt = 0;
+  uint16_t suppressed = 0;
+  uint8_t tokens = 0;
+};
+
+// All tracked alert types.
+struct AlertLimiter {
+  AlertBucket buckets[kAlertLimiterSlots];
+};
+
+// Whether an alert may be sent now.
+enum class AlertDecision : uint8_t {
+  Send,
+  RateLimited,
+  Duplicate,
+};
+
+// Decides whether an alert of `alertType` with `message` may be sent at
+// `nowSeconds`. Refused alerts are counted as suppressed. An allowed alert
+// consumes nothing until `RecordAlertSent()` confirms it was delivered.
+AlertDecision CheckAlert(AlertLimiter& limiter,
+                         const AlertLimiterConfig& config,
+                         const char* alertType,
+                         const char* message,
+                         uint32_t nowSeconds);
+
+// Consumes a token for a delivered alert, remembers its message for
+// deduplication, and clears the suppressed count.
+void RecordAlertSent(AlertLimiter& limiter,
+                     const AlertLimiterConfig& config,
+                     const char* alertType,
+                     const char* message,
+                     uint32_t nowSeconds);
+
+// Returns how many alerts of `alertType` were suppressed since the last one
+// was sent.
+uint16_t SuppressedAlertCount(const AlertLimiter& limiter, const char* alertType);
+
+// Returns a stable printable name for `decision`.
+const char* AlertDecisionName(AlertDecision decision);
+
+}  // namespace envnode::core
@@ -0,0 +1,210 @@
+// BME680 calibration parsing and integer compensation implementation.
+
+#include "bme680.h"
+
+#include <cstring>
+
+#include "crc32.h"
+
+namespace envnode::core {
+
+namespace {
+
+// Measurement cycles per oversampling code, from the datasheet.
+constexpr uint8_t kOversamplingCycles[] = {0, 1, 2, 4, 8, 16};
+
+uint16_t Unsigned16(uint8_t msb, uint8_t lsb) {
+  return static_cast<uint16_t>((static_cast<uint16_t>(msb) << 8) | lsb);
+}
+
+int16_t Signed16(uint8_t msb, uint8_t lsb) {
+  return static_cast<int16_t>(Unsigned16(msb, lsb));
+}
+
+uint8_t Cycles(Bme680Oversampling oversampling) {
+  const uint8_t code = static_cast<uint8_t>(oversampling);
+  return code < sizeof(kOversamplingCycles) ? kOversamplingCycles[code] : 16;
+}
+
+// Reports whether every byte of `data` equals `value`.
+bool AllBytes(const uint8_t* data, size_t length, uint8_t value) {
+  for (size_t i = 0; i < length; ++i) {
+    if (data[i] != value) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Checksum over the key and both blocks, field by field so struct padding
+// never takes part.
+uint32_t CalibrationCacheCrc(const Bme680CalibrationCache& cache) {
+  uint32_t crc = Crc32(&cache.address, 1);
+  crc = Crc32(&cache.chipId, 1, crc);
+  crc = Crc32(cache.block1, sizeof(cache.block1), crc);
+  return Crc32(cache.block2, sizeof(cache.block2), crc);
+}
+
+}  // namespace
+
+// Offsets follow the two blocks read back to back, as in Bosch's reference
+// driver. Humidity H1 and H2 are 12-bit values that share register 0xE2.
+bool ParseBme680Calibration(const uint8_t* block1, const uint8_t* block2, Bme680Calibration& out) {
+  if ((AllBytes(block1, kBme680Calibration1Bytes, 0x00) &&
+       AllBytes(block2, kBme680Calibration2Bytes, 0x00)) ||
+      (AllBytes(block1, kBme680Calibration1Bytes, 0xFF) &&
+       AllBytes(block2, kBme680Calibration2Bytes, 0xFF))) {
+    return false;
+  }
+
+  out.parT2 = Signed16(block1[2], block1[1]);
+  out.parT3 = static_cast<int8_t>(block1[3]);
+  out.parP1 = Unsigned16(block1[6], block1[5]);
+  out.parP2 = Signed16(block1[8], block1[7]);
+  out.parP3 = static_cast<int8_t>(block1[9]);
+  out.parP4 = Signed16(block1[12], block1[11]);
+  out.parP5 = Signed16(block1[14], block1[13]);
+  out.parP7 = static_cast<int8_t>(block1[15]);
+  out.parP6 = static_cast<int8_t>(block1[16]);
+  out.parP8 = Signed16(block1[20], block1[19]);
+  out.parP9 = Signed16(block1[22], block1[21]);
+  out.parP10 = block1[23];
+
+  out.parH2 = static_cast<uint16_t>((static_cast<uint16_t>(block2[0]) << 4) | (block2[1] >> 4));
+  out.parH1 = static_cast<uint16_t>((static_cast<uint16_t>(block2[2]) << 4) | (block2[1] & 0x0F));
+  out.parH3 = static_cast<int8_t>(block2[3]);
+  out.parH4 = static_cast<int8_t>(block2[4]);
+  out.parH5 = static_cast<int8_t>(block2[5]);
+  out.parH6 = block2[6];
+  out.parH7 = static_cast<int8_t>(block2[7]);
+  out.parT1 = Unsigned16(block2[9], block2[8]);
+  return true;
+}
+
+void StoreBme680Calibration(Bme680CalibrationCache& cache, uint8_t address, uint8_t chipId,
+                            const uint8_t* block1, const uint8_t* block2) {
+  cache.address = address;
+  cache.chipId = chipId;
+  std::memcpy(cache.block1, block1, sizeof(cache.block1));
+  std::memcpy(cache.block2, block2, sizeof(cache.block2));
+  cache.crc = CalibrationCacheCrc(cache);
+}
+
+// A zeroed cache never validates: the checksum of its fields is not zero.
+bool Bme680CalibrationCacheValid(const Bme680CalibrationCache& cache, uint8_t address,
+                                 uint8_t chipId) {
+  return cache.address == address && cache.chipId == chipId &&
+         cache.crc == CalibrationCacheCrc(cache);
+}
+
+uint8_t Bme680CtrlHum(const Bme680Settings& settings) {
+  return static_cast<uint8_t>(settings.humidity) & 0x07;
+}
+
+uint8_t Bme680CtrlMeas(const Bme680Settings& settings, bool forced) {
+  return static_cast<uint8_t>(((static_cast<uint8_t>(settings.temperature) & 0x07) << 5) |
+                              ((static_cast<uint8_t>(settings.pressure) & 0x07) << 2) |
+                              (forced ? 0x01 : 0x00));
+}
+
+uint8_t Bme680Config(const Bme680Settings& settings) {
+  return static_cast<uint8_t>((settings.filterCode & 0x07) << 2);
+}
+
+// Each oversampling cycle takes 1.963 ms, plus switching time between the
+// three measurements, the gas slot the sensor steps through even with the
+// heater off, and 1 ms for the sensor to wake up.
+uint32_t Bme680MeasurementMs(const Bme680Settings& settings) {
+  uint32_t micros = (Cycles(settings.temperature) + Cycles(settings.pressure) +
+                     Cycles(settings.humidity)) * 1963U;
+  micros += 477U * 4U;
+  micros += 477U * 5U;
+  return (micros + 999U) / 1000U + 1U;
+}
+
+// Pressure and temperature are 20-bit values, left-aligned over three
+// registers; humidity is 16 bits.
+Bme680RawSample DecodeBme680Field(const uint8_t* field) {
+  Bme680RawSample sample;
+  sample.newData = (field[0] & 0x80) != 0;
+  sample.measuring = (field[0] & 0x20) != 0;
+  sample.pressureAdc = (static_cast<uint32_t>(field[2]) << 12) |
+                       (static_cast<uint32_t>(field[3]) << 4) | (field[4] >> 4);
+  sample.temperatureAdc = (static_cast<uint32_t>(field[5]) << 12) |
+                          (static_cast<uint32_t>(field[6]) << 4) | (field[7] >> 4);
+  sample.humidityAdc = Unsigned16(field[8], field[9]);
+  return sample;
+}
+
+// Transcribed from Bosch's BME680 reference driver, keeping its integer widths
+// and shift order. The cubic pressure term, which overflows 32 bits above
+// about 106 kPa there, is computed in 64 bits here, and left shifts of values
+// that can be negative are written as multiplications, which is the same
+// arithmetic without the undefined behavior.
+Bme680Compensated CompensateBme680(const Bme680Calibration& calibration,
+                                   const Bme680RawSample& sample) {
+  Bme680Compensated out;
+
+  int64_t var1 = (static_cast<int32_t>(sample.temperatureAdc) >> 3) -
+                 (static_cast<int32_t>(calibration.parT1) << 1);
+  int64_t var2 = (var1 * static_cast<int32_t>(calibration.parT2)) >> 11;
+  int64_t var3 = ((var1 >> 1) * (var1 >> 1)) >> 12;
+  var3 = (var3 * (static_cast<int32_t>(calibration.parT3) * 16)) >> 14;
+  const int32_t tFine = static_cast<int32_t>(var2 + var3);
+  out.centiCelsius = static_cast<int16_t>(((tFine * 5) + 128) >> 8);
+
+  int32_t p1 = (tFine >> 1) - 64000;
+  int32_t p2 = ((((p1 >> 2) * (p1 >> 2)) >> 11) * static_cast<int32_t>(calibration.parP6)) >> 2;
+  p2 = p2 + ((p1 * static_cast<int32_t>(calibration.parP5)) * 2);
+  p2 = (p2 >> 2) + (static_cast<int32_t>(calibration.parP4) * 65536);
+  p1 = (((((p1 >> 2) * (p1 >> 2)) >> 13) * (static_cast<int32_t>(calibration.parP3) * 32)) >> 3) +
+       ((static_cast<int32_t>(calibration.parP2) * p1) >> 1);
+  p1 = p1 >> 18;
+  p1 = ((32768 + p1) * static_cast<int32_t>(calibration.parP1)) >> 15;
+  int32_t pressure = 1048576 - static_cast<int32_t>(sample.pressureAdc);
+  pressure = static_cast<int32_t>(static_cast<uint32_t>(pressure - (p2 >> 12)) * 3125U);
+  if (p1 == 0) {
+    out.pascals = 0;
+  } else {
+    if (pressure >= 0x40000000) {
+      pressure = (pressure / p1) * 2;
+    } else {
+      pressure = (pressure * 2) / p1;
+    }
+    p1 = (static_cast<int32_t>(calibration.parP9) *
+          static_cast<int32_t>(((pressure >> 3) * (pressure >> 3)) >> 13)) >>
+         12;
+    p2 = ((pressure >> 2) * static_cast<int32_t>(calibration.parP8)) >> 13;
+    const int64_t cube = static_cast<int64_t>(pressure >> 8) * (pressure >> 8) * (pressure >> 8);
+    const int32_t p3 = static_cast<int32_t>((cube * calibration.parP10) >> 17);
+    pressure = pressure + ((p1 + p2 + p3 + (static_cast<int32_t>(calibration.parP7) * 128)) >> 4);
+    out.pascals = static_cast<uint32_t>(pressure);
+  }
+
+  const int32_t tempScaled = ((tFine * 5) + 128) >> 8;
+  const int32_t h1 = static_cast<int32_t>(sample.humidityAdc) -
+                     static_cast<int32_t>(calibration.parH1) * 16 -
+                     (((tempScaled * static_cast<int32_t>(calibration.parH3)) / 100) >> 1);
+  const int32_t h2 =
+      (static_cast<int32_t>(calibration.parH2) *
+       (((tempScaled * static_cast<int32_t>(calibration.parH4)) / 100) +
+        (((tempScaled * ((tempScaled * static_cast<int32_t>(calibration.parH5)) / 100)) >> 6) /
+         100) +
+        (1 << 14))) >>
+      10;
+  const int32_t h3 = h1 * h2;
+  int32_t h4 = static_cast<int32_t>(calibration.parH6) << 7;
+  h4 = (h4 + ((tempScaled * static_cast<int32_t>(calibration.parH7)) / 100)) >> 4;
+  const int32_t h5 = ((h3 >> 14) * (h3 >> 14)) >> 10;
+  const int32_t h6 = (h4 * h5) >> 1;
+  int32_t humidity = (((h3 + h6) >> 10) * 1000) >> 12;
+  if (humidity > 100000) {
+    humidity = 100000;
+  } else if (humidity < 0) {
+    humidity = 0;
+  }
+  out.milliPercentRh = static_cast<uint32_t>(humidity);
+  return out;
+}
+
+}  // namespace envnode::core
@@ -0,0 +1,150 @@
+// BME680 register map, calibration parsing, and integer compensation.
+//
+// The firmware drives the sensor itself instead of going through a blocking
+// library call: it starts a forced measurement, does other work while the
+// sensor converts, and then reads the status and all data registers in one
+// I2C burst. Everything that does not touch the bus lives here: register
+// values for the configuration, the conversion time, decoding of the field
+// registers, and Bosch's fixed-point compensation formulas. Only temperature,
+// pressure, and humidity are used; the gas heater stays off.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace envnode::core {
+
+// Value of the chip ID register on a BME680.
+constexpr uint8_t kBme680ChipId = 0x61;
+
+// Registers and command values used by the driver.
+constexpr uint8_t kBme680RegChipId = 0xD0;
+constexpr uint8_t kBme680RegReset = 0xE0;
+constexpr uint8_t kBme680ResetCommand = 0xB6;
+constexpr uint8_t kBme680RegCtrlGas0 = 0x70;
+constexpr uint8_t kBme680RegCtrlGas1 = 0x71;
+constexpr uint8_t kBme680RegCtrlHum = 0x72;
+constexpr uint8_t kBme680RegCtrlMeas = 0x74;
+constexpr uint8_t kBme680RegConfig = 0x75;
+constexpr uint8_t kBme680RegField0 = 0x1D;
+
+// Calibration coefficients are split over two register blocks.
+constexpr uint8_t kBme680RegCalibration1 = 0x89;
+constexpr size_t kBme680Calibration1Bytes = 25;
+constexpr uint8_t kBme680RegCalibration2 = 0xE1;
+constexpr size_t kBme680Calibration2Bytes = 16;
+
+// First of the two `par_t1` registers, inside the second calibration block.
+// Each chip has its own value, so it doubles as a cheap identity check.
+constexpr uint8_t kBme680RegParT1 = 0xE9;
+
+// Status, measurement index, pressure, temperature, and humidity registers,
+// read as one burst starting at `kBme680RegField0`.
+constexpr size_t kBme680FieldBytes = 10;
+
+// Oversampling register codes.
+enum class Bme680Oversampling : uint8_t {
+  Skip = 0,
+  X1 = 1,
+  X2 = 2,
+  X4 = 3,
+  X8 = 4,
+  X16 = 5,
+};
+
+// Measurement configuration. `filterCode` is the IIR filter register code
+// (2 selects a filter size of 3).
+struct Bme680Settings {
+  Bme680Oversampling temperature = Bme680Oversampling::X8;
+  Bme680Oversampling pressure = Bme680Oversampling::X4;
+  Bme680Oversampling humidity = Bme680Oversampling::X2;
+  uint8_t filterCode = 2;
+};
+
+// Temperature, pressure, and humidity calibration coefficients, named as in
+// the datasheet.
+struct Bme680Calibration {
+  uint16_t parT1 = 0;
+  int16_t parT2 = 0;
+  int8_t parT3 = 0;
+  uint16_t parP1 = 0;
+  int16_t parP2 = 0;
+  int8_t parP3 = 0;
+  int16_t parP4 = 0;
+  int16_t parP5 = 0;
+  int8_t parP6 = 0;
+  int8_t parP7 = 0;
+  int16_t parP8 = 0;
+  int16_t parP9 = 0;
+  uint8_t parP10 = 0;
+  uint16_t parH1 = 0;
+  uint16_t parH2 = 0;
+  int8_t parH3 = 0;
+  int8_t parH4 = 0;
+  int8_t parH5 = 0;
+  uint8_t parH6 = 0;
+  int8_t parH7 = 0;
+};
+
+// Raw calibration blocks of one sensor, kept in RTC memory and NVS so a wake
+// can skip reading them again. The coefficients never change for a given chip.
+// `crc` covers every other field; a cache whose checksum, chip ID, or address
+// does not match is read again from the sensor.
+struct Bme680CalibrationCache {
+  uint8_t address = 0;
+  uint8_t chipId = 0;
+  uint8_t block1[kBme680Calibration1Bytes] = {};
+  uint8_t block2[kBme680Calibration2Bytes] = {};
+  uint32_t crc = 0;
+};
+
+// Raw ADC values and status decoded from the field registers.
+struct Bme680RawSample {
+  bool newData = false;
+  bool measuring = false;
+  uint32_t temperatureAdc = 0;
+  uint32_t pressureAdc = 0;
+  uint16_t humidityAdc = 0;
+};
+
+// Compensated values in the fixed-point units of Bosch's integer formulas.
+struct Bme680Compensated {
+  int16_t centiCelsius = 0;
+  uint32_t pascals = 0;
+  uint32_t milliPercentRh = 0;
+};
+
+// Parses both calibration blocks. Returns false when they look like an absent
+// or unpowered sensor (all zeros or all ones).
+bool ParseBme680Calibration(const uint8_t* block1, const uint8_t* block2, Bme680Calibration& out);
+
+// Stores both raw calibration blocks for the sensor at `address` and seals the
+// cache with its checksum.
+void StoreBme680Calibration(Bme680CalibrationCache& cache, uint8_t address, uint8_t chipId,
+                            const uint8_t* block1, const uint8_t* block2);
+
+// Reports whether `cache` is intact and belongs to a sensor with `chipId` at
+// `address`.
+bool Bme680CalibrationCacheValid(const Bme680CalibrationCache& cache, uint8_t address,
+                                 uint8_t chipId);
+
+// Register values for `settings`. `Bme680CtrlMeas` with `forced` set starts a
+// measurement; without it the sensor stays in sleep mode.
+uint8_t Bme680CtrlHum(const Bme680Settings& settings);
+uint8_t Bme680CtrlMeas(const Bme680Settings& settings, bool forced);
+uint8_t Bme680Config(const Bme680Settings& settings);
+
+// Conversion time of one forced measurement with `settings`, rounded up to
+// whole milliseconds, using the datasheet's per-cycle timing.
+uint32_t Bme680MeasurementMs(const Bme680Settings& settings);
+
+// Decodes the `kBme680FieldBytes` field registers.
+Bme680RawSample DecodeBme680Field(const uint8_t* field);
+
+// Applies Bosch's integer compensation to one raw sample. Temperature is
+// compensated first because pressure and humidity depend on it.
+Bme680Compensated CompensateBme680(const Bme680Calibration& calibration,
+                                   const Bme680RawSample& sample);
+
+}  // namespace envnode::core
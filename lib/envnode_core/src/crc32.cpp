@@ -0,0 +1,30 @@
+// CRC-32 implementation.
+
+#include "crc32.h"
+
+namespace envnode::core {
+
+namespace {
+
+// Nibble-wise lookup table for the reflected CRC-32 polynomial 0xEDB88320.
+constexpr uint32_t kCrc32Nibbles[16] = {
+    0x00000000UL, 0x1DB71064UL, 0x3B6E20C8UL, 0x26D930ACUL,
+    0x76DC4190UL, 0x6B6B51F4UL, 0x4DB26158UL, 0x5005713CUL,
+    0xEDB88320UL, 0xF00F9344UL, 0xD6D6A3E8UL, 0xCB61B38CUL,
+    0x9B64C2B0UL, 0x86D3D2D4UL, 0xA00AE278UL, 0xBDBDF21CUL,
+};
+
+}  // namespace
+
+// Processes four bits per step to keep the table small.
+uint32_t Crc32(const uint8_t* data, size_t length, uint32_t crc) {
+  crc = ~crc;
+  for (size_t i = 0; i < length; ++i) {
+    crc ^= data[i];
+    crc = (crc >> 4) ^ kCrc32Nibbles[crc & 0x0F];
+    crc = (crc >> 4) ^ kCrc32Nibbles[crc & 0x0F];
+  }
+  return ~crc;
+}
+
+}  // namespace envnode::core
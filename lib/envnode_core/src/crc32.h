@@ -0,0 +1,13 @@
+// CRC-32 checksum shared by the flash journal and the gzip encoder.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace envnode::core {
+
+// Computes the standard CRC-32 (IEEE 802.3), continuing from `crc`.
+uint32_t Crc32(const uint8_t* data, size_t length, uint32_t crc = 0);
+
+}  // namespace envnode::core
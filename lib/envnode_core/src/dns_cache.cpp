@@ -0,0 +1,95 @@
+// Retained DNS cache implementation.
+
+#include "dns_cache.h"
+
+#include <cstring>
+
+namespace envnode::core {
+
+namespace {
+
+DnsCacheEntry* FindEntry(DnsCache& cache, const char* host) {
+  if (!host || !host[0]) {
+    return nullptr;
+  }
+  for (DnsCacheEntry& entry : cache.entries) {
+    if (entry.host[0] && strncmp(entry.host, host, sizeof(entry.host)) == 0) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+// Returns a free slot, or the one used least recently.
+DnsCacheEntry& ClaimEntry(DnsCache& cache) {
+  DnsCacheEntry* oldest = &cache.entries[0];
+  for (DnsCacheEntry& entry : cache.entries) {
+    if (!entry.host[0]) {
+      return entry;
+    }
+    if (entry.lastUsedSequence < oldest->lastUsedSequence) {
+      oldest = &entry;
+    }
+  }
+  return *oldest;
+}
+
+}  // namespace
+
+// A hit refreshes the entry's LRU position but not its expiry.
+bool LookupDnsCache(DnsCache& cache, const char* host, uint32_t nowSeconds, uint32_t& address) {
+  DnsCacheEntry* entry = FindEntry(cache, host);
+  if (entry && DnsEntryRemainingSeconds(*entry, nowSeconds) == 0) {
+    *entry = DnsCacheEntry();
+    entry = nullptr;
+  }
+  if (!entry) {
+    ++cache.misses;
+    return false;
+  }
+  ++cache.hits;
+  entry->lastUsedSequence = ++cache.sequence;
+  address = entry->address;
+  return true;
+}
+
+// Re-resolving a cached host overwrites its entry in place.
+bool StoreDnsCache(DnsCache& cache,
+                   const char* host,
+                   uint32_t address,
+                   uint32_t ttlSeconds,
+                   uint32_t nowSeconds) {
+  if (!host || !host[0] || strlen(host) >= kDnsHostMaxBytes || address == 0 ||
+      ttlSeconds == 0) {
+    return false;
+  }
+  DnsCacheEntry* entry = FindEntry(cache, host);
+  if (!entry) {
+    entry = &ClaimEntry(cache);
+    *entry = DnsCacheEntry();
+    memcpy(entry->host, host, strlen(host) + 1);
+  }
+  entry->address = address;
+  entry->storedAtSeconds = nowSeconds;
+  entry->expiresAtSeconds = nowSeconds + ttlSeconds;
+  entry->lastUsedSequence = ++cache.sequence;
+  return true;
+}
+
+// Unknown hosts are ignored.
+void ForgetDnsCacheEntry(DnsCache& cache, const char* host) {
+  if (DnsCacheEntry* entry = FindEntry(cache, host)) {
+    *entry = DnsCacheEntry();
+  }
+}
+
+// Free slots and entries stored "in the future" report 0.
+uint32_t DnsEntryRemainingSeconds(const DnsCacheEntry& entry, uint32_t nowSeconds) {
+  if (!entry.host[0] || nowSeconds < entry.storedAtSeconds ||
+      nowSeconds - entry.storedAtSeconds >= entry.expiresAtSeconds - entry.storedAtSeconds) {
+    return 0;
+  }
+  return entry.expiresAtSeconds - nowSeconds;
+}
+
+}  // namespace envnode::core
@@ -0,0 +1,61 @@
+// Small retained cache of resolved host addresses.
+//
+// Every wake used to resolve the Supabase and webhook hosts again before the
+// first request could go out. The cache keeps one IPv4 address per host with
+// an expiry time so the firmware can keep it in RTC memory and connect
+// straight to the address on the next wake. Hit and miss counts accumulate
+// until the cache is cleared.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace envnode::core {
+
+// Hosts tracked at once; the least recently used entry is evicted when a new
+// host needs a slot. Supabase, n8n, and the debug webhook fit.
+constexpr size_t kDnsCacheSlots = 3;
+
+// Longest host name stored, including the terminator. Longer names are never
+// cached.
+constexpr size_t kDnsHostMaxBytes = 64;
+
+// One resolved host. An empty `host` marks a free slot.
+struct DnsCacheEntry {
+  char host[kDnsHostMaxBytes] = "";
+  uint32_t address = 0;
+  uint32_t storedAtSeconds = 0;
+  uint32_t expiresAtSeconds = 0;
+  uint32_t lastUsedSequence = 0;
+};
+
+// All cached hosts plus lookup counters.
+struct DnsCache {
+  DnsCacheEntry entries[kDnsCacheSlots];
+  uint32_t sequence = 0;
+  uint32_t hits = 0;
+  uint32_t misses = 0;
+};
+
+// Looks up `host` at `nowSeconds` and copies its address on a hit. Expired
+// entries, and entries stored at a time later than `nowSeconds` (the clock was
+// stepped back), are dropped and count as misses.
+bool LookupDnsCache(DnsCache& cache, const char* host, uint32_t nowSeconds, uint32_t& address);
+
+// Stores `address` for `host`, valid for `ttlSeconds`. Returns false, storing
+// nothing, when the name is too long, the address is zero, or `ttlSeconds`
+// is 0.
+bool StoreDnsCache(DnsCache& cache,
+                   const char* host,
+                   uint32_t address,
+                   uint32_t ttlSeconds,
+                   uint32_t nowSeconds);
+
+// Drops the entry for `host`, for example after a connection to it failed.
+void ForgetDnsCacheEntry(DnsCache& cache, const char* host);
+
+// Returns how many seconds `entry` remains valid, or 0 once it has expired.
+uint32_t DnsEntryRemainingSeconds(const DnsCacheEntry& entry, uint32_t nowSeconds);
+
+}  // namespace envnode::core
@@ -0,0 +1,159 @@
+// ESP-NOW reading frame codec implementation.
+
+#include "espnow_frame.h"
+
+#include <cstring>
+
+#include "journal.h"
+#include "sha256.h"
+
+namespace envnode::core {
+
+namespace {
+
+// First two bytes of every frame ("EN" little-endian).
+constexpr uint16_t kFrameMagic = 0x4E45;
+constexpr uint8_t kFrameVersion = 1;
+
+// Magic, version, reading count, counter, and device ID length.
+constexpr size_t kHeaderBytes = 9;
+
+void PutU32(uint8_t* out, uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    out[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+}
+
+uint32_t GetU32(const uint8_t* in) {
+  return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+         (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+// Compares every byte so the time taken does not reveal where a forged tag
+// first differs.
+bool TagsEqual(const uint8_t* a, const uint8_t* b) {
+  uint8_t difference = 0;
+  for (size_t i = 0; i < kEspNowTagBytes; ++i) {
+    difference |= a[i] ^ b[i];
+  }
+  return difference == 0;
+}
+
+void ComputeTag(const uint8_t* key,
+                size_t keyLength,
+                const uint8_t* data,
+                size_t length,
+                uint8_t tag[kEspNowTagBytes]) {
+  uint8_t mac[kSha256Bytes];
+  HmacSha256(key, keyLength, data, length, mac);
+  memcpy(tag, mac, kEspNowTagBytes);
+}
+
+}  // namespace
+
+// The tag covers every byte before it, header included.
+size_t EncodeEspNowFrame(const EspNowFrame& frame,
+                         const uint8_t* key,
+                         size_t keyLength,
+                         uint8_t* out,
+                         size_t outCapacity) {
+  const size_t idLength = strnlen(frame.deviceId, sizeof(frame.deviceId));
+  if (idLength == 0 || idLength > kEspNowDeviceIdMaxBytes || frame.readingCount == 0 ||
+      frame.readingCount > kEspNowMaxReadingsPerFrame) {
+    return 0;
+  }
+  const size_t signedBytes =
+      kHeaderBytes + idLength + frame.readingCount * kJournalReadingPayloadBytes;
+  if (signedBytes + kEspNowTagBytes > outCapacity) {
+    return 0;
+  }
+
+  out[0] = static_cast<uint8_t>(kFrameMagic);
+  out[1] = static_cast<uint8_t>(kFrameMagic >> 8);
+  out[2] = kFrameVersion;
+  out[3] = frame.readingCount;
+  PutU32(out + 4, frame.counter);
+  out[8] = static_cast<uint8_t>(idLength);
+  memcpy(out + kHeaderBytes, frame.deviceId, idLength);
+  uint8_t* cursor = out + kHeaderBytes + idLength;
+  for (size_t i = 0; i < frame.readingCount; ++i) {
+    EncodeReadingPayload(frame.readings[i], cursor);
+    cursor += kJournalReadingPayloadBytes;
+  }
+  ComputeTag(key, keyLength, out, signedBytes, cursor);
+  return signedBytes + kEspNowTagBytes;
+}
+
+// Only the length checks needed to locate the tag run before verification.
+EspNowDecodeStatus DecodeEspNowFrame(const uint8_t* data,
+                                     size_t length,
+                                     const uint8_t* key,
+                                     size_t keyLength,
+                                     EspNowFrame& frame) {
+  if (length < kHeaderBytes + kEspNowTagBytes ||
+      data[0] != static_cast<uint8_t>(kFrameMagic) ||
+      data[1] != static_cast<uint8_t>(kFrameMagic >> 8) || data[2] != kFrameVersion) {
+    return EspNowDecodeStatus::Malformed;
+  }
+  const size_t readingCount = data[3];
+  const size_t idLength = data[8];
+  if (readingCount == 0 || readingCount > kEspNowMaxReadingsPerFrame || idLength == 0 ||
+      idLength > kEspNowDeviceIdMaxBytes ||
+      length != kHeaderBytes + idLength + readingCount * kJournalReadingPayloadBytes +
+                    kEspNowTagBytes) {
+    return EspNowDecodeStatus::Malformed;
+  }
+
+  const size_t signedBytes = length - kEspNowTagBytes;
+  uint8_t expected[kEspNowTagBytes];
+  ComputeTag(key, keyLength, data, signedBytes, expected);
+  if (!TagsEqual(expected, data + signedBytes)) {
+    return EspNowDecodeStatus::BadTag;
+  }
+
+  frame = EspNowFrame();
+  frame.counter = GetU32(data + 4);
+  frame.readingCount = static_cast<uint8_t>(readingCount);
+  memcpy(frame.deviceId, data + kHeaderBytes, idLength);
+  const uint8_t* cursor = data + kHeaderBytes + idLength;
+  for (size_t i = 0; i < readingCount; ++i) {
+    DecodeReadingPayload(cursor, kJournalReadingPayloadBytes, frame.readings[i]);
+    cursor += kJournalReadingPayloadBytes;
+  }
+  return EspNowDecodeStatus::Ok;
+}
+
+// Counter 0 is never sent, so a gateway that has not heard from a node yet
+// accepts its first frame.
+void ResumeFrameCounter(FrameCounter& counter, uint32_t persistedReservation) {
+  counter.next = persistedReservation > 0 ? persistedReservation : 1;
+  counter.reservedUntil = counter.next;
+}
+
+// A counter at or past the reservation is not used until the new one is on
+// flash, which the caller does before sending.
+bool TakeFrameCounter(FrameCounter& counter, uint32_t& value) {
+  if (counter.next == 0) {
+    counter.next = 1;
+  }
+  value = counter.next++;
+  if (value < counter.reservedUntil) {
+    return false;
+  }
+  counter.reservedUntil = value + kFrameCounterReserveBlock;
+  return true;
+}
+
+const char* EspNowDecodeStatusName(EspNowDecodeStatus status) {
+  switch (status) {
+    case EspNowDecodeStatus::Ok:
+      return "ok";
+    case EspNowDecodeStatus::Malformed:
+      return "malformed";
+    case EspNowDecodeStatus::BadTag:
+      return "bad tag";
+  }
+  return "unknown";
+}
+
+}  // namespace envnode::core
@@ -0,0 +1,91 @@
+// Authenticated ESP-NOW reading frames between battery nodes and a gateway.
+//
+// A node on the ESP-NOW uplink sends its pending readings to a mains-powered
+// gateway in one broadcast-free, connectionless frame instead of associating,
+// running DHCP, and opening a TLS connection. Each frame carries the node's
+// device ID, a frame counter that only ever increases, up to eight readings
+// in the journal's reading encoding, and a truncated HMAC-SHA256 tag under a
+// key shared by the node and the gateway. The gateway rejects frames whose
+// tag does not verify and, per node, frames whose counter is not above the
+// last one it accepted, so captured frames cannot be replayed.
+//
+// Frame layout, little-endian: magic "EN" (2), version (1), reading count (1),
+// counter (4), device ID length (1), device ID, readings (24 each), tag (16).
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "reading_batch.h"
+
+namespace envnode::core {
+
+// Largest payload the ESP-NOW driver sends in one frame.
+constexpr size_t kEspNowMaxFrameBytes = 250;
+
+// Longest device ID a frame can carry.
+constexpr size_t kEspNowDeviceIdMaxBytes = 32;
+
+// Bytes of the HMAC-SHA256 tag kept in each frame.
+constexpr size_t kEspNowTagBytes = 16;
+
+// Most readings one frame carries; a full frame still fits `kEspNowMaxFrameBytes`.
+constexpr size_t kEspNowMaxReadingsPerFrame = 8;
+
+// Counter values reserved per flash write. A node persists the end of each
+// block before using it, so a power loss skips ahead instead of repeating
+// counters the gateway has already seen.
+constexpr uint32_t kFrameCounterReserveBlock = 256;
+
+// Decoded contents of one frame.
+struct EspNowFrame {
+  char deviceId[kEspNowDeviceIdMaxBytes + 1] = {0};
+  uint32_t counter = 0;
+  uint8_t readingCount = 0;
+  BatchedReading readings[kEspNowMaxReadingsPerFrame];
+};
+
+// Outcome of decoding a received frame.
+enum class EspNowDecodeStatus : uint8_t {
+  Ok,
+  Malformed,
+  BadTag,
+};
+
+// The node's frame counter and how far its flash reservation reaches.
+struct FrameCounter {
+  uint32_t next = 0;
+  uint32_t reservedUntil = 0;
+};
+
+// Encodes and signs `frame` into `out`. Returns the frame size, or 0 when the
+// device ID is empty or too long, the reading count is 0 or above
+// `kEspNowMaxReadingsPerFrame`, or `out` is too small.
+size_t EncodeEspNowFrame(const EspNowFrame& frame,
+                         const uint8_t* key,
+                         size_t keyLength,
+                         uint8_t* out,
+                         size_t outCapacity);
+
+// Verifies and decodes a received frame into `frame`. The tag is checked
+// before any field is trusted.
+EspNowDecodeStatus DecodeEspNowFrame(const uint8_t* data,
+                                     size_t length,
+                                     const uint8_t* key,
+                                     size_t keyLength,
+                                     EspNowFrame& frame);
+
+// Restarts the counter after a cold boot from the reservation last written to
+// flash; every value below it may already have been sent.
+void ResumeFrameCounter(FrameCounter& counter, uint32_t persistedReservation);
+
+// Takes the next counter value into `value`. Returns true when a new block was
+// reserved, in which case the caller must persist `counter.reservedUntil`
+// before sending the frame.
+bool TakeFrameCounter(FrameCounter& counter, uint32_t& value);
+
+// Returns a stable printable name for `status`.
+const char* EspNowDecodeStatusName(EspNowDecodeStatus status);
+
+}  // namespace envnode::core
@@ -0,0 +1,189 @@
+// ESP-NOW gateway aggregation implementation.
+
+#include "espnow_gateway.h"
+
+#include <cstring>
+
+#include "telemetry_payloads.h"
+
+namespace envnode::core {
+
+namespace {
+
+// Returns the index of the node named `deviceId`, or `kGatewayMaxNodes`.
+size_t FindNode(const EspNowGateway& gateway, const char* deviceId) {
+  for (size_t i = 0; i < gateway.nodeCount; ++i) {
+    if (strcmp(gateway.nodes[i].deviceId, deviceId) == 0) {
+      return i;
+    }
+  }
+  return kGatewayMaxNodes;
+}
+
+// Returns the index of the node named `deviceId`, adding it when it is new, or
+// `kGatewayMaxNodes` when the table is full.
+size_t FindOrAddNode(EspNowGateway& gateway, const char* deviceId) {
+  size_t index = FindNode(gateway, deviceId);
+  if (index == kGatewayMaxNodes && gateway.nodeCount < kGatewayMaxNodes) {
+    index = gateway.nodeCount++;
+    gateway.nodes[index] = GatewayNode();
+    strncpy(gateway.nodes[index].deviceId, deviceId, kEspNowDeviceIdMaxBytes);
+  }
+  return index;
+}
+
+void PushRow(EspNowGateway& gateway, const GatewayRow& row) {
+  if (gateway.rowCount == kGatewayRowCapacity) {
+    DropGatewayRows(gateway, 1);
+    ++gateway.stats.droppedRows;
+  }
+  gateway.rows[gateway.rowCount++] = row;
+}
+
+}  // namespace
+
+// Counters only have to increase, not be consecutive: frames the gateway
+// missed leave gaps, and a node that lost power skips ahead to its next
+// reserved block.
+GatewayAccept AcceptGatewayFrame(EspNowGateway& gateway,
+                                 const uint8_t* data,
+                                 size_t length,
+                                 const uint8_t* key,
+                                 size_t keyLength,
+                                 uint32_t nowSeconds,
+                                 uint32_t nowEpoch) {
+  EspNowFrame frame;
+  switch (DecodeEspNowFrame(data, length, key, keyLength, frame)) {
+    case EspNowDecodeStatus::Ok:
+      break;
+    case EspNowDecodeStatus::Malformed:
+      ++gateway.stats.malformed;
+      return GatewayAccept::Malformed;
+    case EspNowDecodeStatus::BadTag:
+      ++gateway.stats.badTag;
+      return GatewayAccept::BadTag;
+  }
+
+  const size_t index = FindOrAddNode(gateway, frame.deviceId);
+  if (index == kGatewayMaxNodes) {
+    ++gateway.stats.nodeTableFull;
+    return GatewayAccept::NodeTableFull;
+  }
+  GatewayNode& node = gateway.nodes[index];
+  if (frame.counter <= node.lastCounter) {
+    ++gateway.stats.replayed;
+    return GatewayAccept::Replayed;
+  }
+  node.lastCounter = frame.counter;
+  node.lastSeenSeconds = nowSeconds;
+  ++node.frames;
+  ++gateway.stats.accepted;
+
+  for (size_t i = 0; i < frame.readingCount; ++i) {
+    GatewayRow row;
+    row.node = static_cast<uint8_t>(index);
+    row.receivedAtSeconds = nowSeconds;
+    row.reading = frame.readings[i];
+    if (row.reading.recordedAtEpoch < kMinValidEpochSeconds &&
+        nowEpoch >= kMinValidEpochSeconds) {
+      row.reading.recordedAtEpoch = nowEpoch;
+    }
+    PushRow(gateway, row);
+  }
+  return GatewayAccept::Accepted;
+}
+
+bool QueueGatewayRow(EspNowGateway& gateway,
+                     const char* deviceId,
+                     const BatchedReading& reading,
+                     uint32_t nowSeconds) {
+  if (gateway.rowCount == kGatewayRowCapacity) {
+    return false;
+  }
+  const size_t index = FindOrAddNode(gateway, deviceId);
+  if (index == kGatewayMaxNodes) {
+    return false;
+  }
+  GatewayRow& row = gateway.rows[gateway.rowCount++];
+  row.node = static_cast<uint8_t>(index);
+  row.receivedAtSeconds = nowSeconds;
+  row.reading = reading;
+  return true;
+}
+
+// A clock that stepped backwards cannot tell how long the rows waited, so the
+// flush is treated as due.
+bool GatewayFlushDue(const EspNowGateway& gateway,
+                     size_t flushRows,
+                     uint32_t maxHoldSeconds,
+                     uint32_t nowSeconds) {
+  if (gateway.rowCount == 0 || GatewayUploadBackingOff(gateway, nowSeconds)) {
+    return false;
+  }
+  if (gateway.rowCount >= flushRows) {
+    return true;
+  }
+  const uint32_t oldest = gateway.rows[0].receivedAtSeconds;
+  return nowSeconds < oldest || nowSeconds - oldest >= maxHoldSeconds;
+}
+
+// Rows keep their arrival order, so each node's readings stay chronological.
+size_t WriteGatewayReadingBatch(JsonWriter& writer, const EspNowGateway& gateway, size_t maxRows) {
+  const size_t rows = maxRows < gateway.rowCount ? maxRows : gateway.rowCount;
+  writer.BeginArray();
+  for (size_t i = 0; i < rows; ++i) {
+    const GatewayRow& row = gateway.rows[i];
+    WriteReadingRow(writer, row.reading, gateway.nodes[row.node].deviceId);
+  }
+  writer.EndArray();
+  return rows;
+}
+
+// The queue is small enough that shifting it down is cheaper than tracking a
+// ring head.
+void DropGatewayRows(EspNowGateway& gateway, size_t count) {
+  if (count >= gateway.rowCount) {
+    gateway.rowCount = 0;
+    return;
+  }
+  memmove(gateway.rows, gateway.rows + count, (gateway.rowCount - count) * sizeof(GatewayRow));
+  gateway.rowCount = static_cast<uint8_t>(gateway.rowCount - count);
+}
+
+void RecordGatewayUpload(EspNowGateway& gateway,
+                         bool ok,
+                         uint32_t maxRetrySeconds,
+                         uint32_t nowSeconds) {
+  if (ok) {
+    gateway.uploadRetrySeconds = 0;
+    return;
+  }
+  const uint32_t next =
+      gateway.uploadRetrySeconds > 0 ? gateway.uploadRetrySeconds * 2 : kGatewayFirstRetrySeconds;
+  gateway.uploadRetrySeconds = next < maxRetrySeconds ? next : maxRetrySeconds;
+  gateway.uploadFailedAtSeconds = nowSeconds;
+}
+
+// As with the flush hold, a clock that stepped backwards ends the delay.
+bool GatewayUploadBackingOff(const EspNowGateway& gateway, uint32_t nowSeconds) {
+  return gateway.uploadRetrySeconds > 0 && nowSeconds >= gateway.uploadFailedAtSeconds &&
+         nowSeconds - gateway.uploadFailedAtSeconds < gateway.uploadRetrySeconds;
+}
+
+const char* GatewayAcceptName(GatewayAccept outcome) {
+  switch (outcome) {
+    case GatewayAccept::Accepted:
+      return "accepted";
+    case GatewayAccept::Malformed:
+      return "malformed";
+    case GatewayAccept::BadTag:
+      return "bad tag";
+    case GatewayAccept::Replayed:
+      return "replayed";
+    case GatewayAccept::NodeTableFull:
+      return "node table full";
+  }
+  return "unknown";
+}
+
+}  // namespace envnode::core
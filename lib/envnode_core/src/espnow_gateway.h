@@ -0,0 +1,126 @@
+// Gateway-side aggregation of ESP-NOW reading frames from many nodes.
+//
+// A gateway build of the firmware stays awake on mains power, verifies every
+// frame it receives, and collects the readings from all of its nodes into one
+// queue. The queue is uploaded as a single multi-node bulk insert once enough
+// rows are waiting or the oldest row has waited long enough. Each node's
+// highest accepted counter is kept for replay protection; a node is only
+// added to the table after its frame authenticated, so forged frames cannot
+// fill it.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "espnow_frame.h"
+#include "json_writer.h"
+#include "reading_batch.h"
+
+namespace envnode::core {
+
+// Nodes whose replay state the gateway tracks.
+constexpr size_t kGatewayMaxNodes = 16;
+
+// Readings the gateway queues between uploads. When full, the oldest row is
+// dropped and counted.
+constexpr size_t kGatewayRowCapacity = 48;
+
+// Wait after the first failed upload; it doubles with every further failure.
+constexpr uint32_t kGatewayFirstRetrySeconds = 15;
+
+// Replay state and counters for one node.
+struct GatewayNode {
+  char deviceId[kEspNowDeviceIdMaxBytes + 1] = {0};
+  uint32_t lastCounter = 0;
+  uint32_t lastSeenSeconds = 0;
+  uint32_t frames = 0;
+};
+
+// One queued reading, the node it came from, and when it arrived.
+struct GatewayRow {
+  uint8_t node = 0;
+  uint32_t receivedAtSeconds = 0;
+  BatchedReading reading;
+};
+
+// Frame outcomes since the gateway started.
+struct GatewayStats {
+  uint32_t accepted = 0;
+  uint32_t malformed = 0;
+  uint32_t badTag = 0;
+  uint32_t replayed = 0;
+  uint32_t nodeTableFull = 0;
+  uint32_t droppedRows = 0;
+};
+
+// Nodes, queued rows (oldest first), statistics, and the retry delay after a
+// failed upload (zero while uploads succeed).
+struct EspNowGateway {
+  GatewayNode nodes[kGatewayMaxNodes];
+  uint8_t nodeCount = 0;
+  GatewayRow rows[kGatewayRowCapacity];
+  uint8_t rowCount = 0;
+  GatewayStats stats;
+  uint32_t uploadFailedAtSeconds = 0;
+  uint32_t uploadRetrySeconds = 0;
+};
+
+// What happened to one received frame.
+enum class GatewayAccept : uint8_t {
+  Accepted,
+  Malformed,
+  BadTag,
+  Replayed,
+  NodeTableFull,
+};
+
+// Verifies a received frame and queues its readings. Readings captured before
+// the node's clock was synchronized are stamped with `nowEpoch` when the
+// gateway's own clock is valid; that is exact for the node's current reading
+// and an upper bound for older buffered ones.
+GatewayAccept AcceptGatewayFrame(EspNowGateway& gateway,
+                                 const uint8_t* data,
+                                 size_t length,
+                                 const uint8_t* key,
+                                 size_t keyLength,
+                                 uint32_t nowSeconds,
+                                 uint32_t nowEpoch);
+
+// Queues one already verified reading from node `deviceId`, as when rows are
+// read back from the journal. Returns false, leaving the gateway unchanged,
+// when the queue or the node table is full.
+bool QueueGatewayRow(EspNowGateway& gateway,
+                     const char* deviceId,
+                     const BatchedReading& reading,
+                     uint32_t nowSeconds);
+
+// Returns true when `flushRows` rows are queued or the oldest has waited
+// `maxHoldSeconds`, unless a failed upload's retry delay is still running.
+bool GatewayFlushDue(const EspNowGateway& gateway,
+                     size_t flushRows,
+                     uint32_t maxHoldSeconds,
+                     uint32_t nowSeconds);
+
+// Writes up to `maxRows` of the oldest queued rows as one readings-table bulk
+// insert, each under its node's device ID. Returns the number of rows written.
+size_t WriteGatewayReadingBatch(JsonWriter& writer, const EspNowGateway& gateway, size_t maxRows);
+
+// Removes up to `count` of the oldest rows after a successful upload.
+void DropGatewayRows(EspNowGateway& gateway, size_t count);
+
+// Records an upload outcome. A failure starts a retry delay of
+// `kGatewayFirstRetrySeconds`, doubling on each further failure up to
+// `maxRetrySeconds`; a success clears it.
+void RecordGatewayUpload(EspNowGateway& gateway,
+                         bool ok,
+                         uint32_t maxRetrySeconds,
+                         uint32_t nowSeconds);
+
+// Reports whether a failed upload's retry delay is still running.
+bool GatewayUploadBackingOff(const EspNowGateway& gateway, uint32_t nowSeconds);
+
+// Returns a stable printable name for `outcome`.
+const char* GatewayAcceptName(GatewayAccept outcome);
+
+}  // namespace envnode::core
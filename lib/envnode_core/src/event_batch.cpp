@@ -0,0 +1,50 @@
+// In-memory event batch implementation.
+
+#include "event_batch.h"
+
+#include <string_view>
+
+namespace envnode::core {
+
+// Clears buffered rows while preserving the dropped counter.
+void ResetEventBatch(EventBatch& batch) {
+  batch.length = 0;
+  batch.count = 0;
+  batch.rows[0] = '\0';
+}
+
+// Writes the row directly after the existing ones and only commits it if the
+// writer finished without overflowing.
+bool AppendEvent(EventBatch& batch, const EventPayload& event) {
+  size_t offset = batch.length;
+  if (batch.count > 0) {
+    if (offset + 1 >= kEventBatchCapacityBytes) {
+      ++batch.dropped;
+      return false;
+    }
+    batch.rows[offset++] = ',';
+  }
+
+  JsonWriter writer(batch.rows + offset, kEventBatchCapacityBytes - offset);
+  WriteEventPayload(writer, event);
+  if (!writer.Ok()) {
+    batch.rows[batch.length] = '\0';
+    ++batch.dropped;
+    return false;
+  }
+
+  batch.length = offset + writer.Length();
+  ++batch.count;
+  return true;
+}
+
+// Wraps the buffered rows in array brackets.
+void WriteEventBatch(JsonWriter& writer, const EventBatch& batch) {
+  writer.BeginArray();
+  if (batch.count > 0) {
+    writer.Raw(std::string_view(batch.rows, batch.length));
+  }
+  writer.EndArray();
+}
+
+}  // namespace envnode::core
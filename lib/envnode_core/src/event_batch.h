@@ -0,0 +1,39 @@
+// In-memory buffer of `device_events` rows collected during one wake.
+//
+// Recovery sequences produce several events in quick succession. Rather than
+// one HTTPS insert each, rows are serialized into a fixed buffer as they occur
+// and uploaded together as a single PostgREST bulk insert.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "json_writer.h"
+#include "telemetry_payloads.h"
+
+namespace envnode::core {
+
+// Bytes available for serialized event rows in one batch.
+constexpr size_t kEventBatchCapacityBytes = 3072;
+
+// Serialized event rows, stored comma-separated without the enclosing array
+// brackets. `dropped` counts events that did not fit.
+struct EventBatch {
+  char rows[kEventBatchCapacityBytes];
+  size_t length = 0;
+  uint16_t count = 0;
+  uint32_t dropped = 0;
+};
+
+// Discards every buffered row. The dropped counter is kept for diagnostics.
+void ResetEventBatch(EventBatch& batch);
+
+// Serializes one event into the batch. Returns false, leaving the batch
+// unchanged, when the row does not fit in the remaining space.
+bool AppendEvent(EventBatch& batch, const EventPayload& event);
+
+// Writes the buffered rows as one JSON array for a bulk insert.
+void WriteEventBatch(JsonWriter& writer, const EventBatch& batch);
+
+}  // namespace envnode::core
@@ -0,0 +1,214 @@
+// Small-window gzip encoder implementation.
+
+#include "gzip.h"
+
+#include <cstring>
+
+#include "crc32.h"
+
+namespace envnode::core {
+
+namespace {
+
+// Longest match deflate can express.
+constexpr size_t kMaxMatchBytes = 258;
+
+// Shortest match worth emitting as a length/distance pair.
+constexpr size_t kMinMatchBytes = 3;
+
+// Hash-chain candidates examined per position; bounds the worst-case time.
+constexpr int kMaxChainSteps = 16;
+
+// RFC 1951 length code bases (symbols 257-285) and their extra bits.
+constexpr uint16_t kLengthBase[29] = {3,  4,  5,  6,   7,   8,   9,   10,  11, 13,
+                                      15, 17, 19, 23,  27,  31,  35,  43,  51, 59,
+                                      67, 83, 99, 115, 131, 163, 195, 227, 258};
+constexpr uint8_t kLengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                      2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+
+// RFC 1951 distance code bases and their extra bits.
+constexpr uint16_t kDistanceBase[30] = {
+    1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+    193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+constexpr uint8_t kDistanceExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                        6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+// Packs bits least-significant first, as deflate requires.
+struct BitWriter {
+  uint8_t* out;
+  size_t capacity;
+  size_t length;
+  uint32_t bits;
+  int bitCount;
+  bool overflowed;
+};
+
+void WriteByte(BitWriter& writer, uint8_t value) {
+  if (writer.length < writer.capacity) {
+    writer.out[writer.length++] = value;
+  } else {
+    writer.overflowed = true;
+  }
+}
+
+void WriteBits(BitWriter& writer, uint32_t value, int count) {
+  writer.bits |= value << writer.bitCount;
+  writer.bitCount += count;
+  while (writer.bitCount >= 8) {
+    WriteByte(writer, static_cast<uint8_t>(writer.bits));
+    writer.bits >>= 8;
+    writer.bitCount -= 8;
+  }
+}
+
+// Pads the final partial byte with zero bits.
+void FlushBits(BitWriter& writer) {
+  if (writer.bitCount > 0) {
+    WriteByte(writer, static_cast<uint8_t>(writer.bits));
+  }
+  writer.bits = 0;
+  writer.bitCount = 0;
+}
+
+void WriteU32(BitWriter& writer, uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    WriteByte(writer, static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+// Huffman codes are defined most-significant bit first, so they are reversed
+// before going through the LSB-first writer.
+void WriteCode(BitWriter& writer, uint32_t code, int length) {
+  uint32_t reversed = 0;
+  for (int i = 0; i < length; ++i) {
+    reversed = (reversed << 1) | ((code >> i) & 1U);
+  }
+  WriteBits(writer, reversed, length);
+}
+
+// Emits a literal/length symbol using the fixed Huffman table.
+void WriteLiteralLengthSymbol(BitWriter& writer, unsigned symbol) {
+  if (symbol < 144) {
+    WriteCode(writer, 0x30 + symbol, 8);
+  } else if (symbol < 256) {
+    WriteCode(writer, 0x190 + (symbol - 144), 9);
+  } else if (symbol < 280) {
+    WriteCode(writer, symbol - 256, 7);
+  } else {
+    WriteCode(writer, 0xC0 + (symbol - 280), 8);
+  }
+}
+
+// Emits one length/distance pair.
+void WriteMatch(BitWriter& writer, size_t length, size_t distance) {
+  int code = 28;
+  while (kLengthBase[code] > length) {
+    --code;
+  }
+  WriteLiteralLengthSymbol(writer, 257 + code);
+  WriteBits(writer, static_cast<uint32_t>(length - kLengthBase[code]), kLengthExtra[code]);
+
+  code = 29;
+  while (kDistanceBase[code] > distance) {
+    --code;
+  }
+  WriteCode(writer, code, 5);
+  WriteBits(writer, static_cast<uint32_t>(distance - kDistanceBase[code]),
+            kDistanceExtra[code]);
+}
+
+// Hashes the three bytes starting at `data`.
+size_t Hash3(const uint8_t* data) {
+  const uint32_t key = data[0] | (data[1] << 8) | (data[2] << 16);
+  return (static_cast<uint32_t>(key * 2654435761U) >> 16) & (kGzipHashBuckets - 1);
+}
+
+// Records position `pos` as the newest candidate for its hash.
+void InsertPosition(GzipScratch& scratch, const uint8_t* input, size_t pos) {
+  const size_t bucket = Hash3(input + pos);
+  scratch.chain[pos & (kGzipWindowBytes - 1)] = scratch.head[bucket];
+  scratch.head[bucket] = static_cast<uint16_t>(pos + 1);
+}
+
+// Walks the hash chain for the longest earlier match within the window.
+size_t FindMatch(const GzipScratch& scratch,
+                 const uint8_t* input,
+                 size_t length,
+                 size_t pos,
+                 size_t& distance) {
+  const size_t limit = length - pos < kMaxMatchBytes ? length - pos : kMaxMatchBytes;
+  size_t best = 0;
+  uint16_t candidate = scratch.head[Hash3(input + pos)];
+  for (int step = 0; candidate && step < kMaxChainSteps; ++step) {
+    const size_t start = candidate - 1U;
+    if (pos - start >= kGzipWindowBytes) {
+      break;
+    }
+    size_t matched = 0;
+    while (matched < limit && input[start + matched] == input[pos + matched]) {
+      ++matched;
+    }
+    if (matched > best) {
+      best = matched;
+      distance = pos - start;
+      if (matched == limit) {
+        break;
+      }
+    }
+    candidate = scratch.chain[start & (kGzipWindowBytes - 1)];
+  }
+  return best;
+}
+
+}  // namespace
+
+// Writes the gzip header, one final fixed-Huffman deflate block, and the
+// CRC/size trailer.
+size_t GzipCompress(const uint8_t* input,
+                    size_t length,
+                    uint8_t* out,
+                    size_t outCapacity,
+                    GzipScratch& scratch) {
+  if (length > kGzipMaxInputBytes) {
+    return 0;
+  }
+
+  BitWriter writer{out, outCapacity, 0, 0, 0, false};
+  static constexpr uint8_t kHeader[10] = {0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 0xFF};
+  for (uint8_t byte : kHeader) {
+    WriteByte(writer, byte);
+  }
+
+  std::memset(scratch.head, 0, sizeof(scratch.head));
+  WriteBits(writer, 1, 1);  // BFINAL
+  WriteBits(writer, 1, 2);  // BTYPE = fixed Huffman
+
+  size_t pos = 0;
+  while (pos < length && !writer.overflowed) {
+    size_t matched = 0;
+    size_t distance = 0;
+    if (length - pos >= kMinMatchBytes) {
+      matched = FindMatch(scratch, input, length, pos, distance);
+    }
+
+    if (matched >= kMinMatchBytes) {
+      WriteMatch(writer, matched, distance);
+    } else {
+      WriteLiteralLengthSymbol(writer, input[pos]);
+      matched = 1;
+    }
+    for (const size_t end = pos + matched; pos < end; ++pos) {
+      if (length - pos >= kMinMatchBytes) {
+        InsertPosition(scratch, input, pos);
+      }
+    }
+  }
+
+  WriteLiteralLengthSymbol(writer, 256);
+  FlushBits(writer);
+  WriteU32(writer, Crc32(input, length));
+  WriteU32(writer, static_cast<uint32_t>(length));
+  return writer.overflowed ? 0 : writer.length;
+}
+
+}  // namespace envnode::core
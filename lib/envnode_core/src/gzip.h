@@ -0,0 +1,39 @@
+// Small-window gzip encoder for request bodies.
+//
+// Batched inserts repeat the same JSON keys on every row, which LZ77 removes
+// well even with a short history window and the fixed Huffman table from
+// RFC 1951. That keeps the encoder to a few kilobytes of scratch memory and
+// no heap use, at the cost of a few percent of ratio compared with zlib.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace envnode::core {
+
+// Bytes of history searched for repeated strings. Must be a power of two.
+constexpr size_t kGzipWindowBytes = 2048;
+
+// Buckets in the three-byte hash table. Must be a power of two.
+constexpr size_t kGzipHashBuckets = 1024;
+
+// Largest input accepted; positions are stored in 16 bits.
+constexpr size_t kGzipMaxInputBytes = 0xFFFE;
+
+// Match-finder tables. Keep one static instance rather than a stack copy.
+struct GzipScratch {
+  uint16_t head[kGzipHashBuckets];
+  uint16_t chain[kGzipWindowBytes];
+};
+
+// Compresses `input` into a complete gzip member (RFC 1952) in `out`. Returns
+// the compressed size, or 0 when the input is too large or the result does not
+// fit in `outCapacity`.
+size_t GzipCompress(const uint8_t* input,
+                    size_t length,
+                    uint8_t* out,
+                    size_t outCapacity,
+                    GzipScratch& scratch);
+
+}  // namespace envnode::core
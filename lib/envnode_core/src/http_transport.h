@@ -0,0 +1,58 @@
+// Transport seam between telemetry dispatch and the network stack.
+//
+// The firmware implements `HttpTransport` on top of `HTTPClient` and its
+// keep-alive pool; host-side tests and benchmarks implement it with a fake
+// Supabase/n8n server that records every request. Everything above this
+// interface (payload formatting, compression, fallbacks) is shared.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "wake_budget.h"
+
+namespace envnode::core {
+
+// One outbound header. Both strings must outlive the request.
+struct HttpHeader {
+  const char* name;
+  const char* value;
+};
+
+// Describes one outbound request completely so a transport can replay it on a
+// fresh socket when a kept-alive connection turns out to be stale.
+struct HttpRequest {
+  const char* method = "POST";
+  const char* url = nullptr;
+  const HttpHeader* headers = nullptr;
+  size_t headerCount = 0;
+  const char* body = nullptr;
+  size_t bodyLength = 0;
+  uint16_t timeoutMs = 5000U;
+  WakePriority priority = WakePriority::Event;
+};
+
+// Outcome of one request. `started` is false when the request could not be
+// prepared at all (bad URL or TLS policy refused it) or, with `deferred` set,
+// when the wake budget had no time left for its priority. `code` is the HTTP
+// status, or a negative transport error.
+struct HttpResponse {
+  bool started = false;
+  bool deferred = false;
+  int code = 0;
+  uint32_t elapsedMs = 0;
+  bool reusedConnection = false;
+};
+
+// Sends requests on behalf of the telemetry dispatch functions.
+class HttpTransport {
+ public:
+  virtual ~HttpTransport() = default;
+
+  // Performs `request` and reports how it went. Must not retry a request the
+  // server may already have acted on.
+  virtual HttpResponse Send(const HttpRequest& request) = 0;
+};
+
+}  // namespace envnode::core
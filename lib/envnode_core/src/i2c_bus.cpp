@@ -0,0 +1,54 @@
+// I2C bus speed selection implementation.
+
+#include "i2c_bus.h"
+
+namespace envnode::core {
+
+// The hold-off counts down at the start of each slow wake, so a fallback with
+// a hold-off of N spends the rest of its own wake and N more at 100 kHz.
+uint32_t StartI2cWake(I2cSpeedState& state) {
+  if (state.slow) {
+    if (state.slowWakesLeft == 0) {
+      state.slow = false;
+    } else {
+      --state.slowWakesLeft;
+    }
+  }
+  return CurrentI2cClockHz(state);
+}
+
+// The hold-off doubles on each fallback and is only reset by a clean fast
+// wake in `FinishI2cWake()`.
+bool NoteI2cFault(I2cSpeedState& state, const I2cSpeedConfig& config) {
+  if (state.slow) {
+    return false;
+  }
+  if (state.holdOffWakes == 0) {
+    state.holdOffWakes = config.minSlowWakes;
+  } else {
+    const uint16_t doubled = static_cast<uint16_t>(state.holdOffWakes) * 2;
+    state.holdOffWakes =
+        static_cast<uint8_t>(doubled > config.maxSlowWakes ? config.maxSlowWakes : doubled);
+  }
+  state.slow = true;
+  state.slowWakesLeft = state.holdOffWakes;
+  ++state.fallbacks;
+  return true;
+}
+
+void FinishI2cWake(I2cSpeedState& state) {
+  if (!state.slow) {
+    state.holdOffWakes = 0;
+  }
+}
+
+uint32_t CurrentI2cClockHz(const I2cSpeedState& state) {
+  return state.slow ? kI2cStandardClockHz : kI2cFastClockHz;
+}
+
+bool I2cBusCountersEmpty(const I2cBusCounters& counters) {
+  return counters.nacks == 0 && counters.timeouts == 0 && counters.busClears == 0 &&
+         counters.retries == 0;
+}
+
+}  // namespace envnode::core
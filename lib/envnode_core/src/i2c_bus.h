@@ -0,0 +1,61 @@
+// I2C bus speed selection and per-wake bus-health counters.
+//
+// The sensor bus runs in fast mode (400 kHz) to shorten every transaction.
+// Long or marginal wiring shows up as NACKs and timeouts; the first fault on a
+// fast wake drops the bus to standard mode (100 kHz) for the rest of that wake
+// and for `slowWakesLeft` more. A fast retry that faults again doubles the
+// hold-off up to `maxSlowWakes`, so a node on bad wiring settles at 100 kHz
+// and only probes fast mode occasionally. The counters are reset each wake and
+// reported in event metadata, which tells flaky wiring apart from sensor
+// faults across the fleet. All state is plain data for RTC memory.
+
+#pragma once
+
+#include <cstdint>
+
+namespace envnode::core {
+
+// Clock rates the bus switches between.
+constexpr uint32_t kI2cFastClockHz = 400000;
+constexpr uint32_t kI2cStandardClockHz = 100000;
+
+// Hold-off limits, in wakes spent at 100 kHz before fast mode is tried again.
+struct I2cSpeedConfig {
+  uint8_t minSlowWakes = 8;
+  uint8_t maxSlowWakes = 128;
+};
+
+// Retained speed state. `holdOffWakes` is zero until the first fallback.
+struct I2cSpeedState {
+  bool slow = false;
+  uint8_t slowWakesLeft = 0;
+  uint8_t holdOffWakes = 0;
+  uint16_t fallbacks = 0;
+};
+
+// Faults and recovery actions seen on the bus during one wake.
+struct I2cBusCounters {
+  uint16_t nacks = 0;
+  uint16_t timeouts = 0;
+  uint16_t busClears = 0;
+  uint16_t retries = 0;
+};
+
+// Starts a wake and returns the clock to run the bus at.
+uint32_t StartI2cWake(I2cSpeedState& state);
+
+// Records a NACK or timeout. Returns true when it moved the bus from 400 kHz
+// to 100 kHz, so the caller must change the clock.
+bool NoteI2cFault(I2cSpeedState& state, const I2cSpeedConfig& config);
+
+// Ends a wake. A wake that stayed at 400 kHz resets the hold-off, so only
+// repeated faults build it back up.
+void FinishI2cWake(I2cSpeedState& state);
+
+// Returns the clock the bus should currently run at.
+uint32_t CurrentI2cClockHz(const I2cSpeedState& state);
+
+// Reports whether no fault or recovery action was counted.
+bool I2cBusCountersEmpty(const I2cBusCounters& counters);
+
+}  // namespace envnode::core
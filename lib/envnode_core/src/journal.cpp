@@ -0,0 +1,359 @@
+// Store-and-forward journal codec and segment bookkeeping implementation.
+
+#include "journal.h"
+
+#include <cstring>
+
+namespace envnode::core {
+
+namespace {
+
+// Little-endian store helpers.
+void PutU16(uint8_t* out, uint16_t value) {
+  out[0] = static_cast<uint8_t>(value);
+  out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void PutU32(uint8_t* out, uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    out[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+}
+
+// Little-endian load helpers.
+uint16_t GetU16(const uint8_t* in) {
+  return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+
+uint32_t GetU32(const uint8_t* in) {
+  return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+         (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+// Stores a float by its bit pattern so NaN markers survive the round trip.
+void PutFloat(uint8_t* out, float value) {
+  uint32_t bits = 0;
+  std::memcpy(&bits, &value, sizeof(bits));
+  PutU32(out, bits);
+}
+
+float GetFloat(const uint8_t* in) {
+  const uint32_t bits = GetU32(in);
+  float value = 0.0f;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+// Checks whether a type byte names a known record kind.
+bool KnownRecordType(uint8_t type) {
+  return type == static_cast<uint8_t>(JournalRecordType::Reading) ||
+         type == static_cast<uint8_t>(JournalRecordType::EventRows) ||
+         type == static_cast<uint8_t>(JournalRecordType::GatewayReading);
+}
+
+// Returns how much of one segment the cursor has not consumed yet.
+uint32_t UnreplayedBytes(const JournalLayout& layout, const JournalSegment& segment) {
+  if (segment.sequence < layout.cursor.sequence) {
+    return 0;
+  }
+  if (segment.sequence == layout.cursor.sequence) {
+    return segment.bytes > layout.cursor.offset ? segment.bytes - layout.cursor.offset
+                                                : 0;
+  }
+  return segment.bytes;
+}
+
+}  // namespace
+
+// Writes the header and payload; the CRC covers everything after the magic.
+size_t EncodeJournalRecord(JournalRecordType type,
+                           const uint8_t* payload,
+                           size_t length,
+                           uint8_t* out,
+                           size_t outCapacity) {
+  if (length > kJournalMaxPayloadBytes || outCapacity < kJournalHeaderBytes + length) {
+    return 0;
+  }
+
+  PutU16(out, kJournalRecordMagic);
+  out[2] = static_cast<uint8_t>(type);
+  out[3] = 0;
+  PutU16(out + 4, static_cast<uint16_t>(length));
+  if (length) {
+    std::memcpy(out + kJournalHeaderBytes, payload, length);
+  }
+  uint32_t crc = Crc32(out + 2, 4);
+  crc = Crc32(out + kJournalHeaderBytes, length, crc);
+  PutU32(out + 6, crc);
+  return kJournalHeaderBytes + length;
+}
+
+// Validates magic, type, length, and CRC before exposing the payload.
+JournalDecodeStatus DecodeJournalRecord(const uint8_t* data,
+                                        size_t available,
+                                        JournalRecordView& record) {
+  if (available == 0) {
+    return JournalDecodeStatus::NeedMoreData;
+  }
+  if (data[0] != static_cast<uint8_t>(kJournalRecordMagic)) {
+    return JournalDecodeStatus::Corrupt;
+  }
+  if (available < 2) {
+    return JournalDecodeStatus::NeedMoreData;
+  }
+  if (GetU16(data) != kJournalRecordMagic) {
+    return JournalDecodeStatus::Corrupt;
+  }
+  if (available < kJournalHeaderBytes) {
+    return JournalDecodeStatus::NeedMoreData;
+  }
+
+  const uint16_t length = GetU16(data + 4);
+  if (!KnownRecordType(data[2]) || data[3] != 0 || length > kJournalMaxPayloadBytes) {
+    return JournalDecodeStatus::Corrupt;
+  }
+  if (available < kJournalHeaderBytes + length) {
+    return JournalDecodeStatus::NeedMoreData;
+  }
+
+  uint32_t crc = Crc32(data + 2, 4);
+  crc = Crc32(data + kJournalHeaderBytes, length, crc);
+  if (crc != GetU32(data + 6)) {
+    return JournalDecodeStatus::Corrupt;
+  }
+
+  record.type = static_cast<JournalRecordType>(data[2]);
+  record.payload = data + kJournalHeaderBytes;
+  record.length = length;
+  record.totalBytes = kJournalHeaderBytes + length;
+  return JournalDecodeStatus::Ok;
+}
+
+// Scans forward for the magic's first byte; a trailing lone byte still counts
+// because the rest of the magic may follow in the next read.
+size_t FindNextJournalRecord(const uint8_t* data, size_t available) {
+  const uint8_t first = static_cast<uint8_t>(kJournalRecordMagic);
+  const uint8_t second = static_cast<uint8_t>(kJournalRecordMagic >> 8);
+  for (size_t offset = 1; offset < available; ++offset) {
+    if (data[offset] != first) {
+      continue;
+    }
+    if (offset + 1 == available || data[offset + 1] == second) {
+      return offset;
+    }
+  }
+  return available;
+}
+
+// Lays out the five measurements followed by the capture time.
+void EncodeReadingPayload(const BatchedReading& reading,
+                          uint8_t out[kJournalReadingPayloadBytes]) {
+  PutFloat(out, reading.temperature);
+  PutFloat(out + 4, reading.humidity);
+  PutFloat(out + 8, reading.pressure);
+  PutFloat(out + 12, reading.batteryVoltage);
+  PutFloat(out + 16, reading.batteryPercent);
+  PutU32(out + 20, reading.recordedAtEpoch);
+}
+
+// Reverses `EncodeReadingPayload`.
+bool DecodeReadingPayload(const uint8_t* payload,
+                          size_t length,
+                          BatchedReading& reading) {
+  if (length != kJournalReadingPayloadBytes) {
+    return false;
+  }
+  reading.temperature = GetFloat(payload);
+  reading.humidity = GetFloat(payload + 4);
+  reading.pressure = GetFloat(payload + 8);
+  reading.batteryVoltage = GetFloat(payload + 12);
+  reading.batteryPercent = GetFloat(payload + 16);
+  reading.recordedAtEpoch = GetU32(payload + 20);
+  return true;
+}
+
+// The ID's length follows from the payload length.
+size_t EncodeGatewayReadingPayload(const BatchedReading& reading,
+                                   const char* deviceId,
+                                   uint8_t out[kJournalGatewayReadingPayloadBytes]) {
+  const size_t idLength = strnlen(deviceId, kJournalDeviceIdMaxBytes + 1);
+  if (idLength == 0 || idLength > kJournalDeviceIdMaxBytes) {
+    return 0;
+  }
+  EncodeReadingPayload(reading, out);
+  std::memcpy(out + kJournalReadingPayloadBytes, deviceId, idLength);
+  return kJournalReadingPayloadBytes + idLength;
+}
+
+// Reverses `EncodeGatewayReadingPayload`.
+bool DecodeGatewayReadingPayload(const uint8_t* payload,
+                                 size_t length,
+                                 BatchedReading& reading,
+                                 char deviceId[kJournalDeviceIdMaxBytes + 1]) {
+  if (length <= kJournalReadingPayloadBytes || length > kJournalGatewayReadingPayloadBytes) {
+    return false;
+  }
+  DecodeReadingPayload(payload, kJournalReadingPayloadBytes, reading);
+  const size_t idLength = length - kJournalReadingPayloadBytes;
+  std::memcpy(deviceId, payload + kJournalReadingPayloadBytes, idLength);
+  deviceId[idLength] = '\0';
+  return true;
+}
+
+// Prefixes the serialized rows with their count.
+size_t EncodeEventRowsPayload(const EventBatch& batch, uint8_t* out, size_t outCapacity) {
+  if (batch.count == 0 || outCapacity < batch.length + 2) {
+    return 0;
+  }
+  PutU16(out, batch.count);
+  std::memcpy(out + 2, batch.rows, batch.length);
+  return batch.length + 2;
+}
+
+// Joins the stored rows onto the batch with the same comma separation that
+// `AppendEvent` uses.
+bool AppendEventRowsPayload(EventBatch& batch, const uint8_t* payload, size_t length) {
+  if (length < 3) {
+    return false;
+  }
+  const uint16_t rows = GetU16(payload);
+  const size_t rowBytes = length - 2;
+  const size_t separator = batch.count > 0 ? 1 : 0;
+  if (rows == 0 || batch.length + separator + rowBytes >= kEventBatchCapacityBytes) {
+    return false;
+  }
+
+  if (separator) {
+    batch.rows[batch.length++] = ',';
+  }
+  std::memcpy(batch.rows + batch.length, payload + 2, rowBytes);
+  batch.length += rowBytes;
+  batch.rows[batch.length] = '\0';
+  batch.count = static_cast<uint16_t>(batch.count + rows);
+  return true;
+}
+
+// Sums every tracked segment.
+uint32_t JournalTotalBytes(const JournalLayout& layout) {
+  uint32_t total = 0;
+  for (size_t i = 0; i < layout.count; ++i) {
+    total += layout.segments[i].bytes;
+  }
+  return total;
+}
+
+// Sums the bytes at or after the cursor.
+uint32_t JournalPendingBytes(const JournalLayout& layout) {
+  uint32_t pending = 0;
+  for (size_t i = 0; i < layout.count; ++i) {
+    pending += UnreplayedBytes(layout, layout.segments[i]);
+  }
+  return pending;
+}
+
+// Rotates before a segment would outgrow its size, then evicts whole segments
+// oldest-first until the cap and the segment table both have room. The
+// segment being appended to is never evicted.
+JournalAppendPlan PlanJournalAppend(const JournalLayout& layout,
+                                    size_t recordBytes,
+                                    size_t segmentBytes,
+                                    size_t capBytes) {
+  JournalAppendPlan plan;
+  if (layout.count == 0) {
+    plan.startNewSegment = true;
+    plan.sequence = layout.cursor.sequence + 1;
+  } else {
+    const JournalSegment& active = layout.segments[layout.count - 1];
+    plan.startNewSegment =
+        active.bytes > 0 && active.bytes + recordBytes > segmentBytes;
+    plan.sequence = plan.startNewSegment ? active.sequence + 1 : active.sequence;
+  }
+
+  const size_t evictable = plan.startNewSegment ? layout.count : layout.count - 1;
+  const size_t segmentsAfter = layout.count + (plan.startNewSegment ? 1 : 0);
+  size_t total = JournalTotalBytes(layout) + recordBytes;
+  while (plan.evictSegments < evictable &&
+         (total > capBytes || segmentsAfter - plan.evictSegments > kJournalMaxSegments)) {
+    const JournalSegment& oldest = layout.segments[plan.evictSegments];
+    total -= oldest.bytes;
+    plan.evictedUnreplayedBytes += UnreplayedBytes(layout, oldest);
+    ++plan.evictSegments;
+  }
+  return plan;
+}
+
+// Mirrors the file operations the firmware performed for `plan`.
+void ApplyJournalAppend(JournalLayout& layout,
+                        const JournalAppendPlan& plan,
+                        size_t recordBytes) {
+  DropOldestJournalSegments(layout, plan.evictSegments);
+  if (plan.startNewSegment || layout.count == 0) {
+    if (layout.count == kJournalMaxSegments) {
+      DropOldestJournalSegments(layout, 1);
+    }
+    layout.segments[layout.count++] = JournalSegment{plan.sequence, 0};
+  }
+  layout.segments[layout.count - 1].bytes += static_cast<uint32_t>(recordBytes);
+}
+
+// Keeps the table sorted so "oldest" is always index 0.
+bool AddJournalSegment(JournalLayout& layout, uint32_t sequence, uint32_t bytes) {
+  if (layout.count == kJournalMaxSegments) {
+    return false;
+  }
+  size_t index = layout.count;
+  while (index > 0 && layout.segments[index - 1].sequence > sequence) {
+    layout.segments[index] = layout.segments[index - 1];
+    --index;
+  }
+  layout.segments[index] = JournalSegment{sequence, bytes};
+  ++layout.count;
+  return true;
+}
+
+// Shifts the table down and keeps the cursor on a surviving position.
+void DropOldestJournalSegments(JournalLayout& layout, size_t count) {
+  if (count == 0) {
+    return;
+  }
+  if (count > layout.count) {
+    count = layout.count;
+  }
+  const uint32_t lastDropped = layout.segments[count - 1].sequence;
+  for (size_t i = count; i < layout.count; ++i) {
+    layout.segments[i - count] = layout.segments[i];
+  }
+  layout.count = static_cast<uint8_t>(layout.count - count);
+
+  if (layout.count > 0) {
+    if (layout.cursor.sequence < layout.segments[0].sequence) {
+      layout.cursor = JournalCursor{layout.segments[0].sequence, 0};
+    }
+  } else if (layout.cursor.sequence < lastDropped) {
+    layout.cursor = JournalCursor{lastDropped, 0};
+  }
+}
+
+// Steps past finished segments so replayed ones become deletable.
+void AdvanceJournalCursor(JournalLayout& layout, JournalCursor cursor) {
+  layout.cursor = cursor;
+  for (size_t i = 0; i + 1 < layout.count; ++i) {
+    const JournalSegment& segment = layout.segments[i];
+    if (segment.sequence == layout.cursor.sequence &&
+        layout.cursor.offset >= segment.bytes) {
+      layout.cursor = JournalCursor{layout.segments[i + 1].sequence, 0};
+    }
+  }
+}
+
+// Counts leading segments that lie entirely before the cursor.
+size_t ReplayedJournalSegments(const JournalLayout& layout) {
+  size_t replayed = 0;
+  while (replayed < layout.count &&
+         layout.segments[replayed].sequence < layout.cursor.sequence) {
+    ++replayed;
+  }
+  return replayed;
+}
+
+}  // namespace envnode::core
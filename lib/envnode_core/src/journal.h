@@ -0,0 +1,178 @@
+// Record codec and segment bookkeeping for the store-and-forward journal.
+//
+// While offline, the firmware appends readings and event rows to a
+// CRC-protected, append-only journal split into fixed-size segment files on
+// flash. This header holds the parts that do not touch the filesystem: the
+// on-flash record format, and the plan for where the next record goes, which
+// segments to evict, and how far replay has progressed. The firmware carries
+// out the file operations these functions decide on.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "crc32.h"
+#include "event_batch.h"
+#include "reading_batch.h"
+
+namespace envnode::core {
+
+// First two bytes of every record ("JR" little-endian); used to resynchronize
+// after a corrupt or torn record.
+constexpr uint16_t kJournalRecordMagic = 0x524A;
+
+// Record header: magic (2), type (1), reserved (1), payload length (2), and
+// CRC-32 over type, length, and payload (4).
+constexpr size_t kJournalHeaderBytes = 10;
+
+// Largest payload a single record may carry.
+constexpr size_t kJournalMaxPayloadBytes = kEventBatchCapacityBytes + 2;
+
+// Encoded size of one reading payload.
+constexpr size_t kJournalReadingPayloadBytes = 24;
+
+// Longest node device ID a gateway reading payload carries.
+constexpr size_t kJournalDeviceIdMaxBytes = 32;
+
+// Largest gateway reading payload: a reading payload followed by the ID.
+constexpr size_t kJournalGatewayReadingPayloadBytes =
+    kJournalReadingPayloadBytes + kJournalDeviceIdMaxBytes;
+
+// Most segment files tracked at once.
+constexpr size_t kJournalMaxSegments = 32;
+
+// Kinds of journal record.
+enum class JournalRecordType : uint8_t {
+  Reading = 1,
+  EventRows = 2,
+  GatewayReading = 3,
+};
+
+// Outcome of decoding the record at the front of a buffer.
+enum class JournalDecodeStatus {
+  Ok,
+  NeedMoreData,
+  Corrupt,
+};
+
+// A decoded record pointing into the caller's buffer.
+struct JournalRecordView {
+  JournalRecordType type = JournalRecordType::Reading;
+  const uint8_t* payload = nullptr;
+  uint16_t length = 0;
+  size_t totalBytes = 0;
+};
+
+// One segment file, identified by a monotonically increasing sequence number.
+struct JournalSegment {
+  uint32_t sequence = 0;
+  uint32_t bytes = 0;
+};
+
+// Replay position: the next unread byte within segment `sequence`.
+struct JournalCursor {
+  uint32_t sequence = 0;
+  uint32_t offset = 0;
+};
+
+// Segments currently on flash, oldest first, plus the replay cursor.
+struct JournalLayout {
+  JournalSegment segments[kJournalMaxSegments];
+  uint8_t count = 0;
+  JournalCursor cursor;
+};
+
+// Where and how to write the next record.
+struct JournalAppendPlan {
+  uint32_t sequence = 0;
+  bool startNewSegment = false;
+  size_t evictSegments = 0;
+  uint32_t evictedUnreplayedBytes = 0;
+};
+
+// Encodes one record into `out`. Returns the encoded size, or 0 when the
+// payload is too large or `out` is too small.
+size_t EncodeJournalRecord(JournalRecordType type,
+                           const uint8_t* payload,
+                           size_t length,
+                           uint8_t* out,
+                           size_t outCapacity);
+
+// Decodes the record at the start of `data`.
+JournalDecodeStatus DecodeJournalRecord(const uint8_t* data,
+                                        size_t available,
+                                        JournalRecordView& record);
+
+// Returns the offset of the next possible record start after a corrupt byte
+// at offset 0, or `available` when no candidate remains in the buffer.
+size_t FindNextJournalRecord(const uint8_t* data, size_t available);
+
+// Packs a reading into a fixed little-endian payload.
+void EncodeReadingPayload(const BatchedReading& reading,
+                          uint8_t out[kJournalReadingPayloadBytes]);
+
+// Unpacks a reading payload. Returns false when the length is wrong.
+bool DecodeReadingPayload(const uint8_t* payload,
+                          size_t length,
+                          BatchedReading& reading);
+
+// Packs a reading a gateway received from node `deviceId`: the reading payload
+// followed by the ID without its terminator. Returns the payload size, or 0
+// when the ID is empty or longer than `kJournalDeviceIdMaxBytes`.
+size_t EncodeGatewayReadingPayload(const BatchedReading& reading,
+                                   const char* deviceId,
+                                   uint8_t out[kJournalGatewayReadingPayloadBytes]);
+
+// Unpacks a gateway reading payload into `reading` and the terminated
+// `deviceId`. Returns false when the length is wrong.
+bool DecodeGatewayReadingPayload(const uint8_t* payload,
+                                 size_t length,
+                                 BatchedReading& reading,
+                                 char deviceId[kJournalDeviceIdMaxBytes + 1]);
+
+// Packs the buffered event rows (row count followed by the comma-separated
+// JSON) into `out`. Returns the payload size, or 0 when it does not fit.
+size_t EncodeEventRowsPayload(const EventBatch& batch, uint8_t* out, size_t outCapacity);
+
+// Appends the rows from an event-rows payload to `batch`. Returns false,
+// leaving the batch unchanged, when they do not fit or the payload is invalid.
+bool AppendEventRowsPayload(EventBatch& batch, const uint8_t* payload, size_t length);
+
+// Returns the bytes held by every tracked segment.
+uint32_t JournalTotalBytes(const JournalLayout& layout);
+
+// Returns the bytes not yet replayed.
+uint32_t JournalPendingBytes(const JournalLayout& layout);
+
+// Decides where a record of `recordBytes` goes: the active segment, or a new
+// one when it would outgrow `segmentBytes`. Oldest segments are evicted until
+// the journal fits within `capBytes`, reporting how much unreplayed data that
+// discards.
+JournalAppendPlan PlanJournalAppend(const JournalLayout& layout,
+                                    size_t recordBytes,
+                                    size_t segmentBytes,
+                                    size_t capBytes);
+
+// Records the effect of a completed append that followed `plan`.
+void ApplyJournalAppend(JournalLayout& layout,
+                        const JournalAppendPlan& plan,
+                        size_t recordBytes);
+
+// Inserts a segment found on flash, keeping the list ordered by sequence.
+// Returns false when the table is full.
+bool AddJournalSegment(JournalLayout& layout, uint32_t sequence, uint32_t bytes);
+
+// Removes the `count` oldest segments, moving the cursor forward if it pointed
+// into one of them.
+void DropOldestJournalSegments(JournalLayout& layout, size_t count);
+
+// Moves the cursor to `cursor` and normalizes it so a position at the end of a
+// finished segment points at the start of the next one.
+void AdvanceJournalCursor(JournalLayout& layout, JournalCursor cursor);
+
+// Returns how many of the oldest segments have been replayed completely and
+// can be deleted.
+size_t ReplayedJournalSegments(const JournalLayout& layout);
+
+}  // namespace envnode::core
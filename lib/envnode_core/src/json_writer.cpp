@@ -0,0 +1,315 @@
+// Bounded streaming JSON writer implementation.
+
+#include "json_writer.h"
+
+#include <cmath>
+
+namespace envnode::core {
+
+namespace {
+
+// Powers of ten for the supported decimal precisions.
+constexpr int64_t kPowersOfTen[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+
+// Largest scaled magnitude formatted exactly; beyond this doubles lose digits.
+constexpr double kMaxScaledMagnitude = 9.0e15;
+
+// Formats an unsigned integer right-aligned into `scratch`, returning the
+// first digit. `scratch` must hold at least 20 characters.
+char* FormatUnsigned(uint64_t value, char* scratchEnd) {
+  char* cursor = scratchEnd;
+  do {
+    *--cursor = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value);
+  return cursor;
+}
+
+}  // namespace
+
+// Starts an empty document in the supplied buffer.
+JsonWriter::JsonWriter(char* buffer, size_t capacity)
+    : buffer_(buffer), capacity_(capacity) {
+  Reset();
+}
+
+// Clears output, nesting, and error state.
+void JsonWriter::Reset() {
+  length_ = 0;
+  depth_ = 0;
+  needsComma_[0] = false;
+  afterKey_ = false;
+  overflowed_ = capacity_ == 0;
+  invalid_ = false;
+  if (capacity_) {
+    buffer_[0] = '\0';
+  }
+}
+
+// Opens an object as a value.
+void JsonWriter::BeginObject() {
+  Open('{');
+}
+
+// Closes the innermost object.
+void JsonWriter::EndObject() {
+  Close('}');
+}
+
+// Opens an array as a value.
+void JsonWriter::BeginArray() {
+  Open('[');
+}
+
+// Closes the innermost array.
+void JsonWriter::EndArray() {
+  Close(']');
+}
+
+// Writes a member name followed by the colon separator.
+void JsonWriter::Key(std::string_view key) {
+  if (depth_ == 0 || afterKey_) {
+    invalid_ = true;
+  }
+  BeforeValue();
+  Append('"');
+  AppendEscaped(key);
+  Append("\":");
+  afterKey_ = true;
+}
+
+// Writes an escaped string value.
+void JsonWriter::String(std::string_view value) {
+  BeforeValue();
+  Append('"');
+  AppendEscaped(value);
+  Append('"');
+}
+
+// Writes a rounded fixed-point number without going through printf, whose
+// float formatting may allocate on newlib.
+void JsonWriter::Float(float value, int decimals) {
+  if (decimals < 0) {
+    decimals = 0;
+  }
+  if (decimals > 6) {
+    decimals = 6;
+  }
+
+  const double scaled =
+      static_cast<double>(value) * static_cast<double>(kPowersOfTen[decimals]);
+  if (std::isnan(scaled) || std::fabs(scaled) > kMaxScaledMagnitude) {
+    Null();
+    return;
+  }
+
+  const int64_t rounded = std::llround(scaled);
+  const bool negative = rounded < 0;
+  const uint64_t magnitude =
+      negative ? static_cast<uint64_t>(-rounded) : static_cast<uint64_t>(rounded);
+  const uint64_t divisor = static_cast<uint64_t>(kPowersOfTen[decimals]);
+
+  char scratch[24];
+  char* const scratchEnd = scratch + sizeof(scratch);
+  char* cursor = scratchEnd;
+  uint64_t fraction = magnitude % divisor;
+  for (int digit = 0; digit < decimals; ++digit) {
+    *--cursor = static_cast<char>('0' + fraction % 10);
+    fraction /= 10;
+  }
+  if (decimals) {
+    *--cursor = '.';
+  }
+  cursor = FormatUnsigned(magnitude / divisor, cursor);
+  if (negative) {
+    *--cursor = '-';
+  }
+
+  BeforeValue();
+  Append(std::string_view(cursor, static_cast<size_t>(scratchEnd - cursor)));
+}
+
+// Writes a signed integer.
+void JsonWriter::Int(int64_t value) {
+  char scratch[24];
+  char* const scratchEnd = scratch + sizeof(scratch);
+  const uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value)
+                                       : static_cast<uint64_t>(value);
+  char* cursor = FormatUnsigned(magnitude, scratchEnd);
+  if (value < 0) {
+    *--cursor = '-';
+  }
+  BeforeValue();
+  Append(std::string_view(cursor, static_cast<size_t>(scratchEnd - cursor)));
+}
+
+// Writes an unsigned integer.
+void JsonWriter::UInt(uint64_t value) {
+  char scratch[24];
+  char* const scratchEnd = scratch + sizeof(scratch);
+  char* cursor = FormatUnsigned(value, scratchEnd);
+  BeforeValue();
+  Append(std::string_view(cursor, static_cast<size_t>(scratchEnd - cursor)));
+}
+
+// Writes `true` or `false`.
+void JsonWriter::Bool(bool value) {
+  BeforeValue();
+  Append(value ? "true" : "false");
+}
+
+// Writes `null`.
+void JsonWriter::Null() {
+  BeforeValue();
+  Append("null");
+}
+
+// Copies a pre-serialized value into the document.
+void JsonWriter::Raw(std::string_view json) {
+  if (json.empty()) {
+    Null();
+    return;
+  }
+  BeforeValue();
+  Append(json);
+}
+
+// Writes a string member.
+void JsonWriter::Field(std::string_view key, std::string_view value) {
+  Key(key);
+  String(value);
+}
+
+// Writes a string member from a C string; `nullptr` becomes `null`.
+void JsonWriter::Field(std::string_view key, const char* value) {
+  Key(key);
+  if (value) {
+    String(value);
+  } else {
+    Null();
+  }
+}
+
+// Writes a fixed-precision number member.
+void JsonWriter::NumberField(std::string_view key, float value, int decimals) {
+  Key(key);
+  Float(value, decimals);
+}
+
+// Writes a signed integer member.
+void JsonWriter::IntField(std::string_view key, int64_t value) {
+  Key(key);
+  Int(value);
+}
+
+// Writes an unsigned integer member.
+void JsonWriter::UIntField(std::string_view key, uint64_t value) {
+  Key(key);
+  UInt(value);
+}
+
+// Writes a boolean member.
+void JsonWriter::BoolField(std::string_view key, bool value) {
+  Key(key);
+  Bool(value);
+}
+
+// Writes a pre-serialized member value.
+void JsonWriter::RawField(std::string_view key, std::string_view json) {
+  Key(key);
+  Raw(json);
+}
+
+// Emits the separator a new value needs at the current nesting level.
+void JsonWriter::BeforeValue() {
+  if (afterKey_) {
+    afterKey_ = false;
+    return;
+  }
+  if (needsComma_[depth_]) {
+    Append(',');
+  }
+  needsComma_[depth_] = true;
+}
+
+// Appends one character if it fits.
+void JsonWriter::Append(char c) {
+  if (overflowed_) {
+    return;
+  }
+  if (length_ + 1 >= capacity_) {
+    overflowed_ = true;
+    return;
+  }
+  buffer_[length_++] = c;
+  buffer_[length_] = '\0';
+}
+
+// Appends raw text, stopping at the first byte that does not fit.
+void JsonWriter::Append(std::string_view text) {
+  for (char c : text) {
+    Append(c);
+  }
+}
+
+// Appends text with the same escaping rules as `JsonEscape`.
+void JsonWriter::AppendEscaped(std::string_view text) {
+  static constexpr char kHexDigits[] = "0123456789abcdef";
+  for (char c : text) {
+    switch (c) {
+      case '"':
+        Append("\\\"");
+        break;
+      case '\\':
+        Append("\\\\");
+        break;
+      case '\b':
+        Append("\\b");
+        break;
+      case '\f':
+        Append("\\f");
+        break;
+      case '\n':
+        Append("\\n");
+        break;
+      case '\r':
+        Append("\\r");
+        break;
+      case '\t':
+        Append("\\t");
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20U) {
+          const char escaped[] = {'\\', 'u', '0', '0', kHexDigits[(c >> 4) & 0x0F],
+                                  kHexDigits[c & 0x0F]};
+          Append(std::string_view(escaped, sizeof(escaped)));
+        } else {
+          Append(c);
+        }
+        break;
+    }
+  }
+}
+
+// Opens a container and pushes a fresh comma state.
+void JsonWriter::Open(char bracket) {
+  BeforeValue();
+  Append(bracket);
+  if (depth_ >= kJsonWriterMaxDepth) {
+    invalid_ = true;
+    return;
+  }
+  needsComma_[++depth_] = false;
+}
+
+// Closes the innermost container.
+void JsonWriter::Close(char bracket) {
+  if (depth_ == 0 || afterKey_) {
+    invalid_ = true;
+    return;
+  }
+  --depth_;
+  Append(bracket);
+}
+
+}  // namespace envnode::core
@@ -0,0 +1,96 @@
+// Bounded streaming JSON writer over a caller-provided buffer.
+//
+// Payload builders use this instead of growing `String`/`std::string` values so
+// a long awake session does not fragment the heap. The writer never allocates:
+// when the buffer runs out it stops writing, records the overflow, and keeps
+// the output NUL-terminated so callers can detect and report the failure.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace envnode::core {
+
+// Deepest object/array nesting the writer tracks.
+constexpr size_t kJsonWriterMaxDepth = 8;
+
+// Writes compact JSON into a fixed buffer. Commas between members and array
+// elements are inserted automatically; keys must be followed by exactly one
+// value or container.
+class JsonWriter {
+ public:
+  // `buffer` must stay valid while the writer is in use. One byte is always
+  // reserved for the terminating NUL.
+  JsonWriter(char* buffer, size_t capacity);
+
+  // Discards everything written so far and starts a new document.
+  void Reset();
+
+  void BeginObject();
+  void EndObject();
+  void BeginArray();
+  void EndArray();
+
+  // Writes an object member name. The next call supplies its value.
+  void Key(std::string_view key);
+
+  // Writes a JSON string value with escaping.
+  void String(std::string_view value);
+
+  // Writes a fixed-precision number, or `null` when the value is NaN or too
+  // large to format exactly. `decimals` is clamped to 0..6.
+  void Float(float value, int decimals);
+
+  void Int(int64_t value);
+  void UInt(uint64_t value);
+  void Bool(bool value);
+  void Null();
+
+  // Writes an already-serialized JSON value verbatim, or `null` when empty.
+  void Raw(std::string_view json);
+
+  // Key/value shorthands used by the payload builders.
+  void Field(std::string_view key, std::string_view value);
+  void Field(std::string_view key, const char* value);
+  void NumberField(std::string_view key, float value, int decimals);
+  void IntField(std::string_view key, int64_t value);
+  void UIntField(std::string_view key, uint64_t value);
+  void BoolField(std::string_view key, bool value);
+  void RawField(std::string_view key, std::string_view json);
+
+  // Returns true when the document has not overflowed or been misnested.
+  bool Ok() const { return !overflowed_ && !invalid_; }
+
+  // Returns true when the buffer ran out before the document was complete.
+  bool Overflowed() const { return overflowed_; }
+
+  // Returns true when every container opened so far has been closed.
+  bool Complete() const { return depth_ == 0; }
+
+  // Returns the NUL-terminated output written so far.
+  const char* Data() const { return buffer_; }
+
+  // Returns the number of bytes written, excluding the terminator.
+  size_t Length() const { return length_; }
+
+ private:
+  void BeforeValue();
+  void Append(char c);
+  void Append(std::string_view text);
+  void AppendEscaped(std::string_view text);
+  void Open(char bracket);
+  void Close(char bracket);
+
+  char* buffer_;
+  size_t capacity_;
+  size_t length_ = 0;
+  size_t depth_ = 0;
+  bool needsComma_[kJsonWriterMaxDepth + 1] = {};
+  bool afterKey_ = false;
+  bool overflowed_ = false;
+  bool invalid_ = false;
+};
+
+}  // namespace envnode::core
@@ -0,0 +1,169 @@
+// Rolling-window plausibility filter implementation.
+
+#include "plausibility_filter.h"
+
+#include <cmath>
+
+namespace envnode::core {
+
+namespace {
+
+// Scale that makes the MAD estimate the standard deviation of normal noise.
+constexpr float kMadToSigma = 1.4826f;
+
+// Selects one channel of a reading.
+using Channel = float LogicReadings::*;
+
+constexpr Channel kChannels[] = {&LogicReadings::temperature, &LogicReadings::humidity,
+                                 &LogicReadings::pressure};
+
+// Bounds for the channel at the same index in `kChannels`.
+const ChannelBounds& BoundsFor(const PlausibilityConfig& config, size_t channel) {
+  if (channel == 0) {
+    return config.temperature;
+  }
+  return channel == 1 ? config.humidity : config.pressure;
+}
+
+// Median of `length` values, sorting them in place. Insertion sort is enough
+// for a window this small.
+float Median(float* values, size_t length) {
+  for (size_t i = 1; i < length; ++i) {
+    const float value = values[i];
+    size_t j = i;
+    while (j > 0 && values[j - 1] > value) {
+      values[j] = values[j - 1];
+      --j;
+    }
+    values[j] = value;
+  }
+  if (length % 2 == 1) {
+    return values[length / 2];
+  }
+  return (values[length / 2 - 1] + values[length / 2]) / 2.0f;
+}
+
+// Center and allowed deviation of one channel over `samples`.
+struct ChannelRange {
+  float median;
+  float bound;
+};
+
+ChannelRange RangeOf(const LogicReadings* samples,
+                     size_t length,
+                     Channel channel,
+                     const ChannelBounds& bounds,
+                     float madMultiplier) {
+  float values[kPlausibilityWindow];
+  for (size_t i = 0; i < length; ++i) {
+    values[i] = samples[i].*channel;
+  }
+  ChannelRange range;
+  range.median = Median(values, length);
+  for (size_t i = 0; i < length; ++i) {
+    values[i] = std::fabs(values[i] - range.median);
+  }
+  const float spread = madMultiplier * kMadToSigma * Median(values, length);
+  range.bound = std::fmin(std::fmax(spread, bounds.floor), bounds.ceiling);
+  return range;
+}
+
+// Counts the samples whose channel value is within `floor` of `value`.
+size_t Support(const LogicReadings* samples, size_t length, Channel channel, float value,
+               float floor) {
+  size_t support = 0;
+  for (size_t i = 0; i < length; ++i) {
+    if (std::fabs(samples[i].*channel - value) <= floor) {
+      ++support;
+    }
+  }
+  return support;
+}
+
+// Reports whether every channel of `readings` is within bounds of the median
+// of `samples`, or close to at least `minSupport` of them. The second rule
+// keeps a level the window has already seen acceptable, which the median
+// alone would not for a channel that alternates between two levels.
+bool WithinBounds(const LogicReadings* samples,
+                  size_t length,
+                  const PlausibilityConfig& config,
+                  float madMultiplier,
+                  size_t minSupport,
+                  const LogicReadings& readings) {
+  for (size_t c = 0; c < sizeof(kChannels) / sizeof(kChannels[0]); ++c) {
+    const ChannelBounds& bounds = BoundsFor(config, c);
+    const float value = readings.*kChannels[c];
+    const ChannelRange range = RangeOf(samples, length, kChannels[c], bounds, madMultiplier);
+    if (std::fabs(value - range.median) > range.bound &&
+        (minSupport == 0 ||
+         Support(samples, length, kChannels[c], value, bounds.floor) < minSupport)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Adds an accepted reading to the window, replacing the oldest once full.
+void PushAccepted(PlausibilityHistory& history, const LogicReadings& readings) {
+  history.window[history.next] = readings;
+  history.next = static_cast<uint8_t>((history.next + 1) % kPlausibilityWindow);
+  if (history.count < kPlausibilityWindow) {
+    ++history.count;
+  }
+}
+
+}  // namespace
+
+PlausibilityVerdict JudgeReading(const PlausibilityHistory& history,
+                                 const PlausibilityConfig& config,
+                                 const LogicReadings& readings) {
+  if (!PlausibleReadings(readings)) {
+    return PlausibilityVerdict::OutOfRange;
+  }
+  if (history.count == 0 || WithinBounds(history.window, history.count, config,
+                                         config.madMultiplier, config.minSupport, readings)) {
+    return PlausibilityVerdict::Accepted;
+  }
+  return PlausibilityVerdict::Outlier;
+}
+
+// Outliers only count toward a new baseline while they agree with the run so
+// far under the floor bounds; one that does not starts a new run. The run
+// joins the window, so the new level is supported from then on while the old
+// one ages out.
+PlausibilityVerdict FilterReading(PlausibilityHistory& history,
+                                  const PlausibilityConfig& config,
+                                  const LogicReadings& readings) {
+  const PlausibilityVerdict verdict = JudgeReading(history, config, readings);
+  if (verdict == PlausibilityVerdict::OutOfRange) {
+    return verdict;
+  }
+  if (verdict == PlausibilityVerdict::Accepted) {
+    history.candidateCount = 0;
+    PushAccepted(history, readings);
+    return verdict;
+  }
+
+  if (history.candidateCount > 0 &&
+      !WithinBounds(history.candidates, history.candidateCount, config, 0.0f, 0, readings)) {
+    history.candidateCount = 0;
+  }
+  if (history.candidateCount < kPlausibilityCandidates) {
+    history.candidates[history.candidateCount++] = readings;
+  }
+
+  size_t needed = config.rebaselineAfter;
+  if (needed > kPlausibilityCandidates) {
+    needed = kPlausibilityCandidates;
+  }
+  if (needed == 0 || history.candidateCount < needed) {
+    return PlausibilityVerdict::Outlier;
+  }
+  for (size_t i = 0; i < history.candidateCount; ++i) {
+    PushAccepted(history, history.candidates[i]);
+  }
+  history.candidateCount = 0;
+  return PlausibilityVerdict::Rebaselined;
+}
+
+}  // namespace envnode::core
@@ -0,0 +1,80 @@
+// Rolling-window plausibility filter for sensor readings.
+//
+// Comparing each reading with the last accepted one and fixed thresholds
+// rejects every reading after a real fast change, such as a window opening or
+// a shower raising the humidity, until conditions drift back. This filter
+// keeps the last `kPlausibilityWindow` accepted readings in RTC memory and
+// judges each channel against their median. The allowed deviation is
+// `madMultiplier` scaled median absolute deviations, clamped between a floor
+// and a ceiling per channel, so a noisy channel gets wider bounds and a
+// steady one keeps the floor. A value within the floor of at least
+// `minSupport` window readings also passes, so a level seen recently stays
+// acceptable. A reading that fails on any channel is an outlier. When
+// `rebaselineAfter` outliers in a row agree with each other, the level really
+// moved: they join the window and the latest is accepted.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "core_logic.h"
+
+namespace envnode::core {
+
+// Accepted readings kept for the median.
+constexpr size_t kPlausibilityWindow = 9;
+
+// Most consecutive outliers held for re-baselining.
+constexpr size_t kPlausibilityCandidates = 4;
+
+// Allowed deviation from the window median for one channel.
+struct ChannelBounds {
+  float floor;
+  float ceiling;
+};
+
+// Filter limits. The floors are the fixed jump thresholds used before.
+struct PlausibilityConfig {
+  ChannelBounds temperature = {5.0f, 15.0f};
+  ChannelBounds humidity = {15.0f, 45.0f};
+  ChannelBounds pressure = {10.0f, 30.0f};
+  float madMultiplier = 4.0f;
+  uint8_t minSupport = 2;
+  uint8_t rebaselineAfter = 2;
+};
+
+// Retained window of accepted readings, oldest at `next` once full, and the
+// run of outliers that may become the new baseline.
+struct PlausibilityHistory {
+  LogicReadings window[kPlausibilityWindow];
+  uint8_t count = 0;
+  uint8_t next = 0;
+  LogicReadings candidates[kPlausibilityCandidates];
+  uint8_t candidateCount = 0;
+};
+
+// Outcome of judging one reading.
+enum class PlausibilityVerdict : uint8_t {
+  Accepted,
+  Rebaselined,
+  OutOfRange,
+  Outlier,
+};
+
+// Judges `readings` without changing `history`. Returns `OutOfRange` when
+// the absolute limits of `PlausibleReadings()` fail, `Outlier` when a channel
+// is outside its bounds, and `Accepted` otherwise. An empty window accepts any
+// in-range reading.
+PlausibilityVerdict JudgeReading(const PlausibilityHistory& history,
+                                 const PlausibilityConfig& config,
+                                 const LogicReadings& readings);
+
+// Judges `readings` and records the outcome: accepted readings join the
+// window, and outliers join the re-baselining run, which may turn the verdict
+// into `Rebaselined`. Out-of-range readings leave `history` alone.
+PlausibilityVerdict FilterReading(PlausibilityHistory& history,
+                                  const PlausibilityConfig& config,
+                                  const LogicReadings& readings);
+
+}  // namespace envnode::core
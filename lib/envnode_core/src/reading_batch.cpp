@@ -0,0 +1,163 @@
+// Retained reading ring and timestamp helper implementation.
+
+#include "reading_batch.h"
+
+#include <cstdio>
+
+namespace envnode::core {
+
+namespace {
+
+// Converts a proleptic Gregorian date into days since 1970-01-01.
+int64_t DaysFromCivil(int64_t year, unsigned month, unsigned day) {
+  year -= month <= 2 ? 1 : 0;
+  const int64_t era = (year >= 0 ? year : year - 399) / 400;
+  const unsigned yearOfEra = static_cast<unsigned>(year - era * 400);
+  const unsigned dayOfYear =
+      (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+  const unsigned dayOfEra =
+      yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+  return era * 146097 + static_cast<int64_t>(dayOfEra) - 719468;
+}
+
+// Parses exactly `digits` decimal digits from the front of `text`.
+bool ParseFixedDigits(std::string_view text, size_t digits, unsigned& value) {
+  if (text.size() < digits) {
+    return false;
+  }
+  value = 0;
+  for (size_t i = 0; i < digits; ++i) {
+    if (text[i] < '0' || text[i] > '9') {
+      return false;
+    }
+    value = value * 10 + static_cast<unsigned>(text[i] - '0');
+  }
+  return true;
+}
+
+}  // namespace
+
+// Clears the ring back to its empty state.
+void ResetReadingRing(ReadingRing& ring) {
+  ring = ReadingRing{};
+}
+
+// Appends one reading, overwriting the oldest entry when the ring is full.
+bool PushReading(ReadingRing& ring, const BatchedReading& reading) {
+  const size_t tail = (ring.head + ring.count) % kReadingRingCapacity;
+  ring.entries[tail] = reading;
+  if (ring.count < kReadingRingCapacity) {
+    ++ring.count;
+    return true;
+  }
+
+  ring.head = static_cast<uint8_t>((ring.head + 1) % kReadingRingCapacity);
+  ++ring.dropped;
+  return false;
+}
+
+// Returns the reading at an oldest-first index.
+const BatchedReading* ReadingAt(const ReadingRing& ring, size_t index) {
+  if (index >= ring.count) {
+    return nullptr;
+  }
+  return &ring.entries[(ring.head + index) % kReadingRingCapacity];
+}
+
+// Discards the oldest readings once they have been uploaded.
+void DropOldestReadings(ReadingRing& ring, size_t count) {
+  if (count >= ring.count) {
+    ring.head = 0;
+    ring.count = 0;
+    return;
+  }
+  ring.head = static_cast<uint8_t>((ring.head + count) % kReadingRingCapacity);
+  ring.count = static_cast<uint8_t>(ring.count - count);
+}
+
+// Applies the configured flush threshold, clamped to the ring capacity.
+bool ShouldFlushReadings(const ReadingRing& ring, size_t flushThreshold) {
+  if (flushThreshold == 0) {
+    flushThreshold = 1;
+  }
+  if (flushThreshold > kReadingRingCapacity) {
+    flushThreshold = kReadingRingCapacity;
+  }
+  return ring.count >= flushThreshold;
+}
+
+// Converts epoch seconds to a UTC civil date/time string.
+void FormatIso8601Utc(uint32_t epochSeconds, char* buffer, size_t bufferSize) {
+  int64_t days = epochSeconds / 86400;
+  const uint32_t secondsOfDay = epochSeconds % 86400;
+
+  days += 719468;
+  const int64_t era = days / 146097;
+  const unsigned dayOfEra = static_cast<unsigned>(days - era * 146097);
+  const unsigned yearOfEra =
+      (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+  const unsigned dayOfYear =
+      dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+  const unsigned monthIndex = (5 * dayOfYear + 2) / 153;
+  const unsigned day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+  const unsigned month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+  const int64_t year =
+      static_cast<int64_t>(yearOfEra) + era * 400 + (month <= 2 ? 1 : 0);
+
+  std::snprintf(buffer, bufferSize, "%04lld-%02u-%02uT%02u:%02u:%02uZ",
+                static_cast<long long>(year), month, day,
+                static_cast<unsigned>(secondsOfDay / 3600),
+                static_cast<unsigned>((secondsOfDay / 60) % 60),
+                static_cast<unsigned>(secondsOfDay % 60));
+}
+
+// Parses the fixed-width HTTP date format used by PostgREST and most servers.
+bool ParseHttpDate(std::string_view text, uint32_t& epochSeconds) {
+  static constexpr const char* kMonths[12] = {"Jan", "Feb", "Mar", "Apr",
+                                              "May", "Jun", "Jul", "Aug",
+                                              "Sep", "Oct", "Nov", "Dec"};
+
+  // "Sun, 06 Nov 1994 08:49:37 GMT" is exactly 29 characters.
+  if (text.size() < 29 || text[3] != ',' || text[4] != ' ' || text[7] != ' ' ||
+      text[11] != ' ' || text[16] != ' ' || text[19] != ':' ||
+      text[22] != ':' || text.substr(25, 4) != " GMT") {
+    return false;
+  }
+
+  unsigned day = 0;
+  unsigned year = 0;
+  unsigned hour = 0;
+  unsigned minute = 0;
+  unsigned second = 0;
+  if (!ParseFixedDigits(text.substr(5), 2, day) ||
+      !ParseFixedDigits(text.substr(12), 4, year) ||
+      !ParseFixedDigits(text.substr(17), 2, hour) ||
+      !ParseFixedDigits(text.substr(20), 2, minute) ||
+      !ParseFixedDigits(text.substr(23), 2, second)) {
+    return false;
+  }
+
+  unsigned month = 0;
+  const std::string_view monthText = text.substr(8, 3);
+  for (unsigned index = 0; index < 12; ++index) {
+    if (monthText == kMonths[index]) {
+      month = index + 1;
+      break;
+    }
+  }
+
+  if (month == 0 || day < 1 || day > 31 || hour > 23 || minute > 59 ||
+      second > 60 || year < 1970 || year > 2105) {
+    return false;
+  }
+
+  const int64_t seconds = DaysFromCivil(year, month, day) * 86400 +
+                          hour * 3600 + minute * 60 + second;
+  if (seconds < 0 || seconds > UINT32_MAX) {
+    return false;
+  }
+  epochSeconds = static_cast<uint32_t>(seconds);
+  return true;
+}
+
+}  // namespace envnode::core
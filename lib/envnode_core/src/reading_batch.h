@@ -0,0 +1,68 @@
+// Retained reading ring for batched readings-table uploads.
+//
+// The firmware keeps accepted samples in a fixed-size ring that lives in RTC
+// memory across deep sleep, then uploads several rows in one PostgREST insert
+// built by `WriteReadingBatch()`. The ring is plain data so it can sit inside
+// `RTC_DATA_ATTR` storage and be exercised on the host.
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace envnode::core {
+
+// Maximum number of readings retained between uploads.
+constexpr size_t kReadingRingCapacity = 24;
+
+// Epoch seconds before which the wall clock is treated as unsynchronized.
+constexpr uint32_t kMinValidEpochSeconds = 1600000000UL;
+
+// One accepted reading waiting for a batched upload. `recordedAtEpoch` is zero
+// when the device clock was not yet synchronized at capture time.
+struct BatchedReading {
+  float temperature = NAN;
+  float humidity = NAN;
+  float pressure = NAN;
+  float batteryVoltage = NAN;
+  float batteryPercent = NAN;
+  uint32_t recordedAtEpoch = 0;
+};
+
+// Fixed-capacity FIFO of pending readings. When full, the oldest entry is
+// overwritten and counted in `dropped`.
+struct ReadingRing {
+  BatchedReading entries[kReadingRingCapacity];
+  uint8_t head = 0;
+  uint8_t count = 0;
+  uint32_t dropped = 0;
+};
+
+// Clears every pending reading and the dropped counter.
+void ResetReadingRing(ReadingRing& ring);
+
+// Appends one reading. Returns false when the ring was full and the oldest
+// reading had to be overwritten.
+bool PushReading(ReadingRing& ring, const BatchedReading& reading);
+
+// Returns the pending reading at `index` (0 = oldest), or `nullptr` when the
+// index is out of range.
+const BatchedReading* ReadingAt(const ReadingRing& ring, size_t index);
+
+// Removes up to `count` of the oldest readings after a successful upload.
+void DropOldestReadings(ReadingRing& ring, size_t count);
+
+// Reports whether enough readings are pending to justify an upload.
+bool ShouldFlushReadings(const ReadingRing& ring, size_t flushThreshold);
+
+// Formats epoch seconds as an ISO-8601 UTC timestamp (`YYYY-MM-DDTHH:MM:SSZ`).
+// `buffer` must hold at least 21 bytes.
+void FormatIso8601Utc(uint32_t epochSeconds, char* buffer, size_t bufferSize);
+
+// Parses an RFC 7231 IMF-fixdate (`Sun, 06 Nov 1994 08:49:37 GMT`) as sent in
+// HTTP `Date` headers. Returns false when the text is not in that format.
+bool ParseHttpDate(std::string_view text, uint32_t& epochSeconds);
+
+}  // namespace envnode::core
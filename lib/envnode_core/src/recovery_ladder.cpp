@@ -0,0 +1,99 @@
+// Learned sensor recovery ladder implementation.
+
+#include "recovery_ladder.h"
+
+namespace envnode::core {
+
+namespace {
+
+// Reports whether `a` has the better fix rate. Rates use one imagined fix and
+// one imagined failure, so an untried stage ranks at 50% and a single outcome
+// does not decide the order on its own.
+bool BetterRate(const RecoveryStageStats& a, const RecoveryStageStats& b) {
+  return (a.fixes + 1U) * (b.attempts + 2U) > (b.fixes + 1U) * (a.attempts + 2U);
+}
+
+}  // namespace
+
+// Insertion sort keeps ties in cost order, since candidates are collected
+// cheapest first.
+size_t PlanRecovery(RecoveryLadder& ladder, RecoveryStage* order) {
+  size_t count = 0;
+  for (size_t i = 0; i < kRecoveryStageCount; ++i) {
+    RecoveryStageStats& stats = ladder.stages[i];
+    if (stats.skipRunsLeft > 0) {
+      --stats.skipRunsLeft;
+      continue;
+    }
+    const RecoveryStage stage = static_cast<RecoveryStage>(i);
+    size_t at = count;
+    while (at > 0) {
+      const RecoveryStage before = order[at - 1];
+      const bool stageIsLastFix = ladder.hasLastFix && ladder.lastFix == stage;
+      const bool beforeIsLastFix = ladder.hasLastFix && ladder.lastFix == before;
+      if (beforeIsLastFix ||
+          (!stageIsLastFix &&
+           !BetterRate(stats, ladder.stages[static_cast<size_t>(before)]))) {
+        break;
+      }
+      order[at] = before;
+      --at;
+    }
+    order[at] = stage;
+    ++count;
+  }
+  if (count == 0) {
+    order[count++] = RecoveryStage::I2cRestart;
+  }
+  return count;
+}
+
+// A fix clears the stage's backoff at once; failures only start one after
+// `freeFailures` in a row, then double it each time.
+void RecordRecoveryStage(RecoveryLadder& ladder,
+                         const RecoveryLadderConfig& config,
+                         RecoveryStage stage,
+                         bool fixed) {
+  RecoveryStageStats& stats = ladder.stages[static_cast<size_t>(stage)];
+  if (stats.attempts >= config.historyLimit) {
+    stats.attempts /= 2;
+    stats.fixes /= 2;
+  }
+  ++stats.attempts;
+  if (fixed) {
+    ++stats.fixes;
+    stats.consecutiveFailures = 0;
+    stats.skipRuns = 0;
+    stats.skipRunsLeft = 0;
+    ladder.hasLastFix = true;
+    ladder.lastFix = stage;
+    return;
+  }
+
+  if (ladder.hasLastFix && ladder.lastFix == stage) {
+    ladder.hasLastFix = false;
+  }
+  if (stats.consecutiveFailures < UINT8_MAX) {
+    ++stats.consecutiveFailures;
+  }
+  if (stats.consecutiveFailures >= config.freeFailures) {
+    const unsigned doubled = stats.skipRuns == 0 ? 1U : stats.skipRuns * 2U;
+    stats.skipRuns =
+        static_cast<uint8_t>(doubled > config.maxSkipRuns ? config.maxSkipRuns : doubled);
+    stats.skipRunsLeft = stats.skipRuns;
+  }
+}
+
+const char* RecoveryStageName(RecoveryStage stage) {
+  switch (stage) {
+    case RecoveryStage::SoftReset:
+      return "soft_reset";
+    case RecoveryStage::Reinit:
+      return "reinit";
+    case RecoveryStage::I2cRestart:
+      return "i2c_restart";
+  }
+  return "unknown";
+}
+
+}  // namespace envnode::core
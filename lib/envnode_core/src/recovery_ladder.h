@@ -0,0 +1,69 @@
+// Learned order for the sensor recovery stages.
+//
+// When a reading stays implausible the firmware tries up to three recovery
+// stages, cheapest first: a BME680 soft reset, a driver reinit that re-reads
+// the calibration, and a full I2C restart with a bus clear. Which one actually
+// helps depends on the node: a marginal sensor answers to a soft reset, a
+// noisy bus needs the restart. The ladder keeps per-stage attempt and fix
+// counts in RTC memory and plans each run from them: the stage that fixed the
+// sensor last goes first, the rest follow by fix rate, and a stage that fails
+// `freeFailures` times in a row sits out a doubling number of runs. Counts
+// are halved once a stage reaches `historyLimit` attempts, so old history
+// fades. The state is plain data for RTC memory.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace envnode::core {
+
+// Recovery stages in order of cost.
+enum class RecoveryStage : uint8_t {
+  SoftReset = 0,
+  Reinit = 1,
+  I2cRestart = 2,
+};
+
+constexpr size_t kRecoveryStageCount = 3;
+
+// Backoff and history limits.
+struct RecoveryLadderConfig {
+  uint8_t freeFailures = 2;
+  uint8_t maxSkipRuns = 16;
+  uint8_t historyLimit = 32;
+};
+
+// What one stage has done on this node. `skipRuns` is the current backoff
+// length and `skipRunsLeft` how many planned runs it still sits out.
+struct RecoveryStageStats {
+  uint8_t attempts = 0;
+  uint8_t fixes = 0;
+  uint8_t consecutiveFailures = 0;
+  uint8_t skipRuns = 0;
+  uint8_t skipRunsLeft = 0;
+};
+
+// Retained ladder state. `lastFix` is only meaningful when `hasLastFix` is set.
+struct RecoveryLadder {
+  RecoveryStageStats stages[kRecoveryStageCount];
+  bool hasLastFix = false;
+  RecoveryStage lastFix = RecoveryStage::SoftReset;
+};
+
+// Plans one recovery run: writes the stages to try, in order, to `order`
+// (room for `kRecoveryStageCount`) and returns how many there are. Stages in
+// backoff are left out and their backoff counts down. When every stage is in
+// backoff the I2C restart still runs, so a run never does nothing.
+size_t PlanRecovery(RecoveryLadder& ladder, RecoveryStage* order);
+
+// Records whether running `stage` fixed the sensor.
+void RecordRecoveryStage(RecoveryLadder& ladder,
+                         const RecoveryLadderConfig& config,
+                         RecoveryStage stage,
+                         bool fixed);
+
+// Returns the stage's event action name, e.g. "soft_reset".
+const char* RecoveryStageName(RecoveryStage stage);
+
+}  // namespace envnode::core
@@ -0,0 +1,74 @@
+// Deadband reporting policy implementation.
+
+#include "report_policy.h"
+
+#include <cmath>
+
+namespace envnode::core {
+
+namespace {
+
+// A value that appears or disappears (for example a battery gauge that stops
+// answering) counts as a change; two missing values do not.
+bool MovedBeyond(float last, float current, float deadband) {
+  if (std::isnan(last) || std::isnan(current)) {
+    return std::isnan(last) != std::isnan(current);
+  }
+  return std::fabs(current - last) > deadband;
+}
+
+}  // namespace
+
+// A clock that stepped backwards cannot tell how long the node was silent, so
+// the keep-alive is treated as due.
+bool ReportKeepAliveDue(const ReportState& state,
+                        const ReportDeadband& deadband,
+                        uint32_t nowSeconds) {
+  if (!state.hasReported || deadband.maxSilenceSeconds == 0) {
+    return true;
+  }
+  return nowSeconds < state.reportedAtSeconds ||
+         nowSeconds - state.reportedAtSeconds >= deadband.maxSilenceSeconds;
+}
+
+// Change is checked before the keep-alive so logs name the more useful reason.
+ReportDecision EvaluateReport(const ReportState& state,
+                              const ReportDeadband& deadband,
+                              const BatchedReading& reading,
+                              uint32_t nowSeconds) {
+  if (!state.hasReported || deadband.maxSilenceSeconds == 0) {
+    return ReportDecision::First;
+  }
+  const BatchedReading& last = state.last;
+  if (MovedBeyond(last.temperature, reading.temperature, deadband.temperatureC) ||
+      MovedBeyond(last.humidity, reading.humidity, deadband.humidityRh) ||
+      MovedBeyond(last.pressure, reading.pressure, deadband.pressureHpa) ||
+      MovedBeyond(last.batteryVoltage, reading.batteryVoltage, deadband.batteryVoltage)) {
+    return ReportDecision::Changed;
+  }
+  return ReportKeepAliveDue(state, deadband, nowSeconds) ? ReportDecision::KeepAlive
+                                                         : ReportDecision::Suppressed;
+}
+
+// The reading's epoch stamp is kept but never compared.
+void MarkReported(ReportState& state, const BatchedReading& reading, uint32_t nowSeconds) {
+  state.hasReported = true;
+  state.last = reading;
+  state.reportedAtSeconds = nowSeconds;
+}
+
+const char* ReportDecisionName(ReportDecision decision) {
+  switch (decision) {
+    case ReportDecision::First:
+      return "first";
+    case ReportDecision::Changed:
+      return "changed";
+    case ReportDecision::KeepAlive:
+      return "keep-alive";
+    case ReportDecision::Suppressed:
+      return "within deadband";
+  }
+  return "unknown";
+}
+
+}  // namespace envnode::core
@@ -0,0 +1,61 @@
+// Deadband reporting policy for accepted readings.
+//
+// A reading is only queued for upload when one of its values has moved by
+// more than its deadband since the last reported reading, or when the node has
+// been silent for `maxSilenceSeconds`, so slow-changing rooms still show up as
+// alive. Wakes whose reading is not reported can skip Wi-Fi entirely. The
+// state is plain data so the firmware can keep it in RTC memory.
+
+#pragma once
+
+#include <cstdint>
+
+#include "reading_batch.h"
+
+namespace envnode::core {
+
+// Minimum change per value that makes a reading worth reporting, and the
+// longest a node may go without reporting one. A `maxSilenceSeconds` of 0
+// disables the policy and reports every reading.
+struct ReportDeadband {
+  float temperatureC = 0.2f;
+  float humidityRh = 1.0f;
+  float pressureHpa = 0.5f;
+  float batteryVoltage = 0.05f;
+  uint32_t maxSilenceSeconds = 3600;
+};
+
+// The last reading that was reported and when, in RTC clock seconds.
+struct ReportState {
+  bool hasReported = false;
+  BatchedReading last;
+  uint32_t reportedAtSeconds = 0;
+};
+
+// Why a reading is or is not reported.
+enum class ReportDecision : uint8_t {
+  First,
+  Changed,
+  KeepAlive,
+  Suppressed,
+};
+
+// Compares `reading` with the last reported one and the silence limit.
+ReportDecision EvaluateReport(const ReportState& state,
+                              const ReportDeadband& deadband,
+                              const BatchedReading& reading,
+                              uint32_t nowSeconds);
+
+// Returns true when the next reading will be reported whatever its values, so
+// callers can plan network use before the sensor is read.
+bool ReportKeepAliveDue(const ReportState& state,
+                        const ReportDeadband& deadband,
+                        uint32_t nowSeconds);
+
+// Records `reading` as the new reference for later comparisons.
+void MarkReported(ReportState& state, const BatchedReading& reading, uint32_t nowSeconds);
+
+// Returns a stable printable name for `decision`.
+const char* ReportDecisionName(ReportDecision decision);
+
+}  // namespace envnode::core
@@ -0,0 +1,160 @@
+// SHA-256 and HMAC-SHA256 implementation (FIPS 180-4, RFC 2104).
+
+#include "sha256.h"
+
+#include <cstring>
+
+namespace envnode::core {
+
+namespace {
+
+constexpr uint32_t kRoundConstants[64] = {
+    0x428A2F98UL, 0x71374491UL, 0xB5C0FBCFUL, 0xE9B5DBA5UL, 0x3956C25BUL, 0x59F111F1UL,
+    0x923F82A4UL, 0xAB1C5ED5UL, 0xD807AA98UL, 0x12835B01UL, 0x243185BEUL, 0x550C7DC3UL,
+    0x72BE5D74UL, 0x80DEB1FEUL, 0x9BDC06A7UL, 0xC19BF174UL, 0xE49B69C1UL, 0xEFBE4786UL,
+    0x0FC19DC6UL, 0x240CA1CCUL, 0x2DE92C6FUL, 0x4A7484AAUL, 0x5CB0A9DCUL, 0x76F988DAUL,
+    0x983E5152UL, 0xA831C66DUL, 0xB00327C8UL, 0xBF597FC7UL, 0xC6E00BF3UL, 0xD5A79147UL,
+    0x06CA6351UL, 0x14292967UL, 0x27B70A85UL, 0x2E1B2138UL, 0x4D2C6DFCUL, 0x53380D13UL,
+    0x650A7354UL, 0x766A0ABBUL, 0x81C2C92EUL, 0x92722C85UL, 0xA2BFE8A1UL, 0xA81A664BUL,
+    0xC24B8B70UL, 0xC76C51A3UL, 0xD192E819UL, 0xD6990624UL, 0xF40E3585UL, 0x106AA070UL,
+    0x19A4C116UL, 0x1E376C08UL, 0x2748774CUL, 0x34B0BCB5UL, 0x391C0CB3UL, 0x4ED8AA4AUL,
+    0x5B9CCA4FUL, 0x682E6FF3UL, 0x748F82EEUL, 0x78A5636FUL, 0x84C87814UL, 0x8CC70208UL,
+    0x90BEFFFAUL, 0xA4506CEBUL, 0xBEF9A3F7UL, 0xC67178F2UL,
+};
+
+constexpr size_t kBlockBytes = 64;
+
+uint32_t RotateRight(uint32_t value, unsigned bits) {
+  return (value >> bits) | (value << (32 - bits));
+}
+
+// Processes one 64-byte block.
+void Compress(uint32_t state[8], const uint8_t block[kBlockBytes]) {
+  uint32_t w[64];
+  for (size_t i = 0; i < 16; ++i) {
+    w[i] = (static_cast<uint32_t>(block[i * 4]) << 24) |
+           (static_cast<uint32_t>(block[i * 4 + 1]) << 16) |
+           (static_cast<uint32_t>(block[i * 4 + 2]) << 8) | block[i * 4 + 3];
+  }
+  for (size_t i = 16; i < 64; ++i) {
+    const uint32_t s0 = RotateRight(w[i - 15], 7) ^ RotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    const uint32_t s1 = RotateRight(w[i - 2], 17) ^ RotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+
+  uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+  uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+  for (size_t i = 0; i < 64; ++i) {
+    const uint32_t s1 = RotateRight(e, 6) ^ RotateRight(e, 11) ^ RotateRight(e, 25);
+    const uint32_t choice = (e & f) ^ (~e & g);
+    const uint32_t t1 = h + s1 + choice + kRoundConstants[i] + w[i];
+    const uint32_t s0 = RotateRight(a, 2) ^ RotateRight(a, 13) ^ RotateRight(a, 22);
+    const uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+    const uint32_t t2 = s0 + majority;
+    h = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+  state[4] += e;
+  state[5] += f;
+  state[6] += g;
+  state[7] += h;
+}
+
+}  // namespace
+
+// Initial hash values from FIPS 180-4 section 5.3.3.
+void Sha256Begin(Sha256& hash) {
+  static constexpr uint32_t kInitialState[8] = {
+      0x6A09E667UL, 0xBB67AE85UL, 0x3C6EF372UL, 0xA54FF53AUL,
+      0x510E527FUL, 0x9B05688CUL, 0x1F83D9ABUL, 0x5BE0CD19UL,
+  };
+  memcpy(hash.state, kInitialState, sizeof(hash.state));
+  hash.blockLength = 0;
+  hash.totalLength = 0;
+}
+
+// Whole blocks are compressed as they fill; the tail waits in `block`.
+void Sha256Update(Sha256& hash, const uint8_t* data, size_t length) {
+  hash.totalLength += length;
+  while (length > 0) {
+    const size_t take =
+        length < kBlockBytes - hash.blockLength ? length : kBlockBytes - hash.blockLength;
+    memcpy(hash.block + hash.blockLength, data, take);
+    hash.blockLength += take;
+    data += take;
+    length -= take;
+    if (hash.blockLength == kBlockBytes) {
+      Compress(hash.state, hash.block);
+      hash.blockLength = 0;
+    }
+  }
+}
+
+// Pads with 0x80, zeros, and the 64-bit big-endian bit length.
+void Sha256Finish(Sha256& hash, uint8_t digest[kSha256Bytes]) {
+  const uint64_t bitLength = hash.totalLength * 8;
+  hash.block[hash.blockLength++] = 0x80;
+  if (hash.blockLength > kBlockBytes - 8) {
+    memset(hash.block + hash.blockLength, 0, kBlockBytes - hash.blockLength);
+    Compress(hash.state, hash.block);
+    hash.blockLength = 0;
+  }
+  memset(hash.block + hash.blockLength, 0, kBlockBytes - 8 - hash.blockLength);
+  for (size_t i = 0; i < 8; ++i) {
+    hash.block[kBlockBytes - 1 - i] = static_cast<uint8_t>(bitLength >> (8 * i));
+  }
+  Compress(hash.state, hash.block);
+  for (size_t i = 0; i < 8; ++i) {
+    digest[i * 4] = static_cast<uint8_t>(hash.state[i] >> 24);
+    digest[i * 4 + 1] = static_cast<uint8_t>(hash.state[i] >> 16);
+    digest[i * 4 + 2] = static_cast<uint8_t>(hash.state[i] >> 8);
+    digest[i * 4 + 3] = static_cast<uint8_t>(hash.state[i]);
+  }
+}
+
+// Keys longer than a block are hashed first, as RFC 2104 requires.
+void HmacSha256(const uint8_t* key,
+                size_t keyLength,
+                const uint8_t* data,
+                size_t length,
+                uint8_t mac[kSha256Bytes]) {
+  uint8_t keyBlock[kBlockBytes] = {0};
+  Sha256 hash;
+  if (keyLength > kBlockBytes) {
+    Sha256Begin(hash);
+    Sha256Update(hash, key, keyLength);
+    Sha256Finish(hash, keyBlock);
+  } else if (keyLength > 0) {
+    memcpy(keyBlock, key, keyLength);
+  }
+
+  uint8_t pad[kBlockBytes];
+  for (size_t i = 0; i < kBlockBytes; ++i) {
+    pad[i] = keyBlock[i] ^ 0x36;
+  }
+  uint8_t inner[kSha256Bytes];
+  Sha256Begin(hash);
+  Sha256Update(hash, pad, kBlockBytes);
+  Sha256Update(hash, data, length);
+  Sha256Finish(hash, inner);
+
+  for (size_t i = 0; i < kBlockBytes; ++i) {
+    pad[i] = keyBlock[i] ^ 0x5C;
+  }
+  Sha256Begin(hash);
+  Sha256Update(hash, pad, kBlockBytes);
+  Sha256Update(hash, inner, kSha256Bytes);
+  Sha256Finish(hash, mac);
+}
+
+}  // namespace envnode::core
@@ -0,0 +1,40 @@
+// SHA-256 and HMAC-SHA256 used to authenticate ESP-NOW frames.
+//
+// Kept in the core library, like the CRC-32 and gzip code, so the frame codec
+// behaves the same on the device and in host tests.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace envnode::core {
+
+// Size of a SHA-256 digest in bytes.
+constexpr size_t kSha256Bytes = 32;
+
+// Incremental SHA-256 state.
+struct Sha256 {
+  uint32_t state[8];
+  uint8_t block[64];
+  size_t blockLength = 0;
+  uint64_t totalLength = 0;
+};
+
+// Starts a new digest.
+void Sha256Begin(Sha256& hash);
+
+// Feeds `length` bytes into the digest.
+void Sha256Update(Sha256& hash, const uint8_t* data, size_t length);
+
+// Finishes the digest and writes it to `digest`.
+void Sha256Finish(Sha256& hash, uint8_t digest[kSha256Bytes]);
+
+// Computes HMAC-SHA256 (RFC 2104) of `data` under `key`.
+void HmacSha256(const uint8_t* key,
+                size_t keyLength,
+                const uint8_t* data,
+                size_t length,
+                uint8_t mac[kSha256Bytes]);
+
+}  // namespace envnode::core
@@ -0,0 +1,165 @@
+// Supabase and webhook request dispatch.
+
+#include "telemetry_dispatch.h"
+
+#include <cstdio>
+
+namespace envnode::core {
+
+namespace {
+
+// Formats `<url>/rest/v1/<table>?<name><value>`, or the bare table URL when
+// `name` is empty. Returns false when it does not fit.
+bool FormatRestUrl(char* out,
+                   const SupabaseTarget& target,
+                   const char* table,
+                   const char* name,
+                   const char* value) {
+  const int written = std::snprintf(out, kDispatchUrlBytes, "%s/rest/v1/%s%s%s%s", target.url,
+                                    table, name[0] ? "?" : "", name, name[0] ? value : "");
+  return written > 0 && static_cast<size_t>(written) < kDispatchUrlBytes;
+}
+
+// Formats the bearer token header. Returns false when the key does not fit.
+bool FormatBearer(char* out, const SupabaseTarget& target) {
+  const int written = std::snprintf(out, kDispatchAuthBytes, "Bearer %s", target.apiKey);
+  return written > 0 && static_cast<size_t>(written) < kDispatchAuthBytes;
+}
+
+// Gzips the insert body when it is large enough and actually shrinks.
+// Returns the compressed size, or 0 to send the body as-is.
+size_t Compress(const SupabaseInsert& insert, const InsertCompression& compression) {
+  if (!compression.minBytes || !compression.buffer || !compression.scratch ||
+      insert.bodyLength < compression.minBytes) {
+    return 0;
+  }
+  const size_t length =
+      GzipCompress(reinterpret_cast<const uint8_t*>(insert.body), insert.bodyLength,
+                   compression.buffer, compression.capacity, *compression.scratch);
+  return length < insert.bodyLength ? length : 0;
+}
+
+}  // namespace
+
+// Negative transport errors and 1xx/3xx/4xx/5xx statuses all count as failure.
+bool HttpSucceeded(const HttpResponse& response) {
+  return response.code >= 200 && response.code < 300;
+}
+
+// The `Content-Encoding` header is kept last so the uncompressed retry can
+// drop it by shortening the header count.
+InsertResult SendSupabaseInsert(HttpTransport& transport,
+                                const SupabaseTarget& target,
+                                const SupabaseInsert& insert,
+                                const InsertCompression& compression) {
+  InsertResult result;
+  const bool hasColumns = insert.columns && insert.columns[0];
+  char url[kDispatchUrlBytes];
+  char authorization[kDispatchAuthBytes];
+  if (!FormatRestUrl(url, target, insert.table, hasColumns ? "columns=" : "",
+                     insert.columns) ||
+      !FormatBearer(authorization, target)) {
+    return result;
+  }
+
+  const HttpHeader headers[] = {
+      {"Content-Type", "application/json"},
+      {"Prefer", hasColumns ? "return=minimal,missing=default" : "return=minimal"},
+      {"apikey", target.apiKey},
+      {"Authorization", authorization},
+      {"Content-Encoding", "gzip"},
+  };
+  const size_t plainHeaderCount = sizeof(headers) / sizeof(headers[0]) - 1;
+
+  HttpRequest request;
+  request.url = url;
+  request.headers = headers;
+  request.headerCount = plainHeaderCount;
+  request.body = insert.body;
+  request.bodyLength = insert.bodyLength;
+  request.timeoutMs = insert.timeoutMs;
+  request.priority = insert.priority;
+
+  const size_t compressedLength = Compress(insert, compression);
+  if (compressedLength) {
+    request.headerCount = plainHeaderCount + 1;
+    request.body = reinterpret_cast<const char*>(compression.buffer);
+    request.bodyLength = compressedLength;
+    result.compressed = true;
+  }
+
+  result.response = transport.Send(request);
+  result.sentBytes = request.bodyLength;
+  if (result.compressed &&
+      (result.response.code == 400 || result.response.code == 415)) {
+    result.compressedCode = result.response.code;
+    result.compressed = false;
+    request.headerCount = plainHeaderCount;
+    request.body = insert.body;
+    request.bodyLength = insert.bodyLength;
+    result.response = transport.Send(request);
+    result.sentBytes = request.bodyLength;
+    result.compressionRejected = HttpSucceeded(result.response);
+  }
+  return result;
+}
+
+// Asks for at most one row so the check costs the server almost nothing.
+HttpResponse SendSupabaseProbe(HttpTransport& transport,
+                               const SupabaseTarget& target,
+                               const char* table,
+                               uint16_t timeoutMs,
+                               WakePriority priority) {
+  char url[kDispatchUrlBytes];
+  char authorization[kDispatchAuthBytes];
+  if (!FormatRestUrl(url, target, table, "select=*&limit=1", "") ||
+      !FormatBearer(authorization, target)) {
+    return HttpResponse();
+  }
+
+  const HttpHeader headers[] = {
+      {"Accept", "application/json"},
+      {"Range-Unit", "items"},
+      {"Range", "0-0"},
+      {"apikey", target.apiKey},
+      {"Authorization", authorization},
+  };
+  HttpRequest request;
+  request.method = "GET";
+  request.url = url;
+  request.headers = headers;
+  request.headerCount = sizeof(headers) / sizeof(headers[0]);
+  request.timeoutMs = timeoutMs;
+  request.priority = priority;
+  return transport.Send(request);
+}
+
+// `Content-Type` always comes first; the extra headers follow in order.
+HttpResponse SendJsonPost(HttpTransport& transport,
+                          const char* url,
+                          const HttpHeader* extraHeaders,
+                          size_t extraHeaderCount,
+                          const char* body,
+                          size_t bodyLength,
+                          uint16_t timeoutMs,
+                          WakePriority priority) {
+  if (extraHeaderCount > kDispatchMaxExtraHeaders) {
+    return HttpResponse();
+  }
+  HttpHeader headers[1 + kDispatchMaxExtraHeaders] = {{"Content-Type", "application/json"}};
+  for (size_t index = 0; index < extraHeaderCount; ++index) {
+    headers[1 + index] = extraHeaders[index];
+  }
+
+  HttpRequest request;
+  request.url = url;
+  request.headers = headers;
+  request.headerCount = 1 + extraHeaderCount;
+  request.body = body;
+  request.bodyLength = bodyLength;
+  request.timeoutMs = timeoutMs;
+  request.priority = priority;
+  return transport.Send(request);
+}
+
+}  // namespace envnode::core
@@ -0,0 +1,93 @@
+// Request construction and dispatch for Supabase inserts and webhooks.
+//
+// These functions turn finished JSON bodies into requests on an
+// `HttpTransport`: endpoint URLs, PostgREST headers, optional gzip encoding,
+// and the uncompressed fallback for servers that refuse it. They hold no state
+// and never log, so the firmware and the host-side harness run the same code.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "gzip.h"
+#include "http_transport.h"
+
+namespace envnode::core {
+
+// Longest endpoint URL, including the `?columns=` list, that can be built.
+constexpr size_t kDispatchUrlBytes = 384;
+
+// Longest `Authorization` header value that can be built.
+constexpr size_t kDispatchAuthBytes = 320;
+
+// Most caller-supplied headers a JSON POST can carry.
+constexpr size_t kDispatchMaxExtraHeaders = 4;
+
+// Supabase project base URL and API key.
+struct SupabaseTarget {
+  const char* url = "";
+  const char* apiKey = "";
+};
+
+// One PostgREST bulk insert. When `columns` is set, rows may omit keys and let
+// the table defaults fill them in.
+struct SupabaseInsert {
+  const char* table = "";
+  const char* columns = nullptr;
+  const char* body = nullptr;
+  size_t bodyLength = 0;
+  uint16_t timeoutMs = 5000U;
+  WakePriority priority = WakePriority::Reading;
+};
+
+// Optional gzip encoding for insert bodies. Bodies shorter than `minBytes`, or
+// every body when `minBytes` is 0 or no buffer is given, go out uncompressed.
+struct InsertCompression {
+  size_t minBytes = 0;
+  uint8_t* buffer = nullptr;
+  size_t capacity = 0;
+  GzipScratch* scratch = nullptr;
+};
+
+// Outcome of one insert. `compressedCode` holds the status of a gzip attempt
+// that was refused and retried uncompressed; `compressionRejected` is set when
+// that retry succeeded, meaning the server only objected to the encoding.
+struct InsertResult {
+  HttpResponse response;
+  size_t sentBytes = 0;
+  bool compressed = false;
+  int compressedCode = 0;
+  bool compressionRejected = false;
+};
+
+// Returns true for a 2xx status.
+bool HttpSucceeded(const HttpResponse& response);
+
+// Posts `insert` to `<url>/rest/v1/<table>`, gzipping it when `compression`
+// allows. A 400 or 415 answer to a gzip body is retried once uncompressed.
+InsertResult SendSupabaseInsert(HttpTransport& transport,
+                                const SupabaseTarget& target,
+                                const SupabaseInsert& insert,
+                                const InsertCompression& compression);
+
+// Issues a one-row GET against `table` to confirm the endpoint is reachable
+// and the key is authorized.
+HttpResponse SendSupabaseProbe(HttpTransport& transport,
+                               const SupabaseTarget& target,
+                               const char* table,
+                               uint16_t timeoutMs,
+                               WakePriority priority);
+
+// Posts a JSON body to a webhook URL with up to `kDispatchMaxExtraHeaders`
+// additional headers, such as access tokens.
+HttpResponse SendJsonPost(HttpTransport& transport,
+                          const char* url,
+                          const HttpHeader* extraHeaders,
+                          size_t extraHeaderCount,
+                          const char* body,
+                          size_t bodyLength,
+                          uint16_t timeoutMs,
+                          WakePriority priority);
+
+}  // namespace envnode::core
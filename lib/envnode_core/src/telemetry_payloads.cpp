@@ -0,0 +1,221 @@
+// JSON payload builder implementation.
+
+#include "telemetry_payloads.h"
+
+namespace envnode::core {
+
+namespace {
+
+// Writes the reading fields shared by batched rows and webhook snapshots.
+void WriteReadingFields(JsonWriter& writer, const BatchedReading& reading) {
+  writer.NumberField("temperature_c", reading.temperature, 2);
+  writer.NumberField("humidity_rh", reading.humidity, 2);
+  writer.NumberField("pressure_hpa", reading.pressure, 2);
+  if (!std::isnan(reading.batteryVoltage)) {
+    writer.NumberField("battery_voltage_v", reading.batteryVoltage, 3);
+    writer.NumberField("battery_pct", reading.batteryPercent, 1);
+  }
+}
+
+// Writes the leading fields common to boot and service-mode metadata.
+void WriteMetaHeader(JsonWriter& writer, const DeviceMeta& meta) {
+  writer.Field("fw", meta.fwVersion);
+  writer.Field("boot_mode", meta.bootMode);
+  writer.Field("runtime_mode", meta.runtimeMode);
+}
+
+// Writes the trailing network/session fields common to both metadata shapes.
+void WriteMetaNetwork(JsonWriter& writer, const DeviceMeta& meta) {
+  if (meta.networkAvailable) {
+    writer.Field("ip", meta.ipAddress);
+    writer.Field("mac_address", meta.macAddress);
+    writer.IntField("rssi_dbm", meta.rssiDbm);
+  }
+  if (!meta.sessionId.empty()) {
+    writer.Field("session_id", meta.sessionId);
+  }
+}
+
+// Writes the I2C clock and counters shared by boot and sensor-bus metadata.
+void WriteI2cFields(JsonWriter& writer, uint16_t clockKhz, const I2cBusCounters& counters) {
+  writer.UIntField("i2c_khz", clockKhz);
+  writer.UIntField("i2c_nacks", counters.nacks);
+  writer.UIntField("i2c_timeouts", counters.timeouts);
+  writer.UIntField("i2c_bus_clears", counters.busClears);
+  writer.UIntField("i2c_retries", counters.retries);
+}
+
+}  // namespace
+
+// Shared by the node's own batches and the ESP-NOW gateway's multi-node ones.
+void WriteReadingRow(JsonWriter& writer, const BatchedReading& reading, std::string_view deviceId) {
+  writer.BeginObject();
+  writer.Field("device_id", deviceId);
+  if (reading.recordedAtEpoch >= kMinValidEpochSeconds) {
+    char timestamp[24];
+    FormatIso8601Utc(reading.recordedAtEpoch, timestamp, sizeof(timestamp));
+    writer.Field("recorded_at", timestamp);
+  }
+  WriteReadingFields(writer, reading);
+  writer.EndObject();
+}
+
+// Streams the oldest pending readings as a PostgREST bulk-insert array.
+size_t WriteReadingBatch(JsonWriter& writer,
+                         const ReadingRing& ring,
+                         size_t maxRows,
+                         std::string_view deviceId) {
+  const size_t rows = maxRows < ring.count ? maxRows : ring.count;
+  writer.BeginArray();
+  for (size_t index = 0; index < rows; ++index) {
+    WriteReadingRow(writer, *ReadingAt(ring, index), deviceId);
+  }
+  writer.EndArray();
+  return rows;
+}
+
+// Streams one event row, omitting optional fields the caller left unset.
+void WriteEventPayload(JsonWriter& writer, const EventPayload& event) {
+  writer.BeginObject();
+  writer.Field("device_id", event.deviceId);
+  if (event.createdAtEpoch >= kMinValidEpochSeconds) {
+    char timestamp[24];
+    FormatIso8601Utc(event.createdAtEpoch, timestamp, sizeof(timestamp));
+    writer.Field("created_at", timestamp);
+  }
+  if (!event.sessionId.empty()) {
+    writer.Field("session_id", event.sessionId);
+  }
+  writer.Field("event_type", event.eventType);
+  writer.Field("severity", event.severity);
+  if (!event.message.empty()) {
+    writer.Field("message", event.message);
+  }
+  if (event.snapshot) {
+    writer.NumberField("reading_temp_c", event.snapshot->temperature, 2);
+    writer.NumberField("reading_humidity_rh", event.snapshot->humidity, 2);
+    writer.NumberField("reading_pressure_hpa", event.snapshot->pressure, 2);
+  }
+  if (event.action) {
+    writer.Field("action", event.action);
+  }
+  if (event.attempt) {
+    writer.IntField("attempt", event.attempt);
+  }
+  writer.BoolField("action_success", event.actionSuccess);
+  if (!event.metaJson.empty()) {
+    writer.RawField("meta", event.metaJson);
+  }
+  writer.EndObject();
+}
+
+// Streams one structured webhook notification.
+void WriteWebhookPayload(JsonWriter& writer, const WebhookPayload& webhook) {
+  writer.BeginObject();
+  writer.Field("device_id", webhook.deviceId);
+  writer.Field("alert_type", webhook.alertType);
+  writer.Field("severity", webhook.severity);
+  writer.Field("message", webhook.message);
+  writer.UIntField("timestamp", webhook.timestampMs);
+  writer.Field("fw_version", webhook.fwVersion);
+  if (webhook.suppressedCount) {
+    writer.UIntField("suppressed_count", webhook.suppressedCount);
+  }
+  if (webhook.readings && !std::isnan(webhook.readings->temperature)) {
+    writer.Key("readings");
+    writer.BeginObject();
+    WriteReadingFields(writer, *webhook.readings);
+    writer.EndObject();
+  }
+  if (!webhook.extraJson.empty()) {
+    writer.RawField("extra", webhook.extraJson);
+  }
+  writer.EndObject();
+}
+
+// Streams a Discord `content` message.
+void WriteDiscordPayload(JsonWriter& writer, std::string_view content) {
+  writer.BeginObject();
+  writer.Field("content", content);
+  writer.EndObject();
+}
+
+// Streams the debug heartbeat `extra` object.
+void WriteDebugHeartbeatExtra(JsonWriter& writer,
+                              uint32_t intervalSeconds,
+                              uint32_t cycleMs,
+                              bool uploadOk) {
+  writer.BeginObject();
+  writer.Field("mode", "debug");
+  writer.UIntField("interval_s", intervalSeconds);
+  writer.UIntField("cycle_ms", cycleMs);
+  writer.BoolField("upload_ok", uploadOk);
+  writer.EndObject();
+}
+
+// Streams the test webhook `extra` object.
+void WriteTestWebhookExtra(JsonWriter& writer, std::string_view ipAddress) {
+  writer.BeginObject();
+  writer.BoolField("test_mode", true);
+  writer.Field("ip_address", ipAddress);
+  writer.EndObject();
+}
+
+// Streams startup metadata.
+void WriteBootMeta(JsonWriter& writer,
+                   const DeviceMeta& meta,
+                   bool firstReadingFailed) {
+  writer.BeginObject();
+  WriteMetaHeader(writer, meta);
+  writer.UIntField("interval_s", meta.intervalSeconds);
+  WriteMetaNetwork(writer, meta);
+  if (meta.networkAvailable && meta.txPowerQuarterDbm > 0) {
+    writer.NumberField("tx_power_dbm", meta.txPowerQuarterDbm / 4.0f, 1);
+  }
+  if (meta.sensorSettleMs > 0) {
+    writer.UIntField("sensor_settle_ms", meta.sensorSettleMs);
+  }
+  if (meta.i2cClockKhz > 0 && !I2cBusCountersEmpty(meta.i2c)) {
+    WriteI2cFields(writer, meta.i2cClockKhz, meta.i2c);
+  }
+  if (firstReadingFailed) {
+    writer.BoolField("first_reading_failed", true);
+  }
+  writer.EndObject();
+}
+
+// Streams USB service-mode metadata.
+void WriteServiceModeMeta(JsonWriter& writer,
+                          const DeviceMeta& meta,
+                          bool usbHostAttached) {
+  writer.BeginObject();
+  WriteMetaHeader(writer, meta);
+  writer.BoolField("usb_host_attached", usbHostAttached);
+  writer.BoolField("readings_paused", true);
+  writer.UIntField("interval_s", meta.intervalSeconds);
+  WriteMetaNetwork(writer, meta);
+  writer.EndObject();
+}
+
+// Streams sensor-bus metadata.
+void WriteI2cBusMeta(JsonWriter& writer, uint16_t clockKhz, const I2cBusCounters& counters) {
+  writer.BeginObject();
+  WriteI2cFields(writer, clockKhz, counters);
+  writer.EndObject();
+}
+
+// Streams battery alert metadata.
+void WriteBatteryAlertMeta(JsonWriter& writer,
+                           float batteryVoltage,
+                           float batteryPercent,
+                           float alertThresholdVoltage,
+                           float clearThresholdVoltage) {
+  writer.BeginObject();
+  writer.NumberField("battery_voltage_v", batteryVoltage, 3);
+  writer.NumberField("battery_pct", batteryPercent, 1);
+  writer.NumberField("alert_threshold_v", alertThresholdVoltage, 2);
+  writer.NumberField("clear_threshold_v", clearThresholdVoltage, 2);
+  writer.EndObject();
+}
+
+}  // namespace envnode::core
@@ -0,0 +1,121 @@
+// JSON payload builders for Supabase rows and webhook notifications.
+//
+// Every builder streams into a `JsonWriter`, so the firmware can format each
+// request body into one reusable buffer and the exact wire format can be
+// golden-tested on the host.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "core_logic.h"
+#include "i2c_bus.h"
+#include "json_writer.h"
+#include "reading_batch.h"
+
+namespace envnode::core {
+
+// Fields of one `device_events` row. Empty strings, a null snapshot, a null
+// action, and a zero attempt are left out of the row. `createdAtEpoch` is only
+// written once the clock is trusted, so batched rows keep their own time.
+struct EventPayload {
+  std::string_view deviceId;
+  uint32_t createdAtEpoch = 0;
+  std::string_view sessionId;
+  std::string_view eventType;
+  std::string_view severity;
+  std::string_view message;
+  const LogicReadings* snapshot = nullptr;
+  const char* action = nullptr;
+  int attempt = 0;
+  bool actionSuccess = false;
+  std::string_view metaJson;
+};
+
+// Fields of one webhook notification. `readings` is only included when its
+// temperature is valid; battery fields are only included when measured.
+struct WebhookPayload {
+  std::string_view deviceId;
+  std::string_view alertType;
+  std::string_view severity;
+  std::string_view message;
+  uint32_t timestampMs = 0;
+  std::string_view fwVersion;
+  uint16_t suppressedCount = 0;
+  const BatchedReading* readings = nullptr;
+  std::string_view extraJson;
+};
+
+// Boot/session context shared by the startup and service-mode metadata.
+// Network fields are only written when `networkAvailable` is true. I2C
+// counters are only written when the bus saw a fault or recovery action.
+struct DeviceMeta {
+  std::string_view fwVersion;
+  std::string_view bootMode;
+  std::string_view runtimeMode;
+  uint32_t intervalSeconds = 0;
+  bool networkAvailable = false;
+  std::string_view ipAddress;
+  std::string_view macAddress;
+  int32_t rssiDbm = 0;
+  int8_t txPowerQuarterDbm = 0;
+  uint16_t sensorSettleMs = 0;
+  uint16_t i2cClockKhz = 0;
+  I2cBusCounters i2c;
+  std::string_view sessionId;
+};
+
+// Writes one readings-table row. `recorded_at` is left out until the clock
+// was synchronized at capture time, so the server's default applies.
+void WriteReadingRow(JsonWriter& writer, const BatchedReading& reading, std::string_view deviceId);
+
+// Writes the readings-table bulk insert body for up to `maxRows` of the oldest
+// pending readings. Returns the number of rows written.
+size_t WriteReadingBatch(JsonWriter& writer,
+                         const ReadingRing& ring,
+                         size_t maxRows,
+                         std::string_view deviceId);
+
+// Writes one `device_events` row.
+void WriteEventPayload(JsonWriter& writer, const EventPayload& event);
+
+// Writes the structured webhook body consumed by the n8n workflow.
+void WriteWebhookPayload(JsonWriter& writer, const WebhookPayload& webhook);
+
+// Writes the Discord webhook body for a plain-text message.
+void WriteDiscordPayload(JsonWriter& writer, std::string_view content);
+
+// Writes the `extra` object attached to structured debug heartbeats.
+void WriteDebugHeartbeatExtra(JsonWriter& writer,
+                              uint32_t intervalSeconds,
+                              uint32_t cycleMs,
+                              bool uploadOk);
+
+// Writes the `extra` object attached to the `testwebhooks` console command's
+// webhooks.
+void WriteTestWebhookExtra(JsonWriter& writer, std::string_view ipAddress);
+
+// Writes the metadata attached to startup events.
+void WriteBootMeta(JsonWriter& writer,
+                   const DeviceMeta& meta,
+                   bool firstReadingFailed);
+
+// Writes the metadata attached to USB service-mode events.
+void WriteServiceModeMeta(JsonWriter& writer,
+                          const DeviceMeta& meta,
+                          bool usbHostAttached);
+
+// Writes the metadata attached to sensor-bus events: the bus clock and this
+// wake's I2C fault and recovery counters.
+void WriteI2cBusMeta(JsonWriter& writer, uint16_t clockKhz, const I2cBusCounters& counters);
+
+// Writes the metadata attached to battery low/recovered alerts.
+void WriteBatteryAlertMeta(JsonWriter& writer,
+                           float batteryVoltage,
+                           float batteryPercent,
+                           float alertThresholdVoltage,
+                           float clearThresholdVoltage);
+
+}  // namespace envnode::core
@@ -0,0 +1,87 @@
+// Adaptive Wi-Fi transmit power controller implementation.
+
+#include "tx_power.h"
+
+namespace envnode::core {
+
+namespace {
+
+// Keeps `index` inside the configured level range.
+uint8_t ClampLevel(const TxPowerConfig& config, int index) {
+  const int low = TxPowerLevelIndexFor(config.minQuarterDbm);
+  const int high = TxPowerLevelIndexFor(config.maxQuarterDbm);
+  if (index > high) {
+    index = high;
+  }
+  if (index < low) {
+    index = low;
+  }
+  return static_cast<uint8_t>(index);
+}
+
+}  // namespace
+
+// Adding 2 rounds to the nearest half-dBm, so 19 dBm selects 19.5 dBm.
+uint8_t TxPowerLevelIndexFor(int quarterDbm) {
+  uint8_t index = 0;
+  for (size_t i = 0; i < kTxPowerLevelCount; ++i) {
+    if (kTxPowerLevels[i] <= quarterDbm + 2) {
+      index = static_cast<uint8_t>(i);
+    }
+  }
+  return index;
+}
+
+// The healthy-wake run restarts whenever the level is moved by a clamp.
+void StartTxPower(TxPowerState& state, const TxPowerConfig& config, int initialQuarterDbm) {
+  const int index = state.initialized ? state.levelIndex : TxPowerLevelIndexFor(initialQuarterDbm);
+  const uint8_t clamped = ClampLevel(config, index);
+  if (!state.initialized || clamped != state.levelIndex) {
+    state.healthyWakes = 0;
+  }
+  state.levelIndex = clamped;
+  state.initialized = true;
+}
+
+// Failures and weak links raise power immediately; lowering it waits for
+// `healthyWakesToStepDown` strong wakes so one good reading does not undo a
+// raise.
+int8_t UpdateTxPower(TxPowerState& state,
+                     const TxPowerConfig& config,
+                     const TxPowerObservation& observation) {
+  if (state.floorWakesLeft > 0 && --state.floorWakesLeft == 0) {
+    state.floorIndex = 0;
+  }
+
+  int index = state.levelIndex;
+  if (!observation.connected) {
+    if (config.failureFloorWakes > 0) {
+      state.floorIndex = ClampLevel(config, index + 1);
+      state.floorWakesLeft = config.failureFloorWakes;
+    }
+    index += config.failureStepsUp;
+    state.healthyWakes = 0;
+  } else if (observation.rssiDbm < config.raiseBelowDbm) {
+    index += 1;
+    state.healthyWakes = 0;
+  } else if (observation.rssiDbm > config.stepDownAboveDbm) {
+    if (++state.healthyWakes >= config.healthyWakesToStepDown) {
+      if (index - 1 >= state.floorIndex) {
+        index -= 1;
+      }
+      state.healthyWakes = 0;
+    }
+  } else {
+    state.healthyWakes = 0;
+  }
+  state.levelIndex = ClampLevel(config, index);
+  state.initialized = true;
+  return CurrentTxPower(state);
+}
+
+// Uninitialized states report the lowest level; callers start them first.
+int8_t CurrentTxPower(const TxPowerState& state) {
+  return kTxPowerLevels[state.levelIndex < kTxPowerLevelCount ? state.levelIndex : 0];
+}
+
+}  // namespace envnode::core
@@ -0,0 +1,71 @@
+// Closed-loop Wi-Fi transmit power control across wakes.
+//
+// A node next to the access point does not need full transmit power, and one
+// at the edge of coverage cannot afford less. After every connection attempt
+// the firmware reports the outcome and the received signal strength; the
+// controller steps power down one level once the link has stayed healthy for
+// several wakes in a row, and back up at once after a failure or a weak
+// signal. RSSI between the two thresholds leaves the level alone, and a level
+// that failed is not stepped back down to for `failureFloorWakes` wakes, which
+// keeps the controller from oscillating into repeated failed connects. Levels
+// are in quarter-dBm, the unit the ESP32 Wi-Fi driver uses, and the state is
+// plain data for RTC memory.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace envnode::core {
+
+// Transmit power levels the ESP32 radio supports, in quarter-dBm, lowest
+// first (2 dBm to 19.5 dBm).
+constexpr int8_t kTxPowerLevels[] = {8, 20, 28, 34, 44, 52, 60, 68, 74, 76, 78};
+constexpr size_t kTxPowerLevelCount = sizeof(kTxPowerLevels) / sizeof(kTxPowerLevels[0]);
+
+// Controller limits and thresholds.
+struct TxPowerConfig {
+  int8_t minQuarterDbm = 34;
+  int8_t maxQuarterDbm = 78;
+  int8_t stepDownAboveDbm = -60;
+  int8_t raiseBelowDbm = -72;
+  uint8_t healthyWakesToStepDown = 3;
+  uint8_t failureStepsUp = 2;
+  uint16_t failureFloorWakes = 144;
+};
+
+// Learned level, the run of healthy wakes at that level, and the floor set by
+// the last failure. `initialized` is false until the first `StartTxPower()`.
+struct TxPowerState {
+  bool initialized = false;
+  uint8_t levelIndex = 0;
+  uint8_t healthyWakes = 0;
+  uint8_t floorIndex = 0;
+  uint16_t floorWakesLeft = 0;
+};
+
+// Result of one connection attempt as seen by the controller.
+struct TxPowerObservation {
+  bool connected = false;
+  int8_t rssiDbm = 0;
+};
+
+// Returns the index of the highest level at or below `quarterDbm`, rounded to
+// the nearest half-dBm, or the lowest level when none is.
+uint8_t TxPowerLevelIndexFor(int quarterDbm);
+
+// Seeds an uninitialized state with `initialQuarterDbm` clamped to the
+// configured range. Initialized states are only clamped, so a changed range
+// takes effect without discarding what was learned.
+void StartTxPower(TxPowerState& state, const TxPowerConfig& config, int initialQuarterDbm);
+
+// Updates the level after a connection attempt and returns the new level in
+// quarter-dBm.
+int8_t UpdateTxPower(TxPowerState& state,
+                     const TxPowerConfig& config,
+                     const TxPowerObservation& observation);
+
+// Returns the current level in quarter-dBm.
+int8_t CurrentTxPower(const TxPowerState& state);
+
+}  // namespace envnode::core
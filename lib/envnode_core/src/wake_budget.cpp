@@ -0,0 +1,58 @@
+// Per-wake time budget implementation.
+
+#include "wake_budget.h"
+
+namespace envnode::core {
+
+// Records the start time; a zero limit disables every cutoff.
+void StartWakeBudget(WakeBudget& budget, uint32_t nowMs, uint32_t limitMs) {
+  budget.startedAtMs = nowMs;
+  budget.limitMs = limitMs;
+}
+
+// Unsigned subtraction keeps the result correct across `millis()` wraparound.
+uint32_t WakeBudgetElapsedMs(const WakeBudget& budget, uint32_t nowMs) {
+  return nowMs - budget.startedAtMs;
+}
+
+// Scales the limit by the priority's cutoff and subtracts the time used so far.
+uint32_t WakeBudgetRemainingMs(const WakeBudget& budget,
+                               uint32_t nowMs,
+                               WakePriority priority) {
+  if (budget.limitMs == 0) {
+    return UINT32_MAX;
+  }
+  const uint32_t cutoffMs = static_cast<uint32_t>(
+      static_cast<uint64_t>(budget.limitMs) *
+      kWakePriorityCutoffPercent[static_cast<uint8_t>(priority)] / 100U);
+  const uint32_t elapsedMs = WakeBudgetElapsedMs(budget, nowMs);
+  return elapsedMs < cutoffMs ? cutoffMs - elapsedMs : 0;
+}
+
+// Takes the smaller of the caller's timeout and the priority's remaining time.
+uint32_t ClampToWakeBudget(const WakeBudget& budget,
+                           uint32_t nowMs,
+                           WakePriority priority,
+                           uint32_t timeoutMs) {
+  const uint32_t remainingMs = WakeBudgetRemainingMs(budget, nowMs, priority);
+  return timeoutMs < remainingMs ? timeoutMs : remainingMs;
+}
+
+// Converts the priority enum into a stable string for logs.
+const char* WakePriorityName(WakePriority priority) {
+  switch (priority) {
+    case WakePriority::Reading:
+      return "reading";
+    case WakePriority::Event:
+      return "event";
+    case WakePriority::Backlog:
+      return "backlog";
+    case WakePriority::Webhook:
+      return "webhook";
+    case WakePriority::Heartbeat:
+    default:
+      return "heartbeat";
+  }
+}
+
+}  // namespace envnode::core
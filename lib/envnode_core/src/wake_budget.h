@@ -0,0 +1,56 @@
+// Per-wake time budget shared by the sampling path and telemetry.
+//
+// Each wake gets a fixed amount of awake time. Work is served in priority
+// order, and each priority may only start, and only run, until its share of
+// the budget has elapsed. Lower-priority work is deferred or dropped, which
+// leaves the remaining time for more important work and bounds the energy
+// spent per wake.
+
+#pragma once
+
+#include <cstdint>
+
+namespace envnode::core {
+
+// Classes of awake-time work, most important first.
+enum class WakePriority : uint8_t {
+  Reading,
+  Event,
+  Backlog,
+  Webhook,
+  Heartbeat,
+};
+
+// Percentage of the budget by which each priority must be finished, indexed by
+// `WakePriority`.
+constexpr uint8_t kWakePriorityCutoffPercent[] = {100, 90, 75, 65, 50};
+
+// Start time and length of the current wake's budget. A zero limit means the
+// wake is unbounded.
+struct WakeBudget {
+  uint32_t startedAtMs = 0;
+  uint32_t limitMs = 0;
+};
+
+// Starts a new budget of `limitMs` at `nowMs`; pass 0 for no limit.
+void StartWakeBudget(WakeBudget& budget, uint32_t nowMs, uint32_t limitMs);
+
+// Returns the milliseconds left before `priority` reaches its cutoff, 0 once it
+// has, or `UINT32_MAX` when the budget is unbounded.
+uint32_t WakeBudgetRemainingMs(const WakeBudget& budget,
+                               uint32_t nowMs,
+                               WakePriority priority);
+
+// Shortens `timeoutMs` so work at `priority` cannot run past its cutoff.
+uint32_t ClampToWakeBudget(const WakeBudget& budget,
+                           uint32_t nowMs,
+                           WakePriority priority,
+                           uint32_t timeoutMs);
+
+// Returns the milliseconds elapsed since the budget started.
+uint32_t WakeBudgetElapsedMs(const WakeBudget& budget, uint32_t nowMs);
+
+// Returns a stable printable name for `priority`.
+const char* WakePriorityName(WakePriority priority);
+
+}  // namespace envnode::core
@@ -0,0 +1,44 @@
+// Cross-wake Wi-Fi backoff implementation.
+
+#include "wifi_backoff.h"
+
+namespace envnode::core {
+
+// The delay is measured from the failure rather than stored as an absolute
+// time, so a backwards clock step can be detected.
+uint32_t WiFiBackoffRemainingSeconds(const WiFiBackoff& backoff, uint32_t nowSeconds) {
+  if (backoff.delaySeconds == 0 || nowSeconds < backoff.failedAtSeconds) {
+    return 0;
+  }
+  const uint32_t elapsed = nowSeconds - backoff.failedAtSeconds;
+  return elapsed < backoff.delaySeconds ? backoff.delaySeconds - elapsed : 0;
+}
+
+// The failure that reaches `freeFailures` gets the base delay, and each later
+// one doubles it up to `maxSeconds`. With no free failures the first failure
+// already waits. The failure count saturates instead of wrapping.
+void RecordWiFiFailure(WiFiBackoff& backoff, const WiFiBackoffConfig& config, uint32_t nowSeconds) {
+  if (backoff.consecutiveFailures < UINT8_MAX) {
+    ++backoff.consecutiveFailures;
+  }
+  backoff.failedAtSeconds = nowSeconds;
+  if (config.maxSeconds == 0 || backoff.consecutiveFailures < config.freeFailures) {
+    backoff.delaySeconds = 0;
+    return;
+  }
+
+  const uint8_t firstDelayed = config.freeFailures > 0 ? config.freeFailures : 1;
+  uint32_t delay = config.baseSeconds;
+  for (uint8_t extra = backoff.consecutiveFailures - firstDelayed;
+       extra > 0 && delay < config.maxSeconds; --extra) {
+    delay *= 2;
+  }
+  backoff.delaySeconds = delay < config.maxSeconds ? delay : config.maxSeconds;
+}
+
+// A success forgets the whole failure run.
+void RecordWiFiSuccess(WiFiBackoff& backoff) {
+  backoff = WiFiBackoff();
+}
+
+}  // namespace envnode::core
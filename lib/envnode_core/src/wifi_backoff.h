@@ -0,0 +1,41 @@
+// Cross-wake exponential backoff for failed Wi-Fi connects.
+//
+// While the access point is down, every timer wake used to spend the full
+// connect timeout before giving up. After `freeFailures` consecutive failed
+// connects, further attempts are spaced out: the first by `baseSeconds`, each
+// later one twice as long, up to `maxSeconds`. Wakes inside the backoff only
+// sample and buffer. The state is plain data so the firmware can keep it in
+// RTC memory, and it is timed with the RTC clock.
+
+#pragma once
+
+#include <cstdint>
+
+namespace envnode::core {
+
+// Backoff schedule. A `maxSeconds` of 0 disables backoff.
+struct WiFiBackoffConfig {
+  uint8_t freeFailures = 2;
+  uint32_t baseSeconds = 600;
+  uint32_t maxSeconds = 3600;
+};
+
+// Consecutive failures and when the next attempt is allowed.
+struct WiFiBackoff {
+  uint8_t consecutiveFailures = 0;
+  uint32_t failedAtSeconds = 0;
+  uint32_t delaySeconds = 0;
+};
+
+// Returns how many seconds remain before the next connect attempt is allowed,
+// or 0 when one may start now. A clock that stepped backwards ends the
+// backoff.
+uint32_t WiFiBackoffRemainingSeconds(const WiFiBackoff& backoff, uint32_t nowSeconds);
+
+// Counts a failed connect at `nowSeconds` and schedules the next attempt.
+void RecordWiFiFailure(WiFiBackoff& backoff, const WiFiBackoffConfig& config, uint32_t nowSeconds);
+
+// Clears the backoff after a successful connect.
+void RecordWiFiSuccess(WiFiBackoff& backoff);
+
+}  // namespace envnode::core
@@ -0,0 +1,73 @@
+// Retained Wi-Fi link parameters implementation.
+
+#include "wifi_link.h"
+
+#include <cstring>
+
+namespace envnode::core {
+
+// A pinned association needs a known channel; a reused lease also needs the
+// access point it was issued on.
+FastConnectPlan PlanFastConnect(const RetainedLink& link, uint32_t nowSeconds) {
+  FastConnectPlan plan;
+  plan.pinAccessPoint = link.hasAccessPoint && link.channel > 0;
+  plan.reuseLease = plan.pinAccessPoint && LeaseReuseRemainingSeconds(link, nowSeconds) > 0;
+  return plan;
+}
+
+// A clock that stepped backwards cannot tell the lease's age, so the lease is
+// treated as used up.
+uint32_t LeaseReuseRemainingSeconds(const RetainedLink& link, uint32_t nowSeconds) {
+  if (link.leaseReuseSeconds == 0 || link.lease.ip == 0 || nowSeconds < link.leaseObtainedAt) {
+    return 0;
+  }
+  const uint32_t age = nowSeconds - link.leaseObtainedAt;
+  return age < link.leaseReuseSeconds ? link.leaseReuseSeconds - age : 0;
+}
+
+// Moving to another access point keeps the lease; it belongs to the network.
+void RecordAccessPoint(RetainedLink& link, const uint8_t bssid[6], uint8_t channel) {
+  memcpy(link.bssid, bssid, sizeof(link.bssid));
+  link.channel = channel;
+  link.hasAccessPoint = channel > 0;
+  link.fastConnectFailures = 0;
+}
+
+// The lease stays usable, but `PlanFastConnect()` only reuses it alongside a
+// pinned access point.
+void ClearAccessPoint(RetainedLink& link) {
+  memset(link.bssid, 0, sizeof(link.bssid));
+  link.channel = 0;
+  link.hasAccessPoint = false;
+}
+
+// Reusing past the renewal time would let the server's lease lapse unseen.
+void RecordLease(RetainedLink& link,
+                 const LeaseConfig& lease,
+                 uint32_t leaseSeconds,
+                 uint32_t maxReuseSeconds,
+                 uint32_t nowSeconds) {
+  const uint32_t renewalSeconds = leaseSeconds / 2;
+  const uint32_t reuseSeconds = renewalSeconds < maxReuseSeconds ? renewalSeconds : maxReuseSeconds;
+  if (reuseSeconds == 0 || lease.ip == 0) {
+    link.lease = LeaseConfig();
+    link.leaseReuseSeconds = 0;
+    return;
+  }
+  link.lease = lease;
+  link.leaseObtainedAt = nowSeconds;
+  link.leaseReuseSeconds = reuseSeconds;
+}
+
+// The lease is the likelier culprit (the address may have been handed out
+// again), so it goes first.
+void RecordFastConnectFailure(RetainedLink& link) {
+  link.lease = LeaseConfig();
+  link.leaseReuseSeconds = 0;
+  if (++link.fastConnectFailures >= kMaxFastConnectFailures) {
+    ClearAccessPoint(link);
+    link.fastConnectFailures = 0;
+  }
+}
+
+}  // namespace envnode::core
@@ -0,0 +1,77 @@
+// Retained Wi-Fi link parameters for fast reconnects after deep sleep.
+//
+// A timer wake normally scans for the access point and runs DHCP before the
+// first request. This module remembers the access point (BSSID and channel)
+// of the last successful association and the DHCP lease that came with it, so
+// the next wake can associate on a pinned channel and configure the lease
+// statically. A lease is only reused up to its renewal time (half the lease,
+// capped by the caller), after which the node falls back to DHCP and renews
+// it. Failed fast reconnects drop the lease first and then the access point
+// pin. The state is plain data so the firmware can keep it in RTC memory.
+
+#pragma once
+
+#include <cstdint>
+
+namespace envnode::core {
+
+// Consecutive failed fast reconnects after which the access point pin is also
+// dropped and the next attempt scans normally.
+constexpr uint8_t kMaxFastConnectFailures = 2;
+
+// IPv4 configuration from a DHCP lease. Addresses are stored as the raw
+// 32-bit values the network stack uses.
+struct LeaseConfig {
+  uint32_t ip = 0;
+  uint32_t gateway = 0;
+  uint32_t subnet = 0;
+  uint32_t dns1 = 0;
+  uint32_t dns2 = 0;
+};
+
+// What the last successful association used, timed with the RTC clock.
+struct RetainedLink {
+  uint8_t bssid[6] = {0};
+  uint8_t channel = 0;
+  bool hasAccessPoint = false;
+  LeaseConfig lease;
+  uint32_t leaseObtainedAt = 0;
+  uint32_t leaseReuseSeconds = 0;
+  uint8_t fastConnectFailures = 0;
+};
+
+// How the next association should be set up.
+struct FastConnectPlan {
+  bool pinAccessPoint = false;
+  bool reuseLease = false;
+};
+
+// Decides whether the next association can pin the access point and reuse the
+// retained lease at `nowSeconds`.
+FastConnectPlan PlanFastConnect(const RetainedLink& link, uint32_t nowSeconds);
+
+// Returns how many seconds the retained lease may still be reused, or 0.
+uint32_t LeaseReuseRemainingSeconds(const RetainedLink& link, uint32_t nowSeconds);
+
+// Remembers the access point of a successful association and clears the
+// failure count.
+void RecordAccessPoint(RetainedLink& link, const uint8_t bssid[6], uint8_t channel);
+
+// Forgets the access point pin, for example after an authentication failure
+// or when a scan no longer sees it.
+void ClearAccessPoint(RetainedLink& link);
+
+// Stores a lease obtained from DHCP at `nowSeconds`. It is reused for half of
+// `leaseSeconds`, at most `maxReuseSeconds`. Nothing is stored when either
+// limit is 0 or the address is missing.
+void RecordLease(RetainedLink& link,
+                 const LeaseConfig& lease,
+                 uint32_t leaseSeconds,
+                 uint32_t maxReuseSeconds,
+                 uint32_t nowSeconds);
+
+// Notes a fast reconnect that did not complete: the lease is dropped at once,
+// and the access point pin after `kMaxFastConnectFailures` failures in a row.
+void RecordFastConnectFailure(RetainedLink& link);
+
+}  // namespace envnode::core
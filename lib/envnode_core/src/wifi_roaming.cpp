@@ -0,0 +1,162 @@
+// Scored access point table implementation.
+
+#include "wifi_roaming.h"
+
+#include <cstring>
+
+namespace envnode::core {
+
+namespace {
+
+// Weight of a new RSSI reading in the smoothed value.
+constexpr float kRssiSmoothing = 0.3f;
+
+// Attempt count at which the counters are halved.
+constexpr uint8_t kAttemptWindow = 16;
+
+bool InUse(const RoamingCandidate& candidate) {
+  return candidate.channel > 0;
+}
+
+RoamingCandidate* Find(RoamingTable& table, const uint8_t bssid[6]) {
+  for (RoamingCandidate& candidate : table.candidates) {
+    if (InUse(candidate) && memcmp(candidate.bssid, bssid, sizeof(candidate.bssid)) == 0) {
+      return &candidate;
+    }
+  }
+  return nullptr;
+}
+
+// A clock that stepped backwards cannot tell the candidate's age, so it is
+// treated as stale.
+bool Fresh(const RoamingCandidate& candidate, uint32_t nowSeconds) {
+  return nowSeconds >= candidate.lastSeenSeconds &&
+         nowSeconds - candidate.lastSeenSeconds <= kRoamingCandidateMaxAgeSeconds;
+}
+
+}  // namespace
+
+// An empty slot is used first. A candidate that was seen again gets one more
+// attempt even after repeated failures, since the access point is evidently
+// still there.
+void ObserveAccessPoint(RoamingTable& table,
+                        const uint8_t bssid[6],
+                        uint8_t channel,
+                        int8_t rssiDbm,
+                        uint32_t nowSeconds) {
+  if (channel == 0) {
+    return;
+  }
+  RoamingCandidate* candidate = Find(table, bssid);
+  if (candidate) {
+    candidate->rssiDbm += kRssiSmoothing * (rssiDbm - candidate->rssiDbm);
+    candidate->channel = channel;
+    candidate->lastSeenSeconds = nowSeconds;
+    if (candidate->consecutiveFailures >= kMaxRoamingCandidateFailures) {
+      candidate->consecutiveFailures = kMaxRoamingCandidateFailures - 1;
+    }
+    return;
+  }
+
+  candidate = &table.candidates[0];
+  for (RoamingCandidate& slot : table.candidates) {
+    if (!InUse(slot)) {
+      candidate = &slot;
+      break;
+    }
+    const bool slotStale = !Fresh(slot, nowSeconds);
+    const bool worstStale = !Fresh(*candidate, nowSeconds);
+    if ((slotStale && !worstStale) ||
+        (slotStale == worstStale &&
+         RoamingCandidateScore(slot) < RoamingCandidateScore(*candidate))) {
+      candidate = &slot;
+    }
+  }
+  *candidate = RoamingCandidate();
+  memcpy(candidate->bssid, bssid, sizeof(candidate->bssid));
+  candidate->channel = channel;
+  candidate->rssiDbm = rssiDbm;
+  candidate->lastSeenSeconds = nowSeconds;
+}
+
+// The mean connect time only tracks successful associations; a failure's
+// duration is mostly the caller's timeout.
+void RecordRoamingResult(RoamingTable& table,
+                         const uint8_t bssid[6],
+                         bool connected,
+                         uint32_t connectMs) {
+  RoamingCandidate* candidate = Find(table, bssid);
+  if (!candidate) {
+    return;
+  }
+  if (candidate->attempts >= kAttemptWindow) {
+    candidate->attempts /= 2;
+    candidate->successes /= 2;
+  }
+  ++candidate->attempts;
+  if (!connected) {
+    if (candidate->consecutiveFailures < UINT8_MAX) {
+      ++candidate->consecutiveFailures;
+    }
+    return;
+  }
+  ++candidate->successes;
+  candidate->consecutiveFailures = 0;
+  const uint32_t sample = connectMs < UINT16_MAX ? connectMs : UINT16_MAX;
+  candidate->meanConnectMs = candidate->meanConnectMs == 0
+                                 ? static_cast<uint16_t>(sample)
+                                 : static_cast<uint16_t>((3U * candidate->meanConnectMs + sample) / 4U);
+}
+
+// Candidates observed during the scan carry a `lastSeenSeconds` at or after
+// its start.
+void DropUnseenCandidates(RoamingTable& table, uint32_t sinceSeconds) {
+  for (RoamingCandidate& candidate : table.candidates) {
+    if (InUse(candidate) && candidate.lastSeenSeconds < sinceSeconds) {
+      candidate = RoamingCandidate();
+    }
+  }
+}
+
+// The success rate starts at one half for an untried candidate, so a strong
+// new access point can win over a weak proven one, but not over a strong one.
+float RoamingCandidateScore(const RoamingCandidate& candidate) {
+  const float successRate =
+      (candidate.successes + 1.0f) / (candidate.attempts + 2.0f);
+  return candidate.rssiDbm + 30.0f * successRate - candidate.meanConnectMs / 100.0f;
+}
+
+// Ties keep the earlier slot, so the choice is stable between wakes.
+const RoamingCandidate* BestRoamingCandidate(const RoamingTable& table, uint32_t nowSeconds) {
+  const RoamingCandidate* best = nullptr;
+  for (const RoamingCandidate& candidate : table.candidates) {
+    if (!InUse(candidate) || !Fresh(candidate, nowSeconds) ||
+        candidate.consecutiveFailures >= kMaxRoamingCandidateFailures) {
+      continue;
+    }
+    if (!best || RoamingCandidateScore(candidate) > RoamingCandidateScore(*best)) {
+      best = &candidate;
+    }
+  }
+  return best;
+}
+
+// Channels are listed in slot order without duplicates.
+size_t RoamingChannels(const RoamingTable& table, uint8_t* channels, size_t capacity) {
+  size_t count = 0;
+  for (const RoamingCandidate& candidate : table.candidates) {
+    if (!InUse(candidate)) {
+      continue;
+    }
+    bool listed = false;
+    for (size_t i = 0; i < count; ++i) {
+      listed = listed || channels[i] == candidate.channel;
+    }
+    if (!listed && count < capacity) {
+      channels[count++] = candidate.channel;
+    }
+  }
+  return count;
+}
+
+}  // namespace envnode::core
@@ -0,0 +1,81 @@
+// Scored table of candidate access points for the configured SSID.
+//
+// Buildings with several access points (mesh systems, multi-AP offices)
+// advertise one SSID from many BSSIDs. Pinning a single BSSID and dropping it
+// after one bad association made nodes alternate between a full scan and a
+// poor pin. This module keeps a few candidates with a smoothed RSSI, a
+// connect success rate, and a mean connect time, and picks the best-scoring
+// one for each association. Candidates that fail repeatedly stop being picked
+// until a scan sees them again, and candidates that a scan no longer finds are
+// dropped. The state is plain data so the firmware can keep it in RTC memory,
+// and it is timed with the RTC clock.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace envnode::core {
+
+// Candidate slots retained across deep sleep.
+constexpr size_t kRoamingCandidateSlots = 4;
+
+// Consecutive failed associations after which a candidate is no longer picked
+// until a scan sees it again.
+constexpr uint8_t kMaxRoamingCandidateFailures = 2;
+
+// Candidates not seen for this long are no longer picked.
+constexpr uint32_t kRoamingCandidateMaxAgeSeconds = 3UL * 24UL * 3600UL;
+
+// One access point advertising the configured SSID. `channel` is zero for an
+// empty slot. Attempt counts are halved when they reach 16, so the success
+// rate follows recent behaviour.
+struct RoamingCandidate {
+  uint8_t bssid[6] = {0};
+  uint8_t channel = 0;
+  float rssiDbm = 0.0f;
+  uint8_t attempts = 0;
+  uint8_t successes = 0;
+  uint8_t consecutiveFailures = 0;
+  uint16_t meanConnectMs = 0;
+  uint32_t lastSeenSeconds = 0;
+};
+
+// The retained candidates, in no particular order.
+struct RoamingTable {
+  RoamingCandidate candidates[kRoamingCandidateSlots];
+};
+
+// Adds or refreshes the candidate `bssid` with an RSSI reading taken at
+// `nowSeconds`, from a scan or from the live connection. When the table is
+// full, the lowest-scoring candidate makes room.
+void ObserveAccessPoint(RoamingTable& table,
+                        const uint8_t bssid[6],
+                        uint8_t channel,
+                        int8_t rssiDbm,
+                        uint32_t nowSeconds);
+
+// Records the outcome of an association to `bssid`, and on success how long
+// it took. Unknown BSSIDs are ignored.
+void RecordRoamingResult(RoamingTable& table,
+                         const uint8_t bssid[6],
+                         bool connected,
+                         uint32_t connectMs);
+
+// Drops candidates that have not been seen since `sinceSeconds`, for use
+// after a scan that covered all of their channels.
+void DropUnseenCandidates(RoamingTable& table, uint32_t sinceSeconds);
+
+// Scores a candidate: its smoothed RSSI in dBm, plus up to 30 for its success
+// rate, minus 1 per 100 ms of mean connect time. Higher is better.
+float RoamingCandidateScore(const RoamingCandidate& candidate);
+
+// Returns the best candidate that may be picked at `nowSeconds`, or nullptr
+// when none qualifies.
+const RoamingCandidate* BestRoamingCandidate(const RoamingTable& table, uint32_t nowSeconds);
+
+// Writes the distinct channels of the retained candidates to `channels` and
+// returns how many there are, for targeted scans.
+size_t RoamingChannels(const RoamingTable& table, uint8_t* channels, size_t capacity);
+
+}  // namespace envnode::core
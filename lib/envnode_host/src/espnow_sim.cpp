@@ -0,0 +1,149 @@
+// Multi-node ESP-NOW simulator implementation.
+
+#include "espnow_sim.h"
+
+#include <cstring>
+
+#include <json_writer.h>
+#include <telemetry_dispatch.h>
+
+namespace envnode::host {
+
+namespace {
+
+constexpr const char* kReadingColumns =
+    "device_id,recorded_at,temperature_c,humidity_rh,pressure_hpa,"
+    "battery_voltage_v,battery_pct";
+
+// Readings that drift a little with every sample.
+envnode::core::BatchedReading SimulatedReading(size_t node, uint32_t sample) {
+  envnode::core::BatchedReading reading;
+  reading.temperature = 20.0f + node + (sample % 10) * 0.1f;
+  reading.humidity = 40.0f + (sample % 7);
+  reading.pressure = 1005.0f + (sample % 5) * 0.2f;
+  reading.batteryVoltage = 3.9f - sample * 0.0005f;
+  reading.batteryPercent = 70.0f;
+  return reading;
+}
+
+}  // namespace
+
+EspNowSim::EspNowSim(const std::string& key, const AirModel& air, uint32_t seed)
+    : key_(key.begin(), key.end()), air_(air), rngState_(seed ? seed : 1U) {}
+
+size_t EspNowSim::AddNode(const std::string& deviceId) {
+  Node node;
+  node.deviceId = deviceId;
+  envnode::core::ResumeFrameCounter(node.counter, 0);
+  nodes_.push_back(node);
+  return nodes_.size() - 1;
+}
+
+// Mirrors the node firmware: the counter reservation reaches flash before the
+// frame that needs it goes out.
+void EspNowSim::RunWakeRound(uint32_t nowSeconds, uint32_t nowEpoch) {
+  for (size_t index = 0; index < nodes_.size(); ++index) {
+    Node& node = nodes_[index];
+    envnode::core::BatchedReading reading = SimulatedReading(index, node.sample++);
+    reading.recordedAtEpoch = nowEpoch;
+    envnode::core::PushReading(node.pending, reading);
+    ++totals_.readingsTaken;
+
+    envnode::core::EspNowFrame frame;
+    strncpy(frame.deviceId, node.deviceId.c_str(), envnode::core::kEspNowDeviceIdMaxBytes);
+    const size_t rows = node.pending.count < envnode::core::kEspNowMaxReadingsPerFrame
+                            ? node.pending.count
+                            : envnode::core::kEspNowMaxReadingsPerFrame;
+    frame.readingCount = static_cast<uint8_t>(rows);
+    for (size_t i = 0; i < rows; ++i) {
+      frame.readings[i] = *envnode::core::ReadingAt(node.pending, i);
+    }
+    if (envnode::core::TakeFrameCounter(node.counter, frame.counter)) {
+      node.persistedReservation = node.counter.reservedUntil;
+      ++totals_.counterFlashWrites;
+    }
+
+    uint8_t encoded[envnode::core::kEspNowMaxFrameBytes];
+    const size_t length =
+        envnode::core::EncodeEspNowFrame(frame, key_.data(), key_.size(), encoded, sizeof(encoded));
+    node.lastFrame.assign(encoded, encoded + length);
+    ++totals_.framesSent;
+    if (Chance(air_.frameLossPercent)) {
+      ++totals_.framesLost;
+      continue;
+    }
+    envnode::core::AcceptGatewayFrame(gateway_, encoded, length, key_.data(), key_.size(),
+                                      nowSeconds, nowEpoch);
+    if (Chance(air_.ackLossPercent)) {
+      ++totals_.acksLost;
+      continue;
+    }
+    envnode::core::DropOldestReadings(node.pending, rows);
+  }
+}
+
+void EspNowSim::PowerLoss(size_t index) {
+  Node& node = nodes_[index];
+  envnode::core::ResetReadingRing(node.pending);
+  envnode::core::ResumeFrameCounter(node.counter, node.persistedReservation);
+}
+
+envnode::core::GatewayAccept EspNowSim::Inject(const std::vector<uint8_t>& frame,
+                                                uint32_t nowSeconds) {
+  return envnode::core::AcceptGatewayFrame(gateway_, frame.data(), frame.size(), key_.data(),
+                                           key_.size(), nowSeconds, 0);
+}
+
+const std::vector<uint8_t>& EspNowSim::LastFrame(size_t index) const {
+  return nodes_[index].lastFrame;
+}
+
+// Rows stay queued when the insert fails, so the next call retries them.
+size_t EspNowSim::ServiceGateway(FakeTelemetryServer& server,
+                                 uint32_t nowSeconds,
+                                 size_t flushRows,
+                                 uint32_t maxHoldSeconds) {
+  if (!envnode::core::GatewayFlushDue(gateway_, flushRows, maxHoldSeconds, nowSeconds)) {
+    return 0;
+  }
+  static char payload[8192];
+  envnode::core::JsonWriter writer(payload, sizeof(payload));
+  const size_t rows =
+      envnode::core::WriteGatewayReadingBatch(writer, gateway_, gateway_.rowCount);
+
+  envnode::core::SupabaseTarget target;
+  target.url = "https://abcdefghijklmnop.supabase.co";
+  target.apiKey = "sb_publishable_0123456789abcdefghijklmnopqrstuv";
+  envnode::core::SupabaseInsert insert;
+  insert.table = "readings";
+  insert.columns = kReadingColumns;
+  insert.body = writer.Data();
+  insert.bodyLength = writer.Length();
+  const envnode::core::InsertResult result = envnode::core::SendSupabaseInsert(
+      server, target, insert, envnode::core::InsertCompression());
+  if (!envnode::core::HttpSucceeded(result.response)) {
+    return 0;
+  }
+  envnode::core::DropGatewayRows(gateway_, rows);
+  totals_.rowsUploaded += rows;
+  ++totals_.uploads;
+  return rows;
+}
+
+const envnode::core::EspNowGateway& EspNowSim::Gateway() const {
+  return gateway_;
+}
+
+const SimTotals& EspNowSim::Totals() const {
+  return totals_;
+}
+
+// Same xorshift generator as `FakeTelemetryServer`, so runs are repeatable.
+bool EspNowSim::Chance(uint8_t percent) {
+  rngState_ ^= rngState_ << 13;
+  rngState_ ^= rngState_ >> 17;
+  rngState_ ^= rngState_ << 5;
+  return rngState_ % 100U < percent;
+}
+
+}  // namespace envnode::host
@@ -0,0 +1,97 @@
+// Multi-node ESP-NOW simulator for the gateway uplink.
+//
+// Host-side tests drive a set of simulated battery nodes through wake rounds.
+// Each node queues its reading in a retained ring, sends its pending readings
+// to the gateway in one frame using the real codec and frame counter, and only
+// drops them once the frame is acknowledged, as the firmware does. The air
+// between them loses frames and acknowledgements at configurable rates, so a
+// lost acknowledgement makes a node resend readings the gateway already has.
+// The gateway side is the real `EspNowGateway`, uploaded through
+// `FakeTelemetryServer`. Only used by native builds.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <espnow_frame.h>
+#include <espnow_gateway.h>
+#include <reading_batch.h>
+
+#include "fake_telemetry_server.h"
+
+namespace envnode::host {
+
+// Loss rates of the simulated air, in percent.
+struct AirModel {
+  uint8_t frameLossPercent = 0;
+  uint8_t ackLossPercent = 0;
+};
+
+// What the simulation did, summed over every node.
+struct SimTotals {
+  size_t readingsTaken = 0;
+  size_t framesSent = 0;
+  size_t framesLost = 0;
+  size_t acksLost = 0;
+  size_t counterFlashWrites = 0;
+  size_t rowsUploaded = 0;
+  size_t uploads = 0;
+};
+
+// Simulated nodes, the air between them, and one gateway.
+class EspNowSim {
+ public:
+  EspNowSim(const std::string& key, const AirModel& air = AirModel(), uint32_t seed = 1);
+
+  // Adds a node and returns its index.
+  size_t AddNode(const std::string& deviceId);
+
+  // Wakes every node once at `nowSeconds`. Each samples a reading, sends its
+  // pending readings, and keeps them unless the frame was acknowledged. Frames
+  // that arrive are handed to the gateway at once.
+  void RunWakeRound(uint32_t nowSeconds, uint32_t nowEpoch);
+
+  // Cuts power to node `index`: its RTC ring and counter are lost and it
+  // resumes from the reservation it last wrote to flash.
+  void PowerLoss(size_t index);
+
+  // Hands `frame` to the gateway as if it had been received over the air.
+  envnode::core::GatewayAccept Inject(const std::vector<uint8_t>& frame, uint32_t nowSeconds);
+
+  // Returns the last frame node `index` put on the air, for replay tests.
+  const std::vector<uint8_t>& LastFrame(size_t index) const;
+
+  // Uploads the gateway's queue through `server` when a flush is due, the way
+  // the gateway firmware does. Returns the number of rows uploaded.
+  size_t ServiceGateway(FakeTelemetryServer& server,
+                        uint32_t nowSeconds,
+                        size_t flushRows,
+                        uint32_t maxHoldSeconds);
+
+  const envnode::core::EspNowGateway& Gateway() const;
+  const SimTotals& Totals() const;
+
+ private:
+  struct Node {
+    std::string deviceId;
+    envnode::core::FrameCounter counter;
+    uint32_t persistedReservation = 0;
+    envnode::core::ReadingRing pending;
+    std::vector<uint8_t> lastFrame;
+    uint32_t sample = 0;
+  };
+
+  bool Chance(uint8_t percent);
+
+  std::vector<uint8_t> key_;
+  AirModel air_;
+  uint32_t rngState_;
+  std::vector<Node> nodes_;
+  envnode::core::EspNowGateway gateway_;
+  SimTotals totals_;
+};
+
+}  // namespace envnode::host
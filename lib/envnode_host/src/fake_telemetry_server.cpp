@@ -0,0 +1,160 @@
+// In-process Supabase/webhook stand-in implementation.
+
+#include "fake_telemetry_server.h"
+
+#include <algorithm>
+
+namespace envnode::host {
+
+namespace {
+
+// Headers `HTTPClient` adds to every request on its own.
+constexpr const char* kClientDefaultHeaders =
+    "User-Agent: ESP32HTTPClient\r\n"
+    "Connection: keep-alive\r\n"
+    "Accept-Encoding: identity;q=1,chunked;q=0.1,*;q=0\r\n";
+
+// Splits `scheme://host[:port]` off the front of `url`.
+std::string OriginOf(const std::string& url) {
+  const size_t hostStart = url.find("://");
+  if (hostStart == std::string::npos) {
+    return std::string();
+  }
+  const size_t pathStart = url.find_first_of("/?#", hostStart + 3);
+  return url.substr(0, pathStart);
+}
+
+// Bytes of the HTTP/1.1 request head plus body, as the client would send them.
+size_t WireBytes(const RecordedRequest& request) {
+  const std::string path = request.url.substr(request.origin.size());
+  const std::string host = request.origin.substr(request.origin.find("://") + 3);
+  size_t bytes = request.method.size() + 1 + (path.empty() ? 1 : path.size()) + 11;
+  bytes += 6 + host.size() + 2 + std::char_traits<char>::length(kClientDefaultHeaders);
+  for (const auto& header : request.headers) {
+    bytes += header.first.size() + 2 + header.second.size() + 2;
+  }
+  if (!request.body.empty()) {
+    bytes += 16 + std::to_string(request.body.size()).size() + 2;
+  }
+  return bytes + 2 + request.body.size();
+}
+
+// Answers the way PostgREST and a webhook receiver would.
+int Respond(const RecordedRequest& request, bool rejectGzip) {
+  if (request.url.find("/rest/v1/") == std::string::npos) {
+    return request.method == "POST" ? 200 : 405;
+  }
+  if (request.method == "GET") {
+    return 200;
+  }
+  if (request.method != "POST") {
+    return 405;
+  }
+  if (request.gzip) {
+    return rejectGzip ? 415 : 201;
+  }
+  const char first = request.body.empty() ? '\0' : request.body[0];
+  return first == '[' || first == '{' ? 201 : 400;
+}
+
+}  // namespace
+
+std::string RecordedRequest::Header(const std::string& name) const {
+  for (const auto& header : headers) {
+    if (header.first == name) {
+      return header.second;
+    }
+  }
+  return std::string();
+}
+
+FakeTelemetryServer::FakeTelemetryServer(const LinkModel& link, uint32_t seed)
+    : link_(link), rngState_(seed ? seed : 1U) {}
+
+// Requests to an origin without an open connection pay for TCP setup and a
+// full TLS handshake; later ones reuse it until `CloseConnections()`.
+envnode::core::HttpResponse FakeTelemetryServer::Send(
+    const envnode::core::HttpRequest& request) {
+  envnode::core::HttpResponse response;
+  RecordedRequest recorded;
+  recorded.method = request.method ? request.method : "";
+  recorded.url = request.url ? request.url : "";
+  recorded.origin = OriginOf(recorded.url);
+  if (recorded.origin.empty()) {
+    return response;
+  }
+  for (size_t index = 0; index < request.headerCount; ++index) {
+    recorded.headers.emplace_back(request.headers[index].name, request.headers[index].value);
+  }
+  if (request.body) {
+    recorded.body.assign(request.body, request.bodyLength);
+  }
+  recorded.gzip = recorded.Header("Content-Encoding") == "gzip";
+  recorded.wireBytes = WireBytes(recorded);
+
+  const bool reused = std::find(openOrigins_.begin(), openOrigins_.end(),
+                                recorded.origin) != openOrigins_.end();
+  uint32_t latencyMs = link_.roundTripMs + link_.serverMs +
+                       static_cast<uint32_t>(recorded.wireBytes / link_.uplinkBytesPerMs);
+  if (!reused) {
+    latencyMs += link_.roundTripMs + link_.tlsHandshakeMs;
+  }
+
+  if (failCount_ > 0) {
+    --failCount_;
+    recorded.code = failCode_;
+  } else {
+    recorded.code = Respond(recorded, rejectGzip_);
+  }
+  // A refused connection never opens a socket or reaches the server.
+  recorded.newConnection = !reused && recorded.code >= 0;
+  if (recorded.newConnection) {
+    openOrigins_.push_back(recorded.origin);
+    ++connectionsOpened_;
+  }
+  recorded.latencyMs = Jitter(latencyMs);
+
+  response.started = true;
+  response.code = recorded.code;
+  response.elapsedMs = recorded.latencyMs;
+  response.reusedConnection = reused;
+  requests_.push_back(std::move(recorded));
+  return response;
+}
+
+void FakeTelemetryServer::CloseConnections() {
+  openOrigins_.clear();
+}
+
+void FakeTelemetryServer::ClearRequests() {
+  requests_.clear();
+}
+
+void FakeTelemetryServer::SetRejectGzip(bool reject) {
+  rejectGzip_ = reject;
+}
+
+void FakeTelemetryServer::FailNext(size_t count, int code) {
+  failCount_ = count;
+  failCode_ = code;
+}
+
+const std::vector<RecordedRequest>& FakeTelemetryServer::Requests() const {
+  return requests_;
+}
+
+size_t FakeTelemetryServer::ConnectionsOpened() const {
+  return connectionsOpened_;
+}
+
+// xorshift32 keeps runs reproducible for a given seed.
+uint32_t FakeTelemetryServer::Jitter(uint32_t latencyMs) {
+  rngState_ ^= rngState_ << 13;
+  rngState_ ^= rngState_ >> 17;
+  rngState_ ^= rngState_ << 5;
+  const int span = 2 * link_.jitterPercent + 1;
+  const int percent = 100 - link_.jitterPercent + static_cast<int>(rngState_ % span);
+  return static_cast<uint32_t>(static_cast<uint64_t>(latencyMs) * percent / 100U);
+}
+
+}  // namespace envnode::host
@@ -0,0 +1,95 @@
+// In-process stand-in for Supabase PostgREST and the n8n/Discord webhooks.
+//
+// Host-side tests and benchmarks hand this to the `envnode::core` dispatch
+// functions in place of the firmware's pooled `HTTPClient` transport. It
+// answers the way the real services do for the requests the firmware makes,
+// records every request with its size on the wire, and models keep-alive
+// connections and link latency so a cycle's radio cost can be measured on a
+// Linux box. Only used by native builds; the firmware never includes it.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <http_transport.h>
+
+namespace envnode::host {
+
+// Timing used to estimate how long each request keeps the radio busy. The
+// defaults approximate an ESP32-S3 on a home Wi-Fi network talking to a cloud
+// region a few tens of milliseconds away.
+struct LinkModel {
+  uint32_t roundTripMs = 40;
+  // Full TLS handshake, dominated by the certificate check and key agreement
+  // on the ESP32 rather than by round trips.
+  uint32_t tlsHandshakeMs = 450;
+  uint32_t uplinkBytesPerMs = 60;
+  uint32_t serverMs = 25;
+  // Each request's latency is scaled by a deterministic factor within this
+  // many percent either side of 100.
+  uint8_t jitterPercent = 30;
+};
+
+// One request as the server saw it.
+struct RecordedRequest {
+  std::string method;
+  std::string url;
+  std::string origin;
+  std::vector<std::pair<std::string, std::string>> headers;
+  std::string body;
+  size_t wireBytes = 0;
+  bool gzip = false;
+  bool newConnection = false;
+  int code = 0;
+  uint32_t latencyMs = 0;
+
+  // Returns the value of header `name`, or an empty string.
+  std::string Header(const std::string& name) const;
+};
+
+// Records requests and answers them like PostgREST and a webhook receiver:
+// `201` for well-formed inserts, `200` for table probes and webhooks, `415`
+// for gzip bodies when gzip is refused, and `400` for bodies that are not
+// JSON. Keep-alive connections persist per origin until `CloseConnections()`.
+class FakeTelemetryServer : public envnode::core::HttpTransport {
+ public:
+  explicit FakeTelemetryServer(const LinkModel& link = LinkModel(), uint32_t seed = 1);
+
+  envnode::core::HttpResponse Send(const envnode::core::HttpRequest& request) override;
+
+  // Drops every kept-alive connection, as the firmware does before sleeping.
+  void CloseConnections();
+
+  // Forgets the recorded requests but keeps open connections.
+  void ClearRequests();
+
+  // Makes the server answer compressed bodies with `415 Unsupported Media Type`.
+  void SetRejectGzip(bool reject);
+
+  // Makes the next `count` requests fail with `code` before reaching the
+  // handler, for example `-1` for a refused connection or `503`.
+  void FailNext(size_t count, int code);
+
+  const std::vector<RecordedRequest>& Requests() const;
+
+  // Returns how many connections (and therefore TLS handshakes) were opened.
+  size_t ConnectionsOpened() const;
+
+ private:
+  uint32_t Jitter(uint32_t latencyMs);
+
+  LinkModel link_;
+  uint32_t rngState_;
+  bool rejectGzip_ = false;
+  size_t failCount_ = 0;
+  int failCode_ = 0;
+  size_t connectionsOpened_ = 0;
+  std::vector<std::string> openOrigins_;
+  std::vector<RecordedRequest> requests_;
+};
+
+}  // namespace envnode::host
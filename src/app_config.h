@@ -120,14 +120,170 @@
   #define WIFI_OVERRIDE_DNS 0
 #endif
 
+#ifndef WIFI_FAST_RECONNECT
+  #define WIFI_FAST_RECONNECT 1
+#endif
+
+#ifndef WIFI_LEASE_REUSE_MAX_SECONDS
+  #define WIFI_LEASE_REUSE_MAX_SECONDS 43200UL
+#endif
+
 #ifndef WIFI_TX_POWER_DBM
   #define WIFI_TX_POWER_DBM 15
 #endif
 
+#ifndef WIFI_BACKOFF_AFTER_FAILURES
+  #define WIFI_BACKOFF_AFTER_FAILURES 2
+#endif
+
+#ifndef WIFI_BACKOFF_BASE_SECONDS
+  #define WIFI_BACKOFF_BASE_SECONDS 600UL
+#endif
+
+#ifndef WIFI_BACKOFF_MAX_SECONDS
+  #define WIFI_BACKOFF_MAX_SECONDS 3600UL
+#endif
+
+#ifndef WIFI_TX_POWER_ADAPTIVE
+  #define WIFI_TX_POWER_ADAPTIVE 1
+#endif
+
+#ifndef WIFI_TX_POWER_MIN_DBM
+  #define WIFI_TX_POWER_MIN_DBM 8
+#endif
+
+#ifndef WIFI_TX_POWER_MAX_DBM
+  #define WIFI_TX_POWER_MAX_DBM 19
+#endif
+
+#ifndef WIFI_TX_POWER_STEP_DOWN_RSSI
+  #define WIFI_TX_POWER_STEP_DOWN_RSSI -60
+#endif
+
+#ifndef WIFI_TX_POWER_RAISE_RSSI
+  #define WIFI_TX_POWER_RAISE_RSSI -72
+#endif
+
+#ifndef READING_BATCH_FLUSH_COUNT
+  #define READING_BATCH_FLUSH_COUNT 6UL
+#endif
+
+#ifndef DEBUG_READING_BATCH_FLUSH_COUNT
+  #define DEBUG_READING_BATCH_FLUSH_COUNT 1UL
+#endif
+
+#ifndef FLUSH_EVENTS_ON_ERROR
+  #define FLUSH_EVENTS_ON_ERROR 1
+#endif
+
+#ifndef REPORT_DEADBAND_TEMP_C
+  #define REPORT_DEADBAND_TEMP_C 0.2f
+#endif
+
+#ifndef REPORT_DEADBAND_HUMIDITY_RH
+  #define REPORT_DEADBAND_HUMIDITY_RH 1.0f
+#endif
+
+#ifndef REPORT_DEADBAND_PRESSURE_HPA
+  #define REPORT_DEADBAND_PRESSURE_HPA 0.5f
+#endif
+
+#ifndef REPORT_DEADBAND_BATTERY_V
+  #define REPORT_DEADBAND_BATTERY_V 0.05f
+#endif
+
+#ifndef REPORT_MAX_SILENCE_SECONDS
+  #define REPORT_MAX_SILENCE_SECONDS 3600UL
+#endif
+
+#ifndef ALERT_BURST
+  #define ALERT_BURST 3
+#endif
+
+#ifndef ALERT_REFILL_SECONDS
+  #define ALERT_REFILL_SECONDS 1200UL
+#endif
+
+#ifndef ALERT_DEDUP_SECONDS
+  #define ALERT_DEDUP_SECONDS 600UL
+#endif
+
+#ifndef WAKE_BUDGET_MS
+  #define WAKE_BUDGET_MS 20000UL
+#endif
+
+#ifndef DNS_CACHE_TTL_SECONDS
+  #define DNS_CACHE_TTL_SECONDS 3600UL
+#endif
+
+#ifndef WIFI_EARLY_CONNECT
+  #define WIFI_EARLY_CONNECT 1
+#endif
+
+#ifndef UPLOAD_GZIP_MIN_BYTES
+  #define UPLOAD_GZIP_MIN_BYTES 512UL
+#endif
+
+#ifndef JOURNAL_MAX_BYTES
+  #define JOURNAL_MAX_BYTES (256UL * 1024UL)
+#endif
+
+#ifndef JOURNAL_SEGMENT_BYTES
+  #define JOURNAL_SEGMENT_BYTES (16UL * 1024UL)
+#endif
+
+#ifndef JOURNAL_REPLAY_MAX_BATCHES
+  #define JOURNAL_REPLAY_MAX_BATCHES 4
+#endif
+
 #ifndef SENSOR_POWER_SETTLE_MS
   #define SENSOR_POWER_SETTLE_MS 500UL
 #endif
 
+#ifndef I2C_FAST_MODE
+  #define I2C_FAST_MODE 1
+#endif
+
+#ifndef ESPNOW_UPLINK
+  #define ESPNOW_UPLINK 0
+#endif
+
+#ifndef ESPNOW_GATEWAY
+  #define ESPNOW_GATEWAY 0
+#endif
+
+#ifndef ESPNOW_KEY
+  #define ESPNOW_KEY ""
+#endif
+
+#ifndef ESPNOW_GATEWAY_MAC
+  #define ESPNOW_GATEWAY_MAC 0xFF,0xFF,0xFF,0xFF,0xFF,0xFF
+#endif
+
+#ifndef ESPNOW_CHANNEL
+  #define ESPNOW_CHANNEL 0
+#endif
+
+#ifndef ESPNOW_ACK_TIMEOUT_MS
+  #define ESPNOW_ACK_TIMEOUT_MS 60UL
+#endif
+
+#ifndef ESPNOW_GATEWAY_FLUSH_ROWS
+  #define ESPNOW_GATEWAY_FLUSH_ROWS 24UL
+#endif
+
+#ifndef ESPNOW_GATEWAY_MAX_HOLD_SECONDS
+  #define ESPNOW_GATEWAY_MAX_HOLD_SECONDS 300UL
+#endif
+
+#if ESPNOW_UPLINK && ESPNOW_GATEWAY
+  #error "ESPNOW_UPLINK and ESPNOW_GATEWAY are mutually exclusive; a board is either a node or the gateway."
+#endif
+
+#if ESPNOW_GATEWAY && !DISABLE_DEEP_SLEEP
+  #error "ESPNOW_GATEWAY needs DISABLE_DEEP_SLEEP=1 so the gateway keeps listening."
+#endif
+
 #if defined(D3)
 constexpr int SENSE_EN_PIN = D3;
 #else
@@ -193,9 +349,26 @@ constexpr uint32_t DEFAULT_SAMPLE_INTERVAL_SECONDS =
     DEBUG_MODE_ENABLED ? DEBUG_SAMPLE_INTERVAL : PRODUCTION_SAMPLE_INTERVAL;
 constexpr uint32_t MIN_ALLOWED_SAMPLE_INTERVAL_SECONDS = MIN_SAMPLE_INTERVAL_SECONDS;
 constexpr uint32_t MAX_ALLOWED_SAMPLE_INTERVAL_SECONDS = MAX_SAMPLE_INTERVAL_SECONDS;
+constexpr uint32_t READING_FLUSH_THRESHOLD =
+    DEBUG_MODE_ENABLED ? DEBUG_READING_BATCH_FLUSH_COUNT : READING_BATCH_FLUSH_COUNT;
+constexpr bool EVENT_ERROR_FLUSH_ENABLED = FLUSH_EVENTS_ON_ERROR != 0;
+constexpr bool JOURNAL_ENABLED = JOURNAL_MAX_BYTES > 0;
+constexpr bool WIFI_EARLY_CONNECT_ENABLED = WIFI_EARLY_CONNECT != 0;
+constexpr bool WIFI_FAST_RECONNECT_ENABLED = WIFI_FAST_RECONNECT != 0;
+constexpr bool WIFI_TX_POWER_ADAPTIVE_ENABLED = WIFI_TX_POWER_ADAPTIVE != 0;
+constexpr bool WIFI_LEASE_REUSE_ENABLED =
+    WIFI_FAST_RECONNECT_ENABLED && WIFI_LEASE_REUSE_MAX_SECONDS > 0 && !WIFI_USE_STATIC_IP;
+constexpr bool DNS_CACHE_ENABLED = DNS_CACHE_TTL_SECONDS > 0;
+constexpr bool UPLOAD_GZIP_ENABLED = UPLOAD_GZIP_MIN_BYTES > 0;
+constexpr bool ALERT_RATE_LIMIT_ENABLED = ALERT_BURST > 0;
+constexpr bool REPORT_DEADBAND_ENABLED = REPORT_MAX_SILENCE_SECONDS > 0;
+constexpr bool I2C_FAST_MODE_ENABLED = I2C_FAST_MODE != 0;
+constexpr bool ESPNOW_UPLINK_ENABLED = ESPNOW_UPLINK != 0;
+constexpr bool ESPNOW_GATEWAY_ENABLED = ESPNOW_GATEWAY != 0;
+static_assert(!(ESPNOW_UPLINK_ENABLED || ESPNOW_GATEWAY_ENABLED) || sizeof(ESPNOW_KEY) > 16,
+              "ESPNOW_KEY must be at least 16 characters when ESP-NOW is enabled");
 constexpr const char* CONFIG_NAMESPACE = "envnode";
 constexpr const char* SAMPLE_INTERVAL_KEY = "interval_s";
-constexpr unsigned long WEBHOOK_COOLDOWN_MS = 1000UL;
 constexpr uint16_t WEBHOOK_TIMEOUT_MS = 10000U;
 constexpr bool DEBUG_WEBHOOKS = false;
 
@@ -223,3 +396,6 @@ constexpr uint8_t WIFI_GATEWAY_BYTES[4] = {WIFI_GATEWAY};
 constexpr uint8_t WIFI_SUBNET_BYTES[4] = {WIFI_SUBNET};
 constexpr uint8_t WIFI_DNS1_BYTES[4] = {WIFI_DNS1};
 constexpr uint8_t WIFI_DNS2_BYTES[4] = {WIFI_DNS2};
+constexpr uint8_t ESPNOW_GATEWAY_MAC_BYTES[6] = {ESPNOW_GATEWAY_MAC};
+static_assert(!ESPNOW_UPLINK_ENABLED || (ESPNOW_GATEWAY_MAC_BYTES[0] & 0x01) == 0,
+              "ESPNOW_GATEWAY_MAC must be the gateway's station MAC; broadcast frames are never acknowledged");
@@ -9,11 +9,31 @@
 #include <Preferences.h>
 #include <esp_sleep.h>
 #include <esp_system.h>
+#include <sys/time.h>
 #include <core_logic.h>
 
 AppContext gApp;
 RTC_DATA_ATTR PersistentState gPersistentState = {};
 
+namespace {
+
+constexpr envnode::core::ReportDeadband kReportDeadband = {
+    REPORT_DEADBAND_TEMP_C, REPORT_DEADBAND_HUMIDITY_RH, REPORT_DEADBAND_PRESSURE_HPA,
+    REPORT_DEADBAND_BATTERY_V, REPORT_MAX_SILENCE_SECONDS};
+
+// Copies the values the ring and the deadband policy keep from a reading.
+envnode::core::BatchedReading toBatchedReading(const SensorReadings& readings) {
+  envnode::core::BatchedReading entry;
+  entry.temperature = readings.temperature;
+  entry.humidity = readings.humidity;
+  entry.pressure = readings.pressure;
+  entry.batteryVoltage = readings.batteryVoltage;
+  entry.batteryPercent = readings.batteryPercent;
+  return entry;
+}
+
+}  // namespace
+
 // Determines whether the current wake was caused by the timer, a cold boot, or
 // some other reset source.
 BootMode detectBootMode() {
@@ -54,17 +74,72 @@ bool hasLastGoodReading() {
   return gPersistentState.hasLastGood;
 }
 
-// Returns the retained last-good reading so callers can do plausibility checks.
-const SensorReadings* getLastGoodReading() {
-  return gPersistentState.hasLastGood ? &gPersistentState.lastGood : nullptr;
-}
-
 // Updates the retained last-good reading after a sample has been accepted.
 void setLastGoodReading(const SensorReadings& readings) {
   gPersistentState.lastGood = readings;
   gPersistentState.hasLastGood = true;
 }
 
+// Compares against the last reported reading using the configured deadbands.
+envnode::core::ReportDecision evaluateReadingReport(const SensorReadings& readings) {
+  return envnode::core::EvaluateReport(gPersistentState.reportState, kReportDeadband,
+                                       toBatchedReading(readings), rtcClockSeconds());
+}
+
+// Checks the silence limit alone, before the sensor has been read.
+bool readingKeepAliveDue() {
+  return envnode::core::ReportKeepAliveDue(gPersistentState.reportState, kReportDeadband,
+                                           rtcClockSeconds());
+}
+
+// Stores an accepted reading in the retained ring, stamping it with wall-clock
+// time when the clock has been synchronized.
+void queuePendingReading(const SensorReadings& readings) {
+  envnode::core::BatchedReading entry = toBatchedReading(readings);
+  entry.recordedAtEpoch = currentEpochSeconds();
+  if (!envnode::core::PushReading(gPersistentState.pendingReadings, entry)) {
+    Serial.printf("Reading ring full; dropped oldest pending reading (%lu dropped total).\n",
+                  static_cast<unsigned long>(gPersistentState.pendingReadings.dropped));
+  }
+  envnode::core::MarkReported(gPersistentState.reportState, entry, rtcClockSeconds());
+}
+
+// Reports the number of readings still waiting for upload.
+size_t pendingReadingCount() {
+  return gPersistentState.pendingReadings.count;
+}
+
+// Applies the configured flush threshold to the retained ring.
+bool pendingReadingsFlushDue() {
+  return envnode::core::ShouldFlushReadings(gPersistentState.pendingReadings,
+                                            READING_FLUSH_THRESHOLD);
+}
+
+// Reads the RTC-backed system clock, which keeps running through deep sleep
+// once it has been set.
+uint32_t currentEpochSeconds() {
+  struct timeval now = {};
+  gettimeofday(&now, nullptr);
+  if (now.tv_sec < static_cast<time_t>(envnode::core::kMinValidEpochSeconds)) {
+    return 0;
+  }
+  return static_cast<uint32_t>(now.tv_sec);
+}
+
+// Reads `gettimeofday()` without the synchronization check.
+uint32_t rtcClockSeconds() {
+  struct timeval now = {};
+  gettimeofday(&now, nullptr);
+  return static_cast<uint32_t>(now.tv_sec);
+}
+
+// Sets the system clock so retained readings can carry capture timestamps.
+void setWallClockEpochSeconds(uint32_t epochSeconds) {
+  struct timeval now = {};
+  now.tv_sec = static_cast<time_t>(epochSeconds);
+  settimeofday(&now, nullptr);
+}
+
 // Clamps an interval request using the pure helper library shared with tests.
 uint32_t sanitizeSampleIntervalSeconds(uint32_t intervalSeconds) {
   return envnode::core::SanitizeSampleInterval(intervalSeconds,
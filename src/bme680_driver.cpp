@@ -0,0 +1,167 @@
+// BME680 register-level driver implementation.
+
+#include "bme680_driver.h"
+
+#include "sensor_bus.h"
+
+namespace {
+
+// Extra time allowed past the nominal conversion before a measurement that
+// has not set its new-data flag is given up on.
+constexpr uint32_t kCollectGraceMs = 20;
+
+// Driver state for the one sensor on the bus.
+struct Bme680State {
+  uint8_t address = 0;
+  bool ready = false;
+  bool pending = false;
+  bool calibrationCached = false;
+  unsigned long startedMs = 0;
+  envnode::core::Bme680Settings settings;
+  envnode::core::Bme680Calibration calibration;
+};
+
+Bme680State gSensor;
+
+// Writes one register.
+bool writeRegister(uint8_t reg, uint8_t value) {
+  return sensorBusWrite(gSensor.address, reg, value);
+}
+
+// Reads `length` consecutive registers starting at `reg` in one transaction.
+bool readRegisters(uint8_t reg, uint8_t* out, size_t length) {
+  return sensorBusRead(gSensor.address, reg, out, length);
+}
+
+// Compares the chip's `par_t1` registers with the cached copy.
+bool cachedCalibrationMatchesChip(const envnode::core::Bme680CalibrationCache& cache) {
+  constexpr size_t kParT1Offset =
+      envnode::core::kBme680RegParT1 - envnode::core::kBme680RegCalibration2;
+  uint8_t parT1[2];
+  return readRegisters(envnode::core::kBme680RegParT1, parT1, sizeof(parT1)) &&
+         memcmp(parT1, cache.block2 + kParT1Offset, sizeof(parT1)) == 0;
+}
+
+// Checks that the device at the driver's address is a BME680.
+bool chipIdMatches() {
+  uint8_t chipId = 0;
+  return readRegisters(envnode::core::kBme680RegChipId, &chipId, 1) &&
+         chipId == envnode::core::kBme680ChipId;
+}
+
+// Reads both calibration blocks and stores them in `cache`.
+bool readCalibration(envnode::core::Bme680CalibrationCache& cache) {
+  uint8_t block1[envnode::core::kBme680Calibration1Bytes];
+  uint8_t block2[envnode::core::kBme680Calibration2Bytes];
+  if (!readRegisters(envnode::core::kBme680RegCalibration1, block1, sizeof(block1)) ||
+      !readRegisters(envnode::core::kBme680RegCalibration2, block2, sizeof(block2))) {
+    return false;
+  }
+  envnode::core::StoreBme680Calibration(cache, gSensor.address, envnode::core::kBme680ChipId,
+                                        block1, block2);
+  return true;
+}
+
+}  // namespace
+
+// The humidity control register only takes effect on the next write to the
+// measurement control register, so it is written first. A trusted cache was
+// keyed by the chip ID at this address, so that path skips straight to the
+// soft reset. The calibration registers are NVM and survive the reset.
+bool bme680Begin(uint8_t address, envnode::core::Bme680CalibrationCache& cache,
+                 Bme680CacheUse use) {
+  gSensor = Bme680State();
+  gSensor.address = address;
+
+  const bool cacheValid =
+      use != Bme680CacheUse::Ignore &&
+      envnode::core::Bme680CalibrationCacheValid(cache, address, envnode::core::kBme680ChipId);
+  const bool trusted = cacheValid && use == Bme680CacheUse::Trust;
+  if (!trusted && !chipIdMatches()) {
+    return false;
+  }
+  if (!writeRegister(envnode::core::kBme680RegReset, envnode::core::kBme680ResetCommand)) {
+    return false;
+  }
+  delay(5);
+
+  gSensor.calibrationCached = trusted || (cacheValid && cachedCalibrationMatchesChip(cache));
+  if (!gSensor.calibrationCached && !readCalibration(cache)) {
+    return false;
+  }
+  if (!envnode::core::ParseBme680Calibration(cache.block1, cache.block2, gSensor.calibration)) {
+    return false;
+  }
+
+  const envnode::core::Bme680Settings& settings = gSensor.settings;
+  gSensor.ready =
+      writeRegister(envnode::core::kBme680RegCtrlGas1, 0x00) &&
+      writeRegister(envnode::core::kBme680RegCtrlGas0, 0x08) &&
+      writeRegister(envnode::core::kBme680RegCtrlHum, envnode::core::Bme680CtrlHum(settings)) &&
+      writeRegister(envnode::core::kBme680RegConfig, envnode::core::Bme680Config(settings)) &&
+      writeRegister(envnode::core::kBme680RegCtrlMeas,
+                    envnode::core::Bme680CtrlMeas(settings, false));
+  return gSensor.ready;
+}
+
+bool bme680CalibrationWasCached() {
+  return gSensor.calibrationCached;
+}
+
+// Writing forced mode starts the conversion; the sensor returns to sleep on
+// its own when it is done.
+bool bme680StartMeasurement() {
+  if (!gSensor.ready) {
+    return false;
+  }
+  gSensor.pending = writeRegister(envnode::core::kBme680RegCtrlMeas,
+                                  envnode::core::Bme680CtrlMeas(gSensor.settings, true));
+  gSensor.startedMs = millis();
+  return gSensor.pending;
+}
+
+bool bme680MeasurementPending() {
+  return gSensor.pending;
+}
+
+// Sleeps through the rest of the nominal conversion time, then polls the
+// new-data flag in the same burst that reads the values.
+bool bme680CollectMeasurement(float& temperatureC, float& humidityRh, float& pressureHpa) {
+  if (!gSensor.pending) {
+    return false;
+  }
+  gSensor.pending = false;
+
+  const uint32_t conversionMs = bme680MeasurementMs();
+  const unsigned long elapsedMs = millis() - gSensor.startedMs;
+  if (elapsedMs < conversionMs) {
+    delay(conversionMs - elapsedMs);
+  }
+
+  uint8_t field[envnode::core::kBme680FieldBytes];
+  envnode::core::Bme680RawSample sample;
+  while (true) {
+    if (!readRegisters(envnode::core::kBme680RegField0, field, sizeof(field))) {
+      return false;
+    }
+    sample = envnode::core::DecodeBme680Field(field);
+    if (sample.newData) {
+      break;
+    }
+    if (millis() - gSensor.startedMs >= conversionMs + kCollectGraceMs) {
+      return false;
+    }
+    delay(2);
+  }
+
+  const envnode::core::Bme680Compensated values =
+      envnode::core::CompensateBme680(gSensor.calibration, sample);
+  temperatureC = values.centiCelsius / 100.0f;
+  humidityRh = values.milliPercentRh / 1000.0f;
+  pressureHpa = values.pascals / 100.0f;
+  return true;
+}
+
+uint32_t bme680MeasurementMs() {
+  return envnode::core::Bme680MeasurementMs(gSensor.settings);
+}
@@ -0,0 +1,49 @@
+// Minimal BME680 driver for forced temperature, humidity, and pressure reads.
+//
+// A measurement is split in two: `bme680StartMeasurement()` triggers the
+// conversion and returns at once, and `bme680CollectMeasurement()` waits only
+// for whatever part of the conversion time is left before reading all data
+// registers in one I2C burst. The caller can do other work in between. Register
+// values and the integer compensation come from `envnode::core` (see
+// `bme680.h`); this file only moves bytes over the sensor bus (see
+// `sensor_bus.h`).
+
+#pragma once
+
+#include <Arduino.h>
+#include <bme680.h>
+
+// How `bme680Begin()` treats a calibration cache that is valid for the
+// address. `SpotCheck` compares the chip's own `par_t1` registers first, for a
+// cache restored from NVS after the sensor may have been swapped; `Ignore`
+// always reads the calibration from the sensor.
+enum class Bme680CacheUse {
+  Trust,
+  SpotCheck,
+  Ignore,
+};
+
+// Soft-resets the sensor at `address`, takes its calibration from `cache` or
+// reads it from the sensor, and configures 8x temperature, 4x pressure, and 2x
+// humidity oversampling with the gas heater off. Only a trusted cache skips
+// the chip-ID check. A freshly read calibration is stored back into `cache`.
+// Returns false if any step fails.
+bool bme680Begin(uint8_t address, envnode::core::Bme680CalibrationCache& cache,
+                 Bme680CacheUse use);
+
+// Reports whether the last successful `bme680Begin()` used the cached
+// calibration instead of reading it from the sensor.
+bool bme680CalibrationWasCached();
+
+// Triggers one forced measurement. Returns false on an I2C error.
+bool bme680StartMeasurement();
+
+// Reports whether a measurement was started and has not been collected yet.
+bool bme680MeasurementPending();
+
+// Finishes the pending measurement and returns compensated values in degrees
+// Celsius, percent relative humidity, and hectopascals.
+bool bme680CollectMeasurement(float& temperatureC, float& humidityRh, float& pressureHpa);
+
+// Conversion time of one measurement with the configured oversampling.
+uint32_t bme680MeasurementMs();
@@ -6,7 +6,9 @@
 #include "console.h"
 
 #include "app_context.h"
+#include "espnow_link.h"
 #include "hardware.h"
+#include "journal_store.h"
 #include "runtime.h"
 #include "wifi_manager.h"
 
@@ -23,8 +25,10 @@ void printSerialConfigHelp() {
   Serial.println("  status             Print WiFi/IP/tx power details");
   Serial.println("  scan               Scan nearby WiFi networks");
   Serial.println("  ping               Ping gateway, 1.1.1.1, and google.com");
-  Serial.println("  resolve <host>     Resolve a hostname");
+  Serial.println("  resolve <host>     Resolve a hostname and show the DNS cache");
   Serial.println("  txpower            Print configured WiFi TX power");
+  Serial.println("  journal            Print offline journal size and replay position");
+  Serial.println("  espnow             Print ESP-NOW frame counter or gateway node table");
   Serial.println("  reconnect          Restart STA and reconnect WiFi");
   Serial.println("  sample             Take one local sensor reading (USB service mode)");
   Serial.println("  sample upload      Take one reading and upload it once (USB service mode)");
@@ -75,6 +79,16 @@ void handleSerialCommand(const String& rawCommand) {
     return;
   }
 
+  if (command.equalsIgnoreCase("journal")) {
+    printJournalStatus();
+    return;
+  }
+
+  if (command.equalsIgnoreCase("espnow")) {
+    printEspNowStatus();
+    return;
+  }
+
   if (command.equalsIgnoreCase("reconnect")) {
     connectWiFi();
     return;
@@ -114,12 +128,14 @@ void handleSerialCommand(const String& rawCommand) {
     }
 
     IPAddress resolved;
-    if (WiFi.hostByName(host.c_str(), resolved)) {
-      Serial.printf("Resolved %s -> %s\n", host.c_str(),
-                    resolved.toString().c_str());
+    bool cacheHit = false;
+    if (resolveHost(host.c_str(), resolved, &cacheHit)) {
+      Serial.printf("Resolved %s -> %s (cache %s)\n", host.c_str(),
+                    resolved.toString().c_str(), cacheHit ? "hit" : "miss");
     } else {
       Serial.printf("Failed to resolve %s\n", host.c_str());
     }
+    printDnsCache();
     return;
   }
 
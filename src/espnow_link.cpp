@@ -0,0 +1,379 @@
+// ESP-NOW node and gateway implementation.
+//
+// Frame encoding, replay protection, and row aggregation are decided by
+// `envnode::core` (see `espnow_frame.h` and `espnow_gateway.h`); this file only
+// drives the ESP-NOW driver, the counter reservation in NVS, and the gateway's
+// receive queue.
+
+#include "espnow_link.h"
+
+#include <Preferences.h>
+#include <esp_now.h>
+#include <esp_wifi.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+#include <freertos/queue.h>
+#include <espnow_gateway.h>
+
+#include "journal_store.h"
+#include "telemetry.h"
+#include "wifi_manager.h"
+
+namespace {
+
+using envnode::core::EspNowFrame;
+using envnode::core::kEspNowMaxFrameBytes;
+using envnode::core::kEspNowMaxReadingsPerFrame;
+
+static_assert(sizeof(DEVICE_ID) - 1 <= envnode::core::kEspNowDeviceIdMaxBytes,
+              "DEVICE_ID is too long for an ESP-NOW frame");
+
+constexpr const char* kFrameCounterKey = "espnow_ctr";
+constexpr const char* kGatewayNodesKey = "espnow_nodes";
+
+// Event-group bits set from the send callback.
+constexpr EventBits_t kEspNowAckedBit = 1 << 0;
+constexpr EventBits_t kEspNowFailedBit = 1 << 1;
+
+// Received frames waiting for the awake loop. The driver's receive callback
+// runs on the Wi-Fi task, so it only copies the frame.
+constexpr UBaseType_t kGatewayQueueDepth = 8;
+
+struct ReceivedFrame {
+  uint8_t length;
+  uint8_t data[kEspNowMaxFrameBytes];
+};
+
+EventGroupHandle_t gEspNowEvents = nullptr;
+QueueHandle_t gGatewayFrames = nullptr;
+bool gGatewayListening = false;
+volatile uint32_t gGatewayQueueOverflows = 0;
+envnode::core::EspNowGateway gGateway;
+
+const uint8_t* espNowKey() {
+  return reinterpret_cast<const uint8_t*>(ESPNOW_KEY);
+}
+
+constexpr size_t kEspNowKeyLength = sizeof(ESPNOW_KEY) - 1;
+
+// Uses the configured channel, or the access point's channel from the last
+// association, which is the channel a connected gateway listens on.
+uint8_t espNowChannel() {
+  if (ESPNOW_CHANNEL != 0) {
+    return ESPNOW_CHANNEL;
+  }
+  return gPersistentState.wifiLink.hasAccessPoint ? gPersistentState.wifiLink.channel : 0;
+}
+
+// Restores the counter from its NVS reservation after a cold boot; timer wakes
+// keep it in RTC memory.
+bool ensureFrameCounterLoaded() {
+  auto& counter = gPersistentState.espNowCounter;
+  if (counter.next != 0) {
+    return true;
+  }
+  Preferences prefs;
+  if (!prefs.begin(CONFIG_NAMESPACE, false)) {
+    return false;
+  }
+  const uint32_t reserved = prefs.getULong(kFrameCounterKey, 0);
+  prefs.end();
+  envnode::core::ResumeFrameCounter(counter, reserved);
+  return true;
+}
+
+// Writes a new counter reservation before any frame that uses it goes out.
+bool persistFrameCounterReservation() {
+  Preferences prefs;
+  if (!prefs.begin(CONFIG_NAMESPACE, false)) {
+    return false;
+  }
+  const bool ok = prefs.putULong(kFrameCounterKey, gPersistentState.espNowCounter.reservedUntil) ==
+                  sizeof(uint32_t);
+  prefs.end();
+  return ok;
+}
+
+// The driver reports the gateway radio's MAC-layer acknowledgement here. It
+// means the frame arrived, not that the gateway accepted it.
+void onEspNowSent(const uint8_t* mac, esp_now_send_status_t status) {
+  (void)mac;
+  if (gEspNowEvents) {
+    xEventGroupSetBits(gEspNowEvents,
+                       status == ESP_NOW_SEND_SUCCESS ? kEspNowAckedBit : kEspNowFailedBit);
+  }
+}
+
+// Copies a received frame into the queue; the awake loop verifies it.
+void onEspNowReceived(const uint8_t* mac, const uint8_t* data, int length) {
+  (void)mac;
+  if (!gGatewayFrames || length <= 0 || length > static_cast<int>(kEspNowMaxFrameBytes)) {
+    return;
+  }
+  ReceivedFrame frame;
+  frame.length = static_cast<uint8_t>(length);
+  memcpy(frame.data, data, length);
+  if (xQueueSend(gGatewayFrames, &frame, 0) != pdTRUE) {
+    ++gGatewayQueueOverflows;
+  }
+}
+
+// Brings the station interface up on `channel` without associating, then
+// starts ESP-NOW with the gateway as its only peer.
+bool startEspNowNode(uint8_t channel) {
+  if (!gEspNowEvents) {
+    gEspNowEvents = xEventGroupCreate();
+  }
+  WiFi.mode(WIFI_STA);
+  esp_wifi_set_channel(channel, WIFI_SECOND_CHAN_NONE);
+  esp_err_t err = esp_now_init();
+  if (err != ESP_OK) {
+    Serial.printf("ESP-NOW: init failed (%s)\n", esp_err_to_name(err));
+    return false;
+  }
+  esp_now_register_send_cb(onEspNowSent);
+
+  esp_now_peer_info_t peer = {};
+  memcpy(peer.peer_addr, ESPNOW_GATEWAY_MAC_BYTES, sizeof(peer.peer_addr));
+  peer.channel = channel;
+  peer.ifidx = WIFI_IF_STA;
+  peer.encrypt = false;
+  err = esp_now_add_peer(&peer);
+  if (err != ESP_OK) {
+    Serial.printf("ESP-NOW: adding gateway peer failed (%s)\n", esp_err_to_name(err));
+    esp_now_deinit();
+    return false;
+  }
+  return true;
+}
+
+// Sends one encoded frame and waits for the gateway radio's acknowledgement.
+bool sendFrameAndWaitForAck(const uint8_t* data, size_t length) {
+  xEventGroupClearBits(gEspNowEvents, kEspNowAckedBit | kEspNowFailedBit);
+  if (esp_now_send(ESPNOW_GATEWAY_MAC_BYTES, data, length) != ESP_OK) {
+    return false;
+  }
+  const EventBits_t bits =
+      xEventGroupWaitBits(gEspNowEvents, kEspNowAckedBit | kEspNowFailedBit, pdTRUE, pdFALSE,
+                          pdMS_TO_TICKS(ESPNOW_ACK_TIMEOUT_MS));
+  return (bits & kEspNowAckedBit) != 0;
+}
+
+// Restores the node table saved at the last successful flush.
+void loadGatewayNodes() {
+  Preferences prefs;
+  if (!prefs.begin(CONFIG_NAMESPACE, true)) {
+    return;
+  }
+  const size_t bytes = prefs.getBytesLength(kGatewayNodesKey);
+  if (bytes > 0 && bytes <= sizeof(gGateway.nodes) &&
+      bytes % sizeof(envnode::core::GatewayNode) == 0) {
+    prefs.getBytes(kGatewayNodesKey, gGateway.nodes, bytes);
+    gGateway.nodeCount = static_cast<uint8_t>(bytes / sizeof(envnode::core::GatewayNode));
+  }
+  prefs.end();
+}
+
+// Saves each node's last accepted counter. Only done after an upload, so a
+// gateway power loss can at most re-accept frames from its last flush window.
+void persistGatewayNodes() {
+  Preferences prefs;
+  if (!prefs.begin(CONFIG_NAMESPACE, false)) {
+    return;
+  }
+  prefs.putBytes(kGatewayNodesKey, gGateway.nodes,
+                 gGateway.nodeCount * sizeof(envnode::core::GatewayNode));
+  prefs.end();
+}
+
+}  // namespace
+
+// Frames are built oldest-first, so an unacknowledged frame leaves the ring in
+// order and the next wake resends the same readings under a new counter.
+bool sendPendingReadingsOverEspNow() {
+  auto& ring = gPersistentState.pendingReadings;
+  if (ring.count == 0) {
+    return true;
+  }
+  const uint8_t channel = espNowChannel();
+  if (channel == 0) {
+    Serial.println("ESP-NOW: gateway channel unknown until Wi-Fi has connected once.");
+    return false;
+  }
+  if (!ensureFrameCounterLoaded()) {
+    Serial.println("ESP-NOW: could not load the frame counter.");
+    return false;
+  }
+
+  const unsigned long startedMs = millis();
+  if (!startEspNowNode(channel)) {
+    shutdownWiFi();
+    return false;
+  }
+
+  unsigned framesAcked = 0;
+  unsigned readingsAcked = 0;
+  bool ok = true;
+  while (ring.count > 0) {
+    EspNowFrame frame;
+    strncpy(frame.deviceId, DEVICE_ID, envnode::core::kEspNowDeviceIdMaxBytes);
+    const size_t rows =
+        ring.count < kEspNowMaxReadingsPerFrame ? ring.count : kEspNowMaxReadingsPerFrame;
+    frame.readingCount = static_cast<uint8_t>(rows);
+    for (size_t i = 0; i < rows; ++i) {
+      frame.readings[i] = *envnode::core::ReadingAt(ring, i);
+    }
+    if (envnode::core::TakeFrameCounter(gPersistentState.espNowCounter, frame.counter) &&
+        !persistFrameCounterReservation()) {
+      // Without the reservation on flash, a power loss could reuse this value.
+      Serial.println("ESP-NOW: could not persist the frame counter reservation.");
+      gPersistentState.espNowCounter.next = 0;
+      ok = false;
+      break;
+    }
+
+    uint8_t encoded[kEspNowMaxFrameBytes];
+    const size_t length =
+        envnode::core::EncodeEspNowFrame(frame, espNowKey(), kEspNowKeyLength, encoded,
+                                         sizeof(encoded));
+    if (length == 0 || !sendFrameAndWaitForAck(encoded, length)) {
+      ok = false;
+      break;
+    }
+    envnode::core::DropOldestReadings(ring, rows);
+    ++framesAcked;
+    readingsAcked += rows;
+  }
+
+  esp_now_deinit();
+  shutdownWiFi();
+  Serial.printf("ESP-NOW: %s on channel %u (%u frame(s), %u reading(s) acked, %u pending) in %lu ms\n",
+                ok ? "sent" : "send failed",
+                static_cast<unsigned>(channel),
+                framesAcked,
+                readingsAcked,
+                static_cast<unsigned>(ring.count),
+                millis() - startedMs);
+  return ok;
+}
+
+// The listener itself starts from `serviceEspNowGateway()`, because ESP-NOW
+// needs the station interface the Wi-Fi connect brings up.
+void beginEspNowGateway() {
+  if (!gGatewayFrames) {
+    gGatewayFrames = xQueueCreate(kGatewayQueueDepth, sizeof(ReceivedFrame));
+  }
+  loadGatewayNodes();
+  Serial.printf("ESP-NOW gateway: %u known node(s) restored.\n",
+                static_cast<unsigned>(gGateway.nodeCount));
+}
+
+// Frames are verified here rather than in the receive callback, so HMAC work
+// never blocks the Wi-Fi task.
+void serviceEspNowGateway() {
+  if (!gGatewayListening) {
+    if (WiFi.getMode() == WIFI_OFF) {
+      return;
+    }
+    // Modem sleep would make the gateway miss frames between beacons.
+    WiFi.setSleep(false);
+    const esp_err_t err = esp_now_init();
+    if (err != ESP_OK) {
+      Serial.printf("ESP-NOW gateway: init failed (%s)\n", esp_err_to_name(err));
+      return;
+    }
+    esp_now_register_recv_cb(onEspNowReceived);
+    gGatewayListening = true;
+    Serial.println("ESP-NOW gateway: listening.");
+  }
+
+  const bool uploadsDown =
+      !gApp.networkAvailable || envnode::core::GatewayUploadBackingOff(gGateway, rtcClockSeconds());
+  ReceivedFrame frame;
+  while (gGatewayFrames && xQueueReceive(gGatewayFrames, &frame, 0) == pdTRUE) {
+    // The nodes dropped these rows when the frames were acked, so while uploads
+    // are down a queue without room for another frame moves to flash instead of
+    // losing its oldest rows.
+    if (uploadsDown && JOURNAL_ENABLED &&
+        gGateway.rowCount + kEspNowMaxReadingsPerFrame > envnode::core::kGatewayRowCapacity) {
+      spillGatewayRowsToJournal(gGateway);
+    }
+    const envnode::core::GatewayAccept outcome =
+        envnode::core::AcceptGatewayFrame(gGateway, frame.data, frame.length, espNowKey(),
+                                          kEspNowKeyLength, rtcClockSeconds(),
+                                          currentEpochSeconds());
+    if (outcome != envnode::core::GatewayAccept::Accepted) {
+      Serial.printf("ESP-NOW gateway: frame %s\n", envnode::core::GatewayAcceptName(outcome));
+    }
+  }
+
+  if (!gApp.networkAvailable ||
+      !envnode::core::GatewayFlushDue(gGateway, ESPNOW_GATEWAY_FLUSH_ROWS,
+                                      ESPNOW_GATEWAY_MAX_HOLD_SECONDS, rtcClockSeconds())) {
+    return;
+  }
+  // Gateway uploads run outside any sample run, so they are not bound by a
+  // wake budget.
+  envnode::core::StartWakeBudget(gApp.wakeBudget, millis(), 0);
+  const size_t rows = uploadGatewayReadingBatch(gGateway, ESPNOW_GATEWAY_FLUSH_ROWS);
+  envnode::core::RecordGatewayUpload(gGateway, rows > 0, ESPNOW_GATEWAY_MAX_HOLD_SECONDS,
+                                     rtcClockSeconds());
+  if (rows == 0) {
+    Serial.printf("ESP-NOW gateway: upload failed (%u row(s) queued); retrying in %lu s\n",
+                  static_cast<unsigned>(gGateway.rowCount),
+                  static_cast<unsigned long>(gGateway.uploadRetrySeconds));
+    return;
+  }
+  Serial.printf("ESP-NOW gateway: upload ok (%u row(s), %u still queued)\n",
+                static_cast<unsigned>(rows),
+                static_cast<unsigned>(gGateway.rowCount - rows));
+  envnode::core::DropGatewayRows(gGateway, rows);
+  persistGatewayNodes();
+  // Rows spilled during an outage go out as soon as uploads work again.
+  if (journalHasPendingData()) {
+    replayJournal();
+  }
+}
+
+// Prints either side's state for the `espnow` console command.
+void printEspNowStatus() {
+  if (ESPNOW_UPLINK_ENABLED) {
+    Serial.printf("ESP-NOW uplink: channel %u, next counter %lu, reserved until %lu, %u reading(s) pending\n",
+                  static_cast<unsigned>(espNowChannel()),
+                  static_cast<unsigned long>(gPersistentState.espNowCounter.next),
+                  static_cast<unsigned long>(gPersistentState.espNowCounter.reservedUntil),
+                  static_cast<unsigned>(pendingReadingCount()));
+    return;
+  }
+  if (!ESPNOW_GATEWAY_ENABLED) {
+    Serial.println("ESP-NOW: disabled (set ESPNOW_UPLINK or ESPNOW_GATEWAY).");
+    return;
+  }
+
+  const envnode::core::GatewayStats& stats = gGateway.stats;
+  Serial.printf("ESP-NOW gateway: %s, %u row(s) queued, %u node(s)\n",
+                gGatewayListening ? "listening" : "waiting for Wi-Fi",
+                static_cast<unsigned>(gGateway.rowCount),
+                static_cast<unsigned>(gGateway.nodeCount));
+  if (envnode::core::GatewayUploadBackingOff(gGateway, rtcClockSeconds())) {
+    Serial.printf("  upload failed; next attempt within %lu s\n",
+                  static_cast<unsigned long>(gGateway.uploadRetrySeconds));
+  }
+  Serial.printf("  frames: %lu accepted, %lu malformed, %lu bad tag, %lu replayed, "
+                "%lu node table full, %lu queue overflow(s), %lu row(s) dropped\n",
+                static_cast<unsigned long>(stats.accepted),
+                static_cast<unsigned long>(stats.malformed),
+                static_cast<unsigned long>(stats.badTag),
+                static_cast<unsigned long>(stats.replayed),
+                static_cast<unsigned long>(stats.nodeTableFull),
+                static_cast<unsigned long>(gGatewayQueueOverflows),
+                static_cast<unsigned long>(stats.droppedRows));
+  for (size_t i = 0; i < gGateway.nodeCount; ++i) {
+    const envnode::core::GatewayNode& node = gGateway.nodes[i];
+    Serial.printf("  %-32s counter=%lu frames=%lu last seen %lu s ago\n",
+                  node.deviceId,
+                  static_cast<unsigned long>(node.lastCounter),
+                  static_cast<unsigned long>(node.frames),
+                  static_cast<unsigned long>(rtcClockSeconds() - node.lastSeenSeconds));
+  }
+}
@@ -0,0 +1,31 @@
+// ESP-NOW uplink between battery nodes and a mains-powered gateway.
+//
+// With `ESPNOW_UPLINK` a node sends its pending readings to the gateway as
+// authenticated ESP-NOW frames (see `espnow_frame.h`) instead of associating
+// with the access point, which leaves the radio on for a few milliseconds
+// rather than a few seconds. A gateway build (`ESPNOW_GATEWAY`) stays awake,
+// verifies the frames of all its nodes, and uploads their readings together
+// through the normal Supabase path (see `espnow_gateway.h`).
+
+#pragma once
+
+#include "app_context.h"
+
+// Sends the retained readings to the gateway, one frame of up to eight readings
+// at a time, and drops each frame's readings once the gateway's radio has
+// acknowledged it. Returns true when the ring is empty afterwards; readings
+// that were not acknowledged stay queued for the next wake.
+bool sendPendingReadingsOverEspNow();
+
+// Prepares the gateway: creates the receive queue and restores the node table,
+// so counters accepted before a restart are still rejected as replays.
+void beginEspNowGateway();
+
+// Starts listening once Wi-Fi is up, verifies queued frames, and uploads the
+// collected rows when a flush is due and the network is available. Called from
+// the awake loop.
+void serviceEspNowGateway();
+
+// Prints the frame counter on a node, or the node table, queue, and frame
+// statistics on a gateway.
+void printEspNowStatus();
@@ -7,6 +7,8 @@
 
 #include <core_logic.h>
 
+#include "journal_store.h"
+#include "telemetry.h"
 #include "wifi_manager.h"
 
 // Drives the sensor power-control transistor low during boot.
@@ -24,6 +26,7 @@ void enableSensePower() {
 
   digitalWrite(SENSE_EN_PIN, HIGH);
   gApp.sensePowerEnabled = true;
+  gApp.sensePowerOnMs = millis();
 }
 
 // Cuts power to the sensor rail and invalidates any cached sensor state that
@@ -104,20 +107,14 @@ bool isUsbHostAttached() {
   #endif
 }
 
-// Gives the powered sensor rail time to stabilize before the first I2C access.
-void waitForSensorPowerRail() {
-  if (SENSOR_POWER_SETTLE_MS == 0) {
-    return;
-  }
-
-  Serial.printf("Sensor power settle: waiting %lu ms before BME init.\n",
-                static_cast<unsigned long>(SENSOR_POWER_SETTLE_MS));
-  delay(SENSOR_POWER_SETTLE_MS);
-}
-
 // Applies the firmware's sleep policy, including the rule that only
 // startup sensor/bootstrap faults can block sleep for diagnostics.
 void enterDeepSleep() {
+  if (!flushPendingEvents()) {
+    spillEventsToJournal();
+  }
+  closeTelemetryConnections();
+
   #if DISABLE_DEEP_SLEEP
   setAwakeLed(true);
   Serial.printf("Deep sleep disabled; WiFi status=%d. Staying awake.\n",
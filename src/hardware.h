@@ -34,9 +34,6 @@ void blinkColdBootSuccessLed();
 // Detects whether a USB host is currently attached to the native USB port.
 bool isUsbHostAttached();
 
-// Waits for the powered sensor rail to settle before I2C access begins.
-void waitForSensorPowerRail();
-
 // Transitions the device into deep sleep unless diagnostics are intentionally
 // keeping it awake.
 void enterDeepSleep();
@@ -0,0 +1,545 @@
+// LittleFS-backed store-and-forward journal.
+//
+// Records are appended to segment files named by sequence number under
+// `/journal`. A segment is closed once the next record would push it past
+// `JOURNAL_SEGMENT_BYTES`, so every flash block is written once and erased only
+// when the whole segment is deleted after replay or evicted by the byte cap.
+// The replay position lives in a small CRC-checked cursor file that is
+// rewritten only after each accepted bulk insert. Decisions about rotation,
+// eviction, and cursor movement are made by `envnode::core` (see `journal.h`);
+// this file only carries them out on flash.
+
+#include "journal_store.h"
+
+#include <LittleFS.h>
+#include <journal.h>
+
+#include "telemetry.h"
+
+namespace {
+
+using envnode::core::JournalAppendPlan;
+using envnode::core::JournalCursor;
+using envnode::core::JournalDecodeStatus;
+using envnode::core::JournalLayout;
+using envnode::core::JournalRecordType;
+using envnode::core::JournalRecordView;
+using envnode::core::kJournalDeviceIdMaxBytes;
+using envnode::core::kJournalGatewayReadingPayloadBytes;
+using envnode::core::kJournalHeaderBytes;
+using envnode::core::kJournalMaxPayloadBytes;
+using envnode::core::kJournalReadingPayloadBytes;
+
+static_assert(envnode::core::kEspNowDeviceIdMaxBytes <= kJournalDeviceIdMaxBytes,
+              "gateway rows must fit a journal record");
+
+constexpr const char* kJournalDirectory = "/journal";
+constexpr const char* kJournalCursorPath = "/journal/cursor";
+constexpr size_t kJournalPathBytes = 32;
+constexpr size_t kJournalRecordBufferBytes = kJournalHeaderBytes + kJournalMaxPayloadBytes;
+
+// One upload's worth of replayed records. Batches hold a single record type so
+// a failed insert never causes the other table's rows to be sent twice.
+struct ReplayBatch {
+  JournalRecordType type = JournalRecordType::Reading;
+  size_t records = 0;
+  uint32_t skippedBytes = 0;
+  JournalCursor end;
+};
+
+bool gJournalMounted = false;
+bool gJournalLoaded = false;
+JournalLayout gJournalLayout;
+File gActiveSegment;
+uint32_t gActiveSequence = 0;
+uint8_t gRecordBuffer[kJournalRecordBufferBytes];
+envnode::core::ReadingRing gReplayReadings;
+envnode::core::EventBatch gReplayEvents;
+envnode::core::EspNowGateway gReplayGateway;
+
+// Formats the file path for segment `sequence`.
+void segmentPath(uint32_t sequence, char* path) {
+  snprintf(path, kJournalPathBytes, "%s/%08lx.seg", kJournalDirectory,
+           static_cast<unsigned long>(sequence));
+}
+
+// Parses a segment file name such as `0000002a.seg`. Returns false for any
+// other file in the journal directory.
+bool parseSegmentName(const char* name, uint32_t& sequence) {
+  const char* base = strrchr(name, '/');
+  base = base ? base + 1 : name;
+  char* end = nullptr;
+  unsigned long value = strtoul(base, &end, 16);
+  if (end == base || strcmp(end, ".seg") != 0) {
+    return false;
+  }
+  sequence = static_cast<uint32_t>(value);
+  return true;
+}
+
+// Mirrors the unreplayed size into RTC memory for the next wake.
+void publishPendingBytes() {
+  gPersistentState.journalPendingBytes = envnode::core::JournalPendingBytes(gJournalLayout);
+  gPersistentState.journalStateKnown = true;
+}
+
+// Reads the persisted cursor. A missing or damaged file means replay starts at
+// the oldest segment, which may resend rows but never skips any.
+JournalCursor loadCursor() {
+  JournalCursor cursor;
+  File file = LittleFS.open(kJournalCursorPath, "r");
+  if (!file) {
+    return cursor;
+  }
+
+  uint8_t raw[12];
+  const bool complete = file.read(raw, sizeof(raw)) == sizeof(raw);
+  file.close();
+  uint32_t crc = 0;
+  memcpy(&crc, raw + 8, sizeof(crc));
+  if (!complete || crc != envnode::core::Crc32(raw, 8)) {
+    Serial.println("Journal: cursor file damaged; replaying from the oldest segment.");
+    return cursor;
+  }
+  memcpy(&cursor.sequence, raw, sizeof(cursor.sequence));
+  memcpy(&cursor.offset, raw + 4, sizeof(cursor.offset));
+  return cursor;
+}
+
+// Persists the cursor with a CRC so a torn write is detected on the next load.
+bool saveCursor(const JournalCursor& cursor) {
+  uint8_t raw[12];
+  memcpy(raw, &cursor.sequence, sizeof(cursor.sequence));
+  memcpy(raw + 4, &cursor.offset, sizeof(cursor.offset));
+  const uint32_t crc = envnode::core::Crc32(raw, 8);
+  memcpy(raw + 8, &crc, sizeof(crc));
+
+  File file = LittleFS.open(kJournalCursorPath, "w");
+  if (!file) {
+    return false;
+  }
+  const bool ok = file.write(raw, sizeof(raw)) == sizeof(raw);
+  file.close();
+  return ok;
+}
+
+// Mounts LittleFS on first use, formatting it if it has never been used.
+bool mountJournal() {
+  if (gJournalMounted) {
+    return true;
+  }
+  if (!LittleFS.begin(true)) {
+    Serial.println("Journal: LittleFS mount failed.");
+    return false;
+  }
+  if (!LittleFS.exists(kJournalDirectory) && !LittleFS.mkdir(kJournalDirectory)) {
+    Serial.println("Journal: could not create the journal directory.");
+    return false;
+  }
+  gJournalMounted = true;
+  return true;
+}
+
+// Rebuilds the segment table from the files on flash.
+bool loadJournal() {
+  if (gJournalLoaded) {
+    return true;
+  }
+  if (!JOURNAL_ENABLED || !mountJournal()) {
+    return false;
+  }
+
+  gJournalLayout = JournalLayout();
+  File directory = LittleFS.open(kJournalDirectory);
+  for (File entry = directory.openNextFile(); entry; entry = directory.openNextFile()) {
+    uint32_t sequence = 0;
+    if (parseSegmentName(entry.name(), sequence) &&
+        !envnode::core::AddJournalSegment(gJournalLayout, sequence,
+                                          static_cast<uint32_t>(entry.size()))) {
+      Serial.printf("Journal: ignoring %s (segment table full).\n", entry.name());
+    }
+    entry.close();
+  }
+  directory.close();
+
+  gJournalLayout.cursor = loadCursor();
+  if (gJournalLayout.count > 0 &&
+      gJournalLayout.cursor.sequence < gJournalLayout.segments[0].sequence) {
+    gJournalLayout.cursor = JournalCursor{gJournalLayout.segments[0].sequence, 0};
+  }
+  envnode::core::AdvanceJournalCursor(gJournalLayout, gJournalLayout.cursor);
+  gJournalLoaded = true;
+  publishPendingBytes();
+  return true;
+}
+
+// Closes the segment currently open for appending.
+void closeActiveSegment() {
+  if (gActiveSegment) {
+    gActiveSegment.close();
+  }
+}
+
+// Deletes the `count` oldest segment files and drops them from the table.
+void removeOldestSegments(size_t count) {
+  char path[kJournalPathBytes];
+  for (size_t i = 0; i < count && i < gJournalLayout.count; ++i) {
+    if (gJournalLayout.segments[i].sequence == gActiveSequence) {
+      closeActiveSegment();
+    }
+    segmentPath(gJournalLayout.segments[i].sequence, path);
+    LittleFS.remove(path);
+  }
+  envnode::core::DropOldestJournalSegments(gJournalLayout, count);
+}
+
+// Appends one encoded record, rotating and evicting segments as planned.
+bool appendRecord(JournalRecordType type, const uint8_t* payload, size_t length) {
+  const size_t recordBytes = envnode::core::EncodeJournalRecord(
+      type, payload, length, gRecordBuffer, sizeof(gRecordBuffer));
+  if (!recordBytes) {
+    return false;
+  }
+
+  const JournalAppendPlan plan = envnode::core::PlanJournalAppend(
+      gJournalLayout, recordBytes, JOURNAL_SEGMENT_BYTES, JOURNAL_MAX_BYTES);
+  if (plan.evictedUnreplayedBytes) {
+    Serial.printf("Journal: cap reached; evicting %u segment(s), %lu unsent byte(s) lost.\n",
+                  static_cast<unsigned>(plan.evictSegments),
+                  static_cast<unsigned long>(plan.evictedUnreplayedBytes));
+  }
+  removeOldestSegments(plan.evictSegments);
+
+  if (!gActiveSegment || gActiveSequence != plan.sequence) {
+    closeActiveSegment();
+    char path[kJournalPathBytes];
+    segmentPath(plan.sequence, path);
+    gActiveSegment = LittleFS.open(path, "a");
+    gActiveSequence = plan.sequence;
+    if (!gActiveSegment) {
+      Serial.printf("Journal: could not open %s for append.\n", path);
+      return false;
+    }
+  }
+
+  const size_t written = gActiveSegment.write(gRecordBuffer, recordBytes);
+  if (written) {
+    // A short write leaves a torn record that replay skips over.
+    envnode::core::ApplyJournalAppend(gJournalLayout, plan, written);
+  }
+  return written == recordBytes;
+}
+
+// Adds one decoded record to the replay batch. Returns false when the record
+// belongs in the next batch.
+bool acceptReplayRecord(ReplayBatch& batch, const JournalRecordView& record) {
+  if (batch.records > 0 && record.type != batch.type) {
+    return false;
+  }
+
+  if (record.type == JournalRecordType::Reading) {
+    envnode::core::BatchedReading reading;
+    if (!envnode::core::DecodeReadingPayload(record.payload, record.length, reading)) {
+      batch.skippedBytes += record.totalBytes;
+      return true;
+    }
+    if (gReplayReadings.count == envnode::core::kReadingRingCapacity) {
+      return false;
+    }
+    envnode::core::PushReading(gReplayReadings, reading);
+  } else if (record.type == JournalRecordType::GatewayReading) {
+    envnode::core::BatchedReading reading;
+    char deviceId[kJournalDeviceIdMaxBytes + 1];
+    if (!envnode::core::DecodeGatewayReadingPayload(record.payload, record.length, reading,
+                                                     deviceId)) {
+      batch.skippedBytes += record.totalBytes;
+      return true;
+    }
+    if (gReplayGateway.rowCount >= ESPNOW_GATEWAY_FLUSH_ROWS ||
+        !envnode::core::QueueGatewayRow(gReplayGateway, deviceId, reading, 0)) {
+      return false;
+    }
+  } else if (!envnode::core::AppendEventRowsPayload(gReplayEvents, record.payload,
+                                                    record.length)) {
+    if (gReplayEvents.count > 0) {
+      return false;
+    }
+    batch.skippedBytes += record.totalBytes;
+    return true;
+  }
+
+  batch.type = record.type;
+  ++batch.records;
+  return true;
+}
+
+// Reads records from the cursor onward until one upload's worth is collected
+// or the journal ends. Corrupt bytes are skipped by scanning for the next
+// record, and a torn record at the end of a segment is skipped entirely.
+ReplayBatch collectReplayBatch() {
+  ReplayBatch batch;
+  batch.end = gJournalLayout.cursor;
+  envnode::core::ResetReadingRing(gReplayReadings);
+  envnode::core::ResetEventBatch(gReplayEvents);
+  gReplayGateway.rowCount = 0;
+  gReplayGateway.nodeCount = 0;
+
+  for (size_t i = 0; i < gJournalLayout.count; ++i) {
+    const auto& segment = gJournalLayout.segments[i];
+    if (segment.sequence < batch.end.sequence) {
+      continue;
+    }
+    uint32_t offset = segment.sequence == batch.end.sequence ? batch.end.offset : 0;
+
+    char path[kJournalPathBytes];
+    segmentPath(segment.sequence, path);
+    File file = LittleFS.open(path, "r");
+    if (!file) {
+      batch.skippedBytes += segment.bytes - offset;
+      batch.end = JournalCursor{segment.sequence, segment.bytes};
+      continue;
+    }
+
+    bool full = false;
+    while (offset < segment.bytes && !full) {
+      const size_t remaining = segment.bytes - offset;
+      file.seek(offset);
+      const size_t available =
+          file.read(gRecordBuffer, remaining < sizeof(gRecordBuffer) ? remaining
+                                                                     : sizeof(gRecordBuffer));
+      if (!available) {
+        batch.skippedBytes += remaining;
+        offset = segment.bytes;
+        break;
+      }
+
+      size_t used = 0;
+      while (used < available) {
+        JournalRecordView record;
+        const JournalDecodeStatus status = envnode::core::DecodeJournalRecord(
+            gRecordBuffer + used, available - used, record);
+        if (status == JournalDecodeStatus::NeedMoreData) {
+          if (available == remaining) {
+            batch.skippedBytes += available - used;
+            used = available;
+          }
+          break;
+        }
+        if (status == JournalDecodeStatus::Corrupt) {
+          const size_t skip =
+              envnode::core::FindNextJournalRecord(gRecordBuffer + used, available - used);
+          batch.skippedBytes += skip;
+          used += skip;
+          continue;
+        }
+        if (!acceptReplayRecord(batch, record)) {
+          full = true;
+          break;
+        }
+        used += record.totalBytes;
+      }
+      offset += used;
+    }
+    file.close();
+    batch.end = JournalCursor{segment.sequence, offset};
+    if (full) {
+      break;
+    }
+  }
+  return batch;
+}
+
+// Uploads the collected batch of `type` records at backlog priority.
+bool uploadReplayBatch(JournalRecordType type) {
+  switch (type) {
+    case JournalRecordType::Reading:
+      return uploadReadingBatch(gReplayReadings, envnode::core::WakePriority::Backlog);
+    case JournalRecordType::EventRows:
+      return uploadEventBatch(gReplayEvents, envnode::core::WakePriority::Backlog);
+    case JournalRecordType::GatewayReading:
+      return uploadGatewayReadingBatch(gReplayGateway, gReplayGateway.rowCount,
+                                       envnode::core::WakePriority::Backlog) ==
+             gReplayGateway.rowCount;
+  }
+  return false;
+}
+
+// Returns a printable name for records of `type`.
+const char* replayRecordName(JournalRecordType type) {
+  switch (type) {
+    case JournalRecordType::Reading:
+      return "reading";
+    case JournalRecordType::EventRows:
+      return "event";
+    case JournalRecordType::GatewayReading:
+      return "gateway reading";
+  }
+  return "unknown";
+}
+
+// Deletes replayed segments, or the whole journal once nothing is pending.
+void compactJournal() {
+  if (envnode::core::JournalPendingBytes(gJournalLayout) == 0) {
+    removeOldestSegments(gJournalLayout.count);
+    LittleFS.remove(kJournalCursorPath);
+    gJournalLayout = JournalLayout();
+  } else {
+    removeOldestSegments(envnode::core::ReplayedJournalSegments(gJournalLayout));
+  }
+  publishPendingBytes();
+}
+
+}  // namespace
+
+// Writes one record per retained reading, then clears the ring.
+bool spillReadingsToJournal() {
+  auto& ring = gPersistentState.pendingReadings;
+  if (ring.count == 0) {
+    return true;
+  }
+  if (!loadJournal()) {
+    return false;
+  }
+
+  uint8_t payload[kJournalReadingPayloadBytes];
+  size_t stored = 0;
+  while (stored < ring.count) {
+    envnode::core::EncodeReadingPayload(*envnode::core::ReadingAt(ring, stored), payload);
+    if (!appendRecord(JournalRecordType::Reading, payload, sizeof(payload))) {
+      break;
+    }
+    ++stored;
+  }
+  closeActiveSegment();
+  envnode::core::DropOldestReadings(ring, stored);
+  publishPendingBytes();
+
+  Serial.printf("Journal: stored %u reading(s) for later upload (%lu byte(s) pending).\n",
+                static_cast<unsigned>(stored),
+                static_cast<unsigned long>(gPersistentState.journalPendingBytes));
+  return ring.count == 0;
+}
+
+// Writes one record per queued row, then drops the stored rows.
+bool spillGatewayRowsToJournal(envnode::core::EspNowGateway& gateway) {
+  if (gateway.rowCount == 0) {
+    return true;
+  }
+  if (!loadJournal()) {
+    return false;
+  }
+
+  uint8_t payload[kJournalGatewayReadingPayloadBytes];
+  size_t stored = 0;
+  while (stored < gateway.rowCount) {
+    const envnode::core::GatewayRow& row = gateway.rows[stored];
+    const size_t length = envnode::core::EncodeGatewayReadingPayload(
+        row.reading, gateway.nodes[row.node].deviceId, payload);
+    if (!length || !appendRecord(JournalRecordType::GatewayReading, payload, length)) {
+      break;
+    }
+    ++stored;
+  }
+  closeActiveSegment();
+  envnode::core::DropGatewayRows(gateway, stored);
+  publishPendingBytes();
+
+  Serial.printf("Journal: stored %u gateway row(s) for later upload (%lu byte(s) pending).\n",
+                static_cast<unsigned>(stored),
+                static_cast<unsigned long>(gPersistentState.journalPendingBytes));
+  return gateway.rowCount == 0;
+}
+
+// Writes the buffered events as a single record, then clears the buffer.
+bool spillEventsToJournal() {
+  auto& batch = gApp.pendingEvents;
+  if (batch.count == 0) {
+    return true;
+  }
+  if (!loadJournal()) {
+    return false;
+  }
+
+  static uint8_t payload[kJournalMaxPayloadBytes];
+  const size_t length = envnode::core::EncodeEventRowsPayload(batch, payload, sizeof(payload));
+  const bool ok = length && appendRecord(JournalRecordType::EventRows, payload, length);
+  closeActiveSegment();
+  publishPendingBytes();
+  if (!ok) {
+    Serial.println("Journal: failed to store buffered events.");
+    return false;
+  }
+
+  Serial.printf("Journal: stored %u event(s) for later upload.\n",
+                static_cast<unsigned>(batch.count));
+  envnode::core::ResetEventBatch(batch);
+  return true;
+}
+
+// Trusts the RTC mirror on timer wakes so an empty journal costs no mount.
+bool journalHasPendingData() {
+  if (!JOURNAL_ENABLED) {
+    return false;
+  }
+  if (!gPersistentState.journalStateKnown && !loadJournal()) {
+    return false;
+  }
+  return gPersistentState.journalPendingBytes > 0;
+}
+
+// Uploads oldest-first and persists the cursor after every accepted insert, so
+// an interrupted replay resumes without resending earlier batches.
+bool replayJournal() {
+  if (!journalHasPendingData()) {
+    return true;
+  }
+  if (!gApp.networkAvailable || !loadJournal()) {
+    return false;
+  }
+
+  for (uint32_t round = 0; round < JOURNAL_REPLAY_MAX_BATCHES; ++round) {
+    const ReplayBatch batch = collectReplayBatch();
+    if (batch.records > 0) {
+      if (!uploadReplayBatch(batch.type)) {
+        Serial.println("Journal: replay upload failed; will retry next time.");
+        return false;
+      }
+    }
+    if (batch.skippedBytes) {
+      Serial.printf("Journal: skipped %lu damaged byte(s) during replay.\n",
+                    static_cast<unsigned long>(batch.skippedBytes));
+    }
+
+    envnode::core::AdvanceJournalCursor(gJournalLayout, batch.end);
+    saveCursor(gJournalLayout.cursor);
+    compactJournal();
+    Serial.printf("Journal: replayed %u %s record(s), %lu byte(s) still pending.\n",
+                  static_cast<unsigned>(batch.records),
+                  replayRecordName(batch.type),
+                  static_cast<unsigned long>(gPersistentState.journalPendingBytes));
+    if (gPersistentState.journalPendingBytes == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Loads the journal if needed and prints its footprint and replay position.
+void printJournalStatus() {
+  if (!JOURNAL_ENABLED) {
+    Serial.println("Journal: disabled (JOURNAL_MAX_BYTES=0).");
+    return;
+  }
+  if (!loadJournal()) {
+    Serial.println("Journal: unavailable.");
+    return;
+  }
+
+  Serial.printf("Journal: %lu of %lu byte(s) used in %u segment(s), %lu pending, cursor %08lx+%lu\n",
+                static_cast<unsigned long>(envnode::core::JournalTotalBytes(gJournalLayout)),
+                static_cast<unsigned long>(JOURNAL_MAX_BYTES),
+                static_cast<unsigned>(gJournalLayout.count),
+                static_cast<unsigned long>(gPersistentState.journalPendingBytes),
+                static_cast<unsigned long>(gJournalLayout.cursor.sequence),
+                static_cast<unsigned long>(gJournalLayout.cursor.offset));
+}
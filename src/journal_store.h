@@ -0,0 +1,38 @@
+// Flash-backed store-and-forward journal for offline periods.
+//
+// When Wi-Fi is unavailable, readings from the retained ring and events that
+// could not be uploaded before sleep are appended to a CRC-protected journal
+// on LittleFS instead of being overwritten or lost with RTC memory. The next
+// time the network is up, the journal is replayed oldest-first in bulk
+// inserts and deleted segment by segment.
+
+#pragma once
+
+#include <espnow_gateway.h>
+
+#include "app_context.h"
+
+// Moves every reading in the retained ring into the journal and clears the
+// ring. Returns false, leaving the ring untouched, if the journal is disabled
+// or could not be written.
+bool spillReadingsToJournal();
+
+// Moves every row queued on the ESP-NOW gateway into the journal and drops the
+// stored rows from the queue. Replay uploads them under their nodes' device
+// IDs. Returns false if the journal is disabled or not every row was written.
+bool spillGatewayRowsToJournal(envnode::core::EspNowGateway& gateway);
+
+// Moves the buffered events into the journal and clears the buffer. Returns
+// false, leaving the buffer untouched, if the journal is disabled or could not
+// be written.
+bool spillEventsToJournal();
+
+// Reports whether the journal holds records that have not been replayed.
+bool journalHasPendingData();
+
+// Uploads up to `JOURNAL_REPLAY_MAX_BATCHES` bulk inserts from the journal.
+// Returns true when nothing is left to replay.
+bool replayJournal();
+
+// Prints journal size, segment count, and replay position for diagnostics.
+void printJournalStatus();
@@ -8,7 +8,10 @@
 #include <core_logic.h>
 
 #include "console.h"
+#include "espnow_link.h"
 #include "hardware.h"
+#include "journal_store.h"
+#include "sensor_bus.h"
 #include "sensor_manager.h"
 #include "telemetry.h"
 #include "wifi_manager.h"
@@ -30,6 +33,7 @@ struct SampleRunOptions {
   bool runStartupHooks = false;
   bool updateLastSampleTimestamp = false;
   bool sendDebugHeartbeat = false;
+  uint32_t wakeBudgetMs = 0;
 };
 
 // Captures the outcome of one sampling run so callers can act on success/failure
@@ -39,6 +43,7 @@ struct SampleRunResult {
   bool readingOk = false;
   bool uploadAttempted = false;
   bool uploadOk = false;
+  bool reportReading = false;
   SensorReadings reading;
   unsigned long cycleStartedAtMs = 0;
 };
@@ -80,7 +85,8 @@ void maybeRunStartupHooks(const SensorReadings* readings, bool readingOk) {
     return;
   }
 
-  String startupMeta = buildBootMetaJson(!readingOk);
+  char startupMeta[META_JSON_MAX_BYTES];
+  buildBootMetaJson(!readingOk, startupMeta, sizeof(startupMeta));
   bool startupEventOk = postEvent("startup",
                                   readingOk ? "info" : "warning",
                                   readingOk ? "device boot"
@@ -89,7 +95,7 @@ void maybeRunStartupHooks(const SensorReadings* readings, bool readingOk) {
                                   nullptr,
                                   0,
                                   readingOk,
-                                  startupMeta.c_str());
+                                  startupMeta);
   if (!startupEventOk) {
     noteStartupIssue("startup event post failed");
   }
@@ -99,7 +105,7 @@ void maybeRunStartupHooks(const SensorReadings* readings, bool readingOk) {
                      "Device booted successfully",
                      "info",
                      readings,
-                     startupMeta.c_str())) {
+                     startupMeta)) {
       noteStartupIssue("startup webhook failed");
     }
     blinkColdBootSuccessLed();
@@ -107,7 +113,7 @@ void maybeRunStartupHooks(const SensorReadings* readings, bool readingOk) {
                           "Device booted but first reading failed",
                           "warning",
                           nullptr,
-                          startupMeta.c_str())) {
+                          startupMeta)) {
     noteStartupIssue("startup warning webhook failed");
   }
 }
@@ -135,37 +141,115 @@ void maybeHandleBatteryAlerts(const SensorReadings& readings) {
     return;
   }
 
-  String meta = String("{\"battery_voltage_v\":") + String(readings.batteryVoltage, 3) +
-                ",\"battery_pct\":" + String(readings.batteryPercent, 1) +
-                ",\"alert_threshold_v\":" + String(LOW_BATTERY_ALERT_V, 2) +
-                ",\"clear_threshold_v\":" + String(LOW_BATTERY_CLEAR_V, 2) + "}";
-  String message;
+  char meta[META_JSON_MAX_BYTES];
+  buildBatteryAlertMetaJson(readings, meta, sizeof(meta));
+  char message[64];
 
   if (result.action == envnode::core::BatteryAlertAction::SendClear) {
-    message = String("Battery recovered to ") + String(readings.batteryVoltage, 2) +
-              "V (" + String(readings.batteryPercent, 0) + "%)";
-    postEvent("battery_ok", "info", message, &readings, nullptr, 0, true, meta.c_str());
-    sendWebhook("battery_ok", message, "info", &readings, meta.c_str());
+    snprintf(message, sizeof(message), "Battery recovered to %.2fV (%.0f%%)",
+             readings.batteryVoltage, readings.batteryPercent);
+    postEvent("battery_ok", "info", message, &readings, nullptr, 0, true, meta);
+    sendWebhook("battery_ok", message, "info", &readings, meta);
     return;
   }
 
-  message = String("Battery low: ") + String(readings.batteryVoltage, 2) + "V (" +
-            String(readings.batteryPercent, 0) + "%)";
+  snprintf(message, sizeof(message), "Battery low: %.2fV (%.0f%%)", readings.batteryVoltage,
+           readings.batteryPercent);
   bool eventOk =
       postEvent("battery_low", "warning", message, &readings, nullptr, 0, false,
-                meta.c_str());
+                meta);
   bool webhookOk = sendWebhook("battery_low", message, "warning", &readings,
-                               meta.c_str());
+                               meta);
   if (eventOk && webhookOk) {
     gPersistentState.lowBatteryAlertPending = false;
   }
 }
 
+// Reports the reasons this run needs Wi-Fi that do not depend on its reading:
+// startup hooks, buffered events, error state, debug heartbeats, or a flush
+// that is already due.
+bool sampleRunAlwaysNeedsNetwork(const SampleRunOptions& options) {
+  return options.kind == SampleRunKind::ManualUpload || options.runStartupHooks ||
+         (options.sendDebugHeartbeat && DEBUG_MODE_ENABLED) || gApp.inErrorState ||
+         pendingEventCount() > 0 || pendingReadingsFlushDue();
+}
+
+// Predicts before the sensor is read whether this run will bring up Wi-Fi,
+// assuming the reading succeeds, so association can start early. Automatic
+// readings that may fall inside the deadband are only counted when the
+// keep-alive guarantees they will be reported.
+bool sampleRunLikelyNeedsNetwork(const SampleRunOptions& options) {
+  if (sampleRunAlwaysNeedsNetwork(options)) {
+    return true;
+  }
+  // Readings go to the gateway over ESP-NOW; Wi-Fi is only the fallback once
+  // a full batch has piled up.
+  if (ESPNOW_UPLINK_ENABLED ||
+      (options.kind == SampleRunKind::Automatic && !readingKeepAliveDue())) {
+    return false;
+  }
+  return pendingReadingCount() + 1 >= READING_FLUSH_THRESHOLD || currentEpochSeconds() == 0;
+}
+
+// Decides whether this run has to bring up Wi-Fi. Readings are batched in RTC
+// memory, so timer wakes only need the radio when a flush is due or something
+// else (startup hooks, buffered events, alerts, debug heartbeats) has to be
+// reported. On the ESP-NOW uplink the gateway timestamps unsynchronized
+// readings, so only a batch that ESP-NOW could not deliver needs Wi-Fi.
+bool sampleRunNeedsNetwork(const SampleRunOptions& options,
+                           const SampleRunResult& result) {
+  if (sampleRunAlwaysNeedsNetwork(options)) {
+    return true;
+  }
+
+  if (result.reportReading && !ESPNOW_UPLINK_ENABLED) {
+    if (pendingReadingCount() + 1 >= READING_FLUSH_THRESHOLD) {
+      return true;
+    }
+    // Without a synchronized clock, batched rows would lose their capture time.
+    if (currentEpochSeconds() == 0) {
+      return true;
+    }
+  }
+
+  if (result.readingOk) {
+    auto battery = envnode::core::EvaluateBatteryAlert(
+        result.reading.batteryVoltage,
+        gPersistentState.lowBatteryAlertActive,
+        gPersistentState.lowBatteryAlertPending,
+        LOW_BATTERY_ALERT_V,
+        LOW_BATTERY_CLEAR_V,
+        true);
+    if (battery.action != envnode::core::BatteryAlertAction::None) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Returns how long `connectWiFi()` may wait without the reading upload missing
+// its share of the wake budget. An early connect has already been running, so
+// its elapsed time counts toward the timeout, which is measured from the start
+// of the attempt.
+unsigned long budgetedWiFiTimeoutMs() {
+  const uint32_t now = millis();
+  const uint32_t alreadyWaited = gApp.wifiConnectInProgress ? now - gApp.wifiConnectStartedMs : 0;
+  const uint32_t remaining = envnode::core::WakeBudgetRemainingMs(
+      gApp.wakeBudget, now, envnode::core::WakePriority::Reading);
+  if (remaining >= WIFI_CONNECT_TIMEOUT_MS - alreadyWaited ||
+      alreadyWaited >= WIFI_CONNECT_TIMEOUT_MS) {
+    return WIFI_CONNECT_TIMEOUT_MS;
+  }
+  return alreadyWaited + remaining;
+}
+
 // Runs one complete sample path according to `options`. This is the shared core
 // used by automatic cycles and manual USB-triggered samples.
 SampleRunResult executeSampleRun(const SampleRunOptions& options) {
   SampleRunResult result;
   result.cycleStartedAtMs = millis();
+  envnode::core::StartWakeBudget(gApp.wakeBudget, result.cycleStartedAtMs, options.wakeBudgetMs);
 
   if (options.kind != SampleRunKind::Automatic &&
       gApp.runtimeMode != RuntimeMode::UsbService) {
@@ -175,23 +259,35 @@ SampleRunResult executeSampleRun(const SampleRunOptions& options) {
 
   setAwakeLed(true);
   ensureSessionId();
+  // Automatic wakes inside the Wi-Fi backoff only sample and buffer; manual
+  // runs always try.
+  const uint32_t wifiBackoffSeconds =
+      options.kind == SampleRunKind::Automatic ? wifiBackoffRemainingSeconds() : 0;
+  if (WIFI_EARLY_CONNECT_ENABLED && options.uploadRequested && !gApp.networkAvailable &&
+      wifiBackoffSeconds == 0 && WiFi.status() != WL_CONNECTED &&
+      sampleRunLikelyNeedsNetwork(options)) {
+    // Association and DHCP proceed on the protocol core while this core powers
+    // up and reads the sensor; `connectWiFi()` below only waits for the rest.
+    startWiFiConnect();
+  }
   enableSensePower();
 
   if (!gApp.bmeInitialized) {
-    waitForSensorPowerRail();
     if (!initBME()) {
       disableSensePower();
       resetSensorState();
 
       if (options.runStartupHooks) {
-        if (!gApp.networkAvailable && WiFi.status() != WL_CONNECTED &&
-            !connectWiFi()) {
+        if (!gApp.networkAvailable &&
+            (gApp.wifiConnectInProgress || WiFi.status() != WL_CONNECTED) &&
+            !connectWiFi(budgetedWiFiTimeoutMs())) {
           noteStartupIssue("initial WiFi connect failed during BME fault report");
         }
 
-        String meta = buildBootMetaJson(false);
+        char meta[META_JSON_MAX_BYTES];
+        buildBootMetaJson(false, meta, sizeof(meta));
         if (!postEvent("startup", "error", "BME init failed", nullptr, nullptr, 0,
-                       false, meta.c_str())) {
+                       false, meta)) {
           noteStartupIssue("startup BME error event failed");
         }
         if (shouldRunStartupHooks() &&
@@ -199,9 +295,10 @@ SampleRunResult executeSampleRun(const SampleRunOptions& options) {
                          "Device booted but BME init failed",
                          "error",
                          nullptr,
-                         meta.c_str())) {
+                         meta)) {
           noteStartupIssue("startup BME failure webhook failed");
         }
+        flushPendingEvents();
         requestStartupDiagnosticsHold("BME init failed");
       } else if (options.kind == SampleRunKind::ManualLocal ||
                  options.kind == SampleRunKind::ManualUpload) {
@@ -221,37 +318,55 @@ SampleRunResult executeSampleRun(const SampleRunOptions& options) {
   }
 
   result.sensorReady = true;
+  // The BME680 converts while the battery ADC is sampled.
+  startSensorMeasurement();
   float rawBatteryVoltage = readBatteryVoltage();
   float rawBatteryPercent = batteryVoltageToPercent(rawBatteryVoltage);
   if (options.kind == SampleRunKind::Automatic) {
     Serial.printf("Battery: %.2fV (%.0f%%)\n", rawBatteryVoltage, rawBatteryPercent);
   }
 
-  result.readingOk = captureValidatedReading(result.reading, getLastGoodReading());
+  result.readingOk = captureValidatedReading(result.reading);
   result.reading.batteryVoltage = rawBatteryVoltage;
   result.reading.batteryPercent = rawBatteryPercent;
 
   disableSensePower();
   resetSensorState();
-
-  if (!gApp.networkAvailable && options.uploadRequested && WiFi.status() != WL_CONNECTED) {
-    bool wifiOk = connectWiFi();
-    if (options.runStartupHooks && !wifiOk) {
-      noteStartupIssue("initial WiFi connect failed");
+  Serial.printf("Sensor phase: %lu ms%s\n",
+                millis() - result.cycleStartedAtMs,
+                gApp.wifiConnectInProgress ? " (WiFi associating in parallel)" : "");
+
+  if (result.readingOk && options.uploadRequested) {
+    // Manual samples are always reported; the deadband only thins out the
+    // automatic cycle.
+    const envnode::core::ReportDecision decision = evaluateReadingReport(result.reading);
+    result.reportReading = options.kind != SampleRunKind::Automatic ||
+                           decision != envnode::core::ReportDecision::Suppressed;
+    if (options.kind == SampleRunKind::Automatic && REPORT_DEADBAND_ENABLED) {
+      Serial.printf("Report: %s\n", envnode::core::ReportDecisionName(decision));
     }
   }
 
-  if (options.runStartupHooks && gApp.networkAvailable) {
-    bool tablesOk = checkSupabaseTablesOnce();
-    if (!tablesOk) {
-      noteStartupIssue("Supabase connectivity check failed");
-    }
+  bool networkWanted = options.uploadRequested && sampleRunNeedsNetwork(options, result);
+  if (gApp.wifiConnectInProgress && !networkWanted) {
+    Serial.println("Nothing to report; cancelling early WiFi connect.");
+    shutdownWiFi();
   }
-
-  if (options.runStartupHooks) {
-    maybeRunStartupHooks(result.readingOk ? &result.reading : nullptr, result.readingOk);
+  if (!gApp.networkAvailable && networkWanted && wifiBackoffSeconds > 0) {
+    Serial.printf("WiFi: backing off after %u failed connect(s); next attempt in %lu s.\n",
+                  static_cast<unsigned>(gPersistentState.wifiBackoff.consecutiveFailures),
+                  static_cast<unsigned long>(wifiBackoffSeconds));
+  } else if (gApp.wifiConnectInProgress ||
+             (!gApp.networkAvailable && networkWanted && WiFi.status() != WL_CONNECTED)) {
+    bool wifiOk = connectWiFi(budgetedWiFiTimeoutMs());
+    if (options.runStartupHooks && !wifiOk) {
+      noteStartupIssue("initial WiFi connect failed");
+    }
   }
 
+  // Network work below runs in wake-budget priority order: the reading upload
+  // first, then startup diagnostics and alerts, buffered events, journal
+  // backlog, and the debug heartbeat last.
   if (result.readingOk) {
     setLastGoodReading(result.reading);
     if (options.kind == SampleRunKind::Automatic) {
@@ -270,23 +385,64 @@ SampleRunResult executeSampleRun(const SampleRunOptions& options) {
                     result.reading.batteryPercent);
     }
 
-    if (options.uploadRequested) {
+    if (result.reportReading) {
+      queuePendingReading(result.reading);
+    }
+  } else if (options.kind == SampleRunKind::Automatic) {
+    Serial.println("Dropping bad reading after recovery attempts.");
+  } else {
+    Serial.println("Manual sample failed: sensor did not return a stable reading.");
+  }
+
+  if (options.uploadRequested && pendingReadingCount() > 0) {
+    if (gApp.networkAvailable) {
       result.uploadAttempted = true;
-      if (gApp.networkAvailable) {
-        result.uploadOk = postReadings(result.reading);
-        if (options.runStartupHooks && !result.uploadOk) {
-          noteStartupIssue("initial reading upload failed");
-        }
-      } else if (options.kind == SampleRunKind::ManualUpload) {
+      result.uploadOk = flushPendingReadings();
+      if (options.runStartupHooks && !result.uploadOk) {
+        noteStartupIssue("initial reading upload failed");
+      }
+    } else if (ESPNOW_UPLINK_ENABLED && sendPendingReadingsOverEspNow()) {
+      result.uploadAttempted = true;
+      result.uploadOk = true;
+    } else if (networkWanted) {
+      result.uploadAttempted = true;
+      if (options.kind == SampleRunKind::ManualUpload) {
         Serial.println("Manual upload skipped: WiFi unavailable.");
       } else {
-        Serial.println("Skipping upload: WiFi unavailable for this cycle.");
+        Serial.printf("Skipping upload: WiFi unavailable for this cycle (%u reading(s) kept).\n",
+                      static_cast<unsigned>(pendingReadingCount()));
+        // Once a full batch is waiting, move it to flash so an outage longer
+        // than the RTC ring, or a brownout, does not lose it.
+        if (pendingReadingsFlushDue()) {
+          spillReadingsToJournal();
+        }
         if (options.runStartupHooks) {
           noteStartupIssue("WiFi unavailable during initial upload");
         }
       }
+    } else if (ESPNOW_UPLINK_ENABLED) {
+      result.uploadAttempted = true;
+      Serial.printf("Readings kept for the next ESP-NOW attempt (%u pending).\n",
+                    static_cast<unsigned>(pendingReadingCount()));
+    } else if (result.reportReading) {
+      Serial.printf("Reading queued for batched upload (%u of %lu).\n",
+                    static_cast<unsigned>(pendingReadingCount()),
+                    static_cast<unsigned long>(READING_FLUSH_THRESHOLD));
     }
+  }
+
+  if (options.runStartupHooks && gApp.networkAvailable) {
+    bool tablesOk = checkSupabaseTablesOnce();
+    if (!tablesOk) {
+      noteStartupIssue("Supabase connectivity check failed");
+    }
+  }
+
+  if (options.runStartupHooks) {
+    maybeRunStartupHooks(result.readingOk ? &result.reading : nullptr, result.readingOk);
+  }
 
+  if (result.readingOk) {
     if (options.kind == SampleRunKind::Automatic) {
       maybeHandleBatteryAlerts(result.reading);
     }
@@ -298,10 +454,15 @@ SampleRunResult executeSampleRun(const SampleRunOptions& options) {
                   "info",
                   &result.reading);
     }
-  } else if (options.kind == SampleRunKind::Automatic) {
-    Serial.println("Dropping bad reading after recovery attempts.");
-  } else {
-    Serial.println("Manual sample failed: sensor did not return a stable reading.");
+  }
+
+  if (pendingEventCount() > 0 && gApp.networkAvailable && !flushPendingEvents() &&
+      options.runStartupHooks) {
+    noteStartupIssue("startup event upload failed");
+  }
+
+  if (gApp.networkAvailable && (!result.uploadAttempted || result.uploadOk)) {
+    replayJournal();
   }
 
   if (options.sendDebugHeartbeat) {
@@ -311,6 +472,13 @@ SampleRunResult executeSampleRun(const SampleRunOptions& options) {
                             result.cycleStartedAtMs);
   }
 
+  if (options.wakeBudgetMs > 0) {
+    Serial.printf("Wake budget: %lu of %lu ms used\n",
+                  static_cast<unsigned long>(
+                      envnode::core::WakeBudgetElapsedMs(gApp.wakeBudget, millis())),
+                  static_cast<unsigned long>(options.wakeBudgetMs));
+  }
+
   if (options.updateLastSampleTimestamp) {
     gApp.lastSampleRunMs = millis();
   }
@@ -324,17 +492,18 @@ void maybeAnnounceUsbServiceMode() {
     return;
   }
 
-  String meta = buildServiceModeMetaJson();
+  char meta[META_JSON_MAX_BYTES];
+  buildServiceModeMetaJson(meta, sizeof(meta));
   if (!gApp.usbServiceEventSent) {
-    gApp.usbServiceEventSent = postEvent(
-        "service_mode",
-        "info",
-        "USB host detected; readings paused in diagnostic mode",
-        nullptr,
-        nullptr,
-        0,
-        true,
-        meta.c_str());
+    bool queued = postEvent("service_mode",
+                            "info",
+                            "USB host detected; readings paused in diagnostic mode",
+                            nullptr,
+                            nullptr,
+                            0,
+                            true,
+                            meta);
+    gApp.usbServiceEventSent = queued && flushPendingEvents();
   }
 
   if (!gApp.usbServiceWebhookSent) {
@@ -343,20 +512,21 @@ void maybeAnnounceUsbServiceMode() {
         "Device is in USB diagnostic/charging mode; readings are paused",
         "info",
         nullptr,
-        meta.c_str());
+        meta);
   }
 }
 
 // Runs the normal automatic wake/sample/upload cycle.
 void runSamplingCycle() {
   executeSampleRun(
-      {SampleRunKind::Automatic, true, shouldRunStartupHooks(), true, true});
+      {SampleRunKind::Automatic, true, shouldRunStartupHooks(), true, true, WAKE_BUDGET_MS});
 }
 
 // Switches the runtime into USB service mode and announces it if network access
 // is available.
 void enterUsbServiceMode() {
   gApp.runtimeMode = RuntimeMode::UsbService;
+  envnode::core::StartWakeBudget(gApp.wakeBudget, millis(), 0);
   resetSensorState();
   gApp.usbServiceEventSent = false;
   gApp.usbServiceWebhookSent = false;
@@ -426,7 +596,8 @@ void runUsbServiceLoopIteration() {
     return;
   }
 
-  delay(250);
+  // Wakes early on a link change so the status above is logged without lag.
+  waitForWiFiEvent(250);
 }
 
 }  // namespace
@@ -444,6 +615,28 @@ void printRuntimeModeStatus() {
                 DEEP_SLEEP_ENABLED ? "enabled" : "disabled",
                 wifiStatusName(wifiStatus),
                 static_cast<int>(wifiStatus));
+  Serial.printf("Mode status: sensor settle last=%u ms max=%u ms timeouts=%u\n",
+                static_cast<unsigned>(gPersistentState.sensorSettleMs),
+                static_cast<unsigned>(gPersistentState.sensorSettleMaxMs),
+                static_cast<unsigned>(gPersistentState.sensorSettleTimeouts));
+  Serial.printf("Mode status: i2c %u kHz fallbacks=%u nacks=%u timeouts=%u clears=%u retries=%u\n",
+                static_cast<unsigned>(sensorBusClockKhz()),
+                static_cast<unsigned>(gPersistentState.i2cSpeed.fallbacks),
+                static_cast<unsigned>(gApp.i2cCounters.nacks),
+                static_cast<unsigned>(gApp.i2cCounters.timeouts),
+                static_cast<unsigned>(gApp.i2cCounters.busClears),
+                static_cast<unsigned>(gApp.i2cCounters.retries));
+  Serial.print("Mode status: recovery");
+  for (size_t i = 0; i < envnode::core::kRecoveryStageCount; ++i) {
+    const auto& stats = gPersistentState.recoveryLadder.stages[i];
+    const auto stage = static_cast<envnode::core::RecoveryStage>(i);
+    Serial.printf(" %s=%u/%u", envnode::core::RecoveryStageName(stage),
+                  static_cast<unsigned>(stats.fixes), static_cast<unsigned>(stats.attempts));
+    if (stats.skipRunsLeft > 0) {
+      Serial.printf(" (skip %u)", static_cast<unsigned>(stats.skipRunsLeft));
+    }
+  }
+  Serial.println();
   if (gApp.networkAvailable) {
     Serial.printf("Mode status: IP=%s RSSI=%d dBm\n",
                   WiFi.localIP().toString().c_str(),
@@ -468,6 +661,9 @@ void setupApp() {
   delay(1000);
 
   registerWiFiEventLogger();
+  if (ESPNOW_GATEWAY_ENABLED) {
+    beginEspNowGateway();
+  }
   gApp.bootMode = detectBootMode();
   gApp.runtimeMode = RuntimeMode::Normal;
   gApp.sampleIntervalSeconds = loadSampleIntervalSeconds();
@@ -509,6 +705,10 @@ void loopApp() {
     static unsigned long lastStatusLogMs = 0;
     static unsigned long lastReconnectAttemptMs = 0;
 
+    // Console commands and reconnects here are not part of a sample run, so
+    // the last run's spent budget must not defer their requests. Each sample
+    // run starts its own budget again.
+    envnode::core::StartWakeBudget(gApp.wakeBudget, millis(), 0);
     pollSerialCommands();
 
     unsigned long now = millis();
@@ -535,7 +735,10 @@ void loopApp() {
       runSamplingCycle();
     }
 
-    delay(250);
+    if (ESPNOW_GATEWAY_ENABLED) {
+      serviceEspNowGateway();
+    }
+    waitForWiFiEvent(250);
     return;
   }
 
@@ -0,0 +1,128 @@
+// Counted sensor-bus access and speed fallback implementation.
+
+#include "sensor_bus.h"
+
+#include <Wire.h>
+
+namespace {
+
+// Longest a single transaction may stretch before `Wire` gives up on it.
+constexpr uint16_t kI2cTimeoutMs = 25;
+
+// `Wire.endTransmission()` result for a timeout; 2 and 3 are address and data
+// NACKs.
+constexpr uint8_t kWireTimeout = 5;
+
+// Set between `sensorBusStartWake()` and `sensorBusFinishWake()`.
+bool gWakeActive = false;
+
+// Clock for the current speed state, or 100 kHz with fast mode disabled.
+uint32_t clockHz() {
+  return I2C_FAST_MODE_ENABLED ? envnode::core::CurrentI2cClockHz(gPersistentState.i2cSpeed)
+                               : envnode::core::kI2cStandardClockHz;
+}
+
+// Counts one failed transaction and drops the bus to 100 kHz if it was the
+// first fault at 400 kHz.
+void noteFault(bool timedOut) {
+  if (timedOut) {
+    ++gApp.i2cCounters.timeouts;
+  } else {
+    ++gApp.i2cCounters.nacks;
+  }
+  if (I2C_FAST_MODE_ENABLED &&
+      envnode::core::NoteI2cFault(gPersistentState.i2cSpeed, envnode::core::I2cSpeedConfig())) {
+    Wire.setClock(envnode::core::kI2cStandardClockHz);
+    Serial.printf("I2C: %s at 400 kHz, falling back to 100 kHz for %u wakes.\n",
+                  timedOut ? "timeout" : "NACK",
+                  static_cast<unsigned>(gPersistentState.i2cSpeed.holdOffWakes));
+  }
+}
+
+// Counts an `endTransmission()` failure. Results other than a timeout are
+// counted with the NACKs.
+void noteTransmissionResult(uint8_t result) {
+  if (result != 0) {
+    noteFault(result == kWireTimeout);
+  }
+}
+
+// One register write without a retry.
+bool writeOnce(uint8_t address, uint8_t reg, uint8_t value) {
+  Wire.beginTransmission(address);
+  Wire.write(reg);
+  Wire.write(value);
+  const uint8_t result = Wire.endTransmission();
+  noteTransmissionResult(result);
+  return result == 0;
+}
+
+// `Wire` does not report why a read came back short, so one that took the
+// full timeout is counted as a timeout and anything quicker as a NACK.
+bool readOnce(uint8_t address, uint8_t reg, uint8_t* out, size_t length) {
+  Wire.beginTransmission(address);
+  Wire.write(reg);
+  const uint8_t result = Wire.endTransmission(false);
+  if (result != 0) {
+    noteTransmissionResult(result);
+    return false;
+  }
+  const unsigned long startedMs = millis();
+  if (Wire.requestFrom(static_cast<int>(address), static_cast<int>(length)) != length) {
+    noteFault(millis() - startedMs >= kI2cTimeoutMs);
+    return false;
+  }
+  for (size_t i = 0; i < length; ++i) {
+    out[i] = static_cast<uint8_t>(Wire.read());
+  }
+  return true;
+}
+
+}  // namespace
+
+void sensorBusStartWake() {
+  gApp.i2cCounters = envnode::core::I2cBusCounters();
+  if (I2C_FAST_MODE_ENABLED) {
+    envnode::core::StartI2cWake(gPersistentState.i2cSpeed);
+  }
+  gWakeActive = true;
+}
+
+// Only a wake that was started updates the speed state, so resets outside a
+// sampling run do not clear the hold-off.
+void sensorBusFinishWake() {
+  if (gWakeActive && I2C_FAST_MODE_ENABLED) {
+    envnode::core::FinishI2cWake(gPersistentState.i2cSpeed);
+  }
+  gWakeActive = false;
+}
+
+void sensorBusBegin() {
+  Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN);
+  Wire.setClock(clockHz());
+  Wire.setTimeOut(kI2cTimeoutMs);
+}
+
+bool sensorBusWrite(uint8_t address, uint8_t reg, uint8_t value) {
+  if (writeOnce(address, reg, value)) {
+    return true;
+  }
+  ++gApp.i2cCounters.retries;
+  return writeOnce(address, reg, value);
+}
+
+bool sensorBusRead(uint8_t address, uint8_t reg, uint8_t* out, size_t length) {
+  if (readOnce(address, reg, out, length)) {
+    return true;
+  }
+  ++gApp.i2cCounters.retries;
+  return readOnce(address, reg, out, length);
+}
+
+void sensorBusNoteClear() {
+  ++gApp.i2cCounters.busClears;
+}
+
+uint16_t sensorBusClockKhz() {
+  return static_cast<uint16_t>(clockHz() / 1000U);
+}
@@ -0,0 +1,32 @@
+// Counted register access on the sensor I2C bus.
+//
+// Every BME680 transaction goes through here so NACKs, timeouts, bus clears,
+// and retries are counted per wake, and so the first fault at 400 kHz can drop
+// the bus to 100 kHz (see `i2c_bus.h`). Chip-ID probes while the rail powers
+// up are expected to NACK and bypass these helpers.
+
+#pragma once
+
+#include "app_context.h"
+
+// Starts a sampling wake: resets the counters and picks the bus clock.
+void sensorBusStartWake();
+
+// Ends the wake started by `sensorBusStartWake()`.
+void sensorBusFinishWake();
+
+// Starts `Wire` on the sensor pins at the current clock.
+void sensorBusBegin();
+
+// Writes one register, retrying once. Returns false if both attempts fail.
+bool sensorBusWrite(uint8_t address, uint8_t reg, uint8_t value);
+
+// Reads `length` consecutive registers starting at `reg` in one transaction,
+// retrying once. Returns false if both attempts fail.
+bool sensorBusRead(uint8_t address, uint8_t reg, uint8_t* out, size_t length);
+
+// Counts a manual bus clear.
+void sensorBusNoteClear();
+
+// Current bus clock in kHz.
+uint16_t sensorBusClockKhz();
@@ -6,54 +6,50 @@
 
 #include "sensor_manager.h"
 
-#include <Adafruit_BME680.h>
+#include <Preferences.h>
 #include <Wire.h>
+#include <bme680.h>
 #include <core_logic.h>
+#include <plausibility_filter.h>
+#include <recovery_ladder.h>
 
+#include "bme680_driver.h"
 #include "hardware.h"
+#include "sensor_bus.h"
 #include "telemetry.h"
 
 namespace {
 
-// Single shared BME680 instance for the firmware.
-Adafruit_BME680 gBme;
+// Interval between chip-ID probes while the sensor rail powers up.
+constexpr unsigned long kSensorReadyPollMs = 5;
+
+// Bounds and re-baselining rule for the rolling-window plausibility filter.
+constexpr envnode::core::PlausibilityConfig kPlausibilityConfig{};
+
+// Backoff and history limits for the learned recovery ladder.
+constexpr envnode::core::RecoveryLadderConfig kRecoveryLadderConfig{};
+
+// Least reading-priority budget a recovery stage is started with: a reinit
+// plus the measurement that checks it.
+constexpr uint32_t kMinRecoveryStageBudgetMs = 250;
+
+// NVS key of the calibration cache that seeds RTC memory after a cold boot.
+constexpr const char* kCalibrationCacheKey = "bme_calib";
+
+// How far the retained calibration cache is trusted by the next init. A cache
+// restored from NVS is spot-checked once, since the sensor may have been
+// swapped while the board was off.
+Bme680CacheUse gCalibrationCacheUse = Bme680CacheUse::Trust;
 
 // Applies a fixed calibration offset after the BME680 has produced a reading.
 float applyTemperatureCompensation(float rawTemperatureC) {
   return rawTemperatureC + static_cast<float>(BME_TEMPERATURE_OFFSET_C);
 }
 
-// Configures the BME680 for this project's low-power temperature/humidity/
-// pressure use case and disables unused gas measurements.
-void bmeConfigure() {
-  Wire.setClock(100000);
-  Wire.setTimeOut(25);
-  gBme.setTemperatureOversampling(BME680_OS_8X);
-  gBme.setHumidityOversampling(BME680_OS_2X);
-  gBme.setPressureOversampling(BME680_OS_4X);
-  gBme.setIIRFilterSize(BME680_FILTER_SIZE_3);
-  gBme.setGasHeater(0, 0);
-}
-
-// Writes the BME680 soft-reset command to either supported address.
-bool bmeSoftReset() {
-  uint8_t addrs[2] = {0x76, 0x77};
-  bool wrote = false;
-  for (uint8_t address : addrs) {
-    Wire.beginTransmission(address);
-    Wire.write(0xE0);
-    Wire.write(0xB6);
-    if (Wire.endTransmission() == 0) {
-      wrote = true;
-    }
-  }
-  delay(5);
-  return wrote;
-}
-
 // Attempts to release a stuck I2C bus by manually pulsing SCL and issuing a
 // stop condition before the next sensor re-init.
 bool i2cClearBus() {
+  sensorBusNoteClear();
   pinMode(I2C_SDA_PIN, INPUT_PULLUP);
   pinMode(I2C_SCL_PIN, INPUT_PULLUP);
   delayMicroseconds(5);
@@ -113,6 +109,95 @@ bool readI2cRegister8(uint8_t address, uint8_t reg, uint8_t& value) {
   return true;
 }
 
+// Address the sensor last started at, kept in RTC memory with its calibration
+// cache, or 0x76 before it ever started.
+uint8_t retainedSensorAddress() {
+  return gPersistentState.bmeCalibration.address == 0x77 ? 0x77 : 0x76;
+}
+
+// Seeds the RTC calibration cache from NVS when it holds nothing usable,
+// which is the case after every cold boot.
+void loadCalibrationCache() {
+  auto& cache = gPersistentState.bmeCalibration;
+  if (envnode::core::Bme680CalibrationCacheValid(cache, cache.address, cache.chipId)) {
+    return;
+  }
+  Preferences prefs;
+  if (!prefs.begin(CONFIG_NAMESPACE, true)) {
+    return;
+  }
+  if (prefs.getBytesLength(kCalibrationCacheKey) == sizeof(cache)) {
+    prefs.getBytes(kCalibrationCacheKey, &cache, sizeof(cache));
+    gCalibrationCacheUse = Bme680CacheUse::SpotCheck;
+  }
+  prefs.end();
+}
+
+// Writes the calibration cache to NVS. Only called when the driver read a
+// calibration that differs from the cached one, so flash sees one write per
+// sensor rather than one per wake.
+void saveCalibrationCache() {
+  Preferences prefs;
+  if (!prefs.begin(CONFIG_NAMESPACE, false)) {
+    return;
+  }
+  prefs.putBytes(kCalibrationCacheKey, &gPersistentState.bmeCalibration,
+                 sizeof(gPersistentState.bmeCalibration));
+  prefs.end();
+}
+
+// Starts the driver at `address` with the retained calibration cache. After a
+// successful start the cache is trusted for the rest of this power session.
+bool beginSensorAt(uint8_t address) {
+  auto& cache = gPersistentState.bmeCalibration;
+  const uint32_t previousCrc = cache.crc;
+  if (!bme680Begin(address, cache, gCalibrationCacheUse)) {
+    return false;
+  }
+  gCalibrationCacheUse = Bme680CacheUse::Trust;
+  if (cache.crc != previousCrc) {
+    saveCalibrationCache();
+  }
+  return true;
+}
+
+// Polls the BME680 chip ID at both addresses until the sensor answers, instead
+// of sleeping a fixed settle time after the rail is switched on.
+// `SENSOR_POWER_SETTLE_MS` after power-on is the ceiling. The retained address
+// is probed first. Returns the address that answered, or 0 on timeout.
+uint8_t waitForSensorReady() {
+  const uint8_t first = retainedSensorAddress();
+  const uint8_t addrs[2] = {first, static_cast<uint8_t>(first == 0x76 ? 0x77 : 0x76)};
+  while (true) {
+    for (uint8_t address : addrs) {
+      uint8_t chipId = 0;
+      if (readI2cRegister8(address, envnode::core::kBme680RegChipId, chipId) &&
+          chipId == envnode::core::kBme680ChipId) {
+        const unsigned long settleMs = millis() - gApp.sensePowerOnMs;
+        // A rail that was already on before this call tells nothing about
+        // settle time.
+        if (settleMs <= SENSOR_POWER_SETTLE_MS) {
+          gPersistentState.sensorSettleMs = static_cast<uint16_t>(settleMs);
+          if (settleMs > gPersistentState.sensorSettleMaxMs) {
+            gPersistentState.sensorSettleMaxMs = static_cast<uint16_t>(settleMs);
+          }
+          Serial.printf("Sensor power settle: BME680 answered after %lu ms (max %u ms).\n",
+                        settleMs,
+                        static_cast<unsigned>(gPersistentState.sensorSettleMaxMs));
+        }
+        return address;
+      }
+    }
+    if (millis() - gApp.sensePowerOnMs >= SENSOR_POWER_SETTLE_MS) {
+      ++gPersistentState.sensorSettleTimeouts;
+      Serial.printf("Sensor power settle: no BME680 chip ID within %lu ms.\n",
+                    static_cast<unsigned long>(SENSOR_POWER_SETTLE_MS));
+      return 0;
+    }
+    delay(kSensorReadyPollMs);
+  }
+}
+
 // Prints every responsive I2C address to help debug missing or miswired sensors.
 void logI2cProbeResults() {
   bool foundAny = false;
@@ -139,7 +224,7 @@ void logBmeDetectionHints() {
     }
     foundCandidate = true;
     uint8_t chipId = 0;
-    if (!readI2cRegister8(address, 0xD0, chipId)) {
+    if (!readI2cRegister8(address, envnode::core::kBme680RegChipId, chipId)) {
       Serial.printf("BME probe: device acknowledged at 0x%02X but chip ID read failed.\n",
                     address);
       continue;
@@ -147,7 +232,7 @@ void logBmeDetectionHints() {
 
     Serial.printf("BME probe: address 0x%02X reports chip ID 0x%02X\n", address,
                   chipId);
-    if (chipId == 0x61) {
+    if (chipId == envnode::core::kBme680ChipId) {
       Serial.println(
           "BME probe: this looks like a BME680, so init failure is likely power, timing, or bus integrity.");
     } else if (chipId == 0x60) {
@@ -166,9 +251,27 @@ void logBmeDetectionHints() {
   }
 }
 
-// Rebuilds the I2C/BME state after a fault by resetting the bus and then
-// trying both supported BME680 addresses again.
-bool bmeReinit() {
+// Starts the driver again at the retained address, then the other one, using
+// the calibration cache as `use` allows.
+bool bmeReinit(Bme680CacheUse use) {
+  gCalibrationCacheUse = use;
+  const uint8_t preferred = retainedSensorAddress();
+  const uint8_t fallback = preferred == 0x76 ? 0x77 : 0x76;
+  bool ok = false;
+  if (beginSensorAt(preferred)) {
+    gApp.bmeAddress = preferred;
+    ok = true;
+  } else if (beginSensorAt(fallback)) {
+    gApp.bmeAddress = fallback;
+    ok = true;
+  }
+  gApp.bmeInitialized = ok;
+  return ok;
+}
+
+// Rebuilds the I2C/BME state after a fault by clearing and restarting the bus
+// and then reinitializing the sensor with its calibration read again.
+bool i2cRestart() {
   #if !defined(ARDUINO_ARCH_AVR)
   Wire.end();
   #endif
@@ -180,73 +283,78 @@ bool bmeReinit() {
   if (gApp.lastI2cClearRequired) {
     postEvent("i2c_bus_clear", "warning", "cleared I2C bus before reinit");
   }
+  sensorBusBegin();
+  return bmeReinit(Bme680CacheUse::Ignore);
+}
 
-  Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN);
-  Wire.setClock(100000);
-  Wire.setTimeOut(25);
-
-  bool ok = false;
-  if (gBme.begin(0x76)) {
-    gApp.bmeAddress = 0x76;
-    ok = true;
-  } else if (gBme.begin(0x77)) {
-    gApp.bmeAddress = 0x77;
-    ok = true;
+// Runs one recovery stage. The soft reset is the one `bme680Begin()` issues,
+// followed by the configuration writes with the cached calibration; the
+// reinit also checks the chip ID and re-reads the calibration. Returns false
+// when the stage's own bus actions failed.
+bool runRecoveryStage(envnode::core::RecoveryStage stage) {
+  switch (stage) {
+    case envnode::core::RecoveryStage::SoftReset:
+      return bmeReinit(Bme680CacheUse::Trust);
+    case envnode::core::RecoveryStage::Reinit:
+      return bmeReinit(Bme680CacheUse::Ignore);
+    case envnode::core::RecoveryStage::I2cRestart:
+      return i2cRestart();
   }
-  gApp.bmeInitialized = ok;
-  if (ok) {
-    bmeConfigure();
-  }
-  return ok;
+  return false;
 }
 
-// Requests one forced BME680 reading and copies the result into `out`.
+// Collects the measurement `startSensorMeasurement()` already started, or
+// starts one and waits for it, and copies the result into `out`.
 bool takeReading(SensorReadings& out) {
-  if (!gBme.performReading()) {
+  if (!bme680MeasurementPending() && !bme680StartMeasurement()) {
+    return false;
+  }
+  float temperature = NAN;
+  if (!bme680CollectMeasurement(temperature, out.humidity, out.pressure)) {
     return false;
   }
 
-  out.temperature = applyTemperatureCompensation(gBme.temperature);
-  out.humidity = gBme.humidity;
-  out.pressure = gBme.pressure / 100.0f;
+  out.temperature = applyTemperatureCompensation(temperature);
   return !(isnan(out.temperature) || isnan(out.humidity) || isnan(out.pressure));
 }
 
-// Wraps the pure plausibility helper so sensor readings can be compared against
-// an optional last-known-good sample.
-bool plausible(const SensorReadings& readings, const SensorReadings* lastReadings) {
-  envnode::core::LogicReadings current{readings.temperature, readings.humidity,
-                                       readings.pressure};
-  envnode::core::LogicReadings last;
-  if (lastReadings) {
-    last.temperature = lastReadings->temperature;
-    last.humidity = lastReadings->humidity;
-    last.pressure = lastReadings->pressure;
-  }
-  return envnode::core::PlausibleReadings(current, lastReadings ? &last : nullptr);
+// Converts a firmware reading into the shape the plausibility filter uses.
+envnode::core::LogicReadings logicReadings(const SensorReadings& readings) {
+  return envnode::core::LogicReadings{readings.temperature, readings.humidity,
+                                      readings.pressure};
 }
 
-// Attempts up to three sensor readings before giving up on the current cycle.
-// `lastKnownGood` is optional and is only used for jump detection.
-bool tryTakePlausibleReading(SensorReadings& reading,
-                             const SensorReadings* lastKnownGood) {
+// Judges a reading against the retained window without recording it.
+envnode::core::PlausibilityVerdict judgeReading(const SensorReadings& readings) {
+  return envnode::core::JudgeReading(gPersistentState.plausibility, kPlausibilityConfig,
+                                     logicReadings(readings));
+}
+
+// Attempts up to three sensor readings and returns the verdict of the last
+// one. Only a reading outside the absolute limits is reported here; outliers
+// are reported once their verdict is recorded.
+envnode::core::PlausibilityVerdict tryTakePlausibleReading(SensorReadings& reading) {
+  envnode::core::PlausibilityVerdict verdict = envnode::core::PlausibilityVerdict::OutOfRange;
   for (int attempt = 1; attempt <= 3; ++attempt) {
-    if (takeReading(reading) && plausible(reading, lastKnownGood)) {
-      return true;
+    verdict = takeReading(reading) ? judgeReading(reading)
+                                   : envnode::core::PlausibilityVerdict::OutOfRange;
+    if (verdict == envnode::core::PlausibilityVerdict::Accepted) {
+      return verdict;
     }
-    if (attempt == 1) {
+    if (attempt == 1 && verdict == envnode::core::PlausibilityVerdict::OutOfRange) {
       postEvent("implausible_reading", "warning", "plausibility failed", &reading,
                 nullptr, attempt, false);
     }
     delay(10);
   }
-  return false;
+  return verdict;
 }
 
-// Runs the staged recovery flow after a bad reading: soft reset, BME reinit,
-// and finally a full I2C restart before the sample is dropped.
-bool attemptRecoverySequence(SensorReadings& reading,
-                             const SensorReadings* lastKnownGood) {
+// Runs the staged recovery flow after a reading outside the absolute limits.
+// The learned ladder picks the stages and their order; the run stops at the
+// first stage after which an in-range reading comes back, or once the wake
+// budget has no room for another stage.
+bool attemptRecoverySequence(SensorReadings& reading) {
   Serial.println("Reading implausible -> recovery sequence...");
 
   if (!gApp.inErrorState) {
@@ -257,57 +365,55 @@ bool attemptRecoverySequence(SensorReadings& reading,
                 &reading);
   }
 
-  postEvent("soft_reset", "warning", "attempting BME soft reset");
-  bool softOk = bmeSoftReset();
-  postEvent("soft_reset_result",
-            softOk ? "info" : "error",
-            softOk ? "soft reset write OK" : "soft reset write FAILED",
-            nullptr,
-            "soft_reset",
-            1,
-            softOk);
-
-  bool reinitOk = false;
-  if (softOk) {
-    postEvent("reinit", "warning", "reinit after soft reset", nullptr, "reinit", 1,
-              false);
-    reinitOk = bmeReinit();
-    postEvent("reinit_result",
-              reinitOk ? "info" : "error",
-              reinitOk ? "bme reinit ok" : "bme reinit failed",
-              nullptr,
-              "reinit",
-              1,
-              reinitOk);
-  }
-
-  if (!reinitOk) {
-    postEvent("i2c_restart", "warning", "restarting I2C + reinit", nullptr,
-              "i2c_restart", 1, false);
-    reinitOk = bmeReinit();
-    postEvent("i2c_restart_result",
-              reinitOk ? "info" : "error",
-              reinitOk ? "I2C restart ok" : "I2C restart failed",
-              nullptr,
-              "i2c_restart",
-              1,
-              reinitOk);
-  }
+  auto& ladder = gPersistentState.recoveryLadder;
+  envnode::core::RecoveryStage order[envnode::core::kRecoveryStageCount];
+  const size_t stageCount = envnode::core::PlanRecovery(ladder, order);
+  bool budgetSpent = false;
+  for (size_t i = 0; i < stageCount; ++i) {
+    const uint32_t budgetMs = envnode::core::WakeBudgetRemainingMs(
+        gApp.wakeBudget, millis(), envnode::core::WakePriority::Reading);
+    if (budgetMs < kMinRecoveryStageBudgetMs) {
+      Serial.printf("Recovery: wake budget spent; skipping %u remaining stage(s).\n",
+                    static_cast<unsigned>(stageCount - i));
+      budgetSpent = true;
+      break;
+    }
 
-  if (reinitOk && takeReading(reading) && plausible(reading, lastKnownGood)) {
-    postEvent("recovery_ok", "info", "reading ok after recovery", &reading, nullptr,
-              0, true);
-    if (gApp.inErrorState) {
-      gApp.inErrorState = false;
-      sendWebhook("sensor_recovered",
-                  "Device successfully recovered from error state",
-                  "info",
-                  &reading);
+    const envnode::core::RecoveryStage stage = order[i];
+    const char* action = envnode::core::RecoveryStageName(stage);
+    const bool stageOk = runRecoveryStage(stage);
+    const bool fixed = stageOk && takeReading(reading) &&
+                       judgeReading(reading) != envnode::core::PlausibilityVerdict::OutOfRange;
+    envnode::core::RecordRecoveryStage(ladder, kRecoveryLadderConfig, stage, fixed);
+
+    char eventType[32];
+    snprintf(eventType, sizeof(eventType), "%s_result", action);
+    char message[64];
+    snprintf(message, sizeof(message), "%s: %s", action,
+             fixed     ? "reading ok"
+             : stageOk ? "reading still out of range"
+                       : "failed");
+    Serial.printf("Recovery: %s\n", message);
+    postEvent(eventType, fixed ? "info" : "error", message, nullptr, action,
+              static_cast<int>(i + 1), fixed);
+
+    if (fixed) {
+      postEvent("recovery_ok", "info", "reading ok after recovery", &reading, action,
+                static_cast<int>(i + 1), true);
+      if (gApp.inErrorState) {
+        gApp.inErrorState = false;
+        sendWebhook("sensor_recovered",
+                    "Device successfully recovered from error state",
+                    "info",
+                    &reading);
+      }
+      return true;
     }
-    return true;
   }
 
-  postEvent("recovery_failed", "error", "dropping bad reading after recovery",
+  postEvent("recovery_failed", "error",
+            budgetSpent ? "dropping bad reading; wake budget spent during recovery"
+                        : "dropping bad reading after recovery",
             nullptr, nullptr, 0, false);
   sendWebhook("recovery_failed",
               "Device failed to recover - dropping reading",
@@ -317,32 +423,39 @@ bool attemptRecoverySequence(SensorReadings& reading,
 
 }  // namespace
 
-// Clears sensor-ready state after power transitions or hard failures.
+// Clears sensor-ready state after power transitions or hard failures, which
+// also ends the sensor bus's wake.
 void resetSensorState() {
   gApp.bmeInitialized = false;
   gApp.bmeAddress = 0;
+  sensorBusFinishWake();
 }
 
 // Initializes the BME680 and emits detailed probe hints if the sensor is not
-// found at either supported address.
+// found at either supported address. The address that answered the readiness
+// probe is tried first.
 bool initBME() {
-  Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN);
-  Wire.setClock(100000);
-  Wire.setTimeOut(25);
+  sensorBusStartWake();
+  sensorBusBegin();
 
+  loadCalibrationCache();
+  const uint8_t answered = waitForSensorReady();
+  const uint8_t preferred = answered != 0 ? answered : retainedSensorAddress();
+  const uint8_t fallback = preferred == 0x76 ? 0x77 : 0x76;
   bool ok = false;
-  if (gBme.begin(0x76)) {
-    gApp.bmeAddress = 0x76;
+  if (beginSensorAt(preferred)) {
+    gApp.bmeAddress = preferred;
     ok = true;
-  } else if (gBme.begin(0x77)) {
-    gApp.bmeAddress = 0x77;
+  } else if (beginSensorAt(fallback)) {
+    gApp.bmeAddress = fallback;
     ok = true;
   }
 
   gApp.bmeInitialized = ok;
   if (ok) {
-    bmeConfigure();
-    Serial.printf("BME680 ready at I2C address 0x%02X\n", gApp.bmeAddress);
+    Serial.printf("BME680 ready at I2C address 0x%02X, %u kHz (calibration %s)\n",
+                  gApp.bmeAddress, static_cast<unsigned>(sensorBusClockKhz()),
+                  bme680CalibrationWasCached() ? "cached" : "read from sensor");
   } else {
     Serial.println("BME680 not found (0x76/0x77). Check SDA on pin 9 and SCL on pin 10.");
     logBmeDetectionHints();
@@ -351,13 +464,46 @@ bool initBME() {
   return ok;
 }
 
-// Captures one accepted reading, escalating into the recovery flow if the first
-// attempts fail plausibility checks.
-bool captureValidatedReading(SensorReadings& reading,
-                             const SensorReadings* lastKnownGood) {
-  bool ok = tryTakePlausibleReading(reading, lastKnownGood);
-  if (!ok) {
-    ok = attemptRecoverySequence(reading, lastKnownGood);
+// Starts a forced measurement so the conversion runs while the caller does
+// other work; the next `captureValidatedReading()` collects it.
+bool startSensorMeasurement() {
+  return gApp.bmeInitialized && bme680StartMeasurement();
+}
+
+// Captures one accepted reading. A reading outside the absolute limits
+// escalates into the recovery flow; one that is only outside the recent range
+// cannot be fixed by recovery and is held by the filter until enough agreeing
+// readings move the baseline.
+bool captureValidatedReading(SensorReadings& reading) {
+  envnode::core::PlausibilityVerdict verdict = tryTakePlausibleReading(reading);
+  bool inRange = verdict != envnode::core::PlausibilityVerdict::OutOfRange;
+  if (!inRange) {
+    inRange = attemptRecoverySequence(reading);
+  }
+
+  bool ok = false;
+  if (inRange) {
+    verdict = envnode::core::FilterReading(gPersistentState.plausibility, kPlausibilityConfig,
+                                           logicReadings(reading));
+    ok = verdict != envnode::core::PlausibilityVerdict::Outlier;
+    if (verdict == envnode::core::PlausibilityVerdict::Rebaselined) {
+      Serial.println("Plausibility: agreeing readings moved the baseline.");
+      postEvent("plausibility_rebaseline", "info", "accepted new level after agreeing readings",
+                &reading, nullptr, 0, true);
+    } else if (!ok) {
+      Serial.printf("Plausibility: reading outside the recent range (held %u/%u).\n",
+                    static_cast<unsigned>(gPersistentState.plausibility.candidateCount),
+                    static_cast<unsigned>(kPlausibilityConfig.rebaselineAfter));
+      postEvent("reading_outlier", "warning", "reading outside the recent range", &reading,
+                nullptr, gPersistentState.plausibility.candidateCount, false);
+    }
+  }
+
+  if (!envnode::core::I2cBusCountersEmpty(gApp.i2cCounters)) {
+    char meta[META_JSON_MAX_BYTES];
+    buildI2cBusMetaJson(meta, sizeof(meta));
+    postEvent("i2c_bus_faults", "warning", "I2C faults during sensor phase", nullptr, nullptr, 0,
+              ok, meta);
   }
   return ok;
 }
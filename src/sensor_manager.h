@@ -14,7 +14,10 @@ void resetSensorState();
 // Initializes the BME680 on the configured I2C bus and applies sampling config.
 bool initBME();
 
-// Captures one reading and only returns success after plausibility and recovery
-// checks have passed. `lastKnownGood` may be `nullptr` to skip delta checks.
-bool captureValidatedReading(SensorReadings& reading,
-                             const SensorReadings* lastKnownGood);
+// Starts a forced BME680 measurement without waiting for it, so the conversion
+// overlaps with other work. The next `captureValidatedReading()` collects it.
+bool startSensorMeasurement();
+
+// Captures one reading and only returns success after the rolling-window
+// plausibility filter and, when needed, the recovery flow have accepted it.
+bool captureValidatedReading(SensorReadings& reading);
@@ -1,19 +1,52 @@
 // HTTP/TLS telemetry implementation.
 //
-// This module centralizes request construction, TLS verification, webhook
-// cooldown rules, and the JSON payload formats used by Supabase and external
-// webhooks.
+// This module centralizes TLS verification, the keep-alive connection pool,
+// webhook rate limits, and the JSON payloads used by Supabase and external
+// webhooks. Request construction lives in `envnode::core` (see
+// `telemetry_dispatch.h`) and reaches the network through the pooled
+// `HttpTransport` defined here.
 
 #include "telemetry.h"
 
 #include <HTTPClient.h>
-#include <WiFiClientSecure.h>
 #include <core_logic.h>
+#include <event_batch.h>
+#include <gzip.h>
+#include <json_writer.h>
+#include <reading_batch.h>
+#include <telemetry_dispatch.h>
+#include <telemetry_payloads.h>
 
 #include "hardware.h"
+#include "sensor_bus.h"
+#include "tls_client.h"
 
 namespace {
 
+using envnode::core::HttpHeader;
+using envnode::core::HttpRequest;
+using envnode::core::HttpResponse;
+using envnode::core::HttpSucceeded;
+using envnode::core::JsonWriter;
+using envnode::core::WakePriority;
+
+// Request bodies are formatted into this buffer instead of growing heap
+// strings. Sized for a full reading ring; events and webhooks need far less.
+constexpr size_t kPayloadBufferBytes = 6144;
+
+// Column list for batched readings inserts. Rows captured before the clock was
+// synchronized omit `recorded_at` and fall back to the table default.
+constexpr const char* kReadingColumns =
+    "device_id,recorded_at,temperature_c,humidity_rh,pressure_hpa,"
+    "battery_voltage_v,battery_pct";
+
+// Column list for batched event inserts. Event rows only carry the optional
+// fields that apply to them, so PostgREST needs the full set spelled out.
+constexpr const char* kEventColumns =
+    "device_id,created_at,session_id,event_type,severity,message,"
+    "reading_temp_c,reading_humidity_rh,reading_pressure_hpa,action,attempt,"
+    "action_success,meta";
+
 // Returns true when the supplied URL uses HTTPS and therefore needs TLS setup.
 bool isHttpsUrl(const char* url) {
   return url && strncmp(url, "https://", 8) == 0;
@@ -26,11 +59,6 @@ bool urlStartsWith(const char* value, const char* prefix) {
          strncmp(value, prefix, strlen(prefix)) == 0;
 }
 
-// Escapes arbitrary text for safe embedding inside JSON string values.
-String jsonEscape(const String& input) {
-  return String(envnode::core::JsonEscape(input.c_str()).c_str());
-}
-
 // Chooses the configured root CA for a target URL so HTTPS verification uses
 // the right trust anchor.
 const char* rootCaForUrl(const char* url) {
@@ -47,11 +75,53 @@ const char* rootCaForUrl(const char* url) {
   return "";
 }
 
+// Maximum number of distinct scheme+host origins kept open during one wake.
+// Supabase, n8n, and an optional Discord webhook cover every configured target.
+constexpr size_t kConnectionPoolSlots = 3;
+
+// Timeout applied to requests that do not ask for a specific one. Matches the
+// `HTTPClient` default so pooled clients behave like freshly built ones.
+constexpr uint16_t kDefaultHttpTimeoutMs = 5000U;
+
+// Requests are not started with less wake budget than this left for their
+// priority; a shorter timeout would rarely let them complete.
+constexpr uint32_t kMinRequestBudgetMs = 750;
+
+// Drift from the server `Date` header that is tolerated before the clock is
+// set again. The header has whole-second resolution and arrives after the
+// request's latency, so smaller differences are noise.
+constexpr int64_t kClockResyncThresholdSeconds = 5;
+
+// Per-type webhook limits; the bucket state lives in RTC memory so it carries
+// across deep sleep.
+constexpr envnode::core::AlertLimiterConfig kAlertLimiterConfig{
+    ALERT_BURST, ALERT_REFILL_SECONDS, ALERT_DEDUP_SECONDS};
+
+// Keep-alive connection to one scheme+host origin. `HTTPClient` leaves the
+// socket open after `end()` because reuse is enabled, so the next request to
+// the same origin skips TCP setup and the TLS handshake entirely.
+struct PooledConnection {
+  char origin[96] = "";
+  ResolvingClient plainClient;
+  ResumableTlsClient secureClient;
+  HTTPClient http;
+  uint32_t lastUsedSequence = 0;
+};
+
+char gPayloadBuffer[kPayloadBufferBytes];
+// Gzip output for large Supabase inserts; see `compressPayload()`.
+uint8_t gCompressedBuffer[kPayloadBufferBytes];
+envnode::core::GzipScratch gGzipScratch;
+PooledConnection gConnectionPool[kConnectionPoolSlots];
+uint32_t gConnectionPoolSequence = 0;
+TelemetryConnectionStats gConnectionStats;
+
 // Starts an HTTP or HTTPS request. HTTPS requests require a configured CA
-// unless insecure fallback is explicitly allowed.
+// unless insecure fallback is explicitly allowed, and resume a retained TLS
+// session for the host when one is cached.
 bool beginHttpRequest(HTTPClient& http,
                       WiFiClient& plainClient,
-                      WiFiClientSecure& secureClient,
+                      ResumableTlsClient& secureClient,
                       const char* url) {
   if (!isHttpsUrl(url)) {
     return http.begin(plainClient, url);
@@ -72,57 +142,334 @@ bool beginHttpRequest(HTTPClient& http,
   return http.begin(secureClient, url);
 }
 
-// Adds Cloudflare Access headers only for the protected n8n webhook endpoint.
-void addWebhookAccessHeaders(HTTPClient& http, const char* url) {
+// Returns the Cloudflare Access headers for the protected n8n webhook
+// endpoint, or zero when the URL is not protected or the token is incomplete.
+size_t webhookAccessHeaders(const char* url, HttpHeader* headers) {
   if (!url || strcmp(url, N8N_WEBHOOK_URL) != 0) {
-    return;
+    return 0;
   }
 
   if (N8N_CF_ACCESS_CLIENT_ID[0] && N8N_CF_ACCESS_CLIENT_SECRET[0]) {
-    http.addHeader("CF-Access-Client-Id", N8N_CF_ACCESS_CLIENT_ID);
-    http.addHeader("CF-Access-Client-Secret", N8N_CF_ACCESS_CLIENT_SECRET);
-    return;
+    headers[0] = {"CF-Access-Client-Id", N8N_CF_ACCESS_CLIENT_ID};
+    headers[1] = {"CF-Access-Client-Secret", N8N_CF_ACCESS_CLIENT_SECRET};
+    return 2;
   }
 
   if (N8N_CF_ACCESS_CLIENT_ID[0] || N8N_CF_ACCESS_CLIENT_SECRET[0]) {
     Serial.println("Webhook: Cloudflare Access service token is incomplete; skipping auth headers");
   }
+  return 0;
 }
 
-// Sends one JSON payload to a Supabase REST table endpoint.
-bool supabaseInsert(const char* table, const String& payloadJson) {
-  if (!gApp.networkAvailable) {
-    Serial.printf("Skipping Supabase insert for %s: WiFi unavailable\n", table);
+// Sets the wall clock from the server `Date` header on the first response,
+// and again whenever the RTC slow clock has drifted from it by more than
+// `kClockResyncThresholdSeconds`, so capture timestamps stay accurate through
+// long runs of deep sleep.
+void maybeSyncClockFromResponse(HTTPClient& http) {
+  String dateHeader = http.header("Date");
+  uint32_t serverSeconds = 0;
+  if (!envnode::core::ParseHttpDate(dateHeader.c_str(), serverSeconds)) {
+    return;
+  }
+
+  const uint32_t localSeconds = currentEpochSeconds();
+  if (localSeconds == 0) {
+    setWallClockEpochSeconds(serverSeconds);
+    Serial.printf("Clock: synchronized from HTTP Date header (%s)\n", dateHeader.c_str());
+    return;
+  }
+
+  const int64_t correction =
+      static_cast<int64_t>(serverSeconds) - static_cast<int64_t>(localSeconds);
+  if (correction <= kClockResyncThresholdSeconds && correction >= -kClockResyncThresholdSeconds) {
+    return;
+  }
+  setWallClockEpochSeconds(serverSeconds);
+  Serial.printf("Clock: corrected by %+lld s from HTTP Date header (%s)\n",
+                static_cast<long long>(correction), dateHeader.c_str());
+}
+
+// Copies the `scheme://host[:port]` prefix of `url` into `origin`.
+bool urlOrigin(const char* url, char* origin, size_t originSize) {
+  const char* hostStart = url ? strstr(url, "://") : nullptr;
+  if (!hostStart) {
     return false;
   }
+  hostStart += 3;
+  const size_t length =
+      static_cast<size_t>(hostStart + strcspn(hostStart, "/?#") - url);
+  if (length >= originSize) {
+    return false;
+  }
+  memcpy(origin, url, length);
+  origin[length] = '\0';
+  return true;
+}
+
+// Closes the sockets behind one pooled connection while keeping its origin.
+void stopPooledSockets(PooledConnection& connection) {
+  connection.http.end();
+  connection.plainClient.stop();
+  connection.secureClient.stop();
+}
+
+// Returns the pooled connection for the URL's origin, recycling the least
+// recently used slot when every slot belongs to another host.
+PooledConnection* connectionForUrl(const char* url) {
+  char origin[sizeof(PooledConnection::origin)];
+  if (!urlOrigin(url, origin, sizeof(origin))) {
+    return nullptr;
+  }
 
-  String endpoint = String(SUPABASE_URL) + "/rest/v1/" + table;
-  WiFiClient plainClient;
-  WiFiClientSecure secureClient;
-  HTTPClient http;
+  PooledConnection* victim = &gConnectionPool[0];
+  for (PooledConnection& connection : gConnectionPool) {
+    if (strcmp(connection.origin, origin) == 0) {
+      connection.lastUsedSequence = ++gConnectionPoolSequence;
+      return &connection;
+    }
+    if (connection.lastUsedSequence < victim->lastUsedSequence) {
+      victim = &connection;
+    }
+  }
+
+  if (victim->origin[0]) {
+    stopPooledSockets(*victim);
+  }
+  memcpy(victim->origin, origin, sizeof(origin));
+  victim->http.setReuse(true);
+  victim->lastUsedSequence = ++gConnectionPoolSequence;
+  return victim;
+}
+
+// Sends one request through the keep-alive pool. A reused socket that fails
+// while the request is still being written is retried once on a fresh
+// connection, because the server may have dropped it while idle; failures
+// after that point are not retried so an insert is never sent twice.
+HttpResponse sendPooledRequest(const HttpRequest& request) {
+  HttpResponse result;
+  const uint32_t budgetMs = envnode::core::WakeBudgetRemainingMs(
+      gApp.wakeBudget, millis(), request.priority);
+  if (budgetMs < kMinRequestBudgetMs) {
+    Serial.printf("Budget: skipping %s request (%lu ms left for this priority)\n",
+                  envnode::core::WakePriorityName(request.priority),
+                  static_cast<unsigned long>(budgetMs));
+    result.deferred = true;
+    return result;
+  }
+  const uint16_t timeoutMs = static_cast<uint16_t>(envnode::core::ClampToWakeBudget(
+      gApp.wakeBudget, millis(), request.priority, request.timeoutMs));
+
+  PooledConnection* connection = connectionForUrl(request.url);
+  if (!connection) {
+    Serial.printf("HTTP: unsupported URL %s\n", request.url ? request.url : "(null)");
+    return result;
+  }
+
+  HTTPClient& http = connection->http;
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    result.reusedConnection = http.connected();
+    if (!beginHttpRequest(http, connection->plainClient, connection->secureClient,
+                          request.url)) {
+      stopPooledSockets(*connection);
+      return result;
+    }
+    result.started = true;
+
+    http.setConnectTimeout(timeoutMs);
+    http.setTimeout(timeoutMs);
+    const char* responseHeaders[] = {"Date"};
+    http.collectHeaders(responseHeaders, 1);
+    for (size_t index = 0; index < request.headerCount; ++index) {
+      http.addHeader(request.headers[index].name, request.headers[index].value);
+    }
+
+    uint8_t* payload =
+        reinterpret_cast<uint8_t*>(const_cast<char*>(request.body));
+    uint32_t startedAt = millis();
+    result.code = http.sendRequest(request.method, payload, request.bodyLength);
+    result.elapsedMs = millis() - startedAt;
+    ++gConnectionStats.requests;
+    if (result.reusedConnection) {
+      ++gConnectionStats.connectionsReused;
+    } else if (result.code != HTTPC_ERROR_CONNECTION_REFUSED) {
+      ++gConnectionStats.connectionsOpened;
+    }
+
+    bool staleSocket = result.reusedConnection &&
+                       (result.code == HTTPC_ERROR_SEND_HEADER_FAILED ||
+                        result.code == HTTPC_ERROR_SEND_PAYLOAD_FAILED);
+    if (staleSocket && attempt == 0) {
+      Serial.println("HTTP: kept-alive connection was stale; reconnecting");
+      stopPooledSockets(*connection);
+      continue;
+    }
+    break;
+  }
+
+  // The body must be consumed before the socket can carry the next response.
+  // A body without a length can only be delimited by the server closing the
+  // connection, so that socket is dropped instead of drained.
+  bool keepSocket = result.code > 0;
+  if (result.code > 0) {
+    maybeSyncClockFromResponse(http);
+    int bodySize = http.getSize();
+    if (VERBOSE_HTTP_LOGGING || bodySize > 0) {
+      String body = http.getString();
+      if (VERBOSE_HTTP_LOGGING && body.length()) {
+        Serial.printf("HTTP response body: %s\n", body.c_str());
+      }
+    } else if (bodySize < 0) {
+      keepSocket = false;
+    }
+  }
+
+  if (keepSocket) {
+    http.end();
+  } else {
+    stopPooledSockets(*connection);
+  }
+  return result;
+}
+
+// Routes the shared telemetry dispatch functions through the keep-alive pool.
+class PooledTransport : public envnode::core::HttpTransport {
+ public:
+  HttpResponse Send(const HttpRequest& request) override {
+    return sendPooledRequest(request);
+  }
+};
+
+PooledTransport gTransport;
+
+// Rejects a payload that overflowed its buffer or was left misnested, so a
+// truncated body is never sent.
+bool payloadReady(const JsonWriter& payload, const char* label) {
+  if (payload.Ok() && payload.Complete()) {
+    return true;
+  }
+  Serial.printf("%s payload %s; not sent\n",
+                label,
+                payload.Overflowed() ? "exceeds its buffer" : "is malformed");
+  return false;
+}
 
-  if (!beginHttpRequest(http, plainClient, secureClient, endpoint.c_str())) {
-    Serial.printf("Supabase insert begin failed for %s\n", table);
+// Text buffers backing the string views of a `DeviceMeta`.
+struct DeviceMetaText {
+  char ipAddress[16];
+  char macAddress[18];
+};
+
+// Describes the current boot/session context without building heap strings.
+envnode::core::DeviceMeta currentDeviceMeta(DeviceMetaText& text) {
+  envnode::core::DeviceMeta meta;
+  meta.fwVersion = FW_VERSION;
+  meta.bootMode = bootModeName(gApp.bootMode);
+  meta.runtimeMode = runtimeModeName(gApp.runtimeMode);
+  meta.intervalSeconds = gApp.sampleIntervalSeconds;
+  meta.networkAvailable = gApp.networkAvailable;
+  if (gApp.networkAvailable) {
+    IPAddress ip = WiFi.localIP();
+    snprintf(text.ipAddress, sizeof(text.ipAddress), "%u.%u.%u.%u",
+             ip[0], ip[1], ip[2], ip[3]);
+    uint8_t mac[6];
+    WiFi.macAddress(mac);
+    snprintf(text.macAddress, sizeof(text.macAddress),
+             "%02X:%02X:%02X:%02X:%02X:%02X",
+             mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    meta.ipAddress = text.ipAddress;
+    meta.macAddress = text.macAddress;
+    meta.rssiDbm = WiFi.RSSI();
+    meta.txPowerQuarterDbm = static_cast<int8_t>(WiFi.getTxPower());
+  }
+  meta.sensorSettleMs = gPersistentState.sensorSettleMs;
+  meta.i2cClockKhz = sensorBusClockKhz();
+  meta.i2c = gApp.i2cCounters;
+  meta.sessionId = gApp.sessionId.c_str();
+  return meta;
+}
+
+// Returns `buffer` when the metadata writer finished cleanly, or an empty
+// string so callers simply omit the metadata.
+const char* finishMetaJson(const JsonWriter& writer, char* buffer) {
+  if (payloadReady(writer, "Metadata")) {
+    return buffer;
+  }
+  buffer[0] = '\0';
+  return buffer;
+}
+
+// Offers gzip for large insert bodies unless it is disabled or the server has
+// rejected compressed bodies since the last cold boot.
+envnode::core::InsertCompression insertCompression() {
+  envnode::core::InsertCompression compression;
+  if (UPLOAD_GZIP_ENABLED && !gPersistentState.gzipUploadsRejected) {
+    compression.minBytes = UPLOAD_GZIP_MIN_BYTES;
+    compression.buffer = gCompressedBuffer;
+    compression.capacity = sizeof(gCompressedBuffer);
+    compression.scratch = &gGzipScratch;
+  }
+  return compression;
+}
+
+// Supabase project settings from `secrets.h`.
+envnode::core::SupabaseTarget supabaseTarget() {
+  envnode::core::SupabaseTarget target;
+  target.url = SUPABASE_URL;
+  target.apiKey = SUPABASE_API_KEY;
+  return target;
+}
+
+// Sends one JSON payload to a Supabase REST table endpoint. When `columns` is
+// provided, rows may omit keys and let the table defaults fill them in.
+bool supabaseInsert(const char* table,
+                    const JsonWriter& payload,
+                    const char* columns,
+                    WakePriority priority) {
+  if (!gApp.networkAvailable) {
+    Serial.printf("Skipping Supabase insert for %s: WiFi unavailable\n", table);
+    return false;
+  }
+  if (!payloadReady(payload, table)) {
     return false;
   }
 
-  http.addHeader("Content-Type", "application/json");
-  http.addHeader("Prefer", "return=minimal");
-  String authHeader = String("Bearer ") + SUPABASE_API_KEY;
-  http.addHeader("apikey", SUPABASE_API_KEY);
-  http.addHeader("Authorization", authHeader);
+  envnode::core::SupabaseInsert insert;
+  insert.table = table;
+  insert.columns = columns;
+  insert.body = payload.Data();
+  insert.bodyLength = payload.Length();
+  insert.timeoutMs = kDefaultHttpTimeoutMs;
+  insert.priority = priority;
+  const envnode::core::InsertResult insertResult = envnode::core::SendSupabaseInsert(
+      gTransport, supabaseTarget(), insert, insertCompression());
+  const HttpResponse& result = insertResult.response;
+  if (insertResult.compressedCode) {
+    Serial.printf("POST %s -> %d with gzip body; retried uncompressed\n", table,
+                  insertResult.compressedCode);
+  }
+  if (insertResult.compressionRejected) {
+    // The server only rejected the encoding; stop offering it until the next
+    // cold boot.
+    gPersistentState.gzipUploadsRejected = true;
+  }
+  if (!result.started) {
+    if (!result.deferred) {
+      Serial.printf("Supabase insert begin failed for %s\n", table);
+    }
+    return false;
+  }
 
-  unsigned long startedAt = millis();
-  int code = http.POST(payloadJson);
-  Serial.printf("POST %s -> %d (%lu ms)\n",
+  Serial.printf("POST %s -> %d (%lu ms, %u bytes%s%s)\n",
                 table,
-                code,
-                static_cast<unsigned long>(millis() - startedAt));
-  if (code < 0) {
-    Serial.printf("HTTP error: %s\n", http.errorToString(code).c_str());
-  }
-  http.end();
-  return code >= 200 && code < 300;
+                result.code,
+                static_cast<unsigned long>(result.elapsedMs),
+                static_cast<unsigned>(insertResult.sentBytes),
+                insertResult.compressed ? " gzip" : "",
+                result.reusedConnection ? ", reused connection" : "");
+  if (result.code < 0) {
+    Serial.printf("HTTP error: %s\n", HTTPClient::errorToString(result.code).c_str());
+  }
+  return HttpSucceeded(result);
 }
 
 // Issues a lightweight GET against a Supabase table so startup can confirm the
@@ -133,60 +480,141 @@ bool supabaseTableExists(const char* table) {
     return false;
   }
 
-  String endpoint = String(SUPABASE_URL) + "/rest/v1/" + table + "?select=*&limit=1";
-  WiFiClient plainClient;
-  WiFiClientSecure secureClient;
-  HTTPClient http;
-
-  if (!beginHttpRequest(http, plainClient, secureClient, endpoint.c_str())) {
-    Serial.printf("Supabase table check: begin failed for %s\n", table);
+  const HttpResponse result = envnode::core::SendSupabaseProbe(
+      gTransport, supabaseTarget(), table, kDefaultHttpTimeoutMs, WakePriority::Backlog);
+  if (!result.started) {
+    if (!result.deferred) {
+      Serial.printf("Supabase table check: begin failed for %s\n", table);
+    }
     return false;
   }
 
-  http.addHeader("Accept", "application/json");
-  http.addHeader("Range-Unit", "items");
-  http.addHeader("Range", "0-0");
-  String authHeader = String("Bearer ") + SUPABASE_API_KEY;
-  http.addHeader("apikey", SUPABASE_API_KEY);
-  http.addHeader("Authorization", authHeader);
-
-  unsigned long startedAt = millis();
-  int code = http.GET();
-  if (code < 0) {
+  if (result.code < 0) {
     Serial.printf("Supabase table check: HTTP error for %s -> %s\n",
                   table,
-                  http.errorToString(code).c_str());
+                  HTTPClient::errorToString(result.code).c_str());
   } else {
     Serial.printf("Supabase table check %s -> %d (%lu ms)\n",
                   table,
-                  code,
-                  static_cast<unsigned long>(millis() - startedAt));
+                  result.code,
+                  static_cast<unsigned long>(result.elapsedMs));
   }
-  http.end();
-  return code >= 200 && code < 300;
+  return HttpSucceeded(result);
 }
 
-// Builds and posts a readings-table row. Battery fields are only included when
-// a battery reading was available in the current cycle.
-bool postReadingRow(float temperatureC,
-                    float humidityRh,
-                    float pressureHpa,
-                    float batteryVoltage,
-                    float batteryPercent) {
-  String payload = String("{\"device_id\":\"") + DEVICE_ID +
-                   "\",\"temperature_c\":" + String(temperatureC, 2) +
-                   ",\"humidity_rh\":" + String(humidityRh, 2) +
-                   ",\"pressure_hpa\":" + String(pressureHpa, 2);
-  if (!isnan(batteryVoltage)) {
-    payload += ",\"battery_voltage_v\":" + String(batteryVoltage, 3);
-    payload += ",\"battery_pct\":" + String(batteryPercent, 1);
+// Formats and sends one structured webhook notification from the shared
+// payload buffer. `message` may point at a stack buffer.
+bool sendStructuredWebhook(const char* alertType,
+                           const char* message,
+                           const char* severity,
+                           const SensorReadings* readings,
+                           const char* extraData,
+                           WakePriority priority = WakePriority::Webhook) {
+  if (!gApp.networkAvailable) {
+    Serial.printf("Skipping webhook %s: WiFi unavailable\n", alertType);
+    return false;
+  }
+
+  // Debug heartbeats have their own cadence and are only sent by debug builds.
+  const bool rateLimited =
+      ALERT_RATE_LIMIT_ENABLED && priority != WakePriority::Heartbeat;
+  const uint32_t clockSeconds = rtcClockSeconds();
+  uint16_t suppressedCount = 0;
+  if (rateLimited) {
+    const envnode::core::AlertDecision decision = envnode::core::CheckAlert(
+        gPersistentState.webhookLimiter, kAlertLimiterConfig, alertType, message, clockSeconds);
+    suppressedCount =
+        envnode::core::SuppressedAlertCount(gPersistentState.webhookLimiter, alertType);
+    if (decision != envnode::core::AlertDecision::Send) {
+      Serial.printf("Webhook: suppressed %s (%s, %u suppressed since the last one sent)\n",
+                    alertType,
+                    envnode::core::AlertDecisionName(decision),
+                    static_cast<unsigned>(suppressedCount));
+      return false;
+    }
+  }
+
+  envnode::core::BatchedReading readingSnapshot;
+  envnode::core::WebhookPayload webhook;
+  webhook.deviceId = DEVICE_ID;
+  webhook.alertType = alertType;
+  webhook.severity = severity;
+  webhook.message = message;
+  webhook.timestampMs = millis();
+  webhook.fwVersion = FW_VERSION;
+  webhook.suppressedCount = suppressedCount;
+  if (readings) {
+    readingSnapshot.temperature = readings->temperature;
+    readingSnapshot.humidity = readings->humidity;
+    readingSnapshot.pressure = readings->pressure;
+    readingSnapshot.batteryVoltage = readings->batteryVoltage;
+    readingSnapshot.batteryPercent = readings->batteryPercent;
+    webhook.readings = &readingSnapshot;
+  }
+  webhook.extraJson = extraData ? extraData : "";
+
+  JsonWriter payload(gPayloadBuffer, sizeof(gPayloadBuffer));
+  envnode::core::WriteWebhookPayload(payload, webhook);
+  if (!payloadReady(payload, "Webhook")) {
+    return false;
+  }
+
+  HttpHeader accessHeaders[2];
+  const size_t accessHeaderCount = webhookAccessHeaders(N8N_WEBHOOK_URL, accessHeaders);
+  const HttpResponse result = envnode::core::SendJsonPost(
+      gTransport, N8N_WEBHOOK_URL, accessHeaders, accessHeaderCount, payload.Data(),
+      payload.Length(), WEBHOOK_TIMEOUT_MS, priority);
+  if (!result.started) {
+    if (!result.deferred) {
+      Serial.println("Webhook: begin failed");
+    }
+    return false;
+  }
+
+  int code = result.code;
+  Serial.printf("Webhook POST [%s/%s] -> %d\n", alertType, severity, code);
+  if (code < 0) {
+    Serial.printf("Webhook error: %s\n", HTTPClient::errorToString(code).c_str());
   }
-  payload += "}";
-  return supabaseInsert(SUPABASE_TABLE, payload);
+
+  bool ok = HttpSucceeded(result);
+  if (ok && rateLimited) {
+    envnode::core::RecordAlertSent(
+        gPersistentState.webhookLimiter, kAlertLimiterConfig, alertType, message, clockSeconds);
+  }
+  return ok;
 }
 
 }  // namespace
 
+// Returns request and connection counters since the pool was last closed.
+const TelemetryConnectionStats& telemetryConnectionStats() {
+  return gConnectionStats;
+}
+
+// Closes every kept-alive connection and logs how many requests shared them.
+void closeTelemetryConnections() {
+  for (PooledConnection& connection : gConnectionPool) {
+    if (connection.origin[0]) {
+      stopPooledSockets(connection);
+      connection.origin[0] = '\0';
+      connection.lastUsedSequence = 0;
+    }
+  }
+
+  if (gConnectionStats.requests > 0) {
+    const TlsHandshakeStats& tls = tlsHandshakeStats();
+    Serial.printf("HTTP: %lu request(s) over %lu connection(s), %lu reused; "
+                  "TLS handshakes since boot: %lu full, %lu resumed\n",
+                  static_cast<unsigned long>(gConnectionStats.requests),
+                  static_cast<unsigned long>(gConnectionStats.connectionsOpened),
+                  static_cast<unsigned long>(gConnectionStats.connectionsReused),
+                  static_cast<unsigned long>(tls.fullHandshakes),
+                  static_cast<unsigned long>(tls.resumedHandshakes));
+  }
+  gConnectionStats = TelemetryConnectionStats{};
+}
+
 // Performs a one-time startup check that both configured Supabase tables are
 // reachable.
 bool checkSupabaseTablesOnce() {
@@ -210,138 +638,134 @@ bool checkSupabaseTablesOnce() {
   return false;
 }
 
-// Posts one validated reading to Supabase and prints a concise serial result.
-bool postReadings(const SensorReadings& readings) {
-  if (isnan(readings.temperature) || isnan(readings.humidity) ||
-      isnan(readings.pressure)) {
-    Serial.println("Sensor returned NaN (check the BME680 wiring and power).");
+// Uploads the given readings as one PostgREST bulk insert.
+bool uploadReadingBatch(const envnode::core::ReadingRing& readings, WakePriority priority) {
+  JsonWriter payload(gPayloadBuffer, sizeof(gPayloadBuffer));
+  envnode::core::WriteReadingBatch(payload, readings, readings.count, DEVICE_ID);
+  return supabaseInsert(SUPABASE_TABLE, payload, kReadingColumns, priority);
+}
+
+// Uploads the gateway's oldest rows, each under its own node's device ID.
+size_t uploadGatewayReadingBatch(const envnode::core::EspNowGateway& gateway,
+                                 size_t maxRows,
+                                 WakePriority priority) {
+  JsonWriter payload(gPayloadBuffer, sizeof(gPayloadBuffer));
+  const size_t rows = envnode::core::WriteGatewayReadingBatch(payload, gateway, maxRows);
+  return supabaseInsert(SUPABASE_TABLE, payload, kReadingColumns, priority) ? rows : 0;
+}
+
+// Uploads the given event rows as one bulk insert into the events table.
+bool uploadEventBatch(const envnode::core::EventBatch& events, WakePriority priority) {
+  JsonWriter payload(gPayloadBuffer, sizeof(gPayloadBuffer));
+  envnode::core::WriteEventBatch(payload, events);
+  return supabaseInsert(SUPABASE_EVENTS_TABLE, payload, kEventColumns, priority);
+}
+
+// Uploads the retained readings and drops them from the ring once the server
+// has accepted them.
+bool flushPendingReadings() {
+  auto& ring = gPersistentState.pendingReadings;
+  if (ring.count == 0) {
+    return true;
+  }
+
+  const unsigned rows = ring.count;
+  bool ok = uploadReadingBatch(ring);
+  if (ok) {
+    envnode::core::DropOldestReadings(ring, rows);
+  }
+  Serial.printf("Upload %s (%u reading(s), %u still pending)\n",
+                ok ? "ok" : "failed",
+                rows,
+                static_cast<unsigned>(ring.count));
+  return ok;
+}
+
+// Uploads every buffered event as one bulk insert into the events table.
+bool flushPendingEvents() {
+  auto& batch = gApp.pendingEvents;
+  if (batch.count == 0) {
+    return true;
+  }
+  if (!gApp.networkAvailable) {
     return false;
   }
 
-  bool ok = postReadingRow(readings.temperature,
-                           readings.humidity,
-                           readings.pressure,
-                           readings.batteryVoltage,
-                           readings.batteryPercent);
-  Serial.println(ok ? "Upload ok" : "Upload failed");
+  const unsigned events = batch.count;
+  bool ok = uploadEventBatch(batch);
+  if (ok) {
+    envnode::core::ResetEventBatch(batch);
+  }
+  Serial.printf("Events %s (%u event(s) in one insert)\n",
+                ok ? "logged" : "log failed",
+                events);
   return ok;
 }
 
-// Builds an event payload and writes it to the configured events table.
+// Returns how many events are buffered for the next events insert.
+size_t pendingEventCount() {
+  return gApp.pendingEvents.count;
+}
+
+// Buffers an event row for the next batched insert into the events table.
 bool postEvent(const char* eventType,
                const char* severity,
-               const String& message,
+               const char* message,
                const SensorReadings* snapshot,
                const char* action,
                int attempt,
                bool actionSuccess,
                const char* metaJson) {
-  String payload = "{";
-  payload += "\"device_id\":\"" + String(DEVICE_ID) + "\"";
-  if (gApp.sessionId.length()) {
-    payload += ",\"session_id\":\"" + gApp.sessionId + "\"";
-  }
-  payload += ",\"event_type\":\"" + String(eventType) + "\"";
-  payload += ",\"severity\":\"" + String(severity) + "\"";
-  if (message.length()) {
-    payload += ",\"message\":\"" + jsonEscape(message) + "\"";
-  }
+  envnode::core::LogicReadings snapshotReadings;
+  envnode::core::EventPayload event;
+  event.deviceId = DEVICE_ID;
+  event.createdAtEpoch = currentEpochSeconds();
+  event.sessionId = gApp.sessionId.c_str();
+  event.eventType = eventType;
+  event.severity = severity;
+  event.message = message;
   if (snapshot) {
-    payload += ",\"reading_temp_c\":" + String(snapshot->temperature, 2);
-    payload += ",\"reading_humidity_rh\":" + String(snapshot->humidity, 2);
-    payload += ",\"reading_pressure_hpa\":" + String(snapshot->pressure, 2);
-  }
-  if (action) {
-    payload += ",\"action\":\"" + String(action) + "\"";
-  }
-  if (attempt) {
-    payload += ",\"attempt\":" + String(attempt);
-  }
-  payload += ",\"action_success\":" + String(actionSuccess ? "true" : "false");
-  if (metaJson && metaJson[0]) {
-    payload += ",\"meta\":" + String(metaJson);
+    snapshotReadings.temperature = snapshot->temperature;
+    snapshotReadings.humidity = snapshot->humidity;
+    snapshotReadings.pressure = snapshot->pressure;
+    event.snapshot = &snapshotReadings;
+  }
+  event.action = action;
+  event.attempt = attempt;
+  event.actionSuccess = actionSuccess;
+  event.metaJson = metaJson ? metaJson : "";
+
+  auto& batch = gApp.pendingEvents;
+  bool queued = envnode::core::AppendEvent(batch, event);
+  if (!queued && gApp.networkAvailable && flushPendingEvents()) {
+    queued = envnode::core::AppendEvent(batch, event);
+  }
+  if (!queued) {
+    Serial.printf("EVENT[%s/%s]: dropped (event buffer full, %lu dropped total)\n",
+                  eventType,
+                  severity,
+                  static_cast<unsigned long>(batch.dropped));
+    return false;
   }
-  payload += "}";
 
-  bool ok = supabaseInsert(SUPABASE_EVENTS_TABLE, payload);
-  Serial.printf("EVENT[%s/%s]: %s\n", eventType, severity, ok ? "logged" : "log failed");
-  return ok;
+  Serial.printf("EVENT[%s/%s]: queued (%u pending)\n",
+                eventType,
+                severity,
+                static_cast<unsigned>(batch.count));
+  if (EVENT_ERROR_FLUSH_ENABLED && strcmp(severity, "error") == 0 &&
+      gApp.networkAvailable) {
+    return flushPendingEvents();
+  }
+  return true;
 }
 
 // Sends a webhook payload with optional reading data and extra JSON metadata.
 bool sendWebhook(const char* alertType,
-                 const String& message,
+                 const char* message,
                  const char* severity,
                  const SensorReadings* readings,
                  const char* extraData) {
-  if (!gApp.networkAvailable) {
-    Serial.printf("Skipping webhook %s: WiFi unavailable\n", alertType);
-    return false;
-  }
-
-  unsigned long now = millis();
-  bool isError = strcmp(severity, "error") == 0 || strcmp(severity, "warning") == 0;
-  if (isError && now - gApp.lastWebhookSent < WEBHOOK_COOLDOWN_MS) {
-    Serial.printf("Webhook: skipping (cooldown active, %lu ms remaining)\n",
-                  WEBHOOK_COOLDOWN_MS - (now - gApp.lastWebhookSent));
-    return false;
-  }
-
-  String payload = "{";
-  payload += "\"device_id\":\"" + String(DEVICE_ID) + "\"";
-  payload += ",\"alert_type\":\"" + String(alertType) + "\"";
-  payload += ",\"severity\":\"" + String(severity) + "\"";
-  payload += ",\"message\":\"" + jsonEscape(message) + "\"";
-  payload += ",\"timestamp\":" + String(millis());
-  payload += ",\"fw_version\":\"" + String(FW_VERSION) + "\"";
-  if (readings && !isnan(readings->temperature)) {
-    payload += ",\"readings\":{";
-    payload += "\"temperature_c\":" + String(readings->temperature, 2);
-    payload += ",\"humidity_rh\":" + String(readings->humidity, 2);
-    payload += ",\"pressure_hpa\":" + String(readings->pressure, 2);
-    if (!isnan(readings->batteryVoltage)) {
-      payload += ",\"battery_voltage_v\":" + String(readings->batteryVoltage, 3);
-      payload += ",\"battery_pct\":" + String(readings->batteryPercent, 1);
-    }
-    payload += "}";
-  }
-  if (extraData && extraData[0]) {
-    payload += ",\"extra\":" + String(extraData);
-  }
-  payload += "}";
-
-  WiFiClient plainClient;
-  WiFiClientSecure secureClient;
-  HTTPClient http;
-  http.setConnectTimeout(WEBHOOK_TIMEOUT_MS);
-  http.setTimeout(WEBHOOK_TIMEOUT_MS);
-
-  if (!beginHttpRequest(http, plainClient, secureClient, N8N_WEBHOOK_URL)) {
-    Serial.println("Webhook: begin failed");
-    return false;
-  }
-
-  http.addHeader("Content-Type", "application/json");
-  addWebhookAccessHeaders(http, N8N_WEBHOOK_URL);
-  int code = http.POST(payload);
-  String responseBody;
-  if (VERBOSE_HTTP_LOGGING && code > 0) {
-    responseBody = http.getString();
-  }
-
-  Serial.printf("Webhook POST [%s/%s] -> %d\n", alertType, severity, code);
-  if (code < 0) {
-    Serial.printf("Webhook error: %s\n", http.errorToString(code).c_str());
-  } else if (VERBOSE_HTTP_LOGGING && responseBody.length()) {
-    Serial.printf("Webhook response body: %s\n", responseBody.c_str());
-  }
-
-  http.end();
-  bool ok = code >= 200 && code < 300;
-  if (ok) {
-    gApp.lastWebhookSent = now;
-  }
-  return ok;
+  return sendStructuredWebhook(alertType, message, severity, readings, extraData);
 }
 
 // Sends the per-cycle debug heartbeat, either as a Discord message or the
@@ -366,102 +790,109 @@ bool sendDebugDiscordMessage(const SensorReadings* readings,
   }
 
   bool useStructuredWebhookPayload = strcmp(debugWebhookUrl, N8N_WEBHOOK_URL) == 0;
-  String content = String("ESP debug heartbeat `") + DEVICE_ID + "` ";
-  content += uploadOk ? "upload ok" : "upload failed";
-  content += " | interval=" + String(gApp.sampleIntervalSeconds) + "s";
-  content += " | cycle_ms=" + String(millis() - cycleStartedAtMs);
-  if (readings) {
-    content += " | T=" + String(readings->temperature, 2) + "C";
-    content += " RH=" + String(readings->humidity, 1) + "%";
-    content += " P=" + String(readings->pressure, 1) + "hPa";
-  }
-  if (gApp.networkAvailable) {
-    content += " | IP=" + WiFi.localIP().toString();
-    content += " RSSI=" + String(WiFi.RSSI());
+  const uint32_t cycleMs = millis() - cycleStartedAtMs;
+  char content[256];
+  int contentLength = snprintf(content, sizeof(content),
+                               "ESP debug heartbeat `%s` %s | interval=%lus | cycle_ms=%lu",
+                               DEVICE_ID,
+                               uploadOk ? "upload ok" : "upload failed",
+                               static_cast<unsigned long>(gApp.sampleIntervalSeconds),
+                               static_cast<unsigned long>(cycleMs));
+  if (readings && contentLength > 0 &&
+      static_cast<size_t>(contentLength) < sizeof(content)) {
+    contentLength += snprintf(content + contentLength,
+                              sizeof(content) - contentLength,
+                              " | T=%.2fC RH=%.1f%% P=%.1fhPa",
+                              readings->temperature,
+                              readings->humidity,
+                              readings->pressure);
+  }
+  if (gApp.networkAvailable && contentLength > 0 &&
+      static_cast<size_t>(contentLength) < sizeof(content)) {
+    IPAddress ip = WiFi.localIP();
+    snprintf(content + contentLength,
+             sizeof(content) - contentLength,
+             " | IP=%u.%u.%u.%u RSSI=%d",
+             ip[0], ip[1], ip[2], ip[3],
+             static_cast<int>(WiFi.RSSI()));
   }
 
   if (useStructuredWebhookPayload) {
-    String extra = String("{\"mode\":\"debug\",\"interval_s\":") +
-                   String(gApp.sampleIntervalSeconds) +
-                   ",\"cycle_ms\":" + String(millis() - cycleStartedAtMs) +
-                   ",\"upload_ok\":" + String(uploadOk ? "true" : "false") + "}";
-    return sendWebhook("debug_heartbeat",
-                       content,
-                       uploadOk ? "info" : "warning",
-                       readings,
-                       extra.c_str());
-  }
-
-  String payload = String("{\"content\":\"") + jsonEscape(content) + "\"}";
-  WiFiClient plainClient;
-  WiFiClientSecure secureClient;
-  HTTPClient http;
-  http.setConnectTimeout(WEBHOOK_TIMEOUT_MS);
-  http.setTimeout(WEBHOOK_TIMEOUT_MS);
-
-  if (!beginHttpRequest(http, plainClient, secureClient, debugWebhookUrl)) {
-    Serial.println("Discord debug webhook: begin failed");
+    char extra[128];
+    JsonWriter extraWriter(extra, sizeof(extra));
+    envnode::core::WriteDebugHeartbeatExtra(extraWriter,
+                                            gApp.sampleIntervalSeconds,
+                                            cycleMs,
+                                            uploadOk);
+    return sendStructuredWebhook("debug_heartbeat",
+                                 content,
+                                 uploadOk ? "info" : "warning",
+                                 readings,
+                                 finishMetaJson(extraWriter, extra),
+                                 WakePriority::Heartbeat);
+  }
+
+  JsonWriter payload(gPayloadBuffer, sizeof(gPayloadBuffer));
+  envnode::core::WriteDiscordPayload(payload, content);
+  if (!payloadReady(payload, "Discord debug")) {
     return false;
   }
 
-  http.addHeader("Content-Type", "application/json");
-  addWebhookAccessHeaders(http, debugWebhookUrl);
-  int code = http.POST(payload);
-  String responseBody;
-  if (VERBOSE_HTTP_LOGGING && code > 0) {
-    responseBody = http.getString();
+  HttpHeader accessHeaders[2];
+  const size_t accessHeaderCount = webhookAccessHeaders(debugWebhookUrl, accessHeaders);
+  const HttpResponse result = envnode::core::SendJsonPost(
+      gTransport, debugWebhookUrl, accessHeaders, accessHeaderCount, payload.Data(),
+      payload.Length(), WEBHOOK_TIMEOUT_MS, WakePriority::Heartbeat);
+  if (!result.started) {
+    if (!result.deferred) {
+      Serial.println("Discord debug webhook: begin failed");
+    }
+    return false;
   }
-  http.end();
 
+  int code = result.code;
   Serial.printf("Discord debug webhook -> %d\n", code);
   if (code < 0) {
-    Serial.printf("Discord debug webhook error: %s\n", http.errorToString(code).c_str());
-  } else if (VERBOSE_HTTP_LOGGING && responseBody.length()) {
-    Serial.printf("Discord debug response: %s\n", responseBody.c_str());
+    Serial.printf("Discord debug webhook error: %s\n", HTTPClient::errorToString(code).c_str());
   }
-  return code >= 200 && code < 300;
+  return HttpSucceeded(result);
 }
 
-// Builds a compact JSON object describing the current boot/session context.
-String buildBootMetaJson(bool firstReadingFailed) {
-  String meta = String("{\"fw\":\"") + FW_VERSION +
-                "\",\"boot_mode\":\"" + bootModeName(gApp.bootMode) +
-                "\",\"runtime_mode\":\"" + runtimeModeName(gApp.runtimeMode) +
-                "\",\"interval_s\":" + String(gApp.sampleIntervalSeconds);
-  if (gApp.networkAvailable) {
-    meta += ",\"ip\":\"" + WiFi.localIP().toString() +
-            "\",\"mac_address\":\"" + WiFi.macAddress() +
-            "\",\"rssi_dbm\":" + String(WiFi.RSSI());
-  }
-  if (gApp.sessionId.length()) {
-    meta += ",\"session_id\":\"" + gApp.sessionId + "\"";
-  }
-  if (firstReadingFailed) {
-    meta += ",\"first_reading_failed\":true";
-  }
-  meta += "}";
-  return meta;
+// Writes a compact JSON object describing the current boot/session context.
+const char* buildBootMetaJson(bool firstReadingFailed, char* buffer, size_t bufferSize) {
+  DeviceMetaText text;
+  JsonWriter writer(buffer, bufferSize);
+  envnode::core::WriteBootMeta(writer, currentDeviceMeta(text), firstReadingFailed);
+  return finishMetaJson(writer, buffer);
 }
 
-// Builds a compact JSON object describing the current USB service-mode context.
-String buildServiceModeMetaJson() {
-  String meta = String("{\"fw\":\"") + FW_VERSION +
-                "\",\"boot_mode\":\"" + bootModeName(gApp.bootMode) +
-                "\",\"runtime_mode\":\"" + runtimeModeName(gApp.runtimeMode) +
-                "\",\"usb_host_attached\":" +
-                String(isUsbHostAttached() ? "true" : "false") +
-                ",\"readings_paused\":true" +
-                ",\"interval_s\":" + String(gApp.sampleIntervalSeconds);
-  if (gApp.networkAvailable) {
-    meta += ",\"ip\":\"" + WiFi.localIP().toString() +
-            "\",\"mac_address\":\"" + WiFi.macAddress() +
-            "\",\"rssi_dbm\":" + String(WiFi.RSSI());
-  }
-  if (gApp.sessionId.length()) {
-    meta += ",\"session_id\":\"" + gApp.sessionId + "\"";
-  }
-  meta += "}";
-  return meta;
+// Writes the sensor bus clock and I2C counters as a compact JSON object.
+const char* buildI2cBusMetaJson(char* buffer, size_t bufferSize) {
+  JsonWriter writer(buffer, bufferSize);
+  envnode::core::WriteI2cBusMeta(writer, sensorBusClockKhz(), gApp.i2cCounters);
+  return finishMetaJson(writer, buffer);
+}
+
+// Writes a compact JSON object describing the current USB service-mode context.
+const char* buildServiceModeMetaJson(char* buffer, size_t bufferSize) {
+  DeviceMetaText text;
+  JsonWriter writer(buffer, bufferSize);
+  envnode::core::WriteServiceModeMeta(writer, currentDeviceMeta(text),
+                                      isUsbHostAttached());
+  return finishMetaJson(writer, buffer);
+}
+
+// Writes the battery thresholds and measurement attached to battery alerts.
+const char* buildBatteryAlertMetaJson(const SensorReadings& readings,
+                                      char* buffer,
+                                      size_t bufferSize) {
+  JsonWriter writer(buffer, bufferSize);
+  envnode::core::WriteBatteryAlertMeta(writer,
+                                       readings.batteryVoltage,
+                                       readings.batteryPercent,
+                                       LOW_BATTERY_ALERT_V,
+                                       LOW_BATTERY_CLEAR_V);
+  return finishMetaJson(writer, buffer);
 }
 
 // Emits a fixed set of test webhook payloads so endpoints can be validated
@@ -476,15 +907,19 @@ void testWebhooks() {
   sample.batteryVoltage = 3.95f;
   sample.batteryPercent = 79.0f;
 
-  String extra = String("{\"test_mode\":true,\"ip_address\":\"") +
-                 WiFi.localIP().toString() + "\"}";
+  char ipAddress[16];
+  const IPAddress ip = WiFi.localIP();
+  snprintf(ipAddress, sizeof(ipAddress), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+  char buffer[META_JSON_MAX_BYTES];
+  JsonWriter writer(buffer, sizeof(buffer));
+  envnode::core::WriteTestWebhookExtra(writer, ipAddress);
+  const char* extra = finishMetaJson(writer, buffer);
 
-  sendWebhook("device_startup", "Device booted successfully", "info", &sample,
-              extra.c_str());
+  sendWebhook("device_startup", "Device booted successfully", "info", &sample, extra);
   sendWebhook("sensor_error", "Device entering error state - attempting recovery",
-              "warning", &sample, extra.c_str());
+              "warning", &sample, extra);
   sendWebhook("recovery_failed", "Device failed to recover - dropping reading",
-              "error", &sample, extra.c_str());
+              "error", &sample, extra);
   sendWebhook("sensor_recovered", "Device successfully recovered from error state",
-              "info", &sample, extra.c_str());
+              "info", &sample, extra);
 }
@@ -7,28 +7,75 @@
 
 #include "app_context.h"
 
+#include <espnow_gateway.h>
+#include <wake_budget.h>
+
+// Buffer size callers should use for the metadata builders below.
+constexpr size_t META_JSON_MAX_BYTES = 448;
+
+// Request counters for the keep-alive connection pool. Every request either
+// opens a new connection or reuses one left open by an earlier request to the
+// same scheme+host.
+struct TelemetryConnectionStats {
+  uint32_t requests = 0;
+  uint32_t connectionsOpened = 0;
+  uint32_t connectionsReused = 0;
+};
+
 // Performs a lightweight readiness check against the configured Supabase tables.
 bool checkSupabaseTablesOnce();
 
-// Posts one accepted reading to the configured readings table.
-bool postReadings(const SensorReadings& readings);
+// Uploads every reading waiting in the retained ring as one bulk insert into
+// the configured readings table. Returns true when nothing is left pending.
+bool flushPendingReadings();
+
+// Uploads `readings` as one bulk insert into the configured readings table
+// without modifying them. Used for the retained ring and for journal replay,
+// which passes a lower wake-budget priority.
+bool uploadReadingBatch(
+    const envnode::core::ReadingRing& readings,
+    envnode::core::WakePriority priority = envnode::core::WakePriority::Reading);
+
+// Uploads up to `maxRows` of the ESP-NOW gateway's queued rows from all of its
+// nodes as one bulk insert into the readings table, without modifying them.
+// Returns the number of rows the server accepted, or 0.
+size_t uploadGatewayReadingBatch(
+    const envnode::core::EspNowGateway& gateway,
+    size_t maxRows,
+    envnode::core::WakePriority priority = envnode::core::WakePriority::Reading);
+
+// Uploads `events` as one bulk insert into the events table without modifying
+// them. Used for the in-memory buffer and for journal replay.
+bool uploadEventBatch(
+    const envnode::core::EventBatch& events,
+    envnode::core::WakePriority priority = envnode::core::WakePriority::Event);
 
-// Posts an operational event to the events table. Optional fields allow the
-// caller to attach a reading snapshot, action name, attempt count, and JSON
-// metadata when those details are available.
+// Queues an operational event for the next batched events insert. Optional
+// fields allow the caller to attach a reading snapshot, action name, attempt
+// count, and JSON metadata when those details are available. Error-severity
+// events flush the buffer immediately when `FLUSH_EVENTS_ON_ERROR` is set and
+// Wi-Fi is up. Returns false when the event could not be buffered or that
+// immediate flush failed.
 bool postEvent(const char* eventType,
                const char* severity,
-               const String& message,
+               const char* message,
                const SensorReadings* snapshot = nullptr,
                const char* action = nullptr,
                int attempt = 0,
                bool actionSuccess = false,
                const char* metaJson = nullptr);
 
+// Uploads every buffered event as one bulk insert. Returns true when nothing is
+// left pending; events stay buffered while Wi-Fi is unavailable.
+bool flushPendingEvents();
+
+// Returns how many events are waiting for the next batched insert.
+size_t pendingEventCount();
+
 // Sends a webhook notification for startup, errors, recovery, battery alerts,
 // or debug heartbeats.
 bool sendWebhook(const char* alertType,
-                 const String& message,
+                 const char* message,
                  const char* severity = "info",
                  const SensorReadings* readings = nullptr,
                  const char* extraData = nullptr);
@@ -38,11 +85,30 @@ bool sendDebugDiscordMessage(const SensorReadings* readings,
                              bool uploadOk,
                              unsigned long cycleStartedAtMs);
 
-// Builds JSON metadata describing the current boot and first-reading outcome.
-String buildBootMetaJson(bool firstReadingFailed);
+// Writes JSON metadata describing the current boot and first-reading outcome
+// into `buffer` and returns it. The result is empty if it did not fit.
+const char* buildBootMetaJson(bool firstReadingFailed, char* buffer, size_t bufferSize);
+
+// Writes JSON metadata describing USB service mode and its paused state into
+// `buffer` and returns it. The result is empty if it did not fit.
+const char* buildServiceModeMetaJson(char* buffer, size_t bufferSize);
+
+// Writes JSON metadata with the sensor bus clock and this wake's I2C fault
+// counters into `buffer` and returns it. The result is empty if it did not fit.
+const char* buildI2cBusMetaJson(char* buffer, size_t bufferSize);
+
+// Writes JSON metadata for a battery low/recovered alert into `buffer` and
+// returns it. The result is empty if it did not fit.
+const char* buildBatteryAlertMetaJson(const SensorReadings& readings,
+                                      char* buffer,
+                                      size_t bufferSize);
+
+// Returns request and connection counters since the pool was last closed.
+const TelemetryConnectionStats& telemetryConnectionStats();
 
-// Builds JSON metadata describing USB service mode and its paused state.
-String buildServiceModeMetaJson();
+// Closes every kept-alive Supabase/webhook connection and logs the request,
+// connection, and TLS handshake counts for the wake. Called before sleep.
+void closeTelemetryConnections();
 
 // Sends a small set of synthetic webhook examples for manual endpoint testing.
 void testWebhooks();
@@ -0,0 +1,519 @@
+// mbedTLS-backed HTTPS client with RTC-retained session resumption.
+//
+// Sessions are serialized without the peer certificate so each cached entry
+// stays small enough for RTC memory. Resumption skips the certificate exchange
+// and key agreement entirely; if the server no longer accepts the cached
+// session, mbedTLS falls back to a full handshake on the same connection.
+
+#include "tls_client.h"
+
+#include <mbedtls/ctr_drbg.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/net_sockets.h>
+#include <mbedtls/ssl.h>
+#include <mbedtls/version.h>
+#include <mbedtls/x509_crt.h>
+
+#include "app_context.h"
+#include "wifi_manager.h"
+
+// Resumption detection and the peer certificate drop below use session fields
+// that mbedTLS 3.x made private; platformio.ini pins a 2.x platform.
+#if MBEDTLS_VERSION_NUMBER >= 0x03000000
+#error "tls_client.cpp needs mbedTLS 2.x; use the espressif32 platform version pinned in platformio.ini"
+#endif
+
+namespace {
+
+TlsHandshakeStats gTlsStats;
+
+// Finds the retained session slot for `host`, or `nullptr` when none exists.
+TlsSessionSlot* findSessionSlot(const char* host) {
+  if (!host || !host[0]) {
+    return nullptr;
+  }
+  for (auto& slot : gPersistentState.tlsSessions) {
+    if (slot.length && strncmp(slot.host, host, sizeof(slot.host)) == 0) {
+      return &slot;
+    }
+  }
+  return nullptr;
+}
+
+// Picks the slot to overwrite for `host`: its existing slot, an empty slot, or
+// the least recently used one.
+TlsSessionSlot& selectSessionSlotForWrite(const char* host) {
+  if (TlsSessionSlot* existing = findSessionSlot(host)) {
+    return *existing;
+  }
+
+  TlsSessionSlot* oldest = &gPersistentState.tlsSessions[0];
+  for (auto& slot : gPersistentState.tlsSessions) {
+    if (!slot.length) {
+      return slot;
+    }
+    if (slot.lastUsedSequence < oldest->lastUsedSequence) {
+      oldest = &slot;
+    }
+  }
+  return *oldest;
+}
+
+// Drops the cached session for `host` after the server or handshake rejected it.
+void forgetSession(const char* host) {
+  if (TlsSessionSlot* slot = findSessionSlot(host)) {
+    memset(slot, 0, sizeof(*slot));
+  }
+}
+
+// Loads the cached session for `host` into `session`. Returns false when no
+// usable session is cached.
+bool loadCachedSession(const char* host, mbedtls_ssl_session& session) {
+  TlsSessionSlot* slot = findSessionSlot(host);
+  if (!slot) {
+    return false;
+  }
+  if (mbedtls_ssl_session_load(&session, slot->data, slot->length) != 0) {
+    memset(slot, 0, sizeof(*slot));
+    return false;
+  }
+  slot->lastUsedSequence = ++gPersistentState.tlsSessionSequence;
+  return true;
+}
+
+// Serializes the negotiated session into the RTC cache. The peer certificate
+// is dropped first because resumption does not need it.
+void storeSession(const char* host, mbedtls_ssl_context& ssl) {
+  if (!host || !host[0] || strlen(host) >= sizeof(TlsSessionSlot::host)) {
+    return;
+  }
+
+  mbedtls_ssl_session session;
+  mbedtls_ssl_session_init(&session);
+  if (mbedtls_ssl_get_session(&ssl, &session) != 0) {
+    mbedtls_ssl_session_free(&session);
+    return;
+  }
+
+#if defined(MBEDTLS_X509_CRT_PARSE_C) && defined(MBEDTLS_SSL_KEEP_PEER_CERTIFICATE)
+  if (session.peer_cert) {
+    mbedtls_x509_crt_free(session.peer_cert);
+    mbedtls_free(session.peer_cert);
+    session.peer_cert = nullptr;
+  }
+#endif
+
+  TlsSessionSlot& slot = selectSessionSlotForWrite(host);
+  size_t length = 0;
+  int ret = mbedtls_ssl_session_save(&session, slot.data, sizeof(slot.data), &length);
+  mbedtls_ssl_session_free(&session);
+  if (ret != 0 || length == 0 || length > sizeof(slot.data)) {
+    memset(&slot, 0, sizeof(slot));
+    return;
+  }
+
+  strncpy(slot.host, host, sizeof(slot.host) - 1);
+  slot.host[sizeof(slot.host) - 1] = '\0';
+  slot.length = static_cast<uint16_t>(length);
+  slot.lastUsedSequence = ++gPersistentState.tlsSessionSequence;
+}
+
+}  // namespace
+
+// Heap-allocated mbedTLS state so the client object stays small on the stack.
+struct ResumableTlsClient::TlsState {
+  mbedtls_ssl_context ssl;
+  mbedtls_ssl_config config;
+  mbedtls_ctr_drbg_context drbg;
+  mbedtls_entropy_context entropy;
+  mbedtls_x509_crt caChain;
+  char host[sizeof(TlsSessionSlot::host)] = {0};
+
+  TlsState() {
+    mbedtls_ssl_init(&ssl);
+    mbedtls_ssl_config_init(&config);
+    mbedtls_ctr_drbg_init(&drbg);
+    mbedtls_entropy_init(&entropy);
+    mbedtls_x509_crt_init(&caChain);
+  }
+
+  ~TlsState() {
+    mbedtls_ssl_free(&ssl);
+    mbedtls_ssl_config_free(&config);
+    mbedtls_ctr_drbg_free(&drbg);
+    mbedtls_entropy_free(&entropy);
+    mbedtls_x509_crt_free(&caChain);
+  }
+};
+
+// Connects by host name through the DNS cache with the default timeout.
+int ResolvingClient::connect(const char* host, uint16_t port) {
+  return connectResolved(host, port, -1);
+}
+
+// Connects by host name through the DNS cache.
+int ResolvingClient::connect(const char* host, uint16_t port, int32_t timeoutMs) {
+  return connectResolved(host, port, timeoutMs);
+}
+
+// Tries the cached address first and falls back to one fresh lookup when it
+// does not answer.
+int ResolvingClient::connectResolved(const char* host, uint16_t port, int32_t timeoutMs) {
+  IPAddress address;
+  bool cacheHit = false;
+  if (!resolveHost(host, address, &cacheHit)) {
+    Serial.printf("DNS: failed to resolve %s\n", host ? host : "(null)");
+    return 0;
+  }
+  if (connectAddress(address, port, timeoutMs)) {
+    return 1;
+  }
+  if (!cacheHit) {
+    return 0;
+  }
+
+  Serial.printf("DNS: cached address %s for %s did not answer; resolving again\n",
+                address.toString().c_str(), host);
+  forgetResolvedHost(host);
+  if (!resolveHost(host, address)) {
+    return 0;
+  }
+  return connectAddress(address, port, timeoutMs);
+}
+
+// Opens the TCP socket only; a negative timeout uses the client default.
+int ResolvingClient::connectAddress(IPAddress ip, uint16_t port, int32_t timeoutMs) {
+  return timeoutMs < 0 ? WiFiClient::connect(ip, port) : WiFiClient::connect(ip, port, timeoutMs);
+}
+
+ResumableTlsClient::ResumableTlsClient() = default;
+
+ResumableTlsClient::~ResumableTlsClient() {
+  stop();
+}
+
+// Stores the trust anchor used for certificate verification.
+void ResumableTlsClient::setCACert(const char* rootCaPem) {
+  rootCaPem_ = rootCaPem;
+  insecure_ = false;
+}
+
+// Disables certificate verification for explicit debug builds.
+void ResumableTlsClient::setInsecure() {
+  rootCaPem_ = nullptr;
+  insecure_ = true;
+}
+
+// Sets the maximum time spent in the TLS handshake.
+void ResumableTlsClient::setHandshakeTimeout(unsigned long timeoutMs) {
+  handshakeTimeoutMs_ = timeoutMs;
+}
+
+// Connects by IP without SNI or session caching.
+int ResumableTlsClient::connect(IPAddress ip, uint16_t port) {
+  return connect(ip, port, static_cast<int32_t>(handshakeTimeoutMs_));
+}
+
+// Connects by IP without SNI or session caching.
+int ResumableTlsClient::connect(IPAddress ip, uint16_t port, int32_t timeoutMs) {
+  stop();
+  if (!WiFiClient::connect(ip, port, timeoutMs)) {
+    return 0;
+  }
+  if (!startTls(nullptr, timeoutMs)) {
+    stop();
+    return 0;
+  }
+  return 1;
+}
+
+// Connects by host name with SNI and session resumption.
+int ResumableTlsClient::connect(const char* host, uint16_t port) {
+  return connect(host, port, static_cast<int32_t>(handshakeTimeoutMs_));
+}
+
+// Connects by host name with SNI and session resumption.
+int ResumableTlsClient::connect(const char* host, uint16_t port, int32_t timeoutMs) {
+  stop();
+  if (!ResolvingClient::connect(host, port, timeoutMs)) {
+    return 0;
+  }
+  if (!startTls(host, timeoutMs)) {
+    stop();
+    return 0;
+  }
+  return 1;
+}
+
+// Runs the TLS handshake over the already-connected TCP socket, offering a
+// cached session for `host` when one is available.
+bool ResumableTlsClient::startTls(const char* host, int32_t timeoutMs) {
+  tls_.reset(new TlsState());
+  lastError_ = 0;
+  lastHandshakeResumed_ = false;
+  peekByte_ = -1;
+
+  const char* personalization = "envnode-tls";
+  int ret = mbedtls_ctr_drbg_seed(&tls_->drbg,
+                                  mbedtls_entropy_func,
+                                  &tls_->entropy,
+                                  reinterpret_cast<const unsigned char*>(personalization),
+                                  strlen(personalization));
+  if (ret == 0) {
+    ret = mbedtls_ssl_config_defaults(&tls_->config,
+                                      MBEDTLS_SSL_IS_CLIENT,
+                                      MBEDTLS_SSL_TRANSPORT_STREAM,
+                                      MBEDTLS_SSL_PRESET_DEFAULT);
+  }
+  if (ret == 0 && rootCaPem_ && rootCaPem_[0]) {
+    ret = mbedtls_x509_crt_parse(&tls_->caChain,
+                                 reinterpret_cast<const unsigned char*>(rootCaPem_),
+                                 strlen(rootCaPem_) + 1);
+    mbedtls_ssl_conf_ca_chain(&tls_->config, &tls_->caChain, nullptr);
+    mbedtls_ssl_conf_authmode(&tls_->config, MBEDTLS_SSL_VERIFY_REQUIRED);
+  } else if (ret == 0 && insecure_) {
+    mbedtls_ssl_conf_authmode(&tls_->config, MBEDTLS_SSL_VERIFY_NONE);
+  } else if (ret == 0) {
+    Serial.println("TLS: no root CA configured and insecure mode not enabled");
+    lastError_ = MBEDTLS_ERR_X509_CERT_VERIFY_FAILED;
+    ++gTlsStats.failedHandshakes;
+    return false;
+  }
+  if (ret != 0) {
+    lastError_ = ret;
+    ++gTlsStats.failedHandshakes;
+    return false;
+  }
+
+  mbedtls_ssl_conf_rng(&tls_->config, mbedtls_ctr_drbg_random, &tls_->drbg);
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+  mbedtls_ssl_conf_session_tickets(&tls_->config, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
+
+  ret = mbedtls_ssl_setup(&tls_->ssl, &tls_->config);
+  if (ret == 0 && host && host[0]) {
+    strncpy(tls_->host, host, sizeof(tls_->host) - 1);
+    ret = mbedtls_ssl_set_hostname(&tls_->ssl, host);
+  }
+  if (ret != 0) {
+    lastError_ = ret;
+    ++gTlsStats.failedHandshakes;
+    return false;
+  }
+  mbedtls_ssl_set_bio(&tls_->ssl, this, sendCallback, recvCallback, nullptr);
+
+  // Remember the cached master secret so resumption can be detected afterwards.
+  unsigned char offeredMaster[48] = {0};
+  bool offeredSession = false;
+  mbedtls_ssl_session cached;
+  mbedtls_ssl_session_init(&cached);
+  if (loadCachedSession(tls_->host, cached)) {
+    offeredSession = mbedtls_ssl_set_session(&tls_->ssl, &cached) == 0;
+    memcpy(offeredMaster, cached.master, sizeof(offeredMaster));
+  }
+  mbedtls_ssl_session_free(&cached);
+
+  unsigned long startedAt = millis();
+  unsigned long limitMs = timeoutMs > 0 ? static_cast<unsigned long>(timeoutMs)
+                                        : handshakeTimeoutMs_;
+  while ((ret = mbedtls_ssl_handshake(&tls_->ssl)) != 0) {
+    if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+      break;
+    }
+    if (millis() - startedAt > limitMs) {
+      ret = MBEDTLS_ERR_SSL_TIMEOUT;
+      break;
+    }
+    delay(2);
+  }
+
+  if (ret != 0) {
+    lastError_ = ret;
+    ++gTlsStats.failedHandshakes;
+    if (offeredSession) {
+      forgetSession(tls_->host);
+    }
+    Serial.printf("TLS: handshake with %s failed (-0x%04X)\n",
+                  tls_->host[0] ? tls_->host : "server",
+                  static_cast<unsigned>(-ret));
+    return false;
+  }
+
+  if (insecure_ == false &&
+      mbedtls_ssl_get_verify_result(&tls_->ssl) != 0) {
+    lastError_ = MBEDTLS_ERR_X509_CERT_VERIFY_FAILED;
+    ++gTlsStats.failedHandshakes;
+    forgetSession(tls_->host);
+    return false;
+  }
+
+  lastHandshakeResumed_ =
+      offeredSession && tls_->ssl.session &&
+      memcmp(tls_->ssl.session->master, offeredMaster, sizeof(offeredMaster)) == 0;
+  if (lastHandshakeResumed_) {
+    ++gTlsStats.resumedHandshakes;
+  } else {
+    ++gTlsStats.fullHandshakes;
+  }
+  Serial.printf("TLS: %s handshake with %s in %lu ms\n",
+                lastHandshakeResumed_ ? "resumed" : "full",
+                tls_->host[0] ? tls_->host : "server",
+                static_cast<unsigned long>(millis() - startedAt));
+
+  storeSession(tls_->host, tls_->ssl);
+  return true;
+}
+
+// Frees the TLS state without touching the TCP socket.
+void ResumableTlsClient::releaseTls() {
+  tls_.reset();
+  peekByte_ = -1;
+}
+
+// mbedTLS output hook: writes ciphertext to the underlying TCP socket.
+int ResumableTlsClient::sendCallback(void* context,
+                                     const unsigned char* buf,
+                                     size_t len) {
+  auto* self = static_cast<ResumableTlsClient*>(context);
+  size_t written = self->WiFiClient::write(buf, len);
+  if (written == 0) {
+    return self->WiFiClient::connected() ? MBEDTLS_ERR_SSL_WANT_WRITE
+                                         : MBEDTLS_ERR_NET_SEND_FAILED;
+  }
+  return static_cast<int>(written);
+}
+
+// mbedTLS input hook: reads ciphertext from the underlying TCP socket without
+// blocking so the handshake loop can enforce its own timeout.
+int ResumableTlsClient::recvCallback(void* context, unsigned char* buf, size_t len) {
+  auto* self = static_cast<ResumableTlsClient*>(context);
+  int pending = self->WiFiClient::available();
+  if (pending <= 0) {
+    return self->WiFiClient::connected() ? MBEDTLS_ERR_SSL_WANT_READ : 0;
+  }
+  size_t toRead = static_cast<size_t>(pending) < len ? static_cast<size_t>(pending) : len;
+  int received = self->WiFiClient::read(buf, toRead);
+  return received > 0 ? received : MBEDTLS_ERR_SSL_WANT_READ;
+}
+
+// Writes a single plaintext byte through TLS.
+size_t ResumableTlsClient::write(uint8_t data) {
+  return write(&data, 1);
+}
+
+// Writes plaintext through TLS, retrying until every byte is accepted.
+size_t ResumableTlsClient::write(const uint8_t* buf, size_t size) {
+  if (!tls_) {
+    return 0;
+  }
+
+  size_t written = 0;
+  unsigned long startedAt = millis();
+  while (written < size) {
+    int ret = mbedtls_ssl_write(&tls_->ssl, buf + written, size - written);
+    if (ret > 0) {
+      written += static_cast<size_t>(ret);
+      continue;
+    }
+    if ((ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) ||
+        millis() - startedAt > handshakeTimeoutMs_) {
+      lastError_ = ret;
+      break;
+    }
+    delay(1);
+  }
+  return written;
+}
+
+// Reports how many decrypted bytes can be read without blocking.
+int ResumableTlsClient::available() {
+  if (!tls_) {
+    return 0;
+  }
+
+  int pending = peekByte_ >= 0 ? 1 : 0;
+  int ret = mbedtls_ssl_read(&tls_->ssl, nullptr, 0);
+  if (ret < 0 && ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+    lastError_ = ret;
+    if (ret == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY) {
+      return pending + static_cast<int>(mbedtls_ssl_get_bytes_avail(&tls_->ssl));
+    }
+    return pending;
+  }
+  return pending + static_cast<int>(mbedtls_ssl_get_bytes_avail(&tls_->ssl));
+}
+
+// Reads one decrypted byte, or returns -1 when none is available.
+int ResumableTlsClient::read() {
+  uint8_t data = 0;
+  return read(&data, 1) == 1 ? data : -1;
+}
+
+// Reads decrypted bytes, including any byte previously returned by `peek()`.
+int ResumableTlsClient::read(uint8_t* buf, size_t size) {
+  if (!tls_ || size == 0) {
+    return -1;
+  }
+
+  size_t offset = 0;
+  if (peekByte_ >= 0) {
+    buf[offset++] = static_cast<uint8_t>(peekByte_);
+    peekByte_ = -1;
+    if (offset == size) {
+      return 1;
+    }
+  }
+
+  int ret = mbedtls_ssl_read(&tls_->ssl, buf + offset, size - offset);
+  if (ret > 0) {
+    return static_cast<int>(offset) + ret;
+  }
+  if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE && ret != 0) {
+    lastError_ = ret;
+  }
+  return offset ? static_cast<int>(offset) : -1;
+}
+
+// Returns the next decrypted byte without consuming it.
+int ResumableTlsClient::peek() {
+  if (peekByte_ < 0) {
+    uint8_t data = 0;
+    if (tls_ && mbedtls_ssl_read(&tls_->ssl, &data, 1) == 1) {
+      peekByte_ = data;
+    }
+  }
+  return peekByte_;
+}
+
+// Plaintext writes are not buffered, so there is nothing to flush.
+void ResumableTlsClient::flush() {}
+
+// Sends close_notify when possible, frees TLS state, and closes the socket.
+void ResumableTlsClient::stop() {
+  if (tls_ && WiFiClient::connected()) {
+    mbedtls_ssl_close_notify(&tls_->ssl);
+  }
+  releaseTls();
+  WiFiClient::stop();
+}
+
+// Reports whether the TLS session is up or still has buffered plaintext.
+uint8_t ResumableTlsClient::connected() {
+  if (!tls_) {
+    return 0;
+  }
+  if (peekByte_ >= 0 || mbedtls_ssl_get_bytes_avail(&tls_->ssl) > 0) {
+    return 1;
+  }
+  return WiFiClient::connected();
+}
+
+// Returns handshake counters accumulated since boot.
+const TlsHandshakeStats& tlsHandshakeStats() {
+  return gTlsStats;
+}
+
+// Clears every retained TLS session.
+void clearTlsSessionCache() {
+  memset(gPersistentState.tlsSessions, 0, sizeof(gPersistentState.tlsSessions));
+}
@@ -0,0 +1,100 @@
+// TLS client with session resumption across deep sleep.
+//
+// The stock `WiFiClientSecure` always performs a full handshake. This client
+// drives mbedTLS directly so it can offer a cached session ticket/ID on the
+// first connection after a timer wake and store the refreshed session in RTC
+// memory afterwards. Both it and the plain `ResolvingClient` look host names
+// up through the retained DNS cache, so a timer wake usually connects without
+// a DNS round trip.
+
+#pragma once
+
+#include <WiFiClient.h>
+
+#include <memory>
+
+// Counts TLS handshakes completed by `ResumableTlsClient` during this wake.
+struct TlsHandshakeStats {
+  uint32_t fullHandshakes = 0;
+  uint32_t resumedHandshakes = 0;
+  uint32_t failedHandshakes = 0;
+};
+
+// `WiFiClient` that resolves host names through `resolveHost()`. A cached
+// address that refuses the connection is dropped and resolved again once, so
+// a moved server costs one extra lookup rather than a failed request.
+class ResolvingClient : public WiFiClient {
+ public:
+  using WiFiClient::connect;
+  int connect(const char* host, uint16_t port) override;
+  int connect(const char* host, uint16_t port, int32_t timeoutMs) override;
+
+ private:
+  int connectResolved(const char* host, uint16_t port, int32_t timeoutMs);
+  int connectAddress(IPAddress ip, uint16_t port, int32_t timeoutMs);
+};
+
+// Drop-in replacement for `WiFiClientSecure` when used through `HTTPClient`.
+// TCP is handled by the `ResolvingClient` base class; every read/write goes
+// through the TLS session layered on top of it. The host name passed to
+// `connect()` is still used for SNI and session lookup when the address came
+// from the DNS cache.
+class ResumableTlsClient : public ResolvingClient {
+ public:
+  ResumableTlsClient();
+  ~ResumableTlsClient() override;
+
+  // Verifies the server against this PEM root CA. The pointer must outlive the
+  // connection.
+  void setCACert(const char* rootCaPem);
+
+  // Skips certificate verification. Only for explicit debug use.
+  void setInsecure();
+
+  // Limits how long the TLS handshake may take after TCP connects.
+  void setHandshakeTimeout(unsigned long timeoutMs);
+
+  int connect(IPAddress ip, uint16_t port) override;
+  int connect(IPAddress ip, uint16_t port, int32_t timeoutMs) override;
+  int connect(const char* host, uint16_t port) override;
+  int connect(const char* host, uint16_t port, int32_t timeoutMs) override;
+
+  size_t write(uint8_t data) override;
+  size_t write(const uint8_t* buf, size_t size) override;
+  int available() override;
+  int read() override;
+  int read(uint8_t* buf, size_t size) override;
+  int peek() override;
+  void flush() override;
+  void stop() override;
+  uint8_t connected() override;
+  operator bool() override { return connected(); }
+
+  // Returns true when the last handshake resumed a cached session.
+  bool lastHandshakeResumed() const { return lastHandshakeResumed_; }
+
+  // Returns the last mbedTLS error code, or 0 when none occurred.
+  int lastError() const { return lastError_; }
+
+ private:
+  struct TlsState;
+
+  bool startTls(const char* host, int32_t timeoutMs);
+  void releaseTls();
+  static int sendCallback(void* context, const unsigned char* buf, size_t len);
+  static int recvCallback(void* context, unsigned char* buf, size_t len);
+
+  std::unique_ptr<TlsState> tls_;
+  const char* rootCaPem_ = nullptr;
+  bool insecure_ = false;
+  unsigned long handshakeTimeoutMs_ = 10000UL;
+  int peekByte_ = -1;
+  int lastError_ = 0;
+  bool lastHandshakeResumed_ = false;
+};
+
+// Returns handshake counters accumulated since boot.
+const TlsHandshakeStats& tlsHandshakeStats();
+
+// Forgets every cached TLS session, forcing full handshakes on the next wake.
+void clearTlsSessionCache();
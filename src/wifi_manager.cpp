@@ -1,14 +1,45 @@
 // Wi-Fi connection and diagnostics implementation.
 //
 // This module owns ESP32 station setup, reconnect heuristics, scan/BSSID
-// locking, and the serial-friendly diagnostics used in service mode.
+// locking, and the serial-friendly diagnostics used in service mode. The
+// access point and DHCP lease of the last successful association are kept in
+// RTC memory (see `wifi_link.h`) so timer wakes can skip the scan and DHCP.
 
 #include "wifi_manager.h"
 
 #include <ESP32Ping.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+#include <lwip/dhcp.h>
+#include <lwip/netif.h>
 
 namespace {
 
+// Event-group bits set from the Wi-Fi event callback.
+constexpr EventBits_t kWiFiAssociatedBit = 1 << 0;
+constexpr EventBits_t kWiFiGotIpBit = 1 << 1;
+constexpr EventBits_t kWiFiDisconnectedBit = 1 << 2;
+constexpr EventBits_t kWiFiAnyEventBits =
+    kWiFiAssociatedBit | kWiFiGotIpBit | kWiFiDisconnectedBit;
+
+// Disconnect events tolerated in one connect attempt. The first one is usually
+// followed by the driver's automatic retry; a second means the attempt failed.
+constexpr uint8_t kMaxDisconnectsPerConnect = 2;
+
+EventGroupHandle_t gWiFiEvents = nullptr;
+WiFiConnectTiming gConnectTiming;
+
+// Waits for any of `bits`, clearing the ones that arrived. Falls back to a
+// short poll delay before the event logger has created the group.
+EventBits_t waitForWiFiEventBits(EventBits_t bits, unsigned long timeoutMs) {
+  if (!gWiFiEvents) {
+    delay(timeoutMs < 250 ? timeoutMs : 250);
+    return 0;
+  }
+  return xEventGroupWaitBits(gWiFiEvents, bits, pdTRUE, pdFALSE, pdMS_TO_TICKS(timeoutMs)) &
+         bits;
+}
+
 // Returns true when the radio is in any station-capable mode.
 bool isWiFiStaModeEnabled() {
   wifi_mode_t mode = WiFi.getMode();
@@ -35,24 +66,56 @@ String formatMacAddress(const uint8_t* mac) {
   return String(buffer);
 }
 
-// Maps the configured TX power macro to the closest ESP32 enum value.
+// Limits and thresholds for the adaptive TX power controller. The driver's
+// power enum is in quarter-dBm, like the controller's levels.
+constexpr envnode::core::TxPowerConfig kTxPowerConfig = {
+    WIFI_TX_POWER_MIN_DBM * 4, WIFI_TX_POWER_MAX_DBM * 4, WIFI_TX_POWER_STEP_DOWN_RSSI,
+    WIFI_TX_POWER_RAISE_RSSI, 3, 2, 144};
+
+// Dwell per channel for targeted active scans of the roaming candidates. A
+// probe response arrives well inside this; a full scan spends 300 ms on each
+// of 13 channels.
+constexpr uint32_t kTargetedScanMsPerChannel = 80;
+
+// Spacing of connect attempts across wakes once the AP stops answering.
+constexpr envnode::core::WiFiBackoffConfig kWiFiBackoffConfig = {
+    WIFI_BACKOFF_AFTER_FAILURES, WIFI_BACKOFF_BASE_SECONDS, WIFI_BACKOFF_MAX_SECONDS};
+
+// Returns the TX power for the next association: the level learned in RTC
+// memory, or the fixed `WIFI_TX_POWER_DBM` when adaptation is disabled.
 wifi_power_t configuredTxPower() {
-  #if WIFI_TX_POWER_DBM >= 19
-  return WIFI_POWER_19_5dBm;
-  #elif WIFI_TX_POWER_DBM >= 17
-  return WIFI_POWER_17dBm;
-  #else
-  return WIFI_POWER_15dBm;
-  #endif
+  if (!WIFI_TX_POWER_ADAPTIVE_ENABLED) {
+    return static_cast<wifi_power_t>(
+        envnode::core::kTxPowerLevels[envnode::core::TxPowerLevelIndexFor(WIFI_TX_POWER_DBM * 4)]);
+  }
+  envnode::core::StartTxPower(gPersistentState.wifiTxPower, kTxPowerConfig,
+                              WIFI_TX_POWER_DBM * 4);
+  return static_cast<wifi_power_t>(envnode::core::CurrentTxPower(gPersistentState.wifiTxPower));
 }
 
 // Returns a printable label for the current TX power enum.
 const char* txPowerName(wifi_power_t power) {
   switch (power) {
+    case WIFI_POWER_2dBm:
+      return "2 dBm";
+    case WIFI_POWER_5dBm:
+      return "5 dBm";
+    case WIFI_POWER_7dBm:
+      return "7 dBm";
+    case WIFI_POWER_8_5dBm:
+      return "8.5 dBm";
+    case WIFI_POWER_11dBm:
+      return "11 dBm";
+    case WIFI_POWER_13dBm:
+      return "13 dBm";
     case WIFI_POWER_15dBm:
       return "15 dBm";
     case WIFI_POWER_17dBm:
       return "17 dBm";
+    case WIFI_POWER_18_5dBm:
+      return "18.5 dBm";
+    case WIFI_POWER_19dBm:
+      return "19 dBm";
     case WIFI_POWER_19_5dBm:
       return "19.5 dBm";
     default:
@@ -67,6 +130,29 @@ void applyWiFiTxPower() {
   Serial.printf("WiFi: applied TX power %s\n", txPowerName(power));
 }
 
+// Feeds the outcome of a connection attempt to the TX power controller. A
+// raise is applied right away so the rest of this wake benefits from it; a
+// lower level waits for the next association.
+void updateAdaptiveTxPower(bool connected) {
+  if (!WIFI_TX_POWER_ADAPTIVE_ENABLED) {
+    return;
+  }
+  envnode::core::TxPowerObservation observation;
+  observation.connected = connected;
+  observation.rssiDbm = connected ? static_cast<int8_t>(WiFi.RSSI()) : 0;
+  const wifi_power_t before = configuredTxPower();
+  const wifi_power_t after = static_cast<wifi_power_t>(
+      envnode::core::UpdateTxPower(gPersistentState.wifiTxPower, kTxPowerConfig, observation));
+  if (after == before) {
+    return;
+  }
+  Serial.printf("WiFi: TX power %s -> %s for the next connect (%s)\n", txPowerName(before),
+                txPowerName(after), connected ? "RSSI-based" : "connect failed");
+  if (connected && after > before) {
+    WiFi.setTxPower(after);
+  }
+}
+
 // Prints the current IP-layer connection details for diagnostics.
 void printWiFiNetworkSummary() {
   Serial.printf(
@@ -82,9 +168,18 @@ void printWiFiNetworkSummary() {
       static_cast<int>(WiFi.channel()));
 }
 
+// Returns the lease time granted by the DHCP server for the station
+// interface, or 0 when the interface is not bound through DHCP.
+uint32_t dhcpLeaseSeconds() {
+  struct netif* netif = netif_default;
+  struct dhcp* dhcp = netif ? netif_dhcp_data(netif) : nullptr;
+  return dhcp && dhcp->state == DHCP_STATE_BOUND ? dhcp->offered_t0_lease : 0;
+}
+
 // Applies the project's preferred station-mode and IP/DNS configuration before
-// a connection attempt.
-void configureWiFiNetworkStack() {
+// a connection attempt. A retained DHCP lease is applied as a static
+// configuration when `reuseLease` is set, which skips the DHCP exchange.
+void configureWiFiNetworkStack(bool reuseLease) {
   WiFi.persistent(false);
   WiFi.setSleep(false);
   WiFi.setAutoReconnect(true);
@@ -100,6 +195,16 @@ void configureWiFiNetworkStack() {
     if (!WiFi.config(localIp, gateway, subnet, dns1, dns2)) {
       Serial.println("WiFi: static IP config failed; falling back to DHCP.");
     }
+  } else if (reuseLease) {
+    const envnode::core::LeaseConfig& lease = gPersistentState.wifiLink.lease;
+    IPAddress dns1 = WIFI_OVERRIDE_DNS ? makeIpAddress(WIFI_DNS1_BYTES) : IPAddress(lease.dns1);
+    IPAddress dns2 = WIFI_OVERRIDE_DNS ? makeIpAddress(WIFI_DNS2_BYTES) : IPAddress(lease.dns2);
+    if (!WiFi.config(IPAddress(lease.ip), IPAddress(lease.gateway), IPAddress(lease.subnet),
+                     dns1, dns2)) {
+      Serial.println("WiFi: retained lease config failed; falling back to DHCP.");
+      gApp.wifiLeaseReused = false;
+      WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+    }
   } else if (WIFI_OVERRIDE_DNS) {
     IPAddress dns1 = makeIpAddress(WIFI_DNS1_BYTES);
     IPAddress dns2 = makeIpAddress(WIFI_DNS2_BYTES);
@@ -126,11 +231,86 @@ bool isAuthOrAssocDisconnectReason(uint16_t reason) {
   }
 }
 
-// Clears any remembered BSSID/channel lock so the next connect can roam freely.
+// Forgets every roaming candidate and the BSSID/channel lock so the next
+// connect lets the driver choose freely.
 void clearLockedBssid() {
-  memset(gApp.targetBssid, 0, sizeof(gApp.targetBssid));
-  gApp.hasTargetBssid = false;
-  gApp.targetChannel = 0;
+  envnode::core::ClearAccessPoint(gPersistentState.wifiLink);
+  gPersistentState.wifiRoaming = envnode::core::RoamingTable();
+}
+
+// Pins the best-scoring roaming candidate for the next association, or drops
+// the pin when no candidate qualifies. The retained lease is kept either way;
+// it belongs to the network, not to one access point.
+void selectRoamingCandidate() {
+  envnode::core::RetainedLink& link = gPersistentState.wifiLink;
+  const envnode::core::RoamingCandidate* best =
+      envnode::core::BestRoamingCandidate(gPersistentState.wifiRoaming, rtcClockSeconds());
+  if (!best) {
+    if (link.hasAccessPoint) {
+      Serial.println("WiFi: no roaming candidate qualifies; letting the driver choose.");
+      envnode::core::ClearAccessPoint(link);
+    }
+    return;
+  }
+  if (link.hasAccessPoint && link.channel == best->channel &&
+      memcmp(link.bssid, best->bssid, sizeof(link.bssid)) == 0) {
+    return;
+  }
+  Serial.printf("WiFi: roaming to BSSID=%s CH=%u (score %.1f)\n",
+                formatMacAddress(best->bssid).c_str(), static_cast<unsigned>(best->channel),
+                envnode::core::RoamingCandidateScore(*best));
+  envnode::core::RecordAccessPoint(link, best->bssid, best->channel);
+}
+
+// Prints the retained roaming candidates with their scores.
+void printRoamingCandidates() {
+  int listed = 0;
+  for (const envnode::core::RoamingCandidate& candidate :
+       gPersistentState.wifiRoaming.candidates) {
+    if (candidate.channel == 0) {
+      continue;
+    }
+    Serial.printf("  candidate BSSID=%s CH=%u RSSI=%.1f dBm ok=%u/%u connect=%u ms score=%.1f\n",
+                  formatMacAddress(candidate.bssid).c_str(),
+                  static_cast<unsigned>(candidate.channel), candidate.rssiDbm,
+                  static_cast<unsigned>(candidate.successes),
+                  static_cast<unsigned>(candidate.attempts),
+                  static_cast<unsigned>(candidate.meanConnectMs),
+                  envnode::core::RoamingCandidateScore(candidate));
+    ++listed;
+  }
+  if (listed == 0) {
+    Serial.println("  no roaming candidates");
+  }
+}
+
+// Remembers the access point and, when DHCP ran, the lease of the connection
+// that just came up, so the next wake can reconnect without scan or DHCP. The
+// access point's roaming candidate is credited with the connect time.
+void recordSuccessfulLink(unsigned long connectMs) {
+  if (!WIFI_FAST_RECONNECT_ENABLED) {
+    return;
+  }
+  envnode::core::RetainedLink& link = gPersistentState.wifiLink;
+  if (const uint8_t* bssid = WiFi.BSSID()) {
+    const uint8_t channel = static_cast<uint8_t>(WiFi.channel());
+    envnode::core::ObserveAccessPoint(gPersistentState.wifiRoaming, bssid, channel,
+                                      static_cast<int8_t>(WiFi.RSSI()), rtcClockSeconds());
+    envnode::core::RecordRoamingResult(gPersistentState.wifiRoaming, bssid, true, connectMs);
+    envnode::core::RecordAccessPoint(link, bssid, channel);
+  }
+  if (!WIFI_LEASE_REUSE_ENABLED || gApp.wifiLeaseReused) {
+    return;
+  }
+
+  envnode::core::LeaseConfig lease;
+  lease.ip = static_cast<uint32_t>(WiFi.localIP());
+  lease.gateway = static_cast<uint32_t>(WiFi.gatewayIP());
+  lease.subnet = static_cast<uint32_t>(WiFi.subnetMask());
+  lease.dns1 = static_cast<uint32_t>(WiFi.dnsIP(0));
+  lease.dns2 = static_cast<uint32_t>(WiFi.dnsIP(1));
+  envnode::core::RecordLease(link, lease, dhcpLeaseSeconds(), WIFI_LEASE_REUSE_MAX_SECONDS,
+                             rtcClockSeconds());
 }
 
 // Ensures the STA interface is running, optionally forcing a clean restart.
@@ -149,6 +329,19 @@ void ensureWiFiStaReady(bool forceRestart) {
   }
 }
 
+// Starts a connect attempt's wait from a clean slate. Called after any STA
+// restart and right before the association request, because the restart's own
+// disconnect event arrives asynchronously: it must neither count against the
+// new attempt nor leave its reason behind for the next one.
+void resetConnectWait() {
+  if (gWiFiEvents) {
+    xEventGroupClearBits(gWiFiEvents, kWiFiAnyEventBits);
+  }
+  gApp.lastWiFiDisconnectReason = 0;
+  gConnectTiming = WiFiConnectTiming{};
+  gConnectTiming.startedMs = millis();
+}
+
 // Pings a single address and prints the result to serial.
 void logPingResult(const char* label, const IPAddress& address) {
   Serial.printf("Ping test: %s (%s) ... ", label, address.toString().c_str());
@@ -196,6 +389,18 @@ void printTxPowerSummary() {
                 static_cast<int>(currentPower));
 }
 
+// Prints how long each phase of the last connect attempt took.
+void printWiFiConnectTiming() {
+  const WiFiConnectTiming& timing = gConnectTiming;
+  if (timing.associatedMs == 0 || timing.gotIpMs == 0) {
+    return;
+  }
+  Serial.printf("WiFi: associate+auth %lu ms, DHCP %lu ms, %u disconnect(s)\n",
+                static_cast<unsigned long>(timing.associatedMs - timing.startedMs),
+                static_cast<unsigned long>(timing.gotIpMs - timing.associatedMs),
+                static_cast<unsigned>(timing.disconnects));
+}
+
 // Runs a manual set of gateway/public/DNS connectivity checks.
 void runConnectivityChecks() {
   Serial.println("Connectivity checks: waiting 5 seconds before ping tests...");
@@ -220,6 +425,67 @@ void runConnectivityChecks() {
   }
 }
 
+// lwIP's resolver does not expose record TTLs, so cached addresses live for the
+// configured TTL; connection failures drop them early via
+// `forgetResolvedHost()`.
+bool resolveHost(const char* host, IPAddress& address, bool* cacheHit) {
+  if (cacheHit) {
+    *cacheHit = false;
+  }
+  if (!host || !host[0]) {
+    return false;
+  }
+
+  uint32_t cached = 0;
+  if (DNS_CACHE_ENABLED &&
+      envnode::core::LookupDnsCache(gPersistentState.dnsCache, host, rtcClockSeconds(), cached)) {
+    address = IPAddress(cached);
+    if (cacheHit) {
+      *cacheHit = true;
+    }
+    return true;
+  }
+
+  if (!WiFi.hostByName(host, address)) {
+    return false;
+  }
+  if (DNS_CACHE_ENABLED) {
+    envnode::core::StoreDnsCache(gPersistentState.dnsCache, host, static_cast<uint32_t>(address),
+                                 DNS_CACHE_TTL_SECONDS, rtcClockSeconds());
+  }
+  return true;
+}
+
+// Reads the retained backoff against the RTC clock.
+uint32_t wifiBackoffRemainingSeconds() {
+  return envnode::core::WiFiBackoffRemainingSeconds(gPersistentState.wifiBackoff,
+                                                     rtcClockSeconds());
+}
+
+// Forgets one cached host after its address stopped answering.
+void forgetResolvedHost(const char* host) {
+  envnode::core::ForgetDnsCacheEntry(gPersistentState.dnsCache, host);
+}
+
+// Lists cached hosts with their remaining lifetime.
+void printDnsCache() {
+  const envnode::core::DnsCache& cache = gPersistentState.dnsCache;
+  Serial.printf("DNS cache: %lu hit(s), %lu miss(es), TTL %lu s%s\n",
+                static_cast<unsigned long>(cache.hits),
+                static_cast<unsigned long>(cache.misses),
+                static_cast<unsigned long>(DNS_CACHE_TTL_SECONDS),
+                DNS_CACHE_ENABLED ? "" : " (disabled)");
+  const uint32_t now = rtcClockSeconds();
+  for (const envnode::core::DnsCacheEntry& entry : cache.entries) {
+    const uint32_t remaining = envnode::core::DnsEntryRemainingSeconds(entry, now);
+    if (remaining) {
+      Serial.printf("  %s -> %s (%lu s left)\n", entry.host,
+                    IPAddress(entry.address).toString().c_str(),
+                    static_cast<unsigned long>(remaining));
+    }
+  }
+}
+
 // Prints the current Wi-Fi status, network details, and TX power.
 void printWiFiDiagnostics() {
   Serial.printf("WiFi status: %s (%d)\n", wifiStatusName(WiFi.status()),
@@ -227,6 +493,19 @@ void printWiFiDiagnostics() {
   printWiFiNetworkSummary();
   Serial.printf("Last disconnect reason=%u\n",
                 static_cast<unsigned>(gApp.lastWiFiDisconnectReason));
+  const envnode::core::RetainedLink& link = gPersistentState.wifiLink;
+  if (link.hasAccessPoint) {
+    Serial.printf("Retained link: BSSID=%s CH=%u, lease reuse %lu s left\n",
+                  formatMacAddress(link.bssid).c_str(), static_cast<unsigned>(link.channel),
+                  static_cast<unsigned long>(
+                      envnode::core::LeaseReuseRemainingSeconds(link, rtcClockSeconds())));
+  } else {
+    Serial.println("Retained link: none");
+  }
+  printRoamingCandidates();
+  Serial.printf("Connect backoff: %u consecutive failure(s), %lu s left\n",
+                static_cast<unsigned>(gPersistentState.wifiBackoff.consecutiveFailures),
+                static_cast<unsigned long>(wifiBackoffRemainingSeconds()));
   printTxPowerSummary();
 }
 
@@ -234,6 +513,7 @@ void printWiFiDiagnostics() {
 void shutdownWiFi() {
   gApp.networkAvailable = false;
   gApp.wifiHasConfiguredSta = false;
+  gApp.wifiConnectInProgress = false;
   if (isWiFiStaModeEnabled() && WiFi.isConnected()) {
     WiFi.disconnect(false, false);
     delay(50);
@@ -249,6 +529,9 @@ void registerWiFiEventLogger() {
   if (gApp.wifiEventLoggerHandle != 0) {
     return;
   }
+  if (!gWiFiEvents) {
+    gWiFiEvents = xEventGroupCreate();
+  }
 
   gApp.wifiEventLoggerHandle = WiFi.onEvent([](arduino_event_id_t event,
                                                arduino_event_info_t info) {
@@ -258,6 +541,8 @@ void registerWiFiEventLogger() {
         break;
       case ARDUINO_EVENT_WIFI_STA_CONNECTED:
         gApp.lastWiFiDisconnectReason = 0;
+        gConnectTiming.associatedMs = millis();
+        xEventGroupSetBits(gWiFiEvents, kWiFiAssociatedBit);
         Serial.printf("WiFi event: STA connected on channel %u, authmode=%u\n",
                       static_cast<unsigned>(info.wifi_sta_connected.channel),
                       static_cast<unsigned>(info.wifi_sta_connected.authmode));
@@ -265,12 +550,16 @@ void registerWiFiEventLogger() {
       case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
         gApp.lastWiFiDisconnectReason =
             static_cast<uint16_t>(info.wifi_sta_disconnected.reason);
+        gConnectTiming.disconnectReason = gApp.lastWiFiDisconnectReason;
+        xEventGroupSetBits(gWiFiEvents, kWiFiDisconnectedBit);
         Serial.printf("WiFi event: STA disconnected, reason=%u (%s)\n",
                       static_cast<unsigned>(info.wifi_sta_disconnected.reason),
                       WiFi.disconnectReasonName(static_cast<wifi_err_reason_t>(
                           info.wifi_sta_disconnected.reason)));
         break;
       case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+        gConnectTiming.gotIpMs = millis();
+        xEventGroupSetBits(gWiFiEvents, kWiFiGotIpBit);
         Serial.printf("WiFi event: got IP %s\n",
                       IPAddress(info.got_ip.ip_info.ip.addr).toString().c_str());
         break;
@@ -286,11 +575,12 @@ void registerWiFiEventLogger() {
   });
 }
 
-// Scans nearby networks, prints the results, and remembers the best matching
-// BSSID/channel for faster future associations.
+// Scans nearby networks, prints the results, and retains every access point
+// advertising the configured SSID as a roaming candidate.
 void logWiFiScanResults() {
   ensureWiFiStaReady(true);
   Serial.println("WiFi scan: starting...");
+  const uint32_t scanStartedAt = rtcClockSeconds();
   int networkCount = WiFi.scanNetworks(false, true);
   if (networkCount < 0) {
     Serial.printf("WiFi scan: failed with code %d\n", networkCount);
@@ -299,7 +589,6 @@ void logWiFiScanResults() {
 
   Serial.printf("WiFi scan: found %d network(s)\n", networkCount);
   bool foundTarget = false;
-  int32_t bestTargetRssi = INT32_MIN;
   for (int index = 0; index < networkCount; ++index) {
     String ssid = WiFi.SSID(index);
     int32_t rssi = WiFi.RSSI(index);
@@ -312,14 +601,11 @@ void logWiFiScanResults() {
     }
 
     bool isTarget = ssid == WIFI_SSID;
-    if (isTarget) {
+    if (isTarget && bssidPtr) {
       foundTarget = true;
-      if (rssi > bestTargetRssi) {
-        memcpy(gApp.targetBssid, bssid, sizeof(gApp.targetBssid));
-        gApp.targetChannel = channel;
-        gApp.hasTargetBssid = true;
-        bestTargetRssi = rssi;
-      }
+      envnode::core::ObserveAccessPoint(gPersistentState.wifiRoaming, bssid,
+                                        static_cast<uint8_t>(channel),
+                                        static_cast<int8_t>(rssi), rtcClockSeconds());
     }
 
     Serial.printf("  [%d] SSID='%s' RSSI=%ld dBm CH=%ld ENC=%u BSSID=%s%s\n",
@@ -333,45 +619,98 @@ void logWiFiScanResults() {
   }
 
   if (!foundTarget) {
-    gApp.hasTargetBssid = false;
-    gApp.targetChannel = 0;
+    clearLockedBssid();
     Serial.printf("WiFi scan: target SSID '%s' not visible to the ESP32 radio.\n",
                   WIFI_SSID);
   } else {
-    Serial.printf("WiFi scan: locking target BSSID=%s CH=%ld for next association attempt.\n",
-                  formatMacAddress(gApp.targetBssid).c_str(),
-                  static_cast<long>(gApp.targetChannel));
+    envnode::core::DropUnseenCandidates(gPersistentState.wifiRoaming, scanStartedAt);
+    printRoamingCandidates();
   }
 
   WiFi.scanDelete();
 }
 
-// Connects or reconnects station mode, applying the project's heuristics for
-// BSSID locking, restart-on-failure, and scan-after-repeat-failure.
-bool connectWiFi(unsigned long timeoutMs) {
-  configureWiFiNetworkStack();
+// Re-scans only the channels of the retained candidates, actively and for the
+// configured SSID alone. Candidates that no longer answer are dropped. Falls
+// back to a full scan when nothing is retained or nothing answers.
+void refreshRoamingCandidates() {
+  envnode::core::RoamingTable& table = gPersistentState.wifiRoaming;
+  uint8_t channels[envnode::core::kRoamingCandidateSlots] = {0};
+  const size_t channelCount =
+      envnode::core::RoamingChannels(table, channels, envnode::core::kRoamingCandidateSlots);
+  if (channelCount == 0) {
+    logWiFiScanResults();
+    return;
+  }
 
-  wl_status_t preStatus = WiFi.status();
+  ensureWiFiStaReady(true);
+  const uint32_t scanStartedAt = rtcClockSeconds();
+  int answered = 0;
+  for (size_t i = 0; i < channelCount; ++i) {
+    const int networkCount =
+        WiFi.scanNetworks(false, false, false, kTargetedScanMsPerChannel, channels[i], WIFI_SSID);
+    for (int index = 0; index < networkCount; ++index) {
+      const uint8_t* bssid = WiFi.BSSID(index);
+      if (!bssid || WiFi.SSID(index) != WIFI_SSID) {
+        continue;
+      }
+      envnode::core::ObserveAccessPoint(table, bssid, channels[i],
+                                        static_cast<int8_t>(WiFi.RSSI(index)), rtcClockSeconds());
+      ++answered;
+    }
+    WiFi.scanDelete();
+  }
+  Serial.printf("WiFi scan: %d candidate(s) answered on %u channel(s)\n", answered,
+                static_cast<unsigned>(channelCount));
+  if (answered == 0) {
+    logWiFiScanResults();
+    return;
+  }
+  envnode::core::DropUnseenCandidates(table, scanStartedAt);
+}
+
+// Kicks off association, applying the project's heuristics for BSSID locking
+// and restart-on-failure. The Wi-Fi driver and DHCP client run in their own
+// tasks on the protocol core, so this returns as soon as the request is made.
+void startWiFiConnect() {
+  if (gApp.wifiConnectInProgress &&
+      millis() - gApp.wifiConnectStartedMs < WIFI_CONNECT_TIMEOUT_MS) {
+    return;
+  }
+
+  envnode::core::RetainedLink& link = gPersistentState.wifiLink;
   bool authOrAssocIssue =
       isAuthOrAssocDisconnectReason(gApp.lastWiFiDisconnectReason);
+  // A failed association already counted against its candidate, so an auth
+  // or association disconnect no longer discards the pin outright.
+  selectRoamingCandidate();
+
+  const envnode::core::FastConnectPlan plan =
+      envnode::core::PlanFastConnect(link, rtcClockSeconds());
+  gApp.wifiAccessPointPinned = plan.pinAccessPoint;
+  gApp.wifiLeaseReused = WIFI_LEASE_REUSE_ENABLED && plan.reuseLease;
+  configureWiFiNetworkStack(gApp.wifiLeaseReused);
+  if (gApp.wifiLeaseReused) {
+    Serial.printf("WiFi: reusing DHCP lease IP=%s (%lu s of reuse left)\n",
+                  IPAddress(link.lease.ip).toString().c_str(),
+                  static_cast<unsigned long>(
+                      envnode::core::LeaseReuseRemainingSeconds(link, rtcClockSeconds())));
+  }
+
+  wl_status_t preStatus = WiFi.status();
   bool forceRestart = preStatus == WL_CONNECT_FAILED ||
                       preStatus == WL_CONNECTION_LOST ||
                       preStatus == WL_DISCONNECTED || authOrAssocIssue;
   ensureWiFiStaReady(forceRestart);
+  resetConnectWait();
 
-  if (authOrAssocIssue && gApp.hasTargetBssid) {
-    Serial.printf("WiFi: clearing locked BSSID after disconnect reason %u.\n",
-                  static_cast<unsigned>(gApp.lastWiFiDisconnectReason));
-    clearLockedBssid();
-  }
-
-  bool useLockedBssid = gApp.hasTargetBssid && gApp.targetChannel > 0;
+  bool useLockedBssid = gApp.wifiAccessPointPinned;
   if (!gApp.wifiHasConfiguredSta) {
     if (useLockedBssid) {
       Serial.printf("WiFi: associating to locked BSSID=%s CH=%ld\n",
-                    formatMacAddress(gApp.targetBssid).c_str(),
-                    static_cast<long>(gApp.targetChannel));
-      WiFi.begin(WIFI_SSID, WIFI_PASS, gApp.targetChannel, gApp.targetBssid, true);
+                    formatMacAddress(link.bssid).c_str(),
+                    static_cast<long>(link.channel));
+      WiFi.begin(WIFI_SSID, WIFI_PASS, link.channel, link.bssid, true);
     } else {
       WiFi.begin(WIFI_SSID, WIFI_PASS);
     }
@@ -380,11 +719,12 @@ bool connectWiFi(unsigned long timeoutMs) {
   } else if (!WiFi.reconnect()) {
     Serial.println("WiFi: reconnect request failed; restarting STA and reapplying credentials.");
     ensureWiFiStaReady(true);
+    resetConnectWait();
     if (useLockedBssid) {
       Serial.printf("WiFi: reassociating to locked BSSID=%s CH=%ld\n",
-                    formatMacAddress(gApp.targetBssid).c_str(),
-                    static_cast<long>(gApp.targetChannel));
-      WiFi.begin(WIFI_SSID, WIFI_PASS, gApp.targetChannel, gApp.targetBssid, true);
+                    formatMacAddress(link.bssid).c_str(),
+                    static_cast<long>(link.channel));
+      WiFi.begin(WIFI_SSID, WIFI_PASS, link.channel, link.bssid, true);
     } else {
       WiFi.begin(WIFI_SSID, WIFI_PASS);
     }
@@ -392,21 +732,53 @@ bool connectWiFi(unsigned long timeoutMs) {
     gApp.wifiHasConfiguredSta = true;
   }
 
-  Serial.print("WiFi: connecting");
-  unsigned long connectStartedAt = millis();
-  unsigned long start = millis();
+  gApp.wifiConnectInProgress = true;
+  gApp.wifiConnectStartedMs = millis();
+  gApp.wifiConnectAuthIssue = authOrAssocIssue;
+}
+
+// Returns the phase timestamps recorded by the event callback.
+const WiFiConnectTiming& lastWiFiConnectTiming() {
+  return gConnectTiming;
+}
+
+// Consumes whichever events arrived so the next wait only sees new ones.
+bool waitForWiFiEvent(unsigned long timeoutMs) {
+  return waitForWiFiEventBits(kWiFiAnyEventBits, timeoutMs) != 0;
+}
+
+// Waits for the association started by `startWiFiConnect()`, then applies the
+// scan-after-repeat-failure heuristics if it did not complete in time.
+bool connectWiFi(unsigned long timeoutMs) {
+  startWiFiConnect();
+  gApp.wifiConnectInProgress = false;
+  const bool authOrAssocIssue = gApp.wifiConnectAuthIssue;
+
+  Serial.println("WiFi: connecting");
+  const unsigned long connectStartedAt = gApp.wifiConnectStartedMs;
   wl_status_t lastStatus = WiFi.status();
   gApp.lastReportedWiFiStatus = lastStatus;
-  while (WiFi.status() != WL_CONNECTED && millis() - start < timeoutMs) {
-    delay(250);
-    Serial.print(".");
+  // Events that arrived while the sensor was being read are still set, so an
+  // early connect that already finished returns without waiting.
+  while (WiFi.status() != WL_CONNECTED) {
+    const unsigned long elapsed = millis() - connectStartedAt;
+    if (elapsed >= timeoutMs) {
+      break;
+    }
+    const EventBits_t bits =
+        waitForWiFiEventBits(kWiFiGotIpBit | kWiFiDisconnectedBit, timeoutMs - elapsed);
     wl_status_t currentStatus = WiFi.status();
     if (currentStatus != lastStatus) {
-      Serial.println();
       logWiFiStatus("WiFi: status -> ", currentStatus);
       lastStatus = currentStatus;
       gApp.lastReportedWiFiStatus = currentStatus;
     }
+    if ((bits & kWiFiDisconnectedBit) &&
+        ++gConnectTiming.disconnects >= kMaxDisconnectsPerConnect) {
+      Serial.printf("WiFi: giving up after %u disconnects in this attempt.\n",
+                    static_cast<unsigned>(gConnectTiming.disconnects));
+      break;
+    }
   }
 
   wl_status_t finalStatus = WiFi.status();
@@ -414,18 +786,34 @@ bool connectWiFi(unsigned long timeoutMs) {
   gApp.networkAvailable = finalStatus == WL_CONNECTED;
   if (!gApp.networkAvailable) {
     ++gApp.wifiConnectFailures;
-    Serial.println();
-    Serial.printf("WiFi: connection timed out; status=%s (%d).\n",
+    envnode::core::WiFiBackoff& backoff = gPersistentState.wifiBackoff;
+    envnode::core::RecordWiFiFailure(backoff, kWiFiBackoffConfig, rtcClockSeconds());
+    Serial.printf("WiFi: connection failed; status=%s (%d).\n",
                   wifiStatusName(finalStatus),
                   static_cast<int>(finalStatus));
     if (authOrAssocIssue) {
       Serial.printf("WiFi: last disconnect reason=%u suggests AP/auth negotiation trouble rather than DHCP.\n",
                     static_cast<unsigned>(gApp.lastWiFiDisconnectReason));
     }
+    updateAdaptiveTxPower(false);
+    if (gApp.wifiAccessPointPinned) {
+      envnode::core::RecordRoamingResult(gPersistentState.wifiRoaming,
+                                         gPersistentState.wifiLink.bssid, false, 0);
+      envnode::core::RecordFastConnectFailure(gPersistentState.wifiLink);
+      Serial.println(gPersistentState.wifiLink.hasAccessPoint
+                         ? "WiFi: dropping retained lease; next attempt uses DHCP."
+                         : "WiFi: dropping retained BSSID and lease; next attempt scans.");
+    }
 
     if (finalStatus == WL_NO_SSID_AVAIL || finalStatus == WL_CONNECT_FAILED ||
-        finalStatus == WL_DISCONNECTED || gApp.wifiConnectFailures >= 2) {
-      logWiFiScanResults();
+        finalStatus == WL_DISCONNECTED ||
+        backoff.consecutiveFailures >= kWiFiBackoffConfig.freeFailures) {
+      refreshRoamingCandidates();
+    }
+    if (backoff.delaySeconds > 0) {
+      Serial.printf("WiFi: %u consecutive failed connect(s); automatic wakes back off for %lu s.\n",
+                    static_cast<unsigned>(backoff.consecutiveFailures),
+                    static_cast<unsigned long>(backoff.delaySeconds));
     }
 
     #if !DISABLE_DEEP_SLEEP
@@ -436,9 +824,16 @@ bool connectWiFi(unsigned long timeoutMs) {
 
   gApp.wifiConnectFailures = 0;
   gApp.lastWiFiDisconnectReason = 0;
-  Serial.printf("\nWiFi: connected, IP=%s in %lu ms\n",
+  envnode::core::RecordWiFiSuccess(gPersistentState.wifiBackoff);
+  recordSuccessfulLink(millis() - connectStartedAt);
+  updateAdaptiveTxPower(true);
+  Serial.printf("WiFi: connected, IP=%s in %lu ms%s%s\n",
                 WiFi.localIP().toString().c_str(),
-                static_cast<unsigned long>(millis() - connectStartedAt));
+                static_cast<unsigned long>(millis() - connectStartedAt),
+                gApp.wifiAccessPointPinned ? " (pinned BSSID" : "",
+                gApp.wifiAccessPointPinned ? (gApp.wifiLeaseReused ? ", retained lease)" : ")")
+                                           : "");
+  printWiFiConnectTiming();
   printWiFiNetworkSummary();
   printTxPowerSummary();
   return true;
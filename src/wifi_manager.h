@@ -7,10 +7,44 @@
 
 #include "app_context.h"
 
+// Per-phase `millis()` timestamps of the most recent connect attempt, taken
+// from driver events. The driver reports association and the WPA handshake as
+// one event, so `associatedMs` covers both. Zero means the phase was not
+// reached.
+struct WiFiConnectTiming {
+  unsigned long startedMs = 0;
+  unsigned long associatedMs = 0;
+  unsigned long gotIpMs = 0;
+  uint16_t disconnectReason = 0;
+  uint8_t disconnects = 0;
+};
+
+// Starts associating with the configured SSID without waiting. The Wi-Fi
+// driver and DHCP run on the protocol core, so the caller can power up and
+// read the sensor meanwhile and then finish with `connectWiFi()`.
+void startWiFiConnect();
+
 // Connects to the configured SSID and waits up to `timeoutMs` for success.
+// If `startWiFiConnect()` already began an attempt, that attempt is reused and
+// the timeout counts from when it started.
 bool connectWiFi(unsigned long timeoutMs = WIFI_CONNECT_TIMEOUT_MS);
 
-// Registers the one-time Wi-Fi event logger used for serial diagnostics.
+// Returns how many seconds automatic wakes should still wait before the next
+// connect attempt after repeated failures, or 0 when they may connect.
+uint32_t wifiBackoffRemainingSeconds();
+
+// Returns the phase timestamps of the most recent connect attempt.
+const WiFiConnectTiming& lastWiFiConnectTiming();
+
+// Blocks until the Wi-Fi driver reports a connect, IP, or disconnect event, or
+// until `timeoutMs` passes. Returns true when an event arrived. Loops that
+// also poll the serial console use this instead of a plain `delay()`, so they
+// react to link changes at once.
+bool waitForWiFiEvent(unsigned long timeoutMs);
+
+// Registers the one-time Wi-Fi event logger used for serial diagnostics. It
+// also signals the event group `connectWiFi()` and `waitForWiFiEvent()` block
+// on.
 void registerWiFiEventLogger();
 
 // Shuts down station mode so the radio is off before deep sleep.
@@ -25,6 +59,17 @@ void logWiFiStatus(const char* prefix, wl_status_t status);
 // Scans nearby networks and captures the best BSSID/channel for the target SSID.
 void logWiFiScanResults();
 
+// Resolves `host` to an IPv4 address, answering from the RTC-retained DNS
+// cache while its entry is fresh and caching fresh lookups for
+// `DNS_CACHE_TTL_SECONDS`. `cacheHit` reports where the answer came from.
+bool resolveHost(const char* host, IPAddress& address, bool* cacheHit = nullptr);
+
+// Drops the cached address for `host` so the next resolve does a fresh lookup.
+void forgetResolvedHost(const char* host);
+
+// Prints the DNS cache entries and hit/miss counters for diagnostics.
+void printDnsCache();
+
 // Runs manual ping/DNS diagnostics from the serial console.
 void runConnectivityChecks();
 
@@ -0,0 +1,126 @@
+// Host-side unit tests for the alert rate limiter in `lib/envnode_core`.
+
+#include <unity.h>
+
+#include <alert_limiter.h>
+#include <cstdint>
+#include <cstdio>
+
+using envnode::core::AlertDecision;
+using envnode::core::AlertLimiter;
+using envnode::core::AlertLimiterConfig;
+using envnode::core::CheckAlert;
+using envnode::core::kAlertLimiterSlots;
+using envnode::core::RecordAlertSent;
+using envnode::core::SuppressedAlertCount;
+
+namespace {
+
+// Small numbers keep the timelines in the tests readable.
+AlertLimiterConfig testConfig() {
+  AlertLimiterConfig config;
+  config.burst = 2;
+  config.refillSeconds = 100;
+  config.dedupSeconds = 30;
+  return config;
+}
+
+// Checks an alert and records it as delivered when allowed, like the firmware.
+AlertDecision trySend(AlertLimiter& limiter,
+                      const AlertLimiterConfig& config,
+                      const char* type,
+                      const char* message,
+                      uint32_t now) {
+  const AlertDecision decision = CheckAlert(limiter, config, type, message, now);
+  if (decision == AlertDecision::Send) {
+    RecordAlertSent(limiter, config, type, message, now);
+  }
+  return decision;
+}
+
+}  // namespace
+
+// Unity fixture hook required by the test runner.
+void setUp() {}
+
+// Unity fixture hook required by the test runner.
+void tearDown() {}
+
+// Verifies the burst is allowed, further alerts are refused, and tokens come
+// back at the refill rate.
+void test_bucket_allows_burst_then_refills() {
+  AlertLimiter limiter;
+  const AlertLimiterConfig config = testConfig();
+
+  TEST_ASSERT_EQUAL(AlertDecision::Send, trySend(limiter, config, "sensor_error", "a", 1000));
+  TEST_ASSERT_EQUAL(AlertDecision::Send, trySend(limiter, config, "sensor_error", "b", 1001));
+  TEST_ASSERT_EQUAL(AlertDecision::RateLimited,
+                    trySend(limiter, config, "sensor_error", "c", 1002));
+  TEST_ASSERT_EQUAL(AlertDecision::RateLimited,
+                    trySend(limiter, config, "sensor_error", "d", 1099));
+  TEST_ASSERT_EQUAL_UINT16(2, SuppressedAlertCount(limiter, "sensor_error"));
+
+  TEST_ASSERT_EQUAL(AlertDecision::Send, trySend(limiter, config, "sensor_error", "e", 1101));
+  TEST_ASSERT_EQUAL_UINT16(0, SuppressedAlertCount(limiter, "sensor_error"));
+  TEST_ASSERT_EQUAL(AlertDecision::RateLimited,
+                    trySend(limiter, config, "sensor_error", "f", 1150));
+
+  // Refill periods run from 1100, not from the send at 1101.
+  TEST_ASSERT_EQUAL(AlertDecision::Send, trySend(limiter, config, "sensor_error", "g", 1200));
+}
+
+// Verifies identical alerts are suppressed within the window, and that
+// different types do not share a bucket.
+void test_duplicates_and_types_are_tracked_separately() {
+  AlertLimiter limiter;
+  const AlertLimiterConfig config = testConfig();
+
+  TEST_ASSERT_EQUAL(AlertDecision::Send, trySend(limiter, config, "battery_low", "3.40V", 0));
+  TEST_ASSERT_EQUAL(AlertDecision::Duplicate,
+                    trySend(limiter, config, "battery_low", "3.40V", 29));
+  TEST_ASSERT_EQUAL_UINT16(1, SuppressedAlertCount(limiter, "battery_low"));
+  TEST_ASSERT_EQUAL(AlertDecision::Send, trySend(limiter, config, "battery_low", "3.39V", 29));
+  TEST_ASSERT_EQUAL(AlertDecision::Send, trySend(limiter, config, "sensor_error", "3.40V", 30));
+  TEST_ASSERT_EQUAL_UINT16(0, SuppressedAlertCount(limiter, "battery_low"));
+
+  // A bucket that is out of tokens still reports duplicates as duplicates.
+  TEST_ASSERT_EQUAL(AlertDecision::Duplicate,
+                    trySend(limiter, config, "battery_low", "3.39V", 40));
+  TEST_ASSERT_EQUAL(AlertDecision::RateLimited,
+                    trySend(limiter, config, "battery_low", "3.38V", 40));
+  TEST_ASSERT_EQUAL_UINT16(2, SuppressedAlertCount(limiter, "battery_low"));
+}
+
+// Checks that an undelivered alert keeps its token, a clock step backwards
+// grants nothing, and a full table evicts the least recently sent type.
+void test_failed_sends_clock_steps_and_eviction() {
+  AlertLimiter limiter;
+  const AlertLimiterConfig config = testConfig();
+
+  TEST_ASSERT_EQUAL(AlertDecision::Send, trySend(limiter, config, "t", "a", 500));
+  TEST_ASSERT_EQUAL(AlertDecision::Send, CheckAlert(limiter, config, "t", "b", 501));
+  TEST_ASSERT_EQUAL(AlertDecision::Send, trySend(limiter, config, "t", "c", 502));
+  TEST_ASSERT_EQUAL(AlertDecision::RateLimited, trySend(limiter, config, "t", "d", 503));
+
+  // The clock steps backwards; the bucket must not refill from that.
+  TEST_ASSERT_EQUAL(AlertDecision::RateLimited, trySend(limiter, config, "t", "e", 10));
+  TEST_ASSERT_EQUAL(AlertDecision::Send, trySend(limiter, config, "t", "f", 110));
+
+  char types[kAlertLimiterSlots][8];
+  for (size_t i = 0; i < kAlertLimiterSlots; ++i) {
+    snprintf(types[i], sizeof(types[i]), "type%u", static_cast<unsigned>(i));
+    trySend(limiter, config, types[i], "x", 200 + static_cast<uint32_t>(i));
+  }
+  // "t" was sent least recently, so it lost its slot and starts over full.
+  TEST_ASSERT_EQUAL(AlertDecision::Send, trySend(limiter, config, "t", "g", 300));
+  TEST_ASSERT_EQUAL(AlertDecision::Send, trySend(limiter, config, "t", "h", 301));
+}
+
+// Native test entry point for the Unity runner.
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_bucket_allows_burst_then_refills);
+  RUN_TEST(test_duplicates_and_types_are_tracked_separately);
+  RUN_TEST(test_failed_sends_clock_steps_and_eviction);
+  return UNITY_END();
+}
@@ -0,0 +1,142 @@
+// Host-side benchmark for the gzip request-body encoder.
+//
+// Run with `pio test -e native-bench`. It compresses the request bodies the
+// firmware actually sends and reports the compression ratio and encoder time
+// per kilobyte of input.
+
+#include <unity.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <event_batch.h>
+#include <gzip.h>
+
+using envnode::core::AppendEvent;
+using envnode::core::BatchedReading;
+using envnode::core::EventBatch;
+using envnode::core::EventPayload;
+using envnode::core::GzipCompress;
+using envnode::core::GzipScratch;
+using envnode::core::JsonWriter;
+using envnode::core::kReadingRingCapacity;
+using envnode::core::PushReading;
+using envnode::core::ReadingRing;
+using envnode::core::ResetEventBatch;
+using envnode::core::WriteEventBatch;
+using envnode::core::WriteReadingBatch;
+
+namespace {
+
+// Iterations per measurement; large enough to smooth out timer resolution.
+constexpr int kIterations = 5000;
+
+GzipScratch gScratch;
+uint8_t gCompressed[8192];
+
+// Result of one benchmark loop.
+struct BenchResult {
+  size_t inputBytes = 0;
+  size_t outputBytes = 0;
+  double microsecondsPerKilobyte = 0.0;
+};
+
+// Compresses `input` repeatedly and records size and speed.
+BenchResult measure(const char* input, size_t length) {
+  BenchResult result;
+  result.inputBytes = length;
+  const auto started = std::chrono::steady_clock::now();
+  for (int iteration = 0; iteration < kIterations; ++iteration) {
+    result.outputBytes = GzipCompress(reinterpret_cast<const uint8_t*>(input), length,
+                                      gCompressed, sizeof(gCompressed), gScratch);
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - started;
+  result.microsecondsPerKilobyte =
+      std::chrono::duration<double, std::micro>(elapsed).count() / kIterations /
+      (static_cast<double>(length) / 1024.0);
+  return result;
+}
+
+// Prints one benchmark line through the Unity message channel.
+void report(const char* label, const BenchResult& result) {
+  char line[160];
+  std::snprintf(line, sizeof(line), "%-20s %5zu -> %5zu bytes (ratio %.2f) %7.1f us/KB",
+                label, result.inputBytes, result.outputBytes,
+                static_cast<double>(result.outputBytes) / result.inputBytes,
+                result.microsecondsPerKilobyte);
+  TEST_MESSAGE(line);
+}
+
+// Writes a readings batch of `rows` distinct, timestamped readings.
+size_t readingBatch(size_t rows, char* buffer, size_t bufferSize) {
+  ReadingRing ring;
+  for (size_t i = 0; i < rows; ++i) {
+    BatchedReading reading;
+    reading.temperature = 20.0f + i * 0.13f;
+    reading.humidity = 40.0f + i * 0.2f;
+    reading.pressure = 1001.0f + i * 0.05f;
+    reading.batteryVoltage = 3.91f - i * 0.002f;
+    reading.batteryPercent = 75.0f - i * 0.1f;
+    reading.recordedAtEpoch = 1704067200UL + i * 600;
+    PushReading(ring, reading);
+  }
+  JsonWriter writer(buffer, bufferSize);
+  WriteReadingBatch(writer, ring, ring.count, "envnode-livingroom");
+  return writer.Length();
+}
+
+}  // namespace
+
+// Unity fixture hook required by the test runner.
+void setUp() {}
+
+// Unity fixture hook required by the test runner.
+void tearDown() {}
+
+// Benchmarks readings batches at the default flush size and at ring capacity.
+void test_bench_reading_batches() {
+  static char buffer[6144];
+  size_t length = readingBatch(6, buffer, sizeof(buffer));
+  BenchResult six = measure(buffer, length);
+  report("6 readings", six);
+
+  length = readingBatch(kReadingRingCapacity, buffer, sizeof(buffer));
+  BenchResult full = measure(buffer, length);
+  report("24 readings", full);
+  TEST_ASSERT_GREATER_THAN(0, full.outputBytes);
+  TEST_ASSERT_LESS_THAN(full.inputBytes, full.outputBytes);
+}
+
+// Benchmarks a recovery sequence's worth of event rows.
+void test_bench_event_batch() {
+  static EventBatch batch;
+  ResetEventBatch(batch);
+  const char* actions[] = {"soft_reset", "reinit", "i2c_restart", "power_cycle"};
+  for (int attempt = 1; attempt <= 8; ++attempt) {
+    EventPayload event;
+    event.deviceId = "envnode-livingroom";
+    event.createdAtEpoch = 1704067200UL + attempt;
+    event.sessionId = "a1b2c3d4e5f6-9f8e7d6c";
+    event.eventType = "recovery";
+    event.severity = "warning";
+    event.message = "implausible reading; attempting recovery";
+    event.action = actions[attempt % 4];
+    event.attempt = attempt;
+    AppendEvent(batch, event);
+  }
+  static char buffer[4096];
+  JsonWriter writer(buffer, sizeof(buffer));
+  WriteEventBatch(writer, batch);
+
+  BenchResult events = measure(writer.Data(), writer.Length());
+  report("8 recovery events", events);
+  TEST_ASSERT_LESS_THAN(events.inputBytes, events.outputBytes);
+}
+
+// Native test entry point for the Unity runner.
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_bench_reading_batches);
+  RUN_TEST(test_bench_event_batch);
+  return UNITY_END();
+}
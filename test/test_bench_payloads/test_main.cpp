@@ -0,0 +1,200 @@
+// Host-side benchmark for the telemetry payload builders.
+//
+// Run with `pio test -e native-bench`. It compares the streaming writer with
+// the previous append-to-a-growing-string approach and reports time per
+// payload and heap allocations per payload for both.
+
+#include <unity.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <telemetry_payloads.h>
+
+using envnode::core::BatchedReading;
+using envnode::core::EventPayload;
+using envnode::core::JsonEscape;
+using envnode::core::JsonWriter;
+using envnode::core::kReadingRingCapacity;
+using envnode::core::PushReading;
+using envnode::core::ReadingAt;
+using envnode::core::ReadingRing;
+using envnode::core::WriteEventPayload;
+using envnode::core::WriteReadingBatch;
+
+namespace {
+
+// Iterations per measurement; large enough to smooth out timer resolution.
+constexpr int kIterations = 20000;
+
+// Heap allocations observed since the counter was last cleared.
+size_t gAllocationCount = 0;
+
+// Result of one benchmark loop.
+struct BenchResult {
+  double nanosecondsPerPayload = 0.0;
+  double allocationsPerPayload = 0.0;
+  size_t bytes = 0;
+};
+
+// Appends one number field the way the firmware used to with `String`.
+void appendLegacyNumber(std::string& out, const char* key, float value, int decimals) {
+  char number[32];
+  std::snprintf(number, sizeof(number), "%.*f", decimals, static_cast<double>(value));
+  out += ",\"";
+  out += key;
+  out += "\":";
+  out += number;
+}
+
+// Reproduces the old concatenation-based readings batch serializer.
+std::string legacyReadingBatch(const ReadingRing& ring, const char* deviceId) {
+  std::string out = "[";
+  for (size_t index = 0; index < ring.count; ++index) {
+    const BatchedReading& reading = *ReadingAt(ring, index);
+    if (index) {
+      out += ",";
+    }
+    out += "{\"device_id\":\"" + JsonEscape(deviceId) + "\"";
+    appendLegacyNumber(out, "temperature_c", reading.temperature, 2);
+    appendLegacyNumber(out, "humidity_rh", reading.humidity, 2);
+    appendLegacyNumber(out, "pressure_hpa", reading.pressure, 2);
+    appendLegacyNumber(out, "battery_voltage_v", reading.batteryVoltage, 3);
+    appendLegacyNumber(out, "battery_pct", reading.batteryPercent, 1);
+    out += "}";
+  }
+  out += "]";
+  return out;
+}
+
+// Reproduces the old concatenation-based event row builder.
+std::string legacyEvent(const EventPayload& event) {
+  std::string out = "{";
+  out += "\"device_id\":\"" + std::string(event.deviceId) + "\"";
+  out += ",\"event_type\":\"" + std::string(event.eventType) + "\"";
+  out += ",\"severity\":\"" + std::string(event.severity) + "\"";
+  out += ",\"message\":\"" + JsonEscape(event.message) + "\"";
+  out += ",\"action\":\"" + std::string(event.action) + "\"";
+  out += ",\"attempt\":" + std::to_string(event.attempt);
+  out += ",\"action_success\":false}";
+  return out;
+}
+
+// Times `body` over `kIterations` runs and counts its heap allocations.
+template <typename Body>
+BenchResult measure(Body body) {
+  BenchResult result;
+  gAllocationCount = 0;
+  const auto started = std::chrono::steady_clock::now();
+  for (int iteration = 0; iteration < kIterations; ++iteration) {
+    result.bytes = body();
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - started;
+  result.allocationsPerPayload =
+      static_cast<double>(gAllocationCount) / kIterations;
+  result.nanosecondsPerPayload =
+      std::chrono::duration<double, std::nano>(elapsed).count() / kIterations;
+  return result;
+}
+
+// Prints one benchmark line through the Unity message channel.
+void report(const char* label, const BenchResult& result) {
+  char line[160];
+  std::snprintf(line, sizeof(line), "%-24s %8.0f ns/payload %6.1f allocs/payload %5zu bytes",
+                label, result.nanosecondsPerPayload, result.allocationsPerPayload,
+                result.bytes);
+  TEST_MESSAGE(line);
+}
+
+// Fills the ring to capacity with distinct readings.
+ReadingRing makeFullRing() {
+  ReadingRing ring;
+  for (size_t i = 0; i < kReadingRingCapacity; ++i) {
+    BatchedReading reading;
+    reading.temperature = 20.0f + i * 0.13f;
+    reading.humidity = 40.0f + i * 0.2f;
+    reading.pressure = 1001.0f + i * 0.05f;
+    reading.batteryVoltage = 3.9f;
+    reading.batteryPercent = 75.0f;
+    PushReading(ring, reading);
+  }
+  return ring;
+}
+
+}  // namespace
+
+// Counts every allocation so both approaches report their heap traffic.
+void* operator new(size_t size) {
+  ++gAllocationCount;
+  if (void* memory = std::malloc(size ? size : 1)) {
+    return memory;
+  }
+  throw std::bad_alloc();
+}
+
+// Matching release for the counting allocator above.
+void operator delete(void* memory) noexcept {
+  std::free(memory);
+}
+
+// Sized release for the counting allocator above.
+void operator delete(void* memory, size_t) noexcept {
+  std::free(memory);
+}
+
+// Unity fixture hook required by the test runner.
+void setUp() {}
+
+// Unity fixture hook required by the test runner.
+void tearDown() {}
+
+// Benchmarks a full readings batch.
+void test_bench_reading_batch() {
+  const ReadingRing ring = makeFullRing();
+  static char buffer[6144];
+
+  BenchResult writer = measure([&]() {
+    JsonWriter json(buffer, sizeof(buffer));
+    WriteReadingBatch(json, ring, ring.count, "node-1");
+    return json.Length();
+  });
+  BenchResult legacy = measure([&]() { return legacyReadingBatch(ring, "node-1").size(); });
+
+  report("reading batch (writer)", writer);
+  report("reading batch (legacy)", legacy);
+  TEST_ASSERT_TRUE(writer.allocationsPerPayload == 0.0);
+}
+
+// Benchmarks one recovery event row.
+void test_bench_event_row() {
+  EventPayload event;
+  event.deviceId = "node-1";
+  event.eventType = "recovery";
+  event.severity = "warning";
+  event.message = "soft reset after implausible reading";
+  event.action = "soft_reset";
+  event.attempt = 2;
+  char buffer[512];
+
+  BenchResult writer = measure([&]() {
+    JsonWriter json(buffer, sizeof(buffer));
+    WriteEventPayload(json, event);
+    return json.Length();
+  });
+  BenchResult legacy = measure([&]() { return legacyEvent(event).size(); });
+
+  report("event row (writer)", writer);
+  report("event row (legacy)", legacy);
+  TEST_ASSERT_TRUE(writer.allocationsPerPayload == 0.0);
+}
+
+// Native test entry point for the Unity runner.
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_bench_reading_batch);
+  RUN_TEST(test_bench_event_row);
+  return UNITY_END();
+}
@@ -0,0 +1,268 @@
+// Host-side benchmark for the radio traffic of one wake cycle.
+//
+// Run with `pio test -e native-bench`. Each scenario replays what the firmware
+// sends in one wake, using the real payload writers and dispatch functions,
+// against the in-process Supabase/n8n stand-in. It reports requests, uplink
+// bytes, and TLS handshakes per cycle, and p50/p99 of the modeled network time
+// per cycle. Latency comes from the stand-in's link model rather than a real
+// network, so compare runs against each other, not against field numbers.
+
+#include <unity.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <event_batch.h>
+#include <fake_telemetry_server.h>
+#include <functional>
+#include <telemetry_dispatch.h>
+#include <telemetry_payloads.h>
+#include <vector>
+
+using envnode::core::AppendEvent;
+using envnode::core::BatchedReading;
+using envnode::core::EventBatch;
+using envnode::core::EventPayload;
+using envnode::core::GzipScratch;
+using envnode::core::HttpHeader;
+using envnode::core::InsertCompression;
+using envnode::core::JsonWriter;
+using envnode::core::PushReading;
+using envnode::core::ReadingRing;
+using envnode::core::ResetEventBatch;
+using envnode::core::SendJsonPost;
+using envnode::core::SendSupabaseInsert;
+using envnode::core::SupabaseInsert;
+using envnode::core::SupabaseTarget;
+using envnode::core::WakePriority;
+using envnode::core::WebhookPayload;
+using envnode::core::WriteEventBatch;
+using envnode::core::WriteReadingBatch;
+using envnode::core::WriteWebhookPayload;
+using envnode::host::FakeTelemetryServer;
+using envnode::host::RecordedRequest;
+
+namespace {
+
+// Simulated wakes per scenario; enough for a stable p99.
+constexpr int kCycles = 2000;
+
+// Same column lists and gzip threshold the firmware uses.
+constexpr const char* kReadingColumns =
+    "device_id,recorded_at,temperature_c,humidity_rh,pressure_hpa,"
+    "battery_voltage_v,battery_pct";
+constexpr const char* kEventColumns =
+    "device_id,created_at,session_id,event_type,severity,message,"
+    "reading_temp_c,reading_humidity_rh,reading_pressure_hpa,action,attempt,"
+    "action_success,meta";
+constexpr size_t kGzipMinBytes = 512;
+
+constexpr const char* kDeviceId = "envnode-livingroom";
+constexpr const char* kWebhookUrl = "https://n8n.example.com/webhook/7f3a9c";
+
+GzipScratch gScratch;
+uint8_t gCompressed[6144];
+char gPayload[6144];
+
+// Per-cycle measurements for one scenario.
+struct CycleStats {
+  size_t requests = 0;
+  size_t uplinkBytes = 0;
+  size_t handshakes = 0;
+  std::vector<uint32_t> cycleMs;
+};
+
+SupabaseTarget benchTarget() {
+  SupabaseTarget target;
+  target.url = "https://abcdefghijklmnop.supabase.co";
+  target.apiKey = "sb_publishable_0123456789abcdefghijklmnopqrstuv";
+  return target;
+}
+
+InsertCompression benchCompression() {
+  InsertCompression compression;
+  compression.minBytes = kGzipMinBytes;
+  compression.buffer = gCompressed;
+  compression.capacity = sizeof(gCompressed);
+  compression.scratch = &gScratch;
+  return compression;
+}
+
+// Posts one finished JSON body as a Supabase bulk insert.
+void insert(FakeTelemetryServer& server,
+            const char* table,
+            const char* columns,
+            const JsonWriter& body,
+            WakePriority priority) {
+  SupabaseInsert request;
+  request.table = table;
+  request.columns = columns;
+  request.body = body.Data();
+  request.bodyLength = body.Length();
+  request.priority = priority;
+  SendSupabaseInsert(server, benchTarget(), request, benchCompression());
+}
+
+// Uploads a readings batch of `rows` at the firmware's default flush size.
+void uploadReadings(FakeTelemetryServer& server, size_t rows) {
+  ReadingRing ring;
+  for (size_t i = 0; i < rows; ++i) {
+    BatchedReading reading;
+    reading.temperature = 20.0f + i * 0.13f;
+    reading.humidity = 40.0f + i * 0.2f;
+    reading.pressure = 1001.0f + i * 0.05f;
+    reading.batteryVoltage = 3.91f - i * 0.002f;
+    reading.batteryPercent = 75.0f - i * 0.1f;
+    reading.recordedAtEpoch = 1704067200UL + i * 600;
+    PushReading(ring, reading);
+  }
+  JsonWriter writer(gPayload, sizeof(gPayload));
+  WriteReadingBatch(writer, ring, ring.count, kDeviceId);
+  insert(server, "readings", kReadingColumns, writer, WakePriority::Reading);
+}
+
+// Uploads `count` event rows of one type as a single bulk insert.
+void uploadEvents(FakeTelemetryServer& server,
+                  const char* type,
+                  const char* severity,
+                  const char* message,
+                  int count) {
+  static EventBatch batch;
+  ResetEventBatch(batch);
+  const char* actions[] = {"soft_reset", "reinit", "i2c_restart", "power_cycle"};
+  for (int attempt = 1; attempt <= count; ++attempt) {
+    EventPayload event;
+    event.deviceId = kDeviceId;
+    event.createdAtEpoch = 1704067200UL + attempt;
+    event.sessionId = "a1b2c3d4e5f6-9f8e7d6c";
+    event.eventType = type;
+    event.severity = severity;
+    event.message = message;
+    if (count > 1) {
+      event.action = actions[attempt % 4];
+      event.attempt = attempt;
+    }
+    AppendEvent(batch, event);
+  }
+  JsonWriter writer(gPayload, sizeof(gPayload));
+  WriteEventBatch(writer, batch);
+  insert(server, "device_events", kEventColumns, writer, WakePriority::Event);
+}
+
+// Sends one structured n8n webhook with a reading snapshot.
+void sendWebhook(FakeTelemetryServer& server,
+                 const char* alertType,
+                 const char* severity,
+                 const char* message) {
+  BatchedReading reading;
+  reading.temperature = 21.4f;
+  reading.humidity = 41.0f;
+  reading.pressure = 1002.3f;
+  reading.batteryVoltage = 3.48f;
+  reading.batteryPercent = 22.0f;
+  WebhookPayload webhook;
+  webhook.deviceId = kDeviceId;
+  webhook.alertType = alertType;
+  webhook.severity = severity;
+  webhook.message = message;
+  webhook.timestampMs = 2150;
+  webhook.fwVersion = "1.4.0";
+  webhook.readings = &reading;
+  JsonWriter writer(gPayload, sizeof(gPayload));
+  WriteWebhookPayload(writer, webhook);
+  const HttpHeader access[] = {{"CF-Access-Client-Id", "0123456789abcdef.access"},
+                               {"CF-Access-Client-Secret", "0123456789abcdef0123456789abcdef"}};
+  SendJsonPost(server, kWebhookUrl, access, 2, writer.Data(), writer.Length(), 10000,
+               WakePriority::Webhook);
+}
+
+// Runs `cycle` repeatedly with connections closed between wakes, as the
+// firmware does before deep sleep.
+CycleStats measure(const std::function<void(FakeTelemetryServer&)>& cycle) {
+  FakeTelemetryServer server;
+  CycleStats stats;
+  for (int iteration = 0; iteration < kCycles; ++iteration) {
+    server.ClearRequests();
+    const size_t opened = server.ConnectionsOpened();
+    cycle(server);
+    server.CloseConnections();
+
+    uint32_t cycleMs = 0;
+    size_t bytes = 0;
+    for (const RecordedRequest& request : server.Requests()) {
+      cycleMs += request.latencyMs;
+      bytes += request.wireBytes;
+    }
+    stats.requests = server.Requests().size();
+    stats.uplinkBytes = bytes;
+    stats.handshakes = server.ConnectionsOpened() - opened;
+    stats.cycleMs.push_back(cycleMs);
+  }
+  std::sort(stats.cycleMs.begin(), stats.cycleMs.end());
+  return stats;
+}
+
+// Prints one benchmark line through the Unity message channel.
+void report(const char* label, const CycleStats& stats) {
+  const uint32_t p50 = stats.cycleMs[stats.cycleMs.size() / 2];
+  const uint32_t p99 = stats.cycleMs[stats.cycleMs.size() * 99 / 100];
+  char line[160];
+  std::snprintf(line, sizeof(line),
+                "%-14s %zu req/cycle %6zu B/cycle %zu handshake(s)  p50 %4u ms  p99 %4u ms",
+                label, stats.requests, stats.uplinkBytes, stats.handshakes,
+                static_cast<unsigned>(p50), static_cast<unsigned>(p99));
+  TEST_MESSAGE(line);
+}
+
+}  // namespace
+
+// Unity fixture hook required by the test runner.
+void setUp() {}
+
+// Unity fixture hook required by the test runner.
+void tearDown() {}
+
+// A routine flush wake: one readings batch.
+void test_bench_normal_cycle() {
+  const CycleStats stats = measure([](FakeTelemetryServer& server) {
+    uploadReadings(server, 6);
+  });
+  report("normal", stats);
+  TEST_ASSERT_EQUAL_UINT32(1, stats.requests);
+  TEST_ASSERT_EQUAL_UINT32(1, stats.handshakes);
+}
+
+// A wake that recovered the sensor: eight recovery events, the error webhook,
+// and the readings batch.
+void test_bench_recovery_cycle() {
+  const CycleStats stats = measure([](FakeTelemetryServer& server) {
+    uploadReadings(server, 6);
+    uploadEvents(server, "recovery", "warning", "implausible reading; attempting recovery", 8);
+    sendWebhook(server, "sensor_error", "error", "Sensor failed validation; recovery in progress");
+  });
+  report("recovery", stats);
+  TEST_ASSERT_EQUAL_UINT32(3, stats.requests);
+  TEST_ASSERT_EQUAL_UINT32(2, stats.handshakes);
+}
+
+// A wake that crossed the low-battery threshold: one event, the webhook, and
+// the readings batch.
+void test_bench_battery_alert_cycle() {
+  const CycleStats stats = measure([](FakeTelemetryServer& server) {
+    uploadReadings(server, 6);
+    uploadEvents(server, "battery_low", "warning", "Battery low: 3.48V (22%)", 1);
+    sendWebhook(server, "battery_low", "warning", "Battery low: 3.48V (22%)");
+  });
+  report("battery alert", stats);
+  TEST_ASSERT_EQUAL_UINT32(3, stats.requests);
+  TEST_ASSERT_EQUAL_UINT32(2, stats.handshakes);
+}
+
+// Native test entry point for the Unity runner.
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_bench_normal_cycle);
+  RUN_TEST(test_bench_recovery_cycle);
+  RUN_TEST(test_bench_battery_alert_cycle);
+  return UNITY_END();
+}
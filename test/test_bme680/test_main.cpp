@@ -0,0 +1,278 @@
+// Host-side unit tests for the BME680 register helpers and integer
+// compensation in `lib/envnode_core`.
+
+#include <unity.h>
+
+#include <bme680.h>
+
+using envnode::core::Bme680Calibration;
+using envnode::core::Bme680CalibrationCache;
+using envnode::core::Bme680CalibrationCacheValid;
+using envnode::core::Bme680Compensated;
+using envnode::core::Bme680Config;
+using envnode::core::Bme680CtrlHum;
+using envnode::core::Bme680CtrlMeas;
+using envnode::core::Bme680MeasurementMs;
+using envnode::core::Bme680Oversampling;
+using envnode::core::Bme680RawSample;
+using envnode::core::Bme680Settings;
+using envnode::core::CompensateBme680;
+using envnode::core::DecodeBme680Field;
+using envnode::core::kBme680ChipId;
+using envnode::core::kBme680Calibration1Bytes;
+using envnode::core::kBme680Calibration2Bytes;
+using envnode::core::kBme680FieldBytes;
+using envnode::core::ParseBme680Calibration;
+using envnode::core::StoreBme680Calibration;
+
+namespace {
+
+// Coefficients in the range of production sensors, with negative values where
+// the datasheet allows them.
+Bme680Calibration typicalCalibration() {
+  Bme680Calibration c;
+  c.parT1 = 26243;
+  c.parT2 = 26273;
+  c.parT3 = 3;
+  c.parP1 = 36417;
+  c.parP2 = -10426;
+  c.parP3 = 88;
+  c.parP4 = 6771;
+  c.parP5 = -58;
+  c.parP6 = 30;
+  c.parP7 = 42;
+  c.parP8 = -1597;
+  c.parP9 = -3179;
+  c.parP10 = 30;
+  c.parH1 = 757;
+  c.parH2 = 1022;
+  c.parH3 = 0;
+  c.parH4 = 45;
+  c.parH5 = 20;
+  c.parH6 = 120;
+  c.parH7 = -100;
+  return c;
+}
+
+// Floating-point compensation as printed in the BME680 datasheet, used as the
+// reference for the integer formulas.
+struct FloatReading {
+  double celsius;
+  double pascals;
+  double percentRh;
+};
+
+FloatReading datasheetCompensation(const Bme680Calibration& c, const Bme680RawSample& s) {
+  const double t = s.temperatureAdc;
+  const double tVar1 = (t / 16384.0 - c.parT1 / 1024.0) * c.parT2;
+  const double tVar2 =
+      (t / 131072.0 - c.parT1 / 8192.0) * (t / 131072.0 - c.parT1 / 8192.0) * (c.parT3 * 16.0);
+  const double tFine = tVar1 + tVar2;
+  FloatReading out;
+  out.celsius = tFine / 5120.0;
+
+  double var1 = tFine / 2.0 - 64000.0;
+  double var2 = var1 * var1 * (c.parP6 / 131072.0);
+  var2 = var2 + var1 * c.parP5 * 2.0;
+  var2 = var2 / 4.0 + c.parP4 * 65536.0;
+  var1 = (c.parP3 * var1 * var1 / 16384.0 + c.parP2 * var1) / 524288.0;
+  var1 = (1.0 + var1 / 32768.0) * c.parP1;
+  double pressure = 1048576.0 - s.pressureAdc;
+  pressure = (pressure - var2 / 4096.0) * 6250.0 / var1;
+  var1 = c.parP9 * pressure * pressure / 2147483648.0;
+  var2 = pressure * (c.parP8 / 32768.0);
+  const double var3 =
+      (pressure / 256.0) * (pressure / 256.0) * (pressure / 256.0) * (c.parP10 / 131072.0);
+  out.pascals = pressure + (var1 + var2 + var3 + c.parP7 * 128.0) / 16.0;
+
+  const double h1 = s.humidityAdc - (c.parH1 * 16.0 + c.parH3 / 2.0 * out.celsius);
+  const double h2 = h1 * (c.parH2 / 262144.0 *
+                          (1.0 + c.parH4 / 16384.0 * out.celsius +
+                           c.parH5 / 1048576.0 * out.celsius * out.celsius));
+  const double h3 = c.parH6 / 16384.0;
+  const double h4 = c.parH7 / 2097152.0;
+  out.percentRh = h2 + (h3 + h4 * out.celsius) * h2 * h2;
+  out.percentRh = out.percentRh > 100.0 ? 100.0 : (out.percentRh < 0.0 ? 0.0 : out.percentRh);
+  return out;
+}
+
+Bme680RawSample rawSample(uint32_t temperatureAdc, uint32_t pressureAdc, uint16_t humidityAdc) {
+  Bme680RawSample sample;
+  sample.temperatureAdc = temperatureAdc;
+  sample.pressureAdc = pressureAdc;
+  sample.humidityAdc = humidityAdc;
+  return sample;
+}
+
+}  // namespace
+
+// Unity fixture hook required by the test runner.
+void setUp() {}
+
+// Unity fixture hook required by the test runner.
+void tearDown() {}
+
+// Verifies every coefficient is read from its register, including signed
+// values and the two 12-bit humidity values that share one register.
+void test_calibration_blocks_parse_into_coefficients() {
+  uint8_t block1[kBme680Calibration1Bytes] = {0};
+  uint8_t block2[kBme680Calibration2Bytes] = {0};
+  block1[1] = 0xA1;  // T2 = 0x66A1
+  block1[2] = 0x66;
+  block1[3] = 0x03;  // T3
+  block1[5] = 0x41;  // P1 = 0x8E41
+  block1[6] = 0x8E;
+  block1[7] = 0x46;  // P2 = 0xD746 (-10426)
+  block1[8] = 0xD7;
+  block1[9] = 0x58;  // P3
+  block1[11] = 0x73;  // P4 = 0x1A73
+  block1[12] = 0x1A;
+  block1[13] = 0xC6;  // P5 = 0xFFC6 (-58)
+  block1[14] = 0xFF;
+  block1[15] = 0x2A;  // P7
+  block1[16] = 0x1E;  // P6
+  block1[19] = 0xC3;  // P8 = 0xF9C3 (-1597)
+  block1[20] = 0xF9;
+  block1[21] = 0x95;  // P9 = 0xF395 (-3179)
+  block1[22] = 0xF3;
+  block1[23] = 0x1E;  // P10
+  block2[0] = 0x3F;  // H2 = 0x3FE
+  block2[1] = 0xE5;  // H2 low nibble 0xE, H1 low nibble 0x5
+  block2[2] = 0x2F;  // H1 = 0x2F5
+  block2[3] = 0x00;  // H3
+  block2[4] = 0x2D;  // H4
+  block2[5] = 0x14;  // H5
+  block2[6] = 0x78;  // H6
+  block2[7] = 0x9C;  // H7 = -100
+  block2[8] = 0x83;  // T1 = 0x6683
+  block2[9] = 0x66;
+
+  Bme680Calibration parsed;
+  TEST_ASSERT_TRUE(ParseBme680Calibration(block1, block2, parsed));
+  const Bme680Calibration expected = typicalCalibration();
+  TEST_ASSERT_EQUAL_UINT16(expected.parT1, parsed.parT1);
+  TEST_ASSERT_EQUAL_INT16(expected.parT2, parsed.parT2);
+  TEST_ASSERT_EQUAL_INT8(expected.parT3, parsed.parT3);
+  TEST_ASSERT_EQUAL_UINT16(expected.parP1, parsed.parP1);
+  TEST_ASSERT_EQUAL_INT16(expected.parP2, parsed.parP2);
+  TEST_ASSERT_EQUAL_INT8(expected.parP3, parsed.parP3);
+  TEST_ASSERT_EQUAL_INT16(expected.parP4, parsed.parP4);
+  TEST_ASSERT_EQUAL_INT16(expected.parP5, parsed.parP5);
+  TEST_ASSERT_EQUAL_INT8(expected.parP6, parsed.parP6);
+  TEST_ASSERT_EQUAL_INT8(expected.parP7, parsed.parP7);
+  TEST_ASSERT_EQUAL_INT16(expected.parP8, parsed.parP8);
+  TEST_ASSERT_EQUAL_INT16(expected.parP9, parsed.parP9);
+  TEST_ASSERT_EQUAL_UINT8(expected.parP10, parsed.parP10);
+  TEST_ASSERT_EQUAL_UINT16(expected.parH1, parsed.parH1);
+  TEST_ASSERT_EQUAL_UINT16(expected.parH2, parsed.parH2);
+  TEST_ASSERT_EQUAL_INT8(expected.parH4, parsed.parH4);
+  TEST_ASSERT_EQUAL_INT8(expected.parH5, parsed.parH5);
+  TEST_ASSERT_EQUAL_UINT8(expected.parH6, parsed.parH6);
+  TEST_ASSERT_EQUAL_INT8(expected.parH7, parsed.parH7);
+
+  uint8_t blank1[kBme680Calibration1Bytes] = {0};
+  uint8_t blank2[kBme680Calibration2Bytes] = {0};
+  TEST_ASSERT_FALSE(ParseBme680Calibration(blank1, blank2, parsed));
+}
+
+// Checks the register values for the firmware's 8x/4x/2x configuration and the
+// conversion time it implies.
+void test_register_values_and_measurement_time() {
+  const Bme680Settings settings;
+  TEST_ASSERT_EQUAL_HEX8(0x02, Bme680CtrlHum(settings));
+  TEST_ASSERT_EQUAL_HEX8(0x8D, Bme680CtrlMeas(settings, true));
+  TEST_ASSERT_EQUAL_HEX8(0x8C, Bme680CtrlMeas(settings, false));
+  TEST_ASSERT_EQUAL_HEX8(0x08, Bme680Config(settings));
+  TEST_ASSERT_EQUAL_UINT32(33, Bme680MeasurementMs(settings));
+
+  Bme680Settings fast;
+  fast.temperature = Bme680Oversampling::X1;
+  fast.pressure = Bme680Oversampling::X1;
+  fast.humidity = Bme680Oversampling::X1;
+  TEST_ASSERT_LESS_THAN_UINT32(Bme680MeasurementMs(settings), Bme680MeasurementMs(fast));
+}
+
+// Verifies the 20-bit and 16-bit ADC values and the status bits are taken from
+// the right bytes of the field burst.
+void test_field_burst_decodes_adc_values() {
+  const uint8_t field[kBme680FieldBytes] = {0x80, 0x00, 0x5C, 0xC6, 0x00,
+                                            0x72, 0xBF, 0x00, 0x55, 0xF0};
+  const Bme680RawSample sample = DecodeBme680Field(field);
+  TEST_ASSERT_TRUE(sample.newData);
+  TEST_ASSERT_FALSE(sample.measuring);
+  TEST_ASSERT_EQUAL_UINT32(0x5CC60, sample.pressureAdc);
+  TEST_ASSERT_EQUAL_UINT32(0x72BF0, sample.temperatureAdc);
+  TEST_ASSERT_EQUAL_UINT16(0x55F0, sample.humidityAdc);
+
+  const uint8_t busy[kBme680FieldBytes] = {0x20};
+  TEST_ASSERT_FALSE(DecodeBme680Field(busy).newData);
+  TEST_ASSERT_TRUE(DecodeBme680Field(busy).measuring);
+}
+
+// Compares the integer compensation with the datasheet's floating-point
+// formulas across the sensor's temperature, pressure, and humidity range, and
+// pins one result exactly.
+void test_integer_compensation_matches_datasheet_formulas() {
+  const Bme680Calibration calibration = typicalCalibration();
+  for (uint32_t t = 380000; t <= 580000; t += 20000) {
+    for (uint32_t p = 280000; p <= 500000; p += 20000) {
+      for (uint32_t h = 12000; h <= 30000; h += 3000) {
+        const Bme680RawSample sample = rawSample(t, p, static_cast<uint16_t>(h));
+        const Bme680Compensated fixed = CompensateBme680(calibration, sample);
+        const FloatReading reference = datasheetCompensation(calibration, sample);
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, static_cast<float>(reference.celsius),
+                                 fixed.centiCelsius / 100.0f);
+        TEST_ASSERT_FLOAT_WITHIN(10.0f, static_cast<float>(reference.pascals),
+                                 static_cast<float>(fixed.pascals));
+        TEST_ASSERT_FLOAT_WITHIN(0.05f, static_cast<float>(reference.percentRh),
+                                 fixed.milliPercentRh / 1000.0f);
+      }
+    }
+  }
+
+  const Bme680Compensated pinned = CompensateBme680(calibration, rawSample(470000, 380000, 22000));
+  TEST_ASSERT_EQUAL_INT16(1570, pinned.centiCelsius);
+  TEST_ASSERT_EQUAL_UINT32(94675, pinned.pascals);
+  TEST_ASSERT_EQUAL_UINT32(51107, pinned.milliPercentRh);
+}
+
+// Checks that a stored calibration validates only for its own chip ID and
+// address, and that any corrupted byte is caught by the checksum.
+void test_calibration_cache_is_keyed_and_checksummed() {
+  Bme680CalibrationCache empty;
+  TEST_ASSERT_FALSE(Bme680CalibrationCacheValid(empty, 0, 0));
+
+  uint8_t block1[kBme680Calibration1Bytes];
+  uint8_t block2[kBme680Calibration2Bytes];
+  for (size_t i = 0; i < sizeof(block1); ++i) {
+    block1[i] = static_cast<uint8_t>(0x10 + i);
+  }
+  for (size_t i = 0; i < sizeof(block2); ++i) {
+    block2[i] = static_cast<uint8_t>(0xA0 + i);
+  }
+
+  Bme680CalibrationCache cache;
+  StoreBme680Calibration(cache, 0x77, kBme680ChipId, block1, block2);
+  TEST_ASSERT_TRUE(Bme680CalibrationCacheValid(cache, 0x77, kBme680ChipId));
+  TEST_ASSERT_FALSE(Bme680CalibrationCacheValid(cache, 0x76, kBme680ChipId));
+  TEST_ASSERT_FALSE(Bme680CalibrationCacheValid(cache, 0x77, 0x60));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(block1, cache.block1, sizeof(block1));
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(block2, cache.block2, sizeof(block2));
+
+  cache.block2[8] ^= 0x01;
+  TEST_ASSERT_FALSE(Bme680CalibrationCacheValid(cache, 0x77, kBme680ChipId));
+  cache.block2[8] ^= 0x01;
+  cache.address = 0x76;
+  TEST_ASSERT_FALSE(Bme680CalibrationCacheValid(cache, 0x76, kBme680ChipId));
+}
+
+// Native test entry point for the Unity runner.
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_calibration_blocks_parse_into_coefficients);
+  RUN_TEST(test_register_values_and_measurement_time);
+  RUN_TEST(test_field_burst_decodes_adc_values);
+  RUN_TEST(test_integer_compensation_matches_datasheet_formulas);
+  RUN_TEST(test_calibration_cache_is_keyed_and_checksummed);
+  return UNITY_END();
+}
@@ -0,0 +1,86 @@
+// Host-side unit tests for the retained DNS cache in `lib/envnode_core`.
+
+#include <unity.h>
+
+#include <dns_cache.h>
+#include <string>
+
+using envnode::core::DnsCache;
+using envnode::core::DnsEntryRemainingSeconds;
+using envnode::core::ForgetDnsCacheEntry;
+using envnode::core::LookupDnsCache;
+using envnode::core::StoreDnsCache;
+
+namespace {
+
+constexpr uint32_t kSupabaseAddress = 0x0A00A8C0;  // 192.168.0.10, little-endian.
+constexpr uint32_t kWebhookAddress = 0x0B00A8C0;
+
+}  // namespace
+
+// Unity fixture hook required by the test runner.
+void setUp() {}
+
+// Unity fixture hook required by the test runner.
+void tearDown() {}
+
+// Verifies entries hit until their TTL runs out and that misses are counted.
+void test_entries_expire_after_ttl() {
+  DnsCache cache;
+  uint32_t address = 0;
+  TEST_ASSERT_FALSE(LookupDnsCache(cache, "project.supabase.co", 100, address));
+  TEST_ASSERT_TRUE(StoreDnsCache(cache, "project.supabase.co", kSupabaseAddress, 300, 100));
+
+  TEST_ASSERT_TRUE(LookupDnsCache(cache, "project.supabase.co", 399, address));
+  TEST_ASSERT_EQUAL_HEX32(kSupabaseAddress, address);
+  TEST_ASSERT_EQUAL_UINT32(1, DnsEntryRemainingSeconds(cache.entries[0], 399));
+  TEST_ASSERT_FALSE(LookupDnsCache(cache, "project.supabase.co", 400, address));
+  TEST_ASSERT_EQUAL_UINT32(1, cache.hits);
+  TEST_ASSERT_EQUAL_UINT32(2, cache.misses);
+
+  // A clock stepped back cannot vouch for the entry's age.
+  StoreDnsCache(cache, "project.supabase.co", kSupabaseAddress, 300, 1000);
+  TEST_ASSERT_FALSE(LookupDnsCache(cache, "project.supabase.co", 900, address));
+}
+
+// Ensures the least recently used host is evicted and that failed
+// connections can drop a single entry.
+void test_eviction_and_forget() {
+  DnsCache cache;
+  uint32_t address = 0;
+  StoreDnsCache(cache, "a.example.com", kSupabaseAddress, 600, 0);
+  StoreDnsCache(cache, "b.example.com", kWebhookAddress, 600, 0);
+  StoreDnsCache(cache, "c.example.com", kWebhookAddress, 600, 0);
+  TEST_ASSERT_TRUE(LookupDnsCache(cache, "a.example.com", 10, address));
+  StoreDnsCache(cache, "d.example.com", kWebhookAddress, 600, 10);
+
+  TEST_ASSERT_TRUE(LookupDnsCache(cache, "a.example.com", 20, address));
+  TEST_ASSERT_FALSE(LookupDnsCache(cache, "b.example.com", 20, address));
+  TEST_ASSERT_TRUE(LookupDnsCache(cache, "d.example.com", 20, address));
+
+  ForgetDnsCacheEntry(cache, "a.example.com");
+  TEST_ASSERT_FALSE(LookupDnsCache(cache, "a.example.com", 20, address));
+  TEST_ASSERT_TRUE(LookupDnsCache(cache, "c.example.com", 20, address));
+}
+
+// Checks that unusable input is never cached.
+void test_rejects_unusable_entries() {
+  DnsCache cache;
+  const std::string longHost(80, 'h');
+  TEST_ASSERT_FALSE(StoreDnsCache(cache, longHost.c_str(), kSupabaseAddress, 600, 0));
+  TEST_ASSERT_FALSE(StoreDnsCache(cache, "a.example.com", 0, 600, 0));
+  TEST_ASSERT_FALSE(StoreDnsCache(cache, "a.example.com", kSupabaseAddress, 0, 0));
+  TEST_ASSERT_FALSE(StoreDnsCache(cache, "", kSupabaseAddress, 600, 0));
+  for (const auto& entry : cache.entries) {
+    TEST_ASSERT_EQUAL_INT(0, entry.host[0]);
+  }
+}
+
+// Native test entry point for the Unity runner.
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_entries_expire_after_ttl);
+  RUN_TEST(test_eviction_and_forget);
+  RUN_TEST(test_rejects_unusable_entries);
+  return UNITY_END();
+}
@@ -0,0 +1,153 @@
+// Host-side unit tests for the ESP-NOW frame codec and HMAC in `lib/envnode_core`.
+
+#include <unity.h>
+
+#include <cmath>
+#include <cstring>
+#include <espnow_frame.h>
+#include <sha256.h>
+
+using envnode::core::DecodeEspNowFrame;
+using envnode::core::EncodeEspNowFrame;
+using envnode::core::EspNowDecodeStatus;
+using envnode::core::EspNowFrame;
+using envnode::core::FrameCounter;
+using envnode::core::HmacSha256;
+using envnode::core::kEspNowMaxFrameBytes;
+using envnode::core::kEspNowMaxReadingsPerFrame;
+using envnode::core::kFrameCounterReserveBlock;
+using envnode::core::kSha256Bytes;
+using envnode::core::ResumeFrameCounter;
+using envnode::core::TakeFrameCounter;
+
+namespace {
+
+constexpr uint8_t kKey[] = "correct horse battery staple";
+
+// Builds a frame carrying `count` readings.
+EspNowFrame makeFrame(uint8_t count) {
+  EspNowFrame frame;
+  strcpy(frame.deviceId, "envnode-livingroom");
+  frame.counter = 4097;
+  frame.readingCount = count;
+  for (uint8_t i = 0; i < count; ++i) {
+    frame.readings[i].temperature = 21.0f + i;
+    frame.readings[i].humidity = 45.0f;
+    frame.readings[i].pressure = 1010.5f;
+    frame.readings[i].recordedAtEpoch = 1704067200UL + i * 600;
+  }
+  return frame;
+}
+
+}  // namespace
+
+// Unity fixture hook required by the test runner.
+void setUp() {}
+
+// Unity fixture hook required by the test runner.
+void tearDown() {}
+
+// Verifies HMAC-SHA256 against RFC 4231 test cases 2 and 6 (short key and a
+// key longer than one block).
+void test_hmac_sha256_matches_rfc4231() {
+  const uint8_t expectedShort[kSha256Bytes] = {
+      0x5b, 0xdc, 0xc1, 0x46, 0xbf, 0x60, 0x75, 0x4e, 0x6a, 0x04, 0x24,
+      0x26, 0x08, 0x95, 0x75, 0xc7, 0x5a, 0x00, 0x3f, 0x08, 0x9d, 0x27,
+      0x39, 0x83, 0x9d, 0xec, 0x58, 0xb9, 0x64, 0xec, 0x38, 0x43};
+  uint8_t mac[kSha256Bytes];
+  const char* data = "what do ya want for nothing?";
+  HmacSha256(reinterpret_cast<const uint8_t*>("Jefe"), 4,
+             reinterpret_cast<const uint8_t*>(data), strlen(data), mac);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expectedShort, mac, kSha256Bytes);
+
+  const uint8_t expectedLongKey[kSha256Bytes] = {
+      0x60, 0xe4, 0x31, 0x59, 0x1e, 0xe0, 0xb6, 0x7f, 0x0d, 0x8a, 0x26,
+      0xaa, 0xcb, 0xf5, 0xb7, 0x7f, 0x8e, 0x0b, 0xc6, 0x21, 0x37, 0x28,
+      0xc5, 0x14, 0x05, 0x46, 0x04, 0x0f, 0x0e, 0xe3, 0x7f, 0x54};
+  uint8_t longKey[131];
+  memset(longKey, 0xaa, sizeof(longKey));
+  const char* longData = "Test Using Larger Than Block-Size Key - Hash Key First";
+  HmacSha256(longKey, sizeof(longKey), reinterpret_cast<const uint8_t*>(longData),
+             strlen(longData), mac);
+  TEST_ASSERT_EQUAL_UINT8_ARRAY(expectedLongKey, mac, kSha256Bytes);
+}
+
+// Ensures a full frame fits one ESP-NOW payload and round-trips every field,
+// including missing battery values.
+void test_frame_round_trip() {
+  const EspNowFrame sent = makeFrame(kEspNowMaxReadingsPerFrame);
+  uint8_t encoded[kEspNowMaxFrameBytes];
+  const size_t length = EncodeEspNowFrame(sent, kKey, sizeof(kKey), encoded, sizeof(encoded));
+  TEST_ASSERT_GREATER_THAN(0, length);
+  TEST_ASSERT_LESS_OR_EQUAL(kEspNowMaxFrameBytes, length);
+
+  EspNowFrame received;
+  TEST_ASSERT_EQUAL(EspNowDecodeStatus::Ok,
+                    DecodeEspNowFrame(encoded, length, kKey, sizeof(kKey), received));
+  TEST_ASSERT_EQUAL_STRING("envnode-livingroom", received.deviceId);
+  TEST_ASSERT_EQUAL_UINT32(4097, received.counter);
+  TEST_ASSERT_EQUAL_UINT8(kEspNowMaxReadingsPerFrame, received.readingCount);
+  TEST_ASSERT_EQUAL_FLOAT(28.0f, received.readings[7].temperature);
+  TEST_ASSERT_EQUAL_UINT32(1704067200UL + 7 * 600, received.readings[7].recordedAtEpoch);
+  TEST_ASSERT_TRUE(std::isnan(received.readings[0].batteryVoltage));
+}
+
+// Checks that tampering, a wrong key, truncation, and invalid frames are
+// rejected, and that the encoder refuses frames it cannot represent.
+void test_tampered_and_invalid_frames_are_rejected() {
+  EspNowFrame frame = makeFrame(2);
+  uint8_t encoded[kEspNowMaxFrameBytes];
+  const size_t length = EncodeEspNowFrame(frame, kKey, sizeof(kKey), encoded, sizeof(encoded));
+  EspNowFrame received;
+
+  encoded[12] ^= 0x01;
+  TEST_ASSERT_EQUAL(EspNowDecodeStatus::BadTag,
+                    DecodeEspNowFrame(encoded, length, kKey, sizeof(kKey), received));
+  encoded[12] ^= 0x01;
+  const uint8_t otherKey[] = "another network";
+  TEST_ASSERT_EQUAL(EspNowDecodeStatus::BadTag,
+                    DecodeEspNowFrame(encoded, length, otherKey, sizeof(otherKey), received));
+  TEST_ASSERT_EQUAL(EspNowDecodeStatus::Malformed,
+                    DecodeEspNowFrame(encoded, length - 1, kKey, sizeof(kKey), received));
+  encoded[0] = 'X';
+  TEST_ASSERT_EQUAL(EspNowDecodeStatus::Malformed,
+                    DecodeEspNowFrame(encoded, length, kKey, sizeof(kKey), received));
+
+  frame.readingCount = 0;
+  TEST_ASSERT_EQUAL_UINT32(0, EncodeEspNowFrame(frame, kKey, sizeof(kKey), encoded, sizeof(encoded)));
+  frame = makeFrame(1);
+  frame.deviceId[0] = '\0';
+  TEST_ASSERT_EQUAL_UINT32(0, EncodeEspNowFrame(frame, kKey, sizeof(kKey), encoded, sizeof(encoded)));
+  frame = makeFrame(1);
+  TEST_ASSERT_EQUAL_UINT32(0, EncodeEspNowFrame(frame, kKey, sizeof(kKey), encoded, 40));
+}
+
+// Verifies the counter reserves a flash block before using it, and resumes
+// past every value it may have sent after a power loss.
+void test_frame_counter_reserves_blocks() {
+  FrameCounter counter;
+  ResumeFrameCounter(counter, 0);
+  uint32_t value = 0;
+  TEST_ASSERT_TRUE(TakeFrameCounter(counter, value));
+  TEST_ASSERT_EQUAL_UINT32(1, value);
+  const uint32_t persisted = counter.reservedUntil;
+  TEST_ASSERT_EQUAL_UINT32(1 + kFrameCounterReserveBlock, persisted);
+  for (uint32_t i = 2; i < persisted; ++i) {
+    TEST_ASSERT_FALSE(TakeFrameCounter(counter, value));
+  }
+  TEST_ASSERT_EQUAL_UINT32(persisted - 1, value);
+
+  ResumeFrameCounter(counter, persisted);
+  TEST_ASSERT_TRUE(TakeFrameCounter(counter, value));
+  TEST_ASSERT_EQUAL_UINT32(persisted, value);
+}
+
+// Native test entry point for the Unity runner.
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_hmac_sha256_matches_rfc4231);
+  RUN_TEST(test_frame_round_trip);
+  RUN_TEST(test_tampered_and_invalid_frames_are_rejected);
+  RUN_TEST(test_frame_counter_reserves_blocks);
+  return UNITY_END();
+}
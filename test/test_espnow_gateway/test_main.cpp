@@ -0,0 +1,226 @@
+// Host-side tests for ESP-NOW gateway aggregation in `lib/envnode_core`, driven
+// by the multi-node simulator in `lib/envnode_host`.
+
+#include <unity.h>
+
+#include <cstring>
+#include <espnow_gateway.h>
+#include <espnow_sim.h>
+#include <fake_telemetry_server.h>
+#include <set>
+#include <string>
+
+using envnode::core::AcceptGatewayFrame;
+using envnode::core::DropGatewayRows;
+using envnode::core::EncodeEspNowFrame;
+using envnode::core::EspNowFrame;
+using envnode::core::EspNowGateway;
+using envnode::core::GatewayAccept;
+using envnode::core::GatewayFlushDue;
+using envnode::core::GatewayUploadBackingOff;
+using envnode::core::JsonWriter;
+using envnode::core::kEspNowMaxFrameBytes;
+using envnode::core::kGatewayFirstRetrySeconds;
+using envnode::core::kGatewayMaxNodes;
+using envnode::core::kGatewayRowCapacity;
+using envnode::core::QueueGatewayRow;
+using envnode::core::RecordGatewayUpload;
+using envnode::core::WriteGatewayReadingBatch;
+using envnode::host::AirModel;
+using envnode::host::EspNowSim;
+using envnode::host::FakeTelemetryServer;
+
+namespace {
+
+constexpr char kKey[] = "correct horse battery staple";
+
+// Signs a one-reading frame from `deviceId` with `counter`.
+size_t signFrame(const char* deviceId, uint32_t counter, uint32_t epoch, uint8_t* out) {
+  EspNowFrame frame;
+  strcpy(frame.deviceId, deviceId);
+  frame.counter = counter;
+  frame.readingCount = 1;
+  frame.readings[0].temperature = 21.5f;
+  frame.readings[0].humidity = 40.0f;
+  frame.readings[0].pressure = 1001.0f;
+  frame.readings[0].recordedAtEpoch = epoch;
+  return EncodeEspNowFrame(frame, reinterpret_cast<const uint8_t*>(kKey), sizeof(kKey), out,
+                           kEspNowMaxFrameBytes);
+}
+
+GatewayAccept accept(EspNowGateway& gateway, const uint8_t* frame, size_t length,
+                     uint32_t nowSeconds, uint32_t nowEpoch = 0) {
+  return AcceptGatewayFrame(gateway, frame, length, reinterpret_cast<const uint8_t*>(kKey),
+                            sizeof(kKey), nowSeconds, nowEpoch);
+}
+
+}  // namespace
+
+// Unity fixture hook required by the test runner.
+void setUp() {}
+
+// Unity fixture hook required by the test runner.
+void tearDown() {}
+
+// Verifies per-node replay protection, epoch stamping of unsynchronized
+// readings, and a multi-node bulk insert body.
+void test_gateway_rejects_replays_and_writes_multi_node_batch() {
+  static EspNowGateway gateway;
+  gateway = EspNowGateway();
+  uint8_t first[kEspNowMaxFrameBytes];
+  uint8_t second[kEspNowMaxFrameBytes];
+  const size_t firstLength = signFrame("envnode-a", 7, 1704067200UL, first);
+  const size_t secondLength = signFrame("envnode-b", 7, 0, second);
+
+  TEST_ASSERT_EQUAL(GatewayAccept::Accepted, accept(gateway, first, firstLength, 10));
+  TEST_ASSERT_EQUAL(GatewayAccept::Replayed, accept(gateway, first, firstLength, 11));
+  TEST_ASSERT_EQUAL(GatewayAccept::Accepted,
+                    accept(gateway, second, secondLength, 12, 1704067800UL));
+  TEST_ASSERT_EQUAL(GatewayAccept::Replayed, accept(gateway, second, secondLength, 13));
+  TEST_ASSERT_EQUAL_UINT32(2, gateway.stats.replayed);
+
+  char body[512];
+  JsonWriter writer(body, sizeof(body));
+  TEST_ASSERT_EQUAL_UINT32(2, WriteGatewayReadingBatch(writer, gateway, 10));
+  TEST_ASSERT_EQUAL_STRING(
+      "[{\"device_id\":\"envnode-a\",\"recorded_at\":\"2024-01-01T00:00:00Z\","
+      "\"temperature_c\":21.50,\"humidity_rh\":40.00,\"pressure_hpa\":1001.00},"
+      "{\"device_id\":\"envnode-b\",\"recorded_at\":\"2024-01-01T00:10:00Z\","
+      "\"temperature_c\":21.50,\"humidity_rh\":40.00,\"pressure_hpa\":1001.00}]",
+      writer.Data());
+}
+
+// Ensures forged frames never take a node slot, a full node table refuses new
+// nodes, and flushes fall due by row count or hold time.
+void test_gateway_node_table_and_flush_policy() {
+  static EspNowGateway gateway;
+  gateway = EspNowGateway();
+  uint8_t frame[kEspNowMaxFrameBytes];
+  size_t length = signFrame("envnode-forged", 1, 0, frame);
+  frame[length - 1] ^= 0xFF;
+  TEST_ASSERT_EQUAL(GatewayAccept::BadTag, accept(gateway, frame, length, 0));
+  TEST_ASSERT_EQUAL_UINT8(0, gateway.nodeCount);
+
+  for (size_t i = 0; i < kGatewayMaxNodes; ++i) {
+    const std::string id = "envnode-" + std::to_string(i);
+    length = signFrame(id.c_str(), 1, 0, frame);
+    TEST_ASSERT_EQUAL(GatewayAccept::Accepted, accept(gateway, frame, length, 100 + i));
+  }
+  length = signFrame("envnode-late", 1, 0, frame);
+  TEST_ASSERT_EQUAL(GatewayAccept::NodeTableFull, accept(gateway, frame, length, 200));
+
+  TEST_ASSERT_TRUE(GatewayFlushDue(gateway, kGatewayMaxNodes, 600, 200));
+  TEST_ASSERT_FALSE(GatewayFlushDue(gateway, kGatewayMaxNodes + 1, 600, 200));
+  TEST_ASSERT_TRUE(GatewayFlushDue(gateway, kGatewayMaxNodes + 1, 600, 700));
+  DropGatewayRows(gateway, kGatewayMaxNodes - 1);
+  TEST_ASSERT_EQUAL_UINT8(1, gateway.rowCount);
+  TEST_ASSERT_FALSE(GatewayFlushDue(gateway, 10, 600, 700));
+  TEST_ASSERT_TRUE(GatewayFlushDue(gateway, 10, 600, 715));
+}
+
+// Checks that failed uploads hold off flushes for a doubling, capped delay that
+// a success or a backwards clock ends, and that rows read back from the
+// journal queue under their node without ever dropping older ones.
+void test_gateway_upload_backoff_and_queued_rows() {
+  static EspNowGateway gateway;
+  gateway = EspNowGateway();
+  envnode::core::BatchedReading reading;
+  reading.temperature = 19.0f;
+  TEST_ASSERT_TRUE(QueueGatewayRow(gateway, "envnode-a", reading, 1000));
+  TEST_ASSERT_TRUE(QueueGatewayRow(gateway, "envnode-b", reading, 1000));
+  TEST_ASSERT_TRUE(QueueGatewayRow(gateway, "envnode-a", reading, 1000));
+  TEST_ASSERT_EQUAL_UINT8(2, gateway.nodeCount);
+  TEST_ASSERT_EQUAL_UINT8(0, gateway.rows[2].node);
+  TEST_ASSERT_TRUE(GatewayFlushDue(gateway, 3, 300, 1000));
+
+  RecordGatewayUpload(gateway, false, 60, 1000);
+  TEST_ASSERT_EQUAL_UINT32(kGatewayFirstRetrySeconds, gateway.uploadRetrySeconds);
+  TEST_ASSERT_TRUE(GatewayUploadBackingOff(gateway, 1000 + kGatewayFirstRetrySeconds - 1));
+  TEST_ASSERT_FALSE(GatewayFlushDue(gateway, 3, 300, 1000 + kGatewayFirstRetrySeconds - 1));
+  TEST_ASSERT_TRUE(GatewayFlushDue(gateway, 3, 300, 1000 + kGatewayFirstRetrySeconds));
+  TEST_ASSERT_TRUE(GatewayFlushDue(gateway, 3, 300, 999));
+
+  RecordGatewayUpload(gateway, false, 60, 1100);
+  TEST_ASSERT_EQUAL_UINT32(kGatewayFirstRetrySeconds * 2, gateway.uploadRetrySeconds);
+  RecordGatewayUpload(gateway, false, 60, 1200);
+  RecordGatewayUpload(gateway, false, 60, 1300);
+  TEST_ASSERT_EQUAL_UINT32(60, gateway.uploadRetrySeconds);
+  TEST_ASSERT_TRUE(GatewayUploadBackingOff(gateway, 1359));
+  RecordGatewayUpload(gateway, true, 60, 1310);
+  TEST_ASSERT_FALSE(GatewayUploadBackingOff(gateway, 1310));
+
+  while (gateway.rowCount < kGatewayRowCapacity) {
+    TEST_ASSERT_TRUE(QueueGatewayRow(gateway, "envnode-a", reading, 1400));
+  }
+  TEST_ASSERT_FALSE(QueueGatewayRow(gateway, "envnode-a", reading, 1400));
+  TEST_ASSERT_EQUAL_UINT32(0, gateway.stats.droppedRows);
+  TEST_ASSERT_EQUAL_UINT32(1000, gateway.rows[0].receivedAtSeconds);
+}
+
+// Simulates a day of ten-minute wakes from twelve nodes over a lossy link,
+// with power losses and replayed captures, and checks that every reading
+// reaches the readings table at least once and no replay is accepted.
+void test_multi_node_simulation_over_lossy_air() {
+  AirModel air;
+  air.frameLossPercent = 10;
+  air.ackLossPercent = 5;
+  static EspNowSim sim(kKey, air, 42);
+  FakeTelemetryServer server;
+  for (int i = 0; i < 12; ++i) {
+    sim.AddNode("envnode-room" + std::to_string(i));
+  }
+
+  std::vector<uint8_t> captured;
+  for (uint32_t round = 0; round < 144; ++round) {
+    const uint32_t now = round * 600;
+    sim.RunWakeRound(now, 1704067200UL + now);
+    if (round == 10) {
+      captured = sim.LastFrame(3);
+    }
+    if (round == 50) {
+      sim.PowerLoss(5);
+    }
+    if (round > 10 && round % 20 == 0) {
+      TEST_ASSERT_EQUAL(GatewayAccept::Replayed, sim.Inject(captured, now));
+    }
+    sim.ServiceGateway(server, now, 24, 900);
+  }
+  sim.ServiceGateway(server, 144 * 600, 1, 0);
+
+  const envnode::host::SimTotals& totals = sim.Totals();
+  const EspNowGateway& gateway = sim.Gateway();
+  TEST_ASSERT_EQUAL_UINT32(12 * 144, totals.readingsTaken);
+  TEST_ASSERT_GREATER_THAN(0, totals.framesLost);
+  TEST_ASSERT_GREATER_THAN(0, totals.acksLost);
+  TEST_ASSERT_EQUAL_UINT8(12, gateway.nodeCount);
+  TEST_ASSERT_EQUAL_UINT32(0, gateway.stats.badTag);
+  TEST_ASSERT_EQUAL_UINT32(0, gateway.stats.droppedRows);
+  TEST_ASSERT_EQUAL_UINT32(totals.framesSent - totals.framesLost, gateway.stats.accepted);
+  TEST_ASSERT_EQUAL_UINT32(totals.uploads, server.Requests().size());
+
+  // Lost frames are resent with the next reading, and a lost acknowledgement
+  // resends rows the gateway already has. Only readings still pending on a node
+  // at its power loss or at the end of the run may be missing.
+  std::set<std::string> uniqueRows;
+  for (const envnode::host::RecordedRequest& request : server.Requests()) {
+    size_t start = 0;
+    while ((start = request.body.find("{\"device_id\"", start)) != std::string::npos) {
+      const size_t end = request.body.find(",\"temperature_c\"", start);
+      uniqueRows.insert(request.body.substr(start, end - start));
+      start = end;
+    }
+  }
+  TEST_ASSERT_GREATER_OR_EQUAL(totals.readingsTaken - 13 * 8, uniqueRows.size());
+  TEST_ASSERT_GREATER_OR_EQUAL(uniqueRows.size(), totals.rowsUploaded);
+  TEST_ASSERT_LESS_THAN(20, totals.counterFlashWrites);
+}
+
+// Native test entry point for the Unity runner.
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_gateway_rejects_replays_and_writes_multi_node_batch);
+  RUN_TEST(test_gateway_node_table_and_flush_policy);
+  RUN_TEST(test_gateway_upload_backoff_and_queued_rows);
+  RUN_TEST(test_multi_node_simulation_over_lossy_air);
+  return UNITY_END();
+}
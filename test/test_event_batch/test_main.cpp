@@ -0,0 +1,105 @@
+// Host-side unit tests for the in-memory event batch in `lib/envnode_core`.
+
+#include <unity.h>
+
+#include <cstdio>
+#include <event_batch.h>
+
+using envnode::core::AppendEvent;
+using envnode::core::EventBatch;
+using envnode::core::EventPayload;
+using envnode::core::JsonWriter;
+using envnode::core::ResetEventBatch;
+using envnode::core::WriteEventBatch;
+
+namespace {
+
+// Builds a minimal event whose type doubles as an identifier in assertions.
+EventPayload makeEvent(const char* eventType, const char* severity = "warning") {
+  EventPayload event;
+  event.deviceId = "node-1";
+  event.eventType = eventType;
+  event.severity = severity;
+  return event;
+}
+
+}  // namespace
+
+// Unity fixture hook required by the test runner.
+void setUp() {}
+
+// Unity fixture hook required by the test runner.
+void tearDown() {}
+
+// Verifies that buffered rows come out as one bulk-insert array in order,
+// with per-event timestamps once the clock is trusted.
+void test_batch_emits_rows_as_one_array() {
+  EventBatch batch;
+  ResetEventBatch(batch);
+  EventPayload reset = makeEvent("soft_reset");
+  reset.createdAtEpoch = 1704067200UL;
+  TEST_ASSERT_TRUE(AppendEvent(batch, reset));
+  TEST_ASSERT_TRUE(AppendEvent(batch, makeEvent("recovery_failed", "error")));
+  TEST_ASSERT_EQUAL_UINT16(2, batch.count);
+
+  char buffer[512];
+  JsonWriter writer(buffer, sizeof(buffer));
+  WriteEventBatch(writer, batch);
+  TEST_ASSERT_TRUE(writer.Ok());
+  TEST_ASSERT_EQUAL_STRING(
+      "[{\"device_id\":\"node-1\",\"created_at\":\"2024-01-01T00:00:00Z\","
+      "\"event_type\":\"soft_reset\",\"severity\":\"warning\","
+      "\"action_success\":false},"
+      "{\"device_id\":\"node-1\",\"event_type\":\"recovery_failed\","
+      "\"severity\":\"error\",\"action_success\":false}]",
+      writer.Data());
+}
+
+// Confirms an empty batch serializes as an empty array and resets cleanly.
+void test_empty_and_reset_batches() {
+  EventBatch batch;
+  ResetEventBatch(batch);
+  char buffer[16];
+  JsonWriter writer(buffer, sizeof(buffer));
+  WriteEventBatch(writer, batch);
+  TEST_ASSERT_EQUAL_STRING("[]", writer.Data());
+
+  AppendEvent(batch, makeEvent("reinit"));
+  ResetEventBatch(batch);
+  TEST_ASSERT_EQUAL_UINT16(0, batch.count);
+  TEST_ASSERT_EQUAL_UINT32(0, batch.length);
+}
+
+// Ensures a row that does not fit is rejected whole and counted as dropped.
+void test_full_batch_rejects_rows_without_corrupting_earlier_ones() {
+  EventBatch batch;
+  ResetEventBatch(batch);
+  char message[200];
+  std::snprintf(message, sizeof(message), "%0199d", 0);
+  EventPayload event = makeEvent("i2c_restart");
+  event.message = message;
+
+  size_t accepted = 0;
+  while (AppendEvent(batch, event)) {
+    ++accepted;
+  }
+  TEST_ASSERT_GREATER_THAN(0, accepted);
+  TEST_ASSERT_EQUAL_UINT16(accepted, batch.count);
+  TEST_ASSERT_EQUAL_UINT32(1, batch.dropped);
+
+  static char buffer[envnode::core::kEventBatchCapacityBytes + 8];
+  JsonWriter writer(buffer, sizeof(buffer));
+  WriteEventBatch(writer, batch);
+  TEST_ASSERT_TRUE(writer.Ok());
+  TEST_ASSERT_EQUAL(']', buffer[writer.Length() - 1]);
+  TEST_ASSERT_EQUAL('}', buffer[writer.Length() - 2]);
+}
+
+// Native test entry point for the Unity runner.
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_batch_emits_rows_as_one_array);
+  RUN_TEST(test_empty_and_reset_batches);
+  RUN_TEST(test_full_batch_rejects_rows_without_corrupting_earlier_ones);
+  return UNITY_END();
+}
@@ -0,0 +1,212 @@
+// Host-side unit tests for the gzip request-body encoder in `lib/envnode_core`.
+
+#include <unity.h>
+
+#include <cstdint>
+#include <crc32.h>
+#include <gzip.h>
+#include <string>
+#include <telemetry_payloads.h>
+
+using envnode::core::BatchedReading;
+using envnode::core::Crc32;
+using envnode::core::GzipCompress;
+using envnode::core::GzipScratch;
+using envnode::core::JsonWriter;
+using envnode::core::kReadingRingCapacity;
+using envnode::core::PushReading;
+using envnode::core::ReadingRing;
+using envnode::core::WriteReadingBatch;
+
+namespace {
+
+GzipScratch gScratch;
+
+// Reads deflate bits least-significant first.
+struct BitReader {
+  const uint8_t* data;
+  size_t length;
+  size_t bitPos;
+
+  uint32_t Bits(int count) {
+    uint32_t value = 0;
+    for (int i = 0; i < count; ++i, ++bitPos) {
+      const size_t byte = bitPos / 8;
+      const uint32_t bit = byte < length ? (data[byte] >> (bitPos % 8)) & 1U : 0;
+      value |= bit << i;
+    }
+    return value;
+  }
+
+  // Reads a Huffman code, which is packed most-significant bit first.
+  uint32_t Code(int count) {
+    uint32_t value = 0;
+    for (int i = 0; i < count; ++i) {
+      value = (value << 1) | Bits(1);
+    }
+    return value;
+  }
+};
+
+// Decodes one literal/length symbol from the fixed Huffman table.
+int fixedSymbol(BitReader& reader) {
+  uint32_t code = reader.Code(7);
+  if (code <= 0x17) {
+    return 256 + static_cast<int>(code);
+  }
+  code = (code << 1) | reader.Code(1);
+  if (code >= 0x30 && code <= 0xBF) {
+    return static_cast<int>(code - 0x30);
+  }
+  if (code >= 0xC0 && code <= 0xC7) {
+    return 280 + static_cast<int>(code - 0xC0);
+  }
+  code = (code << 1) | reader.Code(1);
+  return 144 + static_cast<int>(code - 0x190);
+}
+
+// Minimal reference inflater for the single fixed-Huffman block the encoder
+// emits. Returns false on any structural or checksum mismatch.
+bool gunzip(const uint8_t* data, size_t length, std::string& out) {
+  static const uint16_t lengthBase[] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,
+                                        15, 17, 19, 23, 27, 31, 35, 43, 51,  59,
+                                        67, 83, 99, 115, 131, 163, 195, 227, 258};
+  static const uint8_t lengthExtra[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                        2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+  static const uint16_t distanceBase[] = {1,    2,    3,    4,    5,    7,     9,     13,
+                                          17,   25,   33,   49,   65,   97,    129,   193,
+                                          257,  385,  513,  769,  1025, 1537,  2049,  3073,
+                                          4097, 6145, 8193, 12289, 16385, 24577};
+  static const uint8_t distanceExtra[] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                          6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+  if (length < 18 || data[0] != 0x1F || data[1] != 0x8B || data[2] != 8) {
+    return false;
+  }
+  BitReader reader{data + 10, length - 18, 0};
+  if (reader.Bits(1) != 1 || reader.Bits(2) != 1) {
+    return false;
+  }
+
+  out.clear();
+  for (;;) {
+    const int symbol = fixedSymbol(reader);
+    if (symbol < 256) {
+      out.push_back(static_cast<char>(symbol));
+      continue;
+    }
+    if (symbol == 256) {
+      break;
+    }
+    const int lengthCode = symbol - 257;
+    if (lengthCode > 28) {
+      return false;
+    }
+    const size_t matchLength = lengthBase[lengthCode] + reader.Bits(lengthExtra[lengthCode]);
+    const uint32_t distanceCode = reader.Code(5);
+    if (distanceCode > 29) {
+      return false;
+    }
+    const size_t distance = distanceBase[distanceCode] + reader.Bits(distanceExtra[distanceCode]);
+    if (distance > out.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < matchLength; ++i) {
+      out.push_back(out[out.size() - distance]);
+    }
+  }
+
+  const uint8_t* trailer = data + length - 8;
+  uint32_t crc = 0;
+  uint32_t size = 0;
+  for (int i = 3; i >= 0; --i) {
+    crc = (crc << 8) | trailer[i];
+    size = (size << 8) | trailer[4 + i];
+  }
+  return crc == Crc32(reinterpret_cast<const uint8_t*>(out.data()), out.size()) &&
+         size == out.size();
+}
+
+// Builds a full readings batch like the firmware uploads.
+std::string readingBatchJson() {
+  ReadingRing ring;
+  for (size_t i = 0; i < kReadingRingCapacity; ++i) {
+    BatchedReading reading;
+    reading.temperature = 20.0f + i * 0.13f;
+    reading.humidity = 40.0f + i * 0.2f;
+    reading.pressure = 1001.0f + i * 0.05f;
+    reading.batteryVoltage = 3.9f;
+    reading.batteryPercent = 75.0f;
+    reading.recordedAtEpoch = 1704067200UL + i * 600;
+    PushReading(ring, reading);
+  }
+  static char buffer[6144];
+  JsonWriter writer(buffer, sizeof(buffer));
+  WriteReadingBatch(writer, ring, ring.count, "node-1");
+  return std::string(writer.Data(), writer.Length());
+}
+
+}  // namespace
+
+// Unity fixture hook required by the test runner.
+void setUp() {}
+
+// Unity fixture hook required by the test runner.
+void tearDown() {}
+
+// Verifies a real readings batch round-trips and shrinks substantially.
+void test_reading_batch_round_trips_and_compresses() {
+  const std::string json = readingBatchJson();
+  static uint8_t compressed[6144];
+  const size_t length =
+      GzipCompress(reinterpret_cast<const uint8_t*>(json.data()), json.size(), compressed,
+                   sizeof(compressed), gScratch);
+  TEST_ASSERT_GREATER_THAN(0, length);
+  TEST_ASSERT_LESS_THAN(json.size() / 3, length);
+
+  std::string restored;
+  TEST_ASSERT_TRUE(gunzip(compressed, length, restored));
+  TEST_ASSERT_TRUE(restored == json);
+}
+
+// Checks the edge cases: empty input, long runs, and incompressible bytes.
+void test_edge_inputs_round_trip() {
+  static uint8_t compressed[8192];
+  std::string restored;
+
+  size_t length = GzipCompress(nullptr, 0, compressed, sizeof(compressed), gScratch);
+  TEST_ASSERT_EQUAL_UINT32(20, length);
+  TEST_ASSERT_TRUE(gunzip(compressed, length, restored));
+  TEST_ASSERT_EQUAL_UINT32(0, restored.size());
+
+  std::string input(1000, 'a');
+  uint32_t state = 12345;
+  for (int i = 0; i < 2000; ++i) {
+    state = state * 1103515245U + 12345U;
+    input.push_back(static_cast<char>(state >> 24));
+  }
+  input += "tail";
+  length = GzipCompress(reinterpret_cast<const uint8_t*>(input.data()), input.size(),
+                        compressed, sizeof(compressed), gScratch);
+  TEST_ASSERT_GREATER_THAN(0, length);
+  TEST_ASSERT_TRUE(gunzip(compressed, length, restored));
+  TEST_ASSERT_TRUE(restored == input);
+}
+
+// Ensures an output buffer that is too small is reported instead of truncated.
+void test_small_output_buffer_reports_failure() {
+  const std::string json = readingBatchJson();
+  uint8_t compressed[64];
+  TEST_ASSERT_EQUAL_UINT32(
+      0, GzipCompress(reinterpret_cast<const uint8_t*>(json.data()), json.size(), compressed,
+                      sizeof(compressed), gScratch));
+}
+
+// Native test entry point for the Unity runner.
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_reading_batch_round_trips_and_compresses);
+  RUN_TEST(test_edge_inputs_round_trip);
+  RUN_TEST(test_small_output_buffer_reports_failure);
+  return UNITY_END();
+}
@@ -0,0 +1,99 @@
+// Host-side unit tests for the I2C bus speed fallback and counters in
+// `lib/envnode_core`.
+
+#include <unity.h>
+
+#include <i2c_bus.h>
+
+using envnode::core::CurrentI2cClockHz;
+using envnode::core::FinishI2cWake;
+using envnode::core::I2cBusCounters;
+using envnode::core::I2cBusCountersEmpty;
+using envnode::core::I2cSpeedConfig;
+using envnode::core::I2cSpeedState;
+using envnode::core::kI2cFastClockHz;
+using envnode::core::kI2cStandardClockHz;
+using envnode::core::NoteI2cFault;
+using envnode::core::StartI2cWake;
+
+namespace {
+
+// Runs wakes until one starts at 400 kHz again and returns how many ran at
+// 100 kHz first. Gives up after `limit` wakes.
+int slowWakesUntilFast(I2cSpeedState& state, int limit) {
+  for (int wake = 0; wake < limit; ++wake) {
+    if (StartI2cWake(state) == kI2cFastClockHz) {
+      return wake;
+    }
+    FinishI2cWake(state);
+  }
+  return limit;
+}
+
+}  // namespace
+
+// Unity fixture hook required by the test runner.
+void setUp() {}
+
+// Unity fixture hook required by the test runner.
+void tearDown() {}
+
+// Verifies a fresh bus runs fast, drops to 100 kHz on its first fault, and
+// only reports the change once.
+void test_first_fault_falls_back_to_standard_mode() {
+  const I2cSpeedConfig config;
+  I2cSpeedState state;
+  TEST_ASSERT_EQUAL_UINT32(kI2cFastClockHz, StartI2cWake(state));
+
+  TEST_ASSERT_TRUE(NoteI2cFault(state, config));
+  TEST_ASSERT_EQUAL_UINT32(kI2cStandardClockHz, CurrentI2cClockHz(state));
+  TEST_ASSERT_FALSE(NoteI2cFault(state, config));
+  TEST_ASSERT_EQUAL_UINT16(1, state.fallbacks);
+  FinishI2cWake(state);
+
+  TEST_ASSERT_EQUAL(config.minSlowWakes, slowWakesUntilFast(state, 1000));
+}
+
+// Checks that a fast retry that faults again doubles the hold-off up to the
+// cap, and that a clean fast wake resets it.
+void test_repeated_faults_double_the_hold_off() {
+  I2cSpeedConfig config;
+  config.minSlowWakes = 4;
+  config.maxSlowWakes = 16;
+  I2cSpeedState state;
+
+  const int expected[] = {4, 8, 16, 16};
+  StartI2cWake(state);
+  for (int hold : expected) {
+    TEST_ASSERT_TRUE(NoteI2cFault(state, config));
+    FinishI2cWake(state);
+    TEST_ASSERT_EQUAL(hold, slowWakesUntilFast(state, 1000));
+  }
+
+  FinishI2cWake(state);
+  TEST_ASSERT_EQUAL_UINT8(0, state.holdOffWakes);
+  StartI2cWake(state);
+  NoteI2cFault(state, config);
+  FinishI2cWake(state);
+  TEST_ASSERT_EQUAL(4, slowWakesUntilFast(state, 1000));
+}
+
+// Verifies the empty check looks at every counter.
+void test_counters_report_any_activity() {
+  I2cBusCounters counters;
+  TEST_ASSERT_TRUE(I2cBusCountersEmpty(counters));
+  counters.retries = 1;
+  TEST_ASSERT_FALSE(I2cBusCountersEmpty(counters));
+  counters = I2cBusCounters();
+  counters.busClears = 1;
+  TEST_ASSERT_FALSE(I2cBusCountersEmpty(counters));
+}
+
+// Native test entry point for the Unity runner.
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_first_fault_falls_back_to_standard_mode);
+  RUN_TEST(test_repeated_faults_double_the_hold_off);
+  RUN_TEST(test_counters_report_any_activity);
+  return UNITY_END();
+}
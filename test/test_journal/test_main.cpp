@@ -0,0 +1,259 @@
+// Host-side unit tests for the store-and-forward journal codec and segment
+// bookkeeping in `lib/envnode_core`.
+
+#include <unity.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <journal.h>
+
+using envnode::core::AddJournalSegment;
+using envnode::core::AdvanceJournalCursor;
+using envnode::core::AppendEventRowsPayload;
+using envnode::core::ApplyJournalAppend;
+using envnode::core::BatchedReading;
+using envnode::core::Crc32;
+using envnode::core::DecodeGatewayReadingPayload;
+using envnode::core::DecodeJournalRecord;
+using envnode::core::DecodeReadingPayload;
+using envnode::core::EncodeEventRowsPayload;
+using envnode::core::EncodeGatewayReadingPayload;
+using envnode::core::EncodeJournalRecord;
+using envnode::core::EncodeReadingPayload;
+using envnode::core::EventBatch;
+using envnode::core::EventPayload;
+using envnode::core::FindNextJournalRecord;
+using envnode::core::JournalAppendPlan;
+using envnode::core::JournalCursor;
+using envnode::core::JournalDecodeStatus;
+using envnode::core::JournalLayout;
+using envnode::core::JournalPendingBytes;
+using envnode::core::JournalRecordType;
+using envnode::core::JournalRecordView;
+using envnode::core::JournalTotalBytes;
+using envnode::core::kJournalDeviceIdMaxBytes;
+using envnode::core::kJournalGatewayReadingPayloadBytes;
+using envnode::core::kJournalHeaderBytes;
+using envnode::core::kJournalMaxSegments;
+using envnode::core::kJournalReadingPayloadBytes;
+using envnode::core::PlanJournalAppend;
+using envnode::core::ReplayedJournalSegments;
+using envnode::core::ResetEventBatch;
+
+namespace {
+
+constexpr size_t kRecordBytes = kJournalHeaderBytes + kJournalReadingPayloadBytes;
+
+// Encodes a reading record whose temperature doubles as an identifier.
+size_t encodeReading(float temperature, uint8_t* out, size_t capacity) {
+  BatchedReading reading;
+  reading.temperature = temperature;
+  reading.humidity = 40.0f;
+  reading.recordedAtEpoch = 1704067200UL;
+  uint8_t payload[kJournalReadingPayloadBytes];
+  EncodeReadingPayload(reading, payload);
+  return EncodeJournalRecord(JournalRecordType::Reading, payload, sizeof(payload), out,
+                             capacity);
+}
+
+// Plans and applies one append, as the firmware does after writing the record.
+JournalAppendPlan append(JournalLayout& layout, size_t segmentBytes, size_t capBytes) {
+  const JournalAppendPlan plan =
+      PlanJournalAppend(layout, kRecordBytes, segmentBytes, capBytes);
+  ApplyJournalAppend(layout, plan, kRecordBytes);
+  return plan;
+}
+
+}  // namespace
+
+// Unity fixture hook required by the test runner.
+void setUp() {}
+
+// Unity fixture hook required by the test runner.
+void tearDown() {}
+
+// Checks the CRC against the standard check value and incremental use.
+void test_crc32_matches_reference_vector() {
+  const uint8_t text[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+  TEST_ASSERT_EQUAL_HEX32(0xCBF43926UL, Crc32(text, sizeof(text)));
+  TEST_ASSERT_EQUAL_HEX32(0xCBF43926UL, Crc32(text + 4, 5, Crc32(text, 4)));
+}
+
+// Verifies a reading survives encode and decode bit-for-bit, including NaN.
+void test_reading_record_round_trips() {
+  uint8_t buffer[64];
+  const size_t length = encodeReading(21.5f, buffer, sizeof(buffer));
+  TEST_ASSERT_EQUAL_UINT32(kRecordBytes, length);
+
+  JournalRecordView record;
+  TEST_ASSERT_EQUAL(JournalDecodeStatus::Ok, DecodeJournalRecord(buffer, length, record));
+  TEST_ASSERT_EQUAL(JournalRecordType::Reading, record.type);
+  TEST_ASSERT_EQUAL_UINT32(kRecordBytes, record.totalBytes);
+
+  BatchedReading decoded;
+  TEST_ASSERT_TRUE(DecodeReadingPayload(record.payload, record.length, decoded));
+  TEST_ASSERT_EQUAL_FLOAT(21.5f, decoded.temperature);
+  TEST_ASSERT_EQUAL_FLOAT(40.0f, decoded.humidity);
+  TEST_ASSERT_TRUE(std::isnan(decoded.pressure));
+  TEST_ASSERT_EQUAL_UINT32(1704067200UL, decoded.recordedAtEpoch);
+}
+
+// Verifies a gateway row keeps its node's device ID through a record, and that
+// empty or overlong IDs are refused.
+void test_gateway_reading_record_round_trips() {
+  BatchedReading reading;
+  reading.temperature = 18.25f;
+  reading.recordedAtEpoch = 1704067200UL;
+  uint8_t payload[kJournalGatewayReadingPayloadBytes];
+  const size_t payloadBytes = EncodeGatewayReadingPayload(reading, "envnode-kitchen", payload);
+  TEST_ASSERT_EQUAL_UINT32(kJournalReadingPayloadBytes + 15, payloadBytes);
+
+  uint8_t buffer[kJournalHeaderBytes + kJournalGatewayReadingPayloadBytes];
+  const size_t length = EncodeJournalRecord(JournalRecordType::GatewayReading, payload,
+                                            payloadBytes, buffer, sizeof(buffer));
+  JournalRecordView record;
+  TEST_ASSERT_EQUAL(JournalDecodeStatus::Ok, DecodeJournalRecord(buffer, length, record));
+  TEST_ASSERT_EQUAL(JournalRecordType::GatewayReading, record.type);
+
+  BatchedReading decoded;
+  char deviceId[kJournalDeviceIdMaxBytes + 1];
+  TEST_ASSERT_TRUE(DecodeGatewayReadingPayload(record.payload, record.length, decoded, deviceId));
+  TEST_ASSERT_EQUAL_STRING("envnode-kitchen", deviceId);
+  TEST_ASSERT_EQUAL_FLOAT(18.25f, decoded.temperature);
+  TEST_ASSERT_EQUAL_UINT32(1704067200UL, decoded.recordedAtEpoch);
+  TEST_ASSERT_FALSE(DecodeGatewayReadingPayload(record.payload, kJournalReadingPayloadBytes,
+                                                decoded, deviceId));
+
+  char longId[kJournalDeviceIdMaxBytes + 2];
+  memset(longId, 'x', sizeof(longId) - 1);
+  longId[sizeof(longId) - 1] = '\0';
+  TEST_ASSERT_EQUAL_UINT32(0, EncodeGatewayReadingPayload(reading, longId, payload));
+  TEST_ASSERT_EQUAL_UINT32(0, EncodeGatewayReadingPayload(reading, "", payload));
+}
+
+// Ensures torn tails ask for more data and flipped bits are rejected, and that
+// the scanner resynchronizes on the next record.
+void test_partial_and_corrupt_records_are_detected() {
+  uint8_t buffer[128];
+  const size_t first = encodeReading(1.0f, buffer, sizeof(buffer));
+  const size_t second = encodeReading(2.0f, buffer + first, sizeof(buffer) - first);
+
+  JournalRecordView record;
+  TEST_ASSERT_EQUAL(JournalDecodeStatus::NeedMoreData,
+                    DecodeJournalRecord(buffer, first - 1, record));
+  TEST_ASSERT_EQUAL(JournalDecodeStatus::NeedMoreData,
+                    DecodeJournalRecord(buffer, 4, record));
+
+  buffer[kJournalHeaderBytes + 3] ^= 0x40;
+  TEST_ASSERT_EQUAL(JournalDecodeStatus::Corrupt,
+                    DecodeJournalRecord(buffer, first + second, record));
+
+  size_t offset = 0;
+  do {
+    offset += FindNextJournalRecord(buffer + offset, first + second - offset);
+  } while (offset < first + second &&
+           DecodeJournalRecord(buffer + offset, first + second - offset, record) !=
+               JournalDecodeStatus::Ok);
+  TEST_ASSERT_EQUAL_UINT32(first, offset);
+  BatchedReading decoded;
+  DecodeReadingPayload(record.payload, record.length, decoded);
+  TEST_ASSERT_EQUAL_FLOAT(2.0f, decoded.temperature);
+}
+
+// Confirms event rows from two spills merge back into one valid batch.
+void test_event_rows_payload_round_trips_into_batch() {
+  EventPayload event;
+  event.deviceId = "node-1";
+  event.eventType = "reinit";
+  event.severity = "warning";
+  EventBatch source;
+  ResetEventBatch(source);
+  envnode::core::AppendEvent(source, event);
+
+  static uint8_t payload[envnode::core::kJournalMaxPayloadBytes];
+  const size_t length = EncodeEventRowsPayload(source, payload, sizeof(payload));
+  TEST_ASSERT_EQUAL_UINT32(source.length + 2, length);
+
+  EventBatch restored;
+  ResetEventBatch(restored);
+  TEST_ASSERT_TRUE(AppendEventRowsPayload(restored, payload, length));
+  TEST_ASSERT_TRUE(AppendEventRowsPayload(restored, payload, length));
+  TEST_ASSERT_EQUAL_UINT16(2, restored.count);
+  TEST_ASSERT_EQUAL_UINT32(source.length * 2 + 1, restored.length);
+  TEST_ASSERT_EQUAL(',', restored.rows[source.length]);
+  TEST_ASSERT_EQUAL_MEMORY(source.rows, restored.rows + source.length + 1, source.length);
+}
+
+// Verifies rotation at the segment size and oldest-first eviction at the cap,
+// including the unreplayed bytes lost to eviction.
+void test_append_rotates_segments_and_evicts_oldest() {
+  JournalLayout layout;
+  const size_t segmentBytes = kRecordBytes * 2;
+  const size_t capBytes = kRecordBytes * 5;
+
+  TEST_ASSERT_TRUE(append(layout, segmentBytes, capBytes).startNewSegment);
+  TEST_ASSERT_FALSE(append(layout, segmentBytes, capBytes).startNewSegment);
+  TEST_ASSERT_TRUE(append(layout, segmentBytes, capBytes).startNewSegment);
+  append(layout, segmentBytes, capBytes);
+  append(layout, segmentBytes, capBytes);
+  TEST_ASSERT_EQUAL_UINT8(3, layout.count);
+  TEST_ASSERT_EQUAL_UINT32(1, layout.segments[0].sequence);
+  TEST_ASSERT_EQUAL_UINT32(capBytes, JournalTotalBytes(layout));
+
+  const JournalAppendPlan plan = append(layout, segmentBytes, capBytes);
+  TEST_ASSERT_EQUAL_UINT32(1, plan.evictSegments);
+  TEST_ASSERT_EQUAL_UINT32(segmentBytes, plan.evictedUnreplayedBytes);
+  TEST_ASSERT_EQUAL_UINT32(2, layout.segments[0].sequence);
+  TEST_ASSERT_EQUAL_UINT32(kRecordBytes * 4, JournalPendingBytes(layout));
+  TEST_ASSERT_EQUAL_UINT32(2, layout.cursor.sequence);
+  TEST_ASSERT_EQUAL_UINT32(0, layout.cursor.offset);
+}
+
+// Ensures the segment table never overflows even when the byte cap allows it.
+void test_append_respects_segment_table_limit() {
+  JournalLayout layout;
+  for (size_t i = 0; i < kJournalMaxSegments + 4; ++i) {
+    append(layout, kRecordBytes, 1024 * 1024);
+  }
+  TEST_ASSERT_EQUAL_UINT8(kJournalMaxSegments, layout.count);
+  TEST_ASSERT_EQUAL_UINT32(5, layout.segments[0].sequence);
+}
+
+// Checks cursor normalization across segment boundaries and which segments
+// become deletable as replay progresses.
+void test_cursor_advance_marks_replayed_segments() {
+  JournalLayout layout;
+  TEST_ASSERT_TRUE(AddJournalSegment(layout, 7, 100));
+  TEST_ASSERT_TRUE(AddJournalSegment(layout, 5, 100));
+  TEST_ASSERT_TRUE(AddJournalSegment(layout, 6, 100));
+  TEST_ASSERT_EQUAL_UINT32(5, layout.segments[0].sequence);
+  TEST_ASSERT_EQUAL_UINT32(300, JournalPendingBytes(layout));
+
+  AdvanceJournalCursor(layout, JournalCursor{5, 40});
+  TEST_ASSERT_EQUAL_UINT32(260, JournalPendingBytes(layout));
+  TEST_ASSERT_EQUAL_UINT32(0, ReplayedJournalSegments(layout));
+
+  AdvanceJournalCursor(layout, JournalCursor{6, 100});
+  TEST_ASSERT_EQUAL_UINT32(7, layout.cursor.sequence);
+  TEST_ASSERT_EQUAL_UINT32(0, layout.cursor.offset);
+  TEST_ASSERT_EQUAL_UINT32(2, ReplayedJournalSegments(layout));
+
+  AdvanceJournalCursor(layout, JournalCursor{7, 100});
+  TEST_ASSERT_EQUAL_UINT32(7, layout.cursor.sequence);
+  TEST_ASSERT_EQUAL_UINT32(0, JournalPendingBytes(layout));
+}
+
+// Native test entry point for the Unity runner.
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_crc32_matches_reference_vector);
+  RUN_TEST(test_reading_record_round_trips);
+  RUN_TEST(test_gateway_reading_record_round_trips);
+  RUN_TEST(test_partial_and_corrupt_records_are_detected);
+  RUN_TEST(test_event_rows_payload_round_trips_into_batch);
+  RUN_TEST(test_append_rotates_segments_and_evicts_oldest);
+  RUN_TEST(test_append_respects_segment_table_limit);
+  RUN_TEST(test_cursor_advance_marks_replayed_segments);
+  return UNITY_END();
+}
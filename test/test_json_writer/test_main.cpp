@@ -0,0 +1,138 @@
+// Host-side unit tests for the bounded JSON writer in `lib/envnode_core`.
+
+#include <unity.h>
+
+#include <cmath>
+#include <cstring>
+#include <json_writer.h>
+
+using envnode::core::JsonWriter;
+using envnode::core::kJsonWriterMaxDepth;
+
+// Unity fixture hook required by the test runner.
+void setUp() {}
+
+// Unity fixture hook required by the test runner.
+void tearDown() {}
+
+// Verifies automatic comma placement across nested objects and arrays.
+void test_writer_separates_members_and_elements() {
+  char buffer[128];
+  JsonWriter writer(buffer, sizeof(buffer));
+  writer.BeginObject();
+  writer.Field("a", "x");
+  writer.Key("list");
+  writer.BeginArray();
+  writer.Int(1);
+  writer.Int(-2);
+  writer.BeginObject();
+  writer.EndObject();
+  writer.EndArray();
+  writer.BoolField("ok", true);
+  writer.Key("none");
+  writer.Null();
+  writer.EndObject();
+
+  TEST_ASSERT_TRUE(writer.Ok());
+  TEST_ASSERT_TRUE(writer.Complete());
+  TEST_ASSERT_EQUAL_STRING("{\"a\":\"x\",\"list\":[1,-2,{}],\"ok\":true,\"none\":null}",
+                           writer.Data());
+  TEST_ASSERT_EQUAL_UINT32(std::strlen(buffer), writer.Length());
+}
+
+// Checks fixed-precision rounding, negative values, and NaN handling.
+void test_writer_formats_floats_with_fixed_precision() {
+  char buffer[128];
+  JsonWriter writer(buffer, sizeof(buffer));
+  writer.BeginArray();
+  writer.Float(21.5f, 2);
+  writer.Float(-0.004f, 2);
+  writer.Float(-3.14159f, 3);
+  writer.Float(1012.349f, 1);
+  writer.Float(79.6f, 0);
+  writer.Float(NAN, 2);
+  writer.Float(INFINITY, 2);
+  writer.EndArray();
+
+  TEST_ASSERT_TRUE(writer.Ok());
+  TEST_ASSERT_EQUAL_STRING("[21.50,0.00,-3.142,1012.3,80,null,null]", writer.Data());
+}
+
+// Confirms string escaping matches `JsonEscape` for quotes and control bytes.
+void test_writer_escapes_strings() {
+  char buffer[64];
+  JsonWriter writer(buffer, sizeof(buffer));
+  writer.String("a\"b\\c\n\t\x01");
+
+  TEST_ASSERT_EQUAL_STRING("\"a\\\"b\\\\c\\n\\t\\u0001\"", writer.Data());
+}
+
+// Ensures running out of space is reported and never writes past the buffer.
+void test_writer_reports_overflow_without_overrunning() {
+  char buffer[16];
+  std::memset(buffer, '#', sizeof(buffer));
+  JsonWriter writer(buffer, 10);
+  writer.BeginObject();
+  writer.Field("message", "too long for the buffer");
+  writer.EndObject();
+
+  TEST_ASSERT_TRUE(writer.Overflowed());
+  TEST_ASSERT_FALSE(writer.Ok());
+  TEST_ASSERT_EQUAL_UINT32(9, writer.Length());
+  TEST_ASSERT_EQUAL('\0', buffer[9]);
+  TEST_ASSERT_EQUAL('#', buffer[10]);
+
+  writer.Reset();
+  writer.Int(7);
+  TEST_ASSERT_TRUE(writer.Ok());
+  TEST_ASSERT_EQUAL_STRING("7", writer.Data());
+}
+
+// Flags misnesting and nesting deeper than the tracked limit.
+void test_writer_flags_invalid_structure() {
+  char buffer[64];
+  JsonWriter writer(buffer, sizeof(buffer));
+  writer.EndObject();
+  TEST_ASSERT_FALSE(writer.Ok());
+
+  writer.Reset();
+  writer.Key("orphan");
+  TEST_ASSERT_FALSE(writer.Ok());
+
+  writer.Reset();
+  for (size_t depth = 0; depth <= kJsonWriterMaxDepth; ++depth) {
+    writer.BeginArray();
+  }
+  TEST_ASSERT_FALSE(writer.Ok());
+
+  writer.Reset();
+  writer.BeginObject();
+  TEST_ASSERT_TRUE(writer.Ok());
+  TEST_ASSERT_FALSE(writer.Complete());
+}
+
+// Writes pre-serialized values verbatim and substitutes `null` for empty ones.
+void test_writer_embeds_raw_json() {
+  char buffer[64];
+  JsonWriter writer(buffer, sizeof(buffer));
+  writer.BeginObject();
+  writer.RawField("meta", "{\"k\":1}");
+  writer.RawField("empty", "");
+  writer.UIntField("big", 4294967295ULL);
+  writer.EndObject();
+
+  TEST_ASSERT_EQUAL_STRING("{\"meta\":{\"k\":1},\"empty\":null,\"big\":4294967295}",
+                           writer.Data());
+}
+
+// Native test entry point for the Unity runner.
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_writer_separates_members_and_elements);
+  RUN_TEST(test_writer_formats_floats_with_fixed_precision);
+  RUN_TEST(test_writer_escapes_strings);
+  RUN_TEST(test_writer_reports_overflow_without_overrunning);
+  RUN_TEST(test_writer_flags_invalid_structure);
+  RUN_TEST(test_writer_embeds_raw_json);
+  return UNITY_END();
+}
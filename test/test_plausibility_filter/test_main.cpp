@@ -0,0 +1,319 @@
+// Host-side unit tests for the rolling-window plausibility filter in
+// `lib/envnode_core`, including a replay of indoor traces that compares its
+// false-reject rate with the fixed jump thresholds it replaces.
+
+#include <unity.h>
+
+#include <cstdio>
+#include <plausibility_filter.h>
+
+using envnode::core::FilterReading;
+using envnode::core::JudgeReading;
+using envnode::core::LogicReadings;
+using envnode::core::PlausibilityConfig;
+using envnode::core::PlausibilityHistory;
+using envnode::core::PlausibilityVerdict;
+using envnode::core::PlausibleReadings;
+
+namespace {
+
+// Longest trace the replay helpers accept.
+constexpr size_t kMaxTraceLength = 160;
+
+// One trace sample at the default 10-minute cadence. `glitch` marks a sample
+// the sensor got wrong, which a filter should reject.
+struct TraceSample {
+  LogicReadings readings;
+  bool glitch = false;
+};
+
+// A named sequence of samples.
+struct Trace {
+  const char* name = "";
+  TraceSample samples[kMaxTraceLength];
+  size_t length = 0;
+};
+
+// Deterministic measurement noise in [-amplitude, amplitude].
+float noise(uint32_t& seed, float amplitude) {
+  seed = seed * 1664525U + 1013904223U;
+  return amplitude * ((static_cast<float>(seed >> 8) / 8388608.0f) - 1.0f);
+}
+
+void append(Trace& trace, uint32_t& seed, float temperature, float humidity, float pressure,
+            bool glitch = false) {
+  TraceSample& sample = trace.samples[trace.length++];
+  sample.readings.temperature = temperature + noise(seed, 0.1f);
+  sample.readings.humidity = humidity + noise(seed, 0.5f);
+  sample.readings.pressure = pressure + noise(seed, 0.1f);
+  sample.glitch = glitch;
+}
+
+// A sensor near a window that is opened on a winter day for an hour: the air
+// around it drops 8 °C within one sample and recovers over half an hour.
+Trace windowTrace() {
+  Trace trace;
+  trace.name = "window";
+  uint32_t seed = 1;
+  for (int i = 0; i < 24; ++i) {
+    append(trace, seed, 21.5f, 42.0f, 1013.0f);
+  }
+  for (int i = 0; i < 6; ++i) {
+    append(trace, seed, 13.0f, 58.0f, 1013.0f);
+  }
+  for (int i = 1; i <= 3; ++i) {
+    append(trace, seed, 13.0f + i * 2.8f, 58.0f - i * 5.3f, 1013.0f);
+  }
+  for (int i = 0; i < 24; ++i) {
+    append(trace, seed, 21.4f, 42.0f, 1013.0f);
+  }
+  return trace;
+}
+
+// A bathroom node: a shower raises humidity by 38 %RH within one sample, and
+// it decays over an hour.
+Trace showerTrace() {
+  Trace trace;
+  trace.name = "shower";
+  uint32_t seed = 2;
+  for (int i = 0; i < 24; ++i) {
+    append(trace, seed, 22.0f, 50.0f, 1008.0f);
+  }
+  for (int i = 0; i < 3; ++i) {
+    append(trace, seed, 24.5f, 88.0f, 1008.0f);
+  }
+  for (int i = 1; i <= 6; ++i) {
+    append(trace, seed, 24.5f - i * 0.4f, 88.0f - i * 6.3f, 1008.0f);
+  }
+  for (int i = 0; i < 24; ++i) {
+    append(trace, seed, 22.0f, 50.0f, 1008.0f);
+  }
+  return trace;
+}
+
+// A node in the path of a forced-air vent: the heating cycles on and off
+// every 40 minutes and the node sees 19 °C or 25.5 °C depending on the phase.
+Trace hvacTrace() {
+  Trace trace;
+  trace.name = "hvac";
+  uint32_t seed = 3;
+  for (int i = 0; i < 18; ++i) {
+    append(trace, seed, 19.5f, 45.0f, 1011.0f);
+  }
+  for (int cycle = 0; cycle < 10; ++cycle) {
+    for (int i = 0; i < 2; ++i) {
+      append(trace, seed, 25.5f, 36.0f, 1011.0f);
+    }
+    for (int i = 0; i < 2; ++i) {
+      append(trace, seed, 19.0f, 45.0f, 1011.0f);
+    }
+  }
+  return trace;
+}
+
+// A quiet room over a falling barometer, with single-sample sensor glitches
+// on each channel that both filters must reject.
+Trace glitchTrace() {
+  Trace trace;
+  trace.name = "glitches";
+  uint32_t seed = 4;
+  for (int i = 0; i < 72; ++i) {
+    const float pressure = 1016.0f - i * 0.15f;
+    if (i == 20) {
+      append(trace, seed, 33.0f, 40.0f, pressure, true);
+    } else if (i == 35) {
+      append(trace, seed, 21.0f, 99.0f, pressure, true);
+    } else if (i == 50) {
+      append(trace, seed, 21.0f, 40.0f, pressure - 24.0f, true);
+    } else if (i == 60) {
+      append(trace, seed, 9.0f, 12.0f, pressure, true);
+    } else {
+      append(trace, seed, 21.0f, 40.0f, pressure);
+    }
+  }
+  return trace;
+}
+
+// Rejected genuine samples and accepted glitches over one replay.
+struct ReplayResult {
+  int genuine = 0;
+  int falseRejects = 0;
+  int glitches = 0;
+  int missedGlitches = 0;
+};
+
+void count(ReplayResult& result, const TraceSample& sample, bool accepted) {
+  if (sample.glitch) {
+    ++result.glitches;
+    result.missedGlitches += accepted ? 1 : 0;
+  } else {
+    ++result.genuine;
+    result.falseRejects += accepted ? 0 : 1;
+  }
+}
+
+// Replays `trace` through the old rule: fixed thresholds against the last
+// accepted reading.
+ReplayResult replayFixedThresholds(const Trace& trace) {
+  ReplayResult result;
+  LogicReadings last;
+  bool hasLast = false;
+  for (size_t i = 0; i < trace.length; ++i) {
+    const TraceSample& sample = trace.samples[i];
+    const bool accepted = PlausibleReadings(sample.readings, hasLast ? &last : nullptr);
+    if (accepted) {
+      last = sample.readings;
+      hasLast = true;
+    }
+    count(result, sample, accepted);
+  }
+  return result;
+}
+
+// Replays `trace` through the rolling-window filter.
+ReplayResult replayFilter(const Trace& trace, const PlausibilityConfig& config) {
+  ReplayResult result;
+  PlausibilityHistory history;
+  for (size_t i = 0; i < trace.length; ++i) {
+    const TraceSample& sample = trace.samples[i];
+    const PlausibilityVerdict verdict = FilterReading(history, config, sample.readings);
+    count(result, sample, verdict == PlausibilityVerdict::Accepted ||
+                              verdict == PlausibilityVerdict::Rebaselined);
+  }
+  return result;
+}
+
+// Prints the before and after false-reject rates for one trace.
+void report(const Trace& trace, const ReplayResult& before, const ReplayResult& after) {
+  char line[160];
+  std::snprintf(line, sizeof(line),
+                "%-9s false rejects %2d/%d -> %2d/%d, missed glitches %d/%d -> %d/%d", trace.name,
+                before.falseRejects, before.genuine, after.falseRejects, after.genuine,
+                before.missedGlitches, before.glitches, after.missedGlitches, after.glitches);
+  TEST_MESSAGE(line);
+}
+
+// Fills a history with `count` copies of `readings`.
+PlausibilityHistory steadyHistory(const LogicReadings& readings, int count) {
+  const PlausibilityConfig config;
+  PlausibilityHistory history;
+  for (int i = 0; i < count; ++i) {
+    FilterReading(history, config, readings);
+  }
+  return history;
+}
+
+}  // namespace
+
+// Unity fixture hook required by the test runner.
+void setUp() {}
+
+// Unity fixture hook required by the test runner.
+void tearDown() {}
+
+// Verifies the absolute limits still apply and that an empty window accepts
+// any in-range reading.
+void test_absolute_limits_and_empty_window() {
+  const PlausibilityConfig config;
+  PlausibilityHistory history;
+  TEST_ASSERT_EQUAL(PlausibilityVerdict::Accepted,
+                    JudgeReading(history, config, LogicReadings{21.0f, 40.0f, 1000.0f}));
+  TEST_ASSERT_EQUAL(PlausibilityVerdict::OutOfRange,
+                    JudgeReading(history, config, LogicReadings{21.0f, 120.0f, 1000.0f}));
+  TEST_ASSERT_EQUAL(PlausibilityVerdict::OutOfRange,
+                    FilterReading(history, config, LogicReadings{}));
+  TEST_ASSERT_EQUAL_UINT8(0, history.count);
+}
+
+// Checks that a steady window holds each channel to its floor around the
+// median, and that a single outlier does not move the window.
+void test_steady_window_uses_floor_bounds() {
+  const PlausibilityConfig config;
+  PlausibilityHistory history = steadyHistory(LogicReadings{21.0f, 40.0f, 1000.0f}, 9);
+  TEST_ASSERT_EQUAL(PlausibilityVerdict::Accepted,
+                    JudgeReading(history, config, LogicReadings{25.9f, 54.0f, 1009.0f}));
+  TEST_ASSERT_EQUAL(PlausibilityVerdict::Outlier,
+                    JudgeReading(history, config, LogicReadings{26.5f, 40.0f, 1000.0f}));
+  TEST_ASSERT_EQUAL(PlausibilityVerdict::Outlier,
+                    FilterReading(history, config, LogicReadings{21.0f, 40.0f, 1011.0f}));
+  TEST_ASSERT_EQUAL_UINT8(9, history.count);
+  TEST_ASSERT_EQUAL_UINT8(1, history.candidateCount);
+
+  TEST_ASSERT_EQUAL(PlausibilityVerdict::Accepted,
+                    FilterReading(history, config, LogicReadings{21.1f, 40.0f, 1000.0f}));
+  TEST_ASSERT_EQUAL_UINT8(0, history.candidateCount);
+}
+
+// Verifies a channel with a wide spread widens its own bounds from the MAD,
+// up to the ceiling, without widening the others.
+void test_volatile_channel_widens_bounds() {
+  const PlausibilityConfig config;
+  PlausibilityHistory history;
+  for (int i = 0; i < 9; ++i) {
+    FilterReading(history, config, LogicReadings{17.0f + i, 40.0f, 1000.0f});
+  }
+  TEST_ASSERT_EQUAL(PlausibilityVerdict::Accepted,
+                    JudgeReading(history, config, LogicReadings{32.5f, 40.0f, 1000.0f}));
+  TEST_ASSERT_EQUAL(PlausibilityVerdict::Outlier,
+                    JudgeReading(history, config, LogicReadings{33.5f, 40.0f, 1000.0f}));
+  TEST_ASSERT_EQUAL(PlausibilityVerdict::Outlier,
+                    JudgeReading(history, config, LogicReadings{21.0f, 40.0f, 1011.0f}));
+}
+
+// Checks that consecutive outliers that agree re-baseline the window, that
+// outliers that disagree restart the run, and that both levels stay
+// acceptable afterwards.
+void test_agreeing_outliers_rebaseline() {
+  const PlausibilityConfig config;
+  PlausibilityHistory history = steadyHistory(LogicReadings{21.0f, 40.0f, 1000.0f}, 9);
+
+  TEST_ASSERT_EQUAL(PlausibilityVerdict::Outlier,
+                    FilterReading(history, config, LogicReadings{13.0f, 58.0f, 1000.0f}));
+  TEST_ASSERT_EQUAL(PlausibilityVerdict::Outlier,
+                    FilterReading(history, config, LogicReadings{33.0f, 40.0f, 1000.0f}));
+  TEST_ASSERT_EQUAL_UINT8(1, history.candidateCount);
+
+  TEST_ASSERT_EQUAL(PlausibilityVerdict::Rebaselined,
+                    FilterReading(history, config, LogicReadings{32.5f, 41.0f, 1000.0f}));
+  TEST_ASSERT_EQUAL_UINT8(0, history.candidateCount);
+  TEST_ASSERT_EQUAL(PlausibilityVerdict::Accepted,
+                    JudgeReading(history, config, LogicReadings{31.0f, 42.0f, 1000.0f}));
+  TEST_ASSERT_EQUAL(PlausibilityVerdict::Accepted,
+                    JudgeReading(history, config, LogicReadings{21.0f, 40.0f, 1000.0f}));
+  TEST_ASSERT_EQUAL(PlausibilityVerdict::Outlier,
+                    JudgeReading(history, config, LogicReadings{44.0f, 40.0f, 1000.0f}));
+}
+
+// Replays indoor traces through the old fixed thresholds and the new filter.
+// The filter must reject fewer genuine readings on every trace, stay within
+// the re-baselining delay per real step, and still reject every glitch.
+void test_trace_replay_lowers_false_rejects() {
+  const PlausibilityConfig config;
+  const Trace traces[] = {windowTrace(), showerTrace(), hvacTrace(), glitchTrace()};
+  int beforeTotal = 0;
+  int afterTotal = 0;
+  for (const Trace& trace : traces) {
+    const ReplayResult before = replayFixedThresholds(trace);
+    const ReplayResult after = replayFilter(trace, config);
+    report(trace, before, after);
+    TEST_ASSERT_LESS_OR_EQUAL(before.falseRejects, after.falseRejects);
+    TEST_ASSERT_EQUAL(0, after.missedGlitches);
+    beforeTotal += before.falseRejects;
+    afterTotal += after.falseRejects;
+  }
+  TEST_ASSERT_LESS_THAN(beforeTotal / 3, afterTotal);
+
+  const ReplayResult window = replayFilter(traces[0], config);
+  TEST_ASSERT_LESS_OR_EQUAL(2 * (config.rebaselineAfter - 1), window.falseRejects);
+}
+
+// Native test entry point for the Unity runner.
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_absolute_limits_and_empty_window);
+  RUN_TEST(test_steady_window_uses_floor_bounds);
+  RUN_TEST(test_volatile_channel_widens_bounds);
+  RUN_TEST(test_agreeing_outliers_rebaseline);
+  RUN_TEST(test_trace_replay_lowers_false_rejects);
+  return UNITY_END();
+}
@@ -0,0 +1,98 @@
+// Host-side unit tests for the retained reading ring and timestamp helpers in
+// `lib/envnode_core`.
+
+#include <unity.h>
+
+#include <cstdint>
+#include <reading_batch.h>
+
+using envnode::core::BatchedReading;
+using envnode::core::DropOldestReadings;
+using envnode::core::FormatIso8601Utc;
+using envnode::core::kReadingRingCapacity;
+using envnode::core::ParseHttpDate;
+using envnode::core::PushReading;
+using envnode::core::ReadingAt;
+using envnode::core::ReadingRing;
+using envnode::core::ResetReadingRing;
+using envnode::core::ShouldFlushReadings;
+
+namespace {
+
+// Builds a reading whose temperature doubles as an identifier in assertions.
+BatchedReading makeReading(float temperature, uint32_t epoch = 0) {
+  BatchedReading reading;
+  reading.temperature = temperature;
+  reading.humidity = 40.0f;
+  reading.pressure = 1000.0f;
+  reading.recordedAtEpoch = epoch;
+  return reading;
+}
+
+}  // namespace
+
+// Unity fixture hook required by the test runner.
+void setUp() {}
+
+// Unity fixture hook required by the test runner.
+void tearDown() {}
+
+// Verifies FIFO order and the flush threshold while the ring is filling.
+void test_ring_keeps_fifo_order_and_reports_flush_threshold() {
+  ReadingRing ring;
+  for (int i = 0; i < 5; ++i) {
+    TEST_ASSERT_TRUE(PushReading(ring, makeReading(static_cast<float>(i))));
+  }
+
+  TEST_ASSERT_EQUAL_UINT8(5, ring.count);
+  TEST_ASSERT_FALSE(ShouldFlushReadings(ring, 6));
+  TEST_ASSERT_TRUE(ShouldFlushReadings(ring, 5));
+  TEST_ASSERT_EQUAL_FLOAT(0.0f, ReadingAt(ring, 0)->temperature);
+  TEST_ASSERT_EQUAL_FLOAT(4.0f, ReadingAt(ring, 4)->temperature);
+  TEST_ASSERT_NULL(ReadingAt(ring, 5));
+
+  DropOldestReadings(ring, 2);
+  TEST_ASSERT_EQUAL_UINT8(3, ring.count);
+  TEST_ASSERT_EQUAL_FLOAT(2.0f, ReadingAt(ring, 0)->temperature);
+}
+
+// Confirms that a full ring overwrites the oldest reading and counts the drop.
+void test_ring_overwrites_oldest_when_full() {
+  ReadingRing ring;
+  ResetReadingRing(ring);
+  for (size_t i = 0; i < kReadingRingCapacity; ++i) {
+    PushReading(ring, makeReading(static_cast<float>(i)));
+  }
+
+  TEST_ASSERT_FALSE(PushReading(ring, makeReading(100.0f)));
+  TEST_ASSERT_EQUAL_UINT8(kReadingRingCapacity, ring.count);
+  TEST_ASSERT_EQUAL_UINT32(1, ring.dropped);
+  TEST_ASSERT_EQUAL_FLOAT(1.0f, ReadingAt(ring, 0)->temperature);
+  TEST_ASSERT_EQUAL_FLOAT(100.0f,
+                          ReadingAt(ring, kReadingRingCapacity - 1)->temperature);
+  TEST_ASSERT_TRUE(ShouldFlushReadings(ring, kReadingRingCapacity + 10));
+}
+
+// Round-trips a known HTTP date through the parser and ISO formatter.
+void test_http_date_parses_and_formats_as_iso8601() {
+  uint32_t epoch = 0;
+  TEST_ASSERT_TRUE(ParseHttpDate("Sun, 06 Nov 1994 08:49:37 GMT", epoch));
+  TEST_ASSERT_EQUAL_UINT32(784111777UL, epoch);
+
+  TEST_ASSERT_TRUE(ParseHttpDate("Thu, 29 Feb 2024 23:59:59 GMT", epoch));
+  char buffer[24];
+  FormatIso8601Utc(epoch, buffer, sizeof(buffer));
+  TEST_ASSERT_EQUAL_STRING("2024-02-29T23:59:59Z", buffer);
+
+  TEST_ASSERT_FALSE(ParseHttpDate("Sunday, 06-Nov-94 08:49:37 GMT", epoch));
+  TEST_ASSERT_FALSE(ParseHttpDate("Sun, 06 Foo 1994 08:49:37 GMT", epoch));
+}
+
+// Native test entry point for the Unity runner.
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_ring_keeps_fifo_order_and_reports_flush_threshold);
+  RUN_TEST(test_ring_overwrites_oldest_when_full);
+  RUN_TEST(test_http_date_parses_and_formats_as_iso8601);
+  return UNITY_END();
+}
@@ -0,0 +1,144 @@
+// Host-side unit tests for the learned sensor recovery ladder in
+// `lib/envnode_core`, driven by simulated nodes.
+
+#include <unity.h>
+
+#include <recovery_ladder.h>
+
+using envnode::core::kRecoveryStageCount;
+using envnode::core::PlanRecovery;
+using envnode::core::RecordRecoveryStage;
+using envnode::core::RecoveryLadder;
+using envnode::core::RecoveryLadderConfig;
+using envnode::core::RecoveryStage;
+using envnode::core::RecoveryStageName;
+
+namespace {
+
+// Runs one recovery on a node that only the stage `cure` can fix, and returns
+// how many stages ran before it, or `kRecoveryStageCount` if it was skipped.
+size_t runRecovery(RecoveryLadder& ladder, const RecoveryLadderConfig& config, RecoveryStage cure) {
+  RecoveryStage order[kRecoveryStageCount];
+  const size_t count = PlanRecovery(ladder, order);
+  for (size_t i = 0; i < count; ++i) {
+    const bool fixed = order[i] == cure;
+    RecordRecoveryStage(ladder, config, order[i], fixed);
+    if (fixed) {
+      return i;
+    }
+  }
+  return kRecoveryStageCount;
+}
+
+}  // namespace
+
+// Unity fixture hook required by the test runner.
+void setUp() {}
+
+// Unity fixture hook required by the test runner.
+void tearDown() {}
+
+// Verifies a fresh ladder tries every stage cheapest first.
+void test_fresh_ladder_runs_in_cost_order() {
+  RecoveryLadder ladder;
+  RecoveryStage order[kRecoveryStageCount];
+  TEST_ASSERT_EQUAL(3, PlanRecovery(ladder, order));
+  TEST_ASSERT_EQUAL(RecoveryStage::SoftReset, order[0]);
+  TEST_ASSERT_EQUAL(RecoveryStage::Reinit, order[1]);
+  TEST_ASSERT_EQUAL(RecoveryStage::I2cRestart, order[2]);
+  TEST_ASSERT_EQUAL_STRING("i2c_restart", RecoveryStageName(RecoveryStage::I2cRestart));
+}
+
+// Checks that a node only the I2C restart fixes starts there from the second
+// run on, so the stages that never help stop costing time.
+void test_node_learns_to_start_at_the_stage_that_works() {
+  const RecoveryLadderConfig config;
+  RecoveryLadder ladder;
+  TEST_ASSERT_EQUAL(2, runRecovery(ladder, config, RecoveryStage::I2cRestart));
+  for (int run = 0; run < 20; ++run) {
+    TEST_ASSERT_EQUAL(0, runRecovery(ladder, config, RecoveryStage::I2cRestart));
+  }
+
+  TEST_ASSERT_EQUAL_UINT8(1, ladder.stages[static_cast<size_t>(RecoveryStage::SoftReset)].attempts);
+  TEST_ASSERT_EQUAL_UINT8(1, ladder.stages[static_cast<size_t>(RecoveryStage::Reinit)].attempts);
+}
+
+// Verifies a stage that keeps failing sits out a doubling number of runs,
+// capped, and that one fix clears its backoff.
+void test_failing_stage_backs_off_and_recovers() {
+  RecoveryLadderConfig config;
+  config.freeFailures = 2;
+  config.maxSkipRuns = 4;
+  RecoveryLadder ladder;
+  const auto& stats = ladder.stages[static_cast<size_t>(RecoveryStage::SoftReset)];
+
+  RecordRecoveryStage(ladder, config, RecoveryStage::SoftReset, false);
+  TEST_ASSERT_EQUAL_UINT8(0, stats.skipRunsLeft);
+  RecordRecoveryStage(ladder, config, RecoveryStage::SoftReset, false);
+  TEST_ASSERT_EQUAL_UINT8(1, stats.skipRunsLeft);
+  RecordRecoveryStage(ladder, config, RecoveryStage::SoftReset, false);
+  TEST_ASSERT_EQUAL_UINT8(2, stats.skipRunsLeft);
+  RecordRecoveryStage(ladder, config, RecoveryStage::SoftReset, false);
+  RecordRecoveryStage(ladder, config, RecoveryStage::SoftReset, false);
+  TEST_ASSERT_EQUAL_UINT8(4, stats.skipRunsLeft);
+
+  RecoveryStage order[kRecoveryStageCount];
+  for (int run = 0; run < 4; ++run) {
+    const size_t count = PlanRecovery(ladder, order);
+    for (size_t i = 0; i < count; ++i) {
+      TEST_ASSERT_TRUE(order[i] != RecoveryStage::SoftReset);
+    }
+  }
+  TEST_ASSERT_EQUAL(3, PlanRecovery(ladder, order));
+
+  RecordRecoveryStage(ladder, config, RecoveryStage::SoftReset, true);
+  TEST_ASSERT_EQUAL_UINT8(0, stats.skipRunsLeft);
+  TEST_ASSERT_EQUAL_UINT8(0, stats.consecutiveFailures);
+  TEST_ASSERT_EQUAL(3, PlanRecovery(ladder, order));
+  TEST_ASSERT_EQUAL(RecoveryStage::SoftReset, order[0]);
+}
+
+// Checks that a run with every stage in backoff still tries the I2C restart.
+void test_all_stages_in_backoff_still_restart_the_bus() {
+  RecoveryLadderConfig config;
+  config.freeFailures = 1;
+  RecoveryLadder ladder;
+  for (size_t i = 0; i < kRecoveryStageCount; ++i) {
+    RecordRecoveryStage(ladder, config, static_cast<RecoveryStage>(i), false);
+  }
+  RecoveryStage order[kRecoveryStageCount];
+  TEST_ASSERT_EQUAL(1, PlanRecovery(ladder, order));
+  TEST_ASSERT_EQUAL(RecoveryStage::I2cRestart, order[0]);
+}
+
+// Verifies old outcomes fade: counts are halved at the history limit, so a
+// node whose fault changes character reorders within a few runs.
+void test_history_is_halved_at_the_limit() {
+  RecoveryLadderConfig config;
+  config.historyLimit = 8;
+  RecoveryLadder ladder;
+  for (int run = 0; run < 20; ++run) {
+    RecordRecoveryStage(ladder, config, RecoveryStage::Reinit, true);
+  }
+  const auto& stats = ladder.stages[static_cast<size_t>(RecoveryStage::Reinit)];
+  TEST_ASSERT_TRUE(stats.attempts <= 8);
+  TEST_ASSERT_EQUAL_UINT8(stats.attempts, stats.fixes);
+
+  for (int run = 0; run < 6; ++run) {
+    runRecovery(ladder, config, RecoveryStage::SoftReset);
+  }
+  RecoveryStage order[kRecoveryStageCount];
+  PlanRecovery(ladder, order);
+  TEST_ASSERT_EQUAL(RecoveryStage::SoftReset, order[0]);
+}
+
+// Native test entry point for the Unity runner.
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_fresh_ladder_runs_in_cost_order);
+  RUN_TEST(test_node_learns_to_start_at_the_stage_that_works);
+  RUN_TEST(test_failing_stage_backs_off_and_recovers);
+  RUN_TEST(test_all_stages_in_backoff_still_restart_the_bus);
+  RUN_TEST(test_history_is_halved_at_the_limit);
+  return UNITY_END();
+}
@@ -0,0 +1,100 @@
+// Host-side unit tests for the deadband reporting policy in `lib/envnode_core`.
+
+#include <unity.h>
+
+#include <cmath>
+#include <report_policy.h>
+
+using envnode::core::BatchedReading;
+using envnode::core::EvaluateReport;
+using envnode::core::MarkReported;
+using envnode::core::ReportDeadband;
+using envnode::core::ReportDecision;
+using envnode::core::ReportKeepAliveDue;
+using envnode::core::ReportState;
+
+namespace {
+
+// Builds a typical indoor reading.
+BatchedReading makeReading() {
+  BatchedReading reading;
+  reading.temperature = 21.0f;
+  reading.humidity = 45.0f;
+  reading.pressure = 1010.0f;
+  reading.batteryVoltage = 3.90f;
+  reading.batteryPercent = 70.0f;
+  return reading;
+}
+
+}  // namespace
+
+// Unity fixture hook required by the test runner.
+void setUp() {}
+
+// Unity fixture hook required by the test runner.
+void tearDown() {}
+
+// Verifies the first reading is reported and small drifts are suppressed
+// until one value leaves its deadband.
+void test_changes_beyond_deadband_are_reported() {
+  ReportState state;
+  const ReportDeadband deadband;
+  BatchedReading reading = makeReading();
+  TEST_ASSERT_EQUAL(ReportDecision::First, EvaluateReport(state, deadband, reading, 100));
+  MarkReported(state, reading, 100);
+
+  reading.temperature += 0.15f;
+  reading.humidity -= 0.9f;
+  reading.pressure += 0.4f;
+  reading.batteryVoltage -= 0.04f;
+  reading.batteryPercent -= 5.0f;
+  TEST_ASSERT_EQUAL(ReportDecision::Suppressed, EvaluateReport(state, deadband, reading, 700));
+
+  // Drift is measured from the last reported value, not the last sample.
+  reading.temperature += 0.1f;
+  TEST_ASSERT_EQUAL(ReportDecision::Changed, EvaluateReport(state, deadband, reading, 1300));
+  reading.temperature = 21.0f;
+  reading.pressure = 1009.4f;
+  TEST_ASSERT_EQUAL(ReportDecision::Changed, EvaluateReport(state, deadband, reading, 1300));
+}
+
+// Ensures a quiet node still reports once per silence interval, and that a
+// clock step backwards forces a row instead of silencing the node.
+void test_keep_alive_after_max_silence() {
+  ReportState state;
+  ReportDeadband deadband;
+  deadband.maxSilenceSeconds = 3600;
+  const BatchedReading reading = makeReading();
+  MarkReported(state, reading, 1000);
+
+  TEST_ASSERT_FALSE(ReportKeepAliveDue(state, deadband, 4599));
+  TEST_ASSERT_EQUAL(ReportDecision::Suppressed, EvaluateReport(state, deadband, reading, 4599));
+  TEST_ASSERT_TRUE(ReportKeepAliveDue(state, deadband, 4600));
+  TEST_ASSERT_EQUAL(ReportDecision::KeepAlive, EvaluateReport(state, deadband, reading, 4600));
+  TEST_ASSERT_EQUAL(ReportDecision::KeepAlive, EvaluateReport(state, deadband, reading, 10));
+
+  deadband.maxSilenceSeconds = 0;
+  TEST_ASSERT_EQUAL(ReportDecision::First, EvaluateReport(state, deadband, reading, 1001));
+}
+
+// Checks that a value appearing or disappearing counts as a change.
+void test_missing_values_count_as_changes() {
+  ReportState state;
+  const ReportDeadband deadband;
+  BatchedReading reading = makeReading();
+  reading.batteryVoltage = NAN;
+  MarkReported(state, reading, 0);
+  TEST_ASSERT_EQUAL(ReportDecision::Suppressed, EvaluateReport(state, deadband, reading, 60));
+
+  reading.batteryVoltage = 3.9f;
+  TEST_ASSERT_EQUAL(ReportDecision::Changed, EvaluateReport(state, deadband, reading, 60));
+}
+
+// Native test entry point for the Unity runner.
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_changes_beyond_deadband_are_reported);
+  RUN_TEST(test_keep_alive_after_max_silence);
+  RUN_TEST(test_missing_values_count_as_changes);
+  return UNITY_END();
+}
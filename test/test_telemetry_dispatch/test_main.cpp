@@ -0,0 +1,174 @@
+// Host-side unit tests for the Supabase/webhook dispatch in `lib/envnode_core`,
+// run against the in-process server stand-in from `lib/envnode_host`.
+
+#include <unity.h>
+
+#include <cstdint>
+#include <fake_telemetry_server.h>
+#include <string>
+#include <telemetry_dispatch.h>
+
+using envnode::core::GzipScratch;
+using envnode::core::HttpHeader;
+using envnode::core::HttpResponse;
+using envnode::core::HttpSucceeded;
+using envnode::core::InsertCompression;
+using envnode::core::InsertResult;
+using envnode::core::SendJsonPost;
+using envnode::core::SendSupabaseInsert;
+using envnode::core::SendSupabaseProbe;
+using envnode::core::SupabaseInsert;
+using envnode::core::SupabaseTarget;
+using envnode::core::WakePriority;
+using envnode::host::FakeTelemetryServer;
+using envnode::host::RecordedRequest;
+
+namespace {
+
+GzipScratch gScratch;
+uint8_t gCompressed[4096];
+
+SupabaseTarget testTarget() {
+  SupabaseTarget target;
+  target.url = "https://project.supabase.co";
+  target.apiKey = "key-123";
+  return target;
+}
+
+InsertCompression testCompression() {
+  InsertCompression compression;
+  compression.minBytes = 256;
+  compression.buffer = gCompressed;
+  compression.capacity = sizeof(gCompressed);
+  compression.scratch = &gScratch;
+  return compression;
+}
+
+// A repetitive JSON array that compresses well, like a readings batch.
+std::string repetitiveRows(int rows) {
+  std::string body = "[";
+  for (int i = 0; i < rows; ++i) {
+    body += i ? "," : "";
+    body += "{\"device_id\":\"node-1\",\"temperature_c\":21.50,\"humidity_rh\":40.00}";
+  }
+  return body + "]";
+}
+
+}  // namespace
+
+// Unity fixture hook required by the test runner.
+void setUp() {}
+
+// Unity fixture hook required by the test runner.
+void tearDown() {}
+
+// Verifies inserts carry the PostgREST URL and headers, and that only large
+// bodies are gzipped.
+void test_insert_builds_postgrest_request() {
+  FakeTelemetryServer server;
+  const std::string small = "[{\"device_id\":\"node-1\"}]";
+  SupabaseInsert insert;
+  insert.table = "readings";
+  insert.columns = "device_id,temperature_c";
+  insert.body = small.data();
+  insert.bodyLength = small.size();
+
+  InsertResult result = SendSupabaseInsert(server, testTarget(), insert, testCompression());
+  TEST_ASSERT_TRUE(HttpSucceeded(result.response));
+  TEST_ASSERT_FALSE(result.compressed);
+  const RecordedRequest& plain = server.Requests().at(0);
+  TEST_ASSERT_EQUAL_STRING(
+      "https://project.supabase.co/rest/v1/readings?columns=device_id,temperature_c",
+      plain.url.c_str());
+  TEST_ASSERT_EQUAL_STRING("return=minimal,missing=default", plain.Header("Prefer").c_str());
+  TEST_ASSERT_EQUAL_STRING("Bearer key-123", plain.Header("Authorization").c_str());
+  TEST_ASSERT_TRUE(plain.body == small);
+  TEST_ASSERT_TRUE(plain.newConnection);
+
+  const std::string large = repetitiveRows(20);
+  insert.columns = nullptr;
+  insert.body = large.data();
+  insert.bodyLength = large.size();
+  result = SendSupabaseInsert(server, testTarget(), insert, testCompression());
+  TEST_ASSERT_EQUAL_INT(201, result.response.code);
+  TEST_ASSERT_TRUE(result.compressed);
+  TEST_ASSERT_LESS_THAN(large.size() / 4, result.sentBytes);
+  const RecordedRequest& gzip = server.Requests().at(1);
+  TEST_ASSERT_EQUAL_STRING("https://project.supabase.co/rest/v1/readings", gzip.url.c_str());
+  TEST_ASSERT_EQUAL_STRING("return=minimal", gzip.Header("Prefer").c_str());
+  TEST_ASSERT_TRUE(gzip.gzip);
+  TEST_ASSERT_FALSE(gzip.newConnection);
+  TEST_ASSERT_EQUAL_UINT32(1, server.ConnectionsOpened());
+}
+
+// Ensures a server that refuses gzip gets the plain body once and the caller
+// learns that only the encoding was the problem.
+void test_refused_gzip_falls_back_to_plain_body() {
+  FakeTelemetryServer server;
+  server.SetRejectGzip(true);
+  const std::string body = repetitiveRows(20);
+  SupabaseInsert insert;
+  insert.table = "readings";
+  insert.body = body.data();
+  insert.bodyLength = body.size();
+
+  const InsertResult result =
+      SendSupabaseInsert(server, testTarget(), insert, testCompression());
+  TEST_ASSERT_EQUAL_INT(201, result.response.code);
+  TEST_ASSERT_EQUAL_INT(415, result.compressedCode);
+  TEST_ASSERT_TRUE(result.compressionRejected);
+  TEST_ASSERT_FALSE(result.compressed);
+  TEST_ASSERT_EQUAL_UINT32(body.size(), result.sentBytes);
+  TEST_ASSERT_EQUAL_UINT32(2, server.Requests().size());
+  TEST_ASSERT_FALSE(server.Requests().at(1).gzip);
+
+  // A transport failure is not mistaken for a refused encoding.
+  server.SetRejectGzip(false);
+  server.FailNext(1, 503);
+  const InsertResult failed =
+      SendSupabaseInsert(server, testTarget(), insert, testCompression());
+  TEST_ASSERT_EQUAL_INT(503, failed.response.code);
+  TEST_ASSERT_FALSE(failed.compressionRejected);
+  TEST_ASSERT_EQUAL_UINT32(3, server.Requests().size());
+}
+
+// Checks probes and webhook posts, including extra headers and per-origin
+// connection reuse across a simulated sleep.
+void test_probe_and_webhook_requests() {
+  FakeTelemetryServer server;
+  HttpResponse response =
+      SendSupabaseProbe(server, testTarget(), "device_events", 5000, WakePriority::Backlog);
+  TEST_ASSERT_EQUAL_INT(200, response.code);
+  const RecordedRequest& probe = server.Requests().at(0);
+  TEST_ASSERT_EQUAL_STRING("GET", probe.method.c_str());
+  TEST_ASSERT_EQUAL_STRING(
+      "https://project.supabase.co/rest/v1/device_events?select=*&limit=1", probe.url.c_str());
+  TEST_ASSERT_EQUAL_STRING("0-0", probe.Header("Range").c_str());
+
+  const HttpHeader access[] = {{"CF-Access-Client-Id", "id"},
+                               {"CF-Access-Client-Secret", "secret"}};
+  const std::string body = "{\"alert_type\":\"sensor_error\"}";
+  response = SendJsonPost(server, "https://n8n.example.com/webhook/abc", access, 2, body.data(),
+                          body.size(), 10000, WakePriority::Webhook);
+  TEST_ASSERT_TRUE(HttpSucceeded(response));
+  TEST_ASSERT_FALSE(response.reusedConnection);
+  const RecordedRequest& webhook = server.Requests().at(1);
+  TEST_ASSERT_EQUAL_STRING("application/json", webhook.Header("Content-Type").c_str());
+  TEST_ASSERT_EQUAL_STRING("secret", webhook.Header("CF-Access-Client-Secret").c_str());
+  TEST_ASSERT_EQUAL_STRING("https://n8n.example.com", webhook.origin.c_str());
+
+  server.CloseConnections();
+  response = SendJsonPost(server, "https://n8n.example.com/webhook/abc", nullptr, 0, body.data(),
+                          body.size(), 10000, WakePriority::Webhook);
+  TEST_ASSERT_FALSE(response.reusedConnection);
+  TEST_ASSERT_EQUAL_UINT32(3, server.ConnectionsOpened());
+}
+
+// Native test entry point for the Unity runner.
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_insert_builds_postgrest_request);
+  RUN_TEST(test_refused_gzip_falls_back_to_plain_body);
+  RUN_TEST(test_probe_and_webhook_requests);
+  return UNITY_END();
+}
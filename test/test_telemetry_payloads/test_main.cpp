@@ -0,0 +1,331 @@
+// Golden tests for the telemetry payload builders in `lib/envnode_core`.
+//
+// The expected strings are the exact request bodies the firmware sends, so any
+// change to field names, ordering, or precision shows up here first.
+
+#include <unity.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <telemetry_payloads.h>
+
+using envnode::core::BatchedReading;
+using envnode::core::DeviceMeta;
+using envnode::core::EventPayload;
+using envnode::core::I2cBusCounters;
+using envnode::core::JsonWriter;
+using envnode::core::LogicReadings;
+using envnode::core::PushReading;
+using envnode::core::ReadingRing;
+using envnode::core::WebhookPayload;
+using envnode::core::WriteBatteryAlertMeta;
+using envnode::core::WriteBootMeta;
+using envnode::core::WriteDebugHeartbeatExtra;
+using envnode::core::WriteDiscordPayload;
+using envnode::core::WriteEventPayload;
+using envnode::core::WriteI2cBusMeta;
+using envnode::core::WriteReadingBatch;
+using envnode::core::WriteServiceModeMeta;
+using envnode::core::WriteTestWebhookExtra;
+using envnode::core::WriteWebhookPayload;
+
+namespace {
+
+// Heap allocations observed since the counter was last cleared.
+size_t gAllocationCount = 0;
+
+// Builds a reading whose temperature doubles as an identifier in assertions.
+BatchedReading makeReading(float temperature, uint32_t epoch = 0) {
+  BatchedReading reading;
+  reading.temperature = temperature;
+  reading.humidity = 40.0f;
+  reading.pressure = 1000.0f;
+  reading.recordedAtEpoch = epoch;
+  return reading;
+}
+
+// Returns device metadata with the network fields populated.
+DeviceMeta makeConnectedMeta() {
+  DeviceMeta meta;
+  meta.fwVersion = "1.2.0";
+  meta.bootMode = "cold";
+  meta.runtimeMode = "normal";
+  meta.intervalSeconds = 300;
+  meta.networkAvailable = true;
+  meta.ipAddress = "192.168.1.20";
+  meta.macAddress = "AA:BB:CC:DD:EE:FF";
+  meta.rssiDbm = -61;
+  meta.txPowerQuarterDbm = 34;
+  meta.sensorSettleMs = 38;
+  meta.i2cClockKhz = 400;
+  meta.sessionId = "abc123";
+  return meta;
+}
+
+}  // namespace
+
+// Counts every allocation so the builders can be checked for heap use.
+void* operator new(size_t size) {
+  ++gAllocationCount;
+  if (void* memory = std::malloc(size ? size : 1)) {
+    return memory;
+  }
+  throw std::bad_alloc();
+}
+
+// Matching release for the counting allocator above.
+void operator delete(void* memory) noexcept {
+  std::free(memory);
+}
+
+// Sized release for the counting allocator above.
+void operator delete(void* memory, size_t) noexcept {
+  std::free(memory);
+}
+
+// Unity fixture hook required by the test runner.
+void setUp() {}
+
+// Unity fixture hook required by the test runner.
+void tearDown() {}
+
+// Checks the PostgREST bulk-insert body, including timestamp and battery
+// handling for rows captured before and after clock sync.
+void test_reading_batch_matches_golden_body() {
+  ReadingRing ring;
+  BatchedReading first = makeReading(21.5f);
+  first.batteryVoltage = 3.9f;
+  first.batteryPercent = 75.0f;
+  PushReading(ring, first);
+  PushReading(ring, makeReading(22.25f, 1704067200UL));
+  PushReading(ring, makeReading(23.0f));
+
+  char buffer[512];
+  JsonWriter writer(buffer, sizeof(buffer));
+  TEST_ASSERT_EQUAL_UINT32(2, WriteReadingBatch(writer, ring, 2, "node-\"1\""));
+  TEST_ASSERT_TRUE(writer.Ok());
+  TEST_ASSERT_EQUAL_STRING(
+      "[{\"device_id\":\"node-\\\"1\\\"\",\"temperature_c\":21.50,"
+      "\"humidity_rh\":40.00,\"pressure_hpa\":1000.00,"
+      "\"battery_voltage_v\":3.900,\"battery_pct\":75.0},"
+      "{\"device_id\":\"node-\\\"1\\\"\",\"recorded_at\":\"2024-01-01T00:00:00Z\","
+      "\"temperature_c\":22.25,\"humidity_rh\":40.00,\"pressure_hpa\":1000.00}]",
+      writer.Data());
+
+  ReadingRing empty;
+  writer.Reset();
+  TEST_ASSERT_EQUAL_UINT32(0, WriteReadingBatch(writer, empty, 8, "x"));
+  TEST_ASSERT_EQUAL_STRING("[]", writer.Data());
+}
+
+// Checks a fully populated event row and a minimal one.
+void test_event_payload_matches_golden_body() {
+  LogicReadings snapshot;
+  snapshot.temperature = 21.456f;
+  snapshot.humidity = NAN;
+  snapshot.pressure = 1001.5f;
+
+  EventPayload event;
+  event.deviceId = "node-1";
+  event.sessionId = "abc123";
+  event.eventType = "recovery";
+  event.severity = "warning";
+  event.message = "retry \"soft\" reset";
+  event.snapshot = &snapshot;
+  event.action = "soft_reset";
+  event.attempt = 2;
+  event.actionSuccess = true;
+  event.metaJson = "{\"fw\":\"1.2.0\"}";
+
+  char buffer[512];
+  JsonWriter writer(buffer, sizeof(buffer));
+  WriteEventPayload(writer, event);
+  TEST_ASSERT_EQUAL_STRING(
+      "{\"device_id\":\"node-1\",\"session_id\":\"abc123\","
+      "\"event_type\":\"recovery\",\"severity\":\"warning\","
+      "\"message\":\"retry \\\"soft\\\" reset\",\"reading_temp_c\":21.46,"
+      "\"reading_humidity_rh\":null,\"reading_pressure_hpa\":1001.50,"
+      "\"action\":\"soft_reset\",\"attempt\":2,\"action_success\":true,"
+      "\"meta\":{\"fw\":\"1.2.0\"}}",
+      writer.Data());
+
+  EventPayload minimal;
+  minimal.deviceId = "node-1";
+  minimal.eventType = "startup";
+  minimal.severity = "info";
+  writer.Reset();
+  WriteEventPayload(writer, minimal);
+  TEST_ASSERT_EQUAL_STRING(
+      "{\"device_id\":\"node-1\",\"event_type\":\"startup\",\"severity\":\"info\","
+      "\"action_success\":false}",
+      writer.Data());
+}
+
+// Checks the structured webhook, Discord, and debug heartbeat bodies.
+void test_webhook_payloads_match_golden_bodies() {
+  BatchedReading readings = makeReading(22.5f);
+  readings.batteryVoltage = 3.95f;
+  readings.batteryPercent = 79.0f;
+
+  char extra[128];
+  JsonWriter extraWriter(extra, sizeof(extra));
+  WriteDebugHeartbeatExtra(extraWriter, 60, 1834, false);
+  TEST_ASSERT_EQUAL_STRING(
+      "{\"mode\":\"debug\",\"interval_s\":60,\"cycle_ms\":1834,\"upload_ok\":false}",
+      extra);
+
+  char testExtra[64];
+  JsonWriter testWriter(testExtra, sizeof(testExtra));
+  WriteTestWebhookExtra(testWriter, "192.168.1.40");
+  TEST_ASSERT_EQUAL_STRING("{\"test_mode\":true,\"ip_address\":\"192.168.1.40\"}", testExtra);
+
+  WebhookPayload webhook;
+  webhook.deviceId = "node-1";
+  webhook.alertType = "battery_low";
+  webhook.severity = "warning";
+  webhook.message = "Battery low:\n3.40V";
+  webhook.timestampMs = 123456;
+  webhook.fwVersion = "1.2.0";
+  webhook.readings = &readings;
+  webhook.extraJson = extra;
+
+  char buffer[512];
+  JsonWriter writer(buffer, sizeof(buffer));
+  WriteWebhookPayload(writer, webhook);
+  TEST_ASSERT_EQUAL_STRING(
+      "{\"device_id\":\"node-1\",\"alert_type\":\"battery_low\","
+      "\"severity\":\"warning\",\"message\":\"Battery low:\\n3.40V\","
+      "\"timestamp\":123456,\"fw_version\":\"1.2.0\",\"readings\":{"
+      "\"temperature_c\":22.50,\"humidity_rh\":40.00,\"pressure_hpa\":1000.00,"
+      "\"battery_voltage_v\":3.950,\"battery_pct\":79.0},"
+      "\"extra\":{\"mode\":\"debug\",\"interval_s\":60,\"cycle_ms\":1834,"
+      "\"upload_ok\":false}}",
+      writer.Data());
+
+  BatchedReading failed;
+  webhook.readings = &failed;
+  webhook.extraJson = "";
+  writer.Reset();
+  WriteWebhookPayload(writer, webhook);
+  TEST_ASSERT_EQUAL_STRING(
+      "{\"device_id\":\"node-1\",\"alert_type\":\"battery_low\","
+      "\"severity\":\"warning\",\"message\":\"Battery low:\\n3.40V\","
+      "\"timestamp\":123456,\"fw_version\":\"1.2.0\"}",
+      writer.Data());
+
+  webhook.suppressedCount = 4;
+  writer.Reset();
+  WriteWebhookPayload(writer, webhook);
+  TEST_ASSERT_EQUAL_STRING(
+      "{\"device_id\":\"node-1\",\"alert_type\":\"battery_low\","
+      "\"severity\":\"warning\",\"message\":\"Battery low:\\n3.40V\","
+      "\"timestamp\":123456,\"fw_version\":\"1.2.0\",\"suppressed_count\":4}",
+      writer.Data());
+
+  writer.Reset();
+  WriteDiscordPayload(writer, "ESP debug heartbeat `node-1` upload ok");
+  TEST_ASSERT_EQUAL_STRING(
+      "{\"content\":\"ESP debug heartbeat `node-1` upload ok\"}", writer.Data());
+}
+
+// Checks the boot, service-mode, sensor-bus, and battery metadata objects.
+void test_metadata_matches_golden_bodies() {
+  char buffer[448];
+  JsonWriter writer(buffer, sizeof(buffer));
+  WriteBootMeta(writer, makeConnectedMeta(), true);
+  TEST_ASSERT_EQUAL_STRING(
+      "{\"fw\":\"1.2.0\",\"boot_mode\":\"cold\",\"runtime_mode\":\"normal\","
+      "\"interval_s\":300,\"ip\":\"192.168.1.20\","
+      "\"mac_address\":\"AA:BB:CC:DD:EE:FF\",\"rssi_dbm\":-61,"
+      "\"session_id\":\"abc123\",\"tx_power_dbm\":8.5,\"sensor_settle_ms\":38,"
+      "\"first_reading_failed\":true}",
+      writer.Data());
+
+  DeviceMeta faulted = makeConnectedMeta();
+  faulted.networkAvailable = false;
+  faulted.i2cClockKhz = 100;
+  faulted.i2c.nacks = 2;
+  faulted.i2c.retries = 2;
+  writer.Reset();
+  WriteBootMeta(writer, faulted, false);
+  TEST_ASSERT_EQUAL_STRING(
+      "{\"fw\":\"1.2.0\",\"boot_mode\":\"cold\",\"runtime_mode\":\"normal\","
+      "\"interval_s\":300,\"session_id\":\"abc123\",\"sensor_settle_ms\":38,"
+      "\"i2c_khz\":100,\"i2c_nacks\":2,\"i2c_timeouts\":0,\"i2c_bus_clears\":0,"
+      "\"i2c_retries\":2}",
+      writer.Data());
+
+  I2cBusCounters counters;
+  counters.timeouts = 1;
+  counters.busClears = 1;
+  writer.Reset();
+  WriteI2cBusMeta(writer, 400, counters);
+  TEST_ASSERT_EQUAL_STRING(
+      "{\"i2c_khz\":400,\"i2c_nacks\":0,\"i2c_timeouts\":1,\"i2c_bus_clears\":1,"
+      "\"i2c_retries\":0}",
+      writer.Data());
+
+  DeviceMeta offline = makeConnectedMeta();
+  offline.networkAvailable = false;
+  offline.sessionId = "";
+  writer.Reset();
+  WriteServiceModeMeta(writer, offline, true);
+  TEST_ASSERT_EQUAL_STRING(
+      "{\"fw\":\"1.2.0\",\"boot_mode\":\"cold\",\"runtime_mode\":\"normal\","
+      "\"usb_host_attached\":true,\"readings_paused\":true,\"interval_s\":300}",
+      writer.Data());
+
+  writer.Reset();
+  WriteBatteryAlertMeta(writer, 3.412f, 21.4f, 3.45f, 3.6f);
+  TEST_ASSERT_EQUAL_STRING(
+      "{\"battery_voltage_v\":3.412,\"battery_pct\":21.4,"
+      "\"alert_threshold_v\":3.45,\"clear_threshold_v\":3.60}",
+      writer.Data());
+}
+
+// Confirms that no builder touches the heap, which is the point of the writer.
+void test_payload_builders_do_not_allocate() {
+  ReadingRing ring;
+  for (int i = 0; i < 24; ++i) {
+    PushReading(ring, makeReading(20.0f + i * 0.1f, 1704067200UL + i * 300));
+  }
+  EventPayload event;
+  event.deviceId = "node-1";
+  event.eventType = "recovery";
+  event.severity = "warning";
+  event.message = "soft reset";
+  WebhookPayload webhook;
+  webhook.deviceId = "node-1";
+  webhook.alertType = "sensor_error";
+  webhook.severity = "error";
+  webhook.message = "sensor stopped responding";
+  BatchedReading readings = makeReading(21.0f);
+  webhook.readings = &readings;
+
+  static char buffer[6144];
+  JsonWriter writer(buffer, sizeof(buffer));
+  gAllocationCount = 0;
+  WriteReadingBatch(writer, ring, ring.count, "node-1");
+  writer.Reset();
+  WriteEventPayload(writer, event);
+  writer.Reset();
+  WriteWebhookPayload(writer, webhook);
+  writer.Reset();
+  WriteBootMeta(writer, makeConnectedMeta(), false);
+  const size_t allocations = gAllocationCount;
+
+  TEST_ASSERT_TRUE(writer.Ok());
+  TEST_ASSERT_EQUAL_UINT32(0, allocations);
+}
+
+// Native test entry point for the Unity runner.
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_reading_batch_matches_golden_body);
+  RUN_TEST(test_event_payload_matches_golden_body);
+  RUN_TEST(test_webhook_payloads_match_golden_bodies);
+  RUN_TEST(test_metadata_matches_golden_bodies);
+  RUN_TEST(test_payload_builders_do_not_allocate);
+  return UNITY_END();
+}
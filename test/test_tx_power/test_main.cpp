@@ -0,0 +1,116 @@
+// Host-side unit tests for the adaptive Wi-Fi TX power controller in
+// `lib/envnode_core`, driven by a simulated link.
+
+#include <unity.h>
+
+#include <tx_power.h>
+
+using envnode::core::CurrentTxPower;
+using envnode::core::StartTxPower;
+using envnode::core::TxPowerConfig;
+using envnode::core::TxPowerLevelIndexFor;
+using envnode::core::TxPowerObservation;
+using envnode::core::TxPowerState;
+using envnode::core::UpdateTxPower;
+
+namespace {
+
+// Node-to-AP link with a fixed path: the AP is heard at `rssiDbm`, and the
+// node's own frames reach the AP only at `minWorkingQuarterDbm` or more.
+struct SimulatedLink {
+  int8_t rssiDbm;
+  int8_t minWorkingQuarterDbm;
+};
+
+// Runs `wakes` connection attempts and returns how many failed.
+int runWakes(TxPowerState& state, const TxPowerConfig& config, const SimulatedLink& link, int wakes) {
+  int failures = 0;
+  for (int wake = 0; wake < wakes; ++wake) {
+    TxPowerObservation observation;
+    observation.connected = CurrentTxPower(state) >= link.minWorkingQuarterDbm;
+    observation.rssiDbm = link.rssiDbm;
+    if (!observation.connected) {
+      ++failures;
+    }
+    UpdateTxPower(state, config, observation);
+  }
+  return failures;
+}
+
+}  // namespace
+
+// Unity fixture hook required by the test runner.
+void setUp() {}
+
+// Unity fixture hook required by the test runner.
+void tearDown() {}
+
+// Verifies a node close to the AP walks down to the configured minimum, one
+// level per run of healthy wakes, and a distant one climbs to the maximum.
+void test_converges_to_link_margin() {
+  const TxPowerConfig config;
+  TxPowerState near;
+  StartTxPower(near, config, 60);
+  TEST_ASSERT_EQUAL_INT(60, CurrentTxPower(near));
+  runWakes(near, config, {-48, 8}, 2);
+  TEST_ASSERT_EQUAL_INT(60, CurrentTxPower(near));
+  runWakes(near, config, {-48, 8}, 1);
+  TEST_ASSERT_EQUAL_INT(52, CurrentTxPower(near));
+  TEST_ASSERT_EQUAL_INT(0, runWakes(near, config, {-48, 8}, 30));
+  TEST_ASSERT_EQUAL_INT(config.minQuarterDbm, CurrentTxPower(near));
+
+  TxPowerState far;
+  StartTxPower(far, config, 60);
+  runWakes(far, config, {-80, 8}, 5);
+  TEST_ASSERT_EQUAL_INT(config.maxQuarterDbm, CurrentTxPower(far));
+
+  // The hysteresis band holds the level wherever it is.
+  TxPowerState middle;
+  StartTxPower(middle, config, 60);
+  runWakes(middle, config, {-66, 8}, 50);
+  TEST_ASSERT_EQUAL_INT(60, CurrentTxPower(middle));
+}
+
+// Ensures a strong downlink with a weak uplink does not keep stepping down
+// into failed connects: after one failure the level stays above the one that
+// failed until the floor expires.
+void test_failure_floor_limits_repeated_failures() {
+  TxPowerConfig config;
+  config.failureFloorWakes = 100;
+  TxPowerState state;
+  StartTxPower(state, config, 78);
+
+  const SimulatedLink asymmetric = {-50, 52};
+  TEST_ASSERT_EQUAL_INT(1, runWakes(state, config, asymmetric, 100));
+  TEST_ASSERT_EQUAL_INT(52, CurrentTxPower(state));
+  TEST_ASSERT_EQUAL_INT(1, runWakes(state, config, asymmetric, 100));
+}
+
+// Checks level lookup rounding and that a narrowed range clamps a learned
+// level without resetting the controller.
+void test_level_mapping_and_range_changes() {
+  TEST_ASSERT_EQUAL_INT(10, TxPowerLevelIndexFor(19 * 4));
+  TEST_ASSERT_EQUAL_INT(6, TxPowerLevelIndexFor(15 * 4));
+  TEST_ASSERT_EQUAL_INT(8, TxPowerLevelIndexFor(18 * 4));
+  TEST_ASSERT_EQUAL_INT(0, TxPowerLevelIndexFor(0));
+
+  TxPowerConfig config;
+  TxPowerState state;
+  StartTxPower(state, config, 44);
+  TEST_ASSERT_EQUAL_INT(44, CurrentTxPower(state));
+  StartTxPower(state, config, 78);
+  TEST_ASSERT_EQUAL_INT(44, CurrentTxPower(state));
+
+  config.minQuarterDbm = 60;
+  StartTxPower(state, config, 78);
+  TEST_ASSERT_EQUAL_INT(60, CurrentTxPower(state));
+}
+
+// Native test entry point for the Unity runner.
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_converges_to_link_margin);
+  RUN_TEST(test_failure_floor_limits_repeated_failures);
+  RUN_TEST(test_level_mapping_and_range_changes);
+  return UNITY_END();
+}
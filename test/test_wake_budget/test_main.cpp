@@ -0,0 +1,70 @@
+// Host-side unit tests for the per-wake time budget in `lib/envnode_core`.
+
+#include <unity.h>
+
+#include <cstdint>
+#include <wake_budget.h>
+
+using envnode::core::ClampToWakeBudget;
+using envnode::core::StartWakeBudget;
+using envnode::core::WakeBudget;
+using envnode::core::WakeBudgetElapsedMs;
+using envnode::core::WakeBudgetRemainingMs;
+using envnode::core::WakePriority;
+
+// Unity fixture hook required by the test runner.
+void setUp() {}
+
+// Unity fixture hook required by the test runner.
+void tearDown() {}
+
+// Verifies each priority stops at its own share of the budget, so lower
+// priorities give way first.
+void test_priorities_reach_their_cutoffs_in_order() {
+  WakeBudget budget;
+  StartWakeBudget(budget, 1000, 20000);
+
+  TEST_ASSERT_EQUAL_UINT32(20000, WakeBudgetRemainingMs(budget, 1000, WakePriority::Reading));
+  TEST_ASSERT_EQUAL_UINT32(10000, WakeBudgetRemainingMs(budget, 1000, WakePriority::Heartbeat));
+
+  const uint32_t now = 1000 + 12000;
+  TEST_ASSERT_EQUAL_UINT32(8000, WakeBudgetRemainingMs(budget, now, WakePriority::Reading));
+  TEST_ASSERT_EQUAL_UINT32(6000, WakeBudgetRemainingMs(budget, now, WakePriority::Event));
+  TEST_ASSERT_EQUAL_UINT32(3000, WakeBudgetRemainingMs(budget, now, WakePriority::Backlog));
+  TEST_ASSERT_EQUAL_UINT32(1000, WakeBudgetRemainingMs(budget, now, WakePriority::Webhook));
+  TEST_ASSERT_EQUAL_UINT32(0, WakeBudgetRemainingMs(budget, now, WakePriority::Heartbeat));
+  TEST_ASSERT_EQUAL_UINT32(0, WakeBudgetRemainingMs(budget, 1000 + 25000, WakePriority::Reading));
+}
+
+// Checks that timeouts shrink to the remaining share and that an unbounded
+// budget leaves them alone.
+void test_clamp_shortens_timeouts_only_when_bounded() {
+  WakeBudget budget;
+  StartWakeBudget(budget, 0, 20000);
+  TEST_ASSERT_EQUAL_UINT32(5000, ClampToWakeBudget(budget, 0, WakePriority::Event, 5000));
+  TEST_ASSERT_EQUAL_UINT32(2000, ClampToWakeBudget(budget, 11000, WakePriority::Webhook, 10000));
+
+  StartWakeBudget(budget, 0, 0);
+  TEST_ASSERT_EQUAL_UINT32(10000,
+                           ClampToWakeBudget(budget, 500000, WakePriority::Heartbeat, 10000));
+  TEST_ASSERT_EQUAL_UINT32(UINT32_MAX,
+                           WakeBudgetRemainingMs(budget, 500000, WakePriority::Heartbeat));
+}
+
+// Ensures elapsed time stays correct when `millis()` wraps during a wake.
+void test_budget_survives_millis_wraparound() {
+  WakeBudget budget;
+  StartWakeBudget(budget, UINT32_MAX - 999, 20000);
+  const uint32_t now = 3000;
+  TEST_ASSERT_EQUAL_UINT32(4000, WakeBudgetElapsedMs(budget, now));
+  TEST_ASSERT_EQUAL_UINT32(16000, WakeBudgetRemainingMs(budget, now, WakePriority::Reading));
+}
+
+// Native test entry point for the Unity runner.
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_priorities_reach_their_cutoffs_in_order);
+  RUN_TEST(test_clamp_shortens_timeouts_only_when_bounded);
+  RUN_TEST(test_budget_survives_millis_wraparound);
+  return UNITY_END();
+}
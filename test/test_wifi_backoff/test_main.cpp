@@ -0,0 +1,78 @@
+// Host-side unit tests for the cross-wake Wi-Fi backoff in `lib/envnode_core`.
+
+#include <unity.h>
+
+#include <wifi_backoff.h>
+
+using envnode::core::RecordWiFiFailure;
+using envnode::core::RecordWiFiSuccess;
+using envnode::core::WiFiBackoff;
+using envnode::core::WiFiBackoffConfig;
+using envnode::core::WiFiBackoffRemainingSeconds;
+
+// Unity fixture hook required by the test runner.
+void setUp() {}
+
+// Unity fixture hook required by the test runner.
+void tearDown() {}
+
+// Verifies the backoff starts with the failure that reaches `freeFailures`,
+// later delays double up to the cap, and a success clears the schedule.
+void test_delays_double_up_to_cap() {
+  const WiFiBackoffConfig config;
+  WiFiBackoff backoff;
+  RecordWiFiFailure(backoff, config, 1000);
+  TEST_ASSERT_EQUAL_UINT32(0, WiFiBackoffRemainingSeconds(backoff, 1000));
+
+  RecordWiFiFailure(backoff, config, 1600);
+  TEST_ASSERT_EQUAL_UINT32(600, WiFiBackoffRemainingSeconds(backoff, 1600));
+  TEST_ASSERT_EQUAL_UINT32(1, WiFiBackoffRemainingSeconds(backoff, 2199));
+  TEST_ASSERT_EQUAL_UINT32(0, WiFiBackoffRemainingSeconds(backoff, 2200));
+
+  RecordWiFiFailure(backoff, config, 2200);
+  TEST_ASSERT_EQUAL_UINT32(1200, WiFiBackoffRemainingSeconds(backoff, 2200));
+  RecordWiFiFailure(backoff, config, 3400);
+  TEST_ASSERT_EQUAL_UINT32(2400, WiFiBackoffRemainingSeconds(backoff, 3400));
+  for (int i = 0; i < 300; ++i) {
+    RecordWiFiFailure(backoff, config, 10000);
+  }
+  TEST_ASSERT_EQUAL_UINT32(3600, WiFiBackoffRemainingSeconds(backoff, 10000));
+
+  WiFiBackoffConfig noFreeFailures;
+  noFreeFailures.freeFailures = 0;
+  WiFiBackoff immediate;
+  RecordWiFiFailure(immediate, noFreeFailures, 1000);
+  TEST_ASSERT_EQUAL_UINT32(600, WiFiBackoffRemainingSeconds(immediate, 1000));
+
+  RecordWiFiSuccess(backoff);
+  TEST_ASSERT_EQUAL_UINT32(0, WiFiBackoffRemainingSeconds(backoff, 10000));
+  TEST_ASSERT_EQUAL_UINT32(0, backoff.consecutiveFailures);
+}
+
+// Ensures a backwards clock step ends the backoff and that a zero cap
+// disables it.
+void test_clock_step_and_disabled_config() {
+  const WiFiBackoffConfig config;
+  WiFiBackoff backoff;
+  for (int i = 0; i < 2; ++i) {
+    RecordWiFiFailure(backoff, config, 5000);
+  }
+  TEST_ASSERT_EQUAL_UINT32(600, WiFiBackoffRemainingSeconds(backoff, 5000));
+  TEST_ASSERT_EQUAL_UINT32(0, WiFiBackoffRemainingSeconds(backoff, 4000));
+
+  WiFiBackoffConfig disabled;
+  disabled.maxSeconds = 0;
+  WiFiBackoff unlimited;
+  for (int i = 0; i < 10; ++i) {
+    RecordWiFiFailure(unlimited, disabled, 5000);
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, WiFiBackoffRemainingSeconds(unlimited, 5000));
+}
+
+// Native test entry point for the Unity runner.
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_delays_double_up_to_cap);
+  RUN_TEST(test_clock_step_and_disabled_config);
+  return UNITY_END();
+}
@@ -0,0 +1,107 @@
+// Host-side unit tests for the retained Wi-Fi link state in `lib/envnode_core`.
+
+#include <unity.h>
+
+#include <wifi_link.h>
+
+using envnode::core::ClearAccessPoint;
+using envnode::core::FastConnectPlan;
+using envnode::core::LeaseConfig;
+using envnode::core::LeaseReuseRemainingSeconds;
+using envnode::core::PlanFastConnect;
+using envnode::core::RecordAccessPoint;
+using envnode::core::RecordFastConnectFailure;
+using envnode::core::RecordLease;
+using envnode::core::RetainedLink;
+
+namespace {
+
+constexpr uint8_t kBssid[6] = {0x74, 0xAC, 0xB9, 0x12, 0x34, 0x56};
+
+// Builds a typical home-network lease.
+LeaseConfig makeLease() {
+  LeaseConfig lease;
+  lease.ip = 0x2A01A8C0;
+  lease.gateway = 0x0101A8C0;
+  lease.subnet = 0x00FFFFFF;
+  lease.dns1 = 0x0101A8C0;
+  return lease;
+}
+
+}  // namespace
+
+// Unity fixture hook required by the test runner.
+void setUp() {}
+
+// Unity fixture hook required by the test runner.
+void tearDown() {}
+
+// Verifies a fresh node scans and runs DHCP, and that a recorded association
+// enables the pinned, lease-reusing path until the renewal time.
+void test_lease_reused_until_renewal_time() {
+  RetainedLink link;
+  FastConnectPlan plan = PlanFastConnect(link, 0);
+  TEST_ASSERT_FALSE(plan.pinAccessPoint);
+  TEST_ASSERT_FALSE(plan.reuseLease);
+
+  RecordAccessPoint(link, kBssid, 6);
+  RecordLease(link, makeLease(), 86400, 3600, 1000);
+  plan = PlanFastConnect(link, 1000);
+  TEST_ASSERT_TRUE(plan.pinAccessPoint);
+  TEST_ASSERT_TRUE(plan.reuseLease);
+  TEST_ASSERT_EQUAL_UINT32(1, LeaseReuseRemainingSeconds(link, 4599));
+  TEST_ASSERT_FALSE(PlanFastConnect(link, 4600).reuseLease);
+  TEST_ASSERT_TRUE(PlanFastConnect(link, 4600).pinAccessPoint);
+
+  // A short lease is reused for half its length, not the cap.
+  RecordLease(link, makeLease(), 600, 3600, 5000);
+  TEST_ASSERT_EQUAL_UINT32(300, LeaseReuseRemainingSeconds(link, 5000));
+  TEST_ASSERT_EQUAL_UINT32(0, LeaseReuseRemainingSeconds(link, 4999));
+}
+
+// Ensures failures drop the lease first and the access point pin after
+// repeated failures, and that a success resets the count.
+void test_failures_fall_back_to_scan_and_dhcp() {
+  RetainedLink link;
+  RecordAccessPoint(link, kBssid, 11);
+  RecordLease(link, makeLease(), 7200, 43200, 0);
+
+  RecordFastConnectFailure(link);
+  FastConnectPlan plan = PlanFastConnect(link, 10);
+  TEST_ASSERT_TRUE(plan.pinAccessPoint);
+  TEST_ASSERT_FALSE(plan.reuseLease);
+
+  RecordAccessPoint(link, kBssid, 11);
+  RecordFastConnectFailure(link);
+  TEST_ASSERT_TRUE(PlanFastConnect(link, 10).pinAccessPoint);
+  RecordFastConnectFailure(link);
+  TEST_ASSERT_FALSE(PlanFastConnect(link, 10).pinAccessPoint);
+}
+
+// Checks that a lease without an access point pin, or with reuse disabled, is
+// never reused.
+void test_lease_needs_pin_and_nonzero_limits() {
+  RetainedLink link;
+  RecordLease(link, makeLease(), 86400, 3600, 0);
+  TEST_ASSERT_FALSE(PlanFastConnect(link, 10).reuseLease);
+
+  RecordAccessPoint(link, kBssid, 1);
+  TEST_ASSERT_TRUE(PlanFastConnect(link, 10).reuseLease);
+  ClearAccessPoint(link);
+  TEST_ASSERT_FALSE(PlanFastConnect(link, 10).reuseLease);
+
+  RecordAccessPoint(link, kBssid, 1);
+  RecordLease(link, makeLease(), 86400, 0, 0);
+  TEST_ASSERT_FALSE(PlanFastConnect(link, 10).reuseLease);
+  RecordLease(link, LeaseConfig(), 86400, 3600, 0);
+  TEST_ASSERT_FALSE(PlanFastConnect(link, 10).reuseLease);
+}
+
+// Native test entry point for the Unity runner.
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_lease_reused_until_renewal_time);
+  RUN_TEST(test_failures_fall_back_to_scan_and_dhcp);
+  RUN_TEST(test_lease_needs_pin_and_nonzero_limits);
+  return UNITY_END();
+}
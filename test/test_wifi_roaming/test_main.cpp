@@ -0,0 +1,103 @@
+// Host-side unit tests for the scored access point table in `lib/envnode_core`.
+
+#include <unity.h>
+
+#include <wifi_roaming.h>
+
+using envnode::core::BestRoamingCandidate;
+using envnode::core::DropUnseenCandidates;
+using envnode::core::kRoamingCandidateMaxAgeSeconds;
+using envnode::core::kRoamingCandidateSlots;
+using envnode::core::ObserveAccessPoint;
+using envnode::core::RecordRoamingResult;
+using envnode::core::RoamingCandidate;
+using envnode::core::RoamingChannels;
+using envnode::core::RoamingTable;
+
+namespace {
+
+constexpr uint8_t kHallway[6] = {0x74, 0xAC, 0xB9, 0x00, 0x00, 0x01};
+constexpr uint8_t kKitchen[6] = {0x74, 0xAC, 0xB9, 0x00, 0x00, 0x02};
+constexpr uint8_t kAttic[6] = {0x74, 0xAC, 0xB9, 0x00, 0x00, 0x03};
+
+}  // namespace
+
+// Unity fixture hook required by the test runner.
+void setUp() {}
+
+// Unity fixture hook required by the test runner.
+void tearDown() {}
+
+// Verifies the strongest access point is picked first, and that a proven
+// record of fast connects outweighs a few dB of signal.
+void test_best_candidate_balances_signal_and_history() {
+  RoamingTable table;
+  TEST_ASSERT_NULL(BestRoamingCandidate(table, 0));
+
+  ObserveAccessPoint(table, kHallway, 1, -58, 100);
+  ObserveAccessPoint(table, kKitchen, 6, -63, 100);
+  TEST_ASSERT_EQUAL_UINT8(1, BestRoamingCandidate(table, 100)->channel);
+
+  for (int wake = 0; wake < 3; ++wake) {
+    RecordRoamingResult(table, kHallway, wake == 0, 900);
+    RecordRoamingResult(table, kKitchen, true, 300);
+  }
+  TEST_ASSERT_EQUAL_UINT8(6, BestRoamingCandidate(table, 100)->channel);
+}
+
+// Ensures a candidate that keeps failing is skipped rather than forgotten, and
+// gets one more attempt once a scan sees it again.
+void test_failing_candidate_is_skipped_until_seen_again() {
+  RoamingTable table;
+  ObserveAccessPoint(table, kHallway, 1, -50, 100);
+  ObserveAccessPoint(table, kKitchen, 6, -70, 100);
+
+  RecordRoamingResult(table, kHallway, false, 0);
+  TEST_ASSERT_EQUAL_UINT8(1, BestRoamingCandidate(table, 100)->channel);
+  RecordRoamingResult(table, kHallway, false, 0);
+  TEST_ASSERT_EQUAL_UINT8(6, BestRoamingCandidate(table, 100)->channel);
+
+  RecordRoamingResult(table, kKitchen, false, 0);
+  RecordRoamingResult(table, kKitchen, false, 0);
+  TEST_ASSERT_NULL(BestRoamingCandidate(table, 100));
+
+  ObserveAccessPoint(table, kHallway, 1, -50, 200);
+  TEST_ASSERT_EQUAL_UINT8(1, BestRoamingCandidate(table, 200)->channel);
+}
+
+// Checks that a full table evicts its worst candidate, that unseen and stale
+// candidates are dropped or skipped, and that channels are listed once.
+void test_table_eviction_staleness_and_channels() {
+  RoamingTable table;
+  for (size_t i = 0; i < kRoamingCandidateSlots; ++i) {
+    uint8_t bssid[6] = {0x02, 0, 0, 0, 0, static_cast<uint8_t>(i)};
+    ObserveAccessPoint(table, bssid, 11, static_cast<int8_t>(-60 - 5 * static_cast<int>(i)), 100);
+  }
+  ObserveAccessPoint(table, kAttic, 1, -62, 100);
+  uint8_t channels[kRoamingCandidateSlots] = {0};
+  TEST_ASSERT_EQUAL_UINT32(2, RoamingChannels(table, channels, kRoamingCandidateSlots));
+  TEST_ASSERT_EQUAL_UINT8(11, channels[0]);
+  TEST_ASSERT_EQUAL_UINT8(1, channels[1]);
+
+  bool weakestKept = false;
+  for (const RoamingCandidate& candidate : table.candidates) {
+    weakestKept = weakestKept || candidate.rssiDbm < -74.0f;
+  }
+  TEST_ASSERT_FALSE(weakestKept);
+
+  ObserveAccessPoint(table, kAttic, 1, -62, 500);
+  DropUnseenCandidates(table, 500);
+  TEST_ASSERT_EQUAL_UINT32(1, RoamingChannels(table, channels, kRoamingCandidateSlots));
+  TEST_ASSERT_NOT_NULL(BestRoamingCandidate(table, 500 + kRoamingCandidateMaxAgeSeconds));
+  TEST_ASSERT_NULL(BestRoamingCandidate(table, 501 + kRoamingCandidateMaxAgeSeconds));
+  TEST_ASSERT_NULL(BestRoamingCandidate(table, 10));
+}
+
+// Native test entry point for the Unity runner.
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_best_candidate_balances_signal_and_history);
+  RUN_TEST(test_failing_candidate_is_skipped_until_seen_again);
+  RUN_TEST(test_table_eviction_staleness_and_channels);
+  return UNITY_END();
+}